@@ -87,6 +87,12 @@
 #define BT_TASK_MAX_PRIORITIES      configMAX_PRIORITIES
 #define BT_BTC_TASK_STACK_SIZE      UC_BTC_TASK_STACK_SIZE
 
+#if UC_BT_OSI_THREAD_LOCKFREE_QUEUE
+#define OSI_THREAD_LOCKFREE_QUEUE   TRUE
+#else
+#define OSI_THREAD_LOCKFREE_QUEUE   FALSE
+#endif
+
 /* Define trace levels */
 #define BT_TRACE_LEVEL_NONE    UC_TRACE_LEVEL_NONE          /* No trace messages to be generated    */
 #define BT_TRACE_LEVEL_ERROR   UC_TRACE_LEVEL_ERROR         /* Error condition trace messages       */
@@ -44,6 +44,12 @@
 #define UC_BTC_TASK_STACK_SIZE              4096
 #endif
 
+#ifdef CONFIG_BT_OSI_THREAD_LOCKFREE_QUEUE
+#define UC_BT_OSI_THREAD_LOCKFREE_QUEUE     CONFIG_BT_OSI_THREAD_LOCKFREE_QUEUE
+#else
+#define UC_BT_OSI_THREAD_LOCKFREE_QUEUE     FALSE
+#endif
+
 /**********************************************************
  * Alarm reference
  **********************************************************/
@@ -81,6 +81,12 @@ const char *osi_thread_name(osi_thread_t *thread);
  */
 int osi_thread_queue_wait_size(osi_thread_t *thread, int wq_idx);
 
+/* brief: Get the number of times the thread has been woken up to process its work queues
+ * param thread: point of thread handler
+ * return: wake-up count since the thread was created
+ */
+uint32_t osi_thread_wake_count(osi_thread_t *thread);
+
 /*
  * brief: Create an osi_event struct and register the handler function and its argument
  *        An osi_event is a kind of work that can be posted to the workqueue of osi_thread to process,
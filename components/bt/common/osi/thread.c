@@ -30,10 +30,32 @@ struct work_item {
     void *context;
 };
 
+#if OSI_THREAD_LOCKFREE_QUEUE
+/*
+ * Bounded multi-producer single-consumer ring, each cell carries a sequence
+ * number which tells whether it is free for the producer owning position
+ * "seq" (seq == pos) or holds an item for the consumer (seq == pos + 1).
+ */
+struct work_cell {
+    uint32_t seq;
+    struct work_item item;
+};
+
+struct work_queue {
+    struct work_cell *cells;
+    uint32_t mask;
+    uint32_t head;                      /*!< Consumer position, only written by the owner thread */
+    uint32_t tail;                      /*!< Producer position, claimed with CAS */
+    uint32_t waiters;                   /*!< Producers blocked on a full ring */
+    osi_sem_t space_sem;
+    size_t capacity;
+};
+#else
 struct work_queue {
     QueueHandle_t queue;
     size_t capacity;
 };
+#endif /* OSI_THREAD_LOCKFREE_QUEUE */
 
 struct osi_thread {
   TaskHandle_t thread_handle;           /*!< Store the thread object */
@@ -43,6 +65,10 @@ struct osi_thread {
   struct work_queue **work_queues;      /*!< Point to queue array, and the priority inverse array index */
   osi_sem_t work_sem;
   osi_sem_t stop_sem;
+#if OSI_THREAD_LOCKFREE_QUEUE
+  uint32_t wake_pending;                /*!< Set when work_sem has been given and not yet taken */
+#endif
+  uint32_t wake_cnt;                    /*!< Number of times the thread has been woken up */
 };
 
 struct osi_thread_start_arg {
@@ -61,6 +87,178 @@ struct osi_event {
 
 static const size_t DEFAULT_WORK_QUEUE_CAPACITY = 100;
 
+#if OSI_THREAD_LOCKFREE_QUEUE
+static struct work_queue *osi_work_queue_create(size_t capacity)
+{
+    size_t size = 1;
+
+    if (capacity == 0) {
+        return NULL;
+    }
+
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    struct work_queue *wq = (struct work_queue *)osi_calloc(sizeof(struct work_queue));
+    if (wq == NULL) {
+        return NULL;
+    }
+
+    wq->cells = (struct work_cell *)osi_calloc(sizeof(struct work_cell) * size);
+    if (wq->cells != NULL && osi_sem_new(&wq->space_sem, 1, 0) == 0) {
+        for (uint32_t i = 0; i < size; i++) {
+            wq->cells[i].seq = i;
+        }
+        wq->mask = size - 1;
+        wq->capacity = size;
+        return wq;
+    }
+
+    if (wq->cells != NULL) {
+        osi_free(wq->cells);
+    }
+    osi_free(wq);
+
+    return NULL;
+}
+
+static void osi_work_queue_delete(struct work_queue *wq)
+{
+    if (wq != NULL) {
+        if (wq->space_sem) {
+            osi_sem_free(&wq->space_sem);
+        }
+        if (wq->cells != NULL) {
+            osi_free(wq->cells);
+        }
+        wq->cells = NULL;
+        wq->capacity = 0;
+        osi_free(wq);
+    }
+    return;
+}
+
+static bool osi_thead_work_queue_get(struct work_queue *wq, struct work_item *item)
+{
+    assert (wq != NULL);
+    assert (wq->cells != NULL);
+    assert (item != NULL);
+
+    uint32_t pos = wq->head;
+    struct work_cell *cell = &wq->cells[pos & wq->mask];
+
+    if (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) != pos + 1) {
+        return false;
+    }
+
+    *item = cell->item;
+    /* Hand the cell over to the producer of the next lap */
+    __atomic_store_n(&cell->seq, pos + wq->mask + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&wq->head, pos + 1, __ATOMIC_RELAXED);
+
+    /* Pairs with the fence in osi_thead_work_queue_put(): the store of seq
+     * above must not be reordered after the load of waiters below, or a
+     * producer may see the ring full while we see no waiter.
+     */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&wq->waiters, __ATOMIC_RELAXED) != 0) {
+        osi_sem_give(&wq->space_sem);
+    }
+
+    return true;
+}
+
+static bool osi_thead_work_queue_try_put(struct work_queue *wq, const struct work_item *item)
+{
+    uint32_t pos = __atomic_load_n(&wq->tail, __ATOMIC_RELAXED);
+    struct work_cell *cell = NULL;
+    int32_t diff;
+
+    while (1) {
+        cell = &wq->cells[pos & wq->mask];
+        diff = (int32_t)(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&wq->tail, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* The consumer has not freed this cell yet, the ring is full */
+            return false;
+        } else {
+            pos = __atomic_load_n(&wq->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->item = *item;
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+static bool osi_thead_work_queue_put(struct work_queue *wq, const struct work_item *item, uint32_t timeout)
+{
+    assert (wq != NULL);
+    assert (wq->cells != NULL);
+    assert (item != NULL);
+
+    if (osi_thead_work_queue_try_put(wq, item)) {
+        return true;
+    }
+
+    if (timeout == 0) {
+        return false;
+    }
+
+    /* Slow path: wait for the consumer to free a cell. The timeout applies
+     * to each wait, like xQueueSend() restarts its timeout on wake-ups.
+     */
+    bool ret = false;
+    __atomic_fetch_add(&wq->waiters, 1, __ATOMIC_RELAXED);
+    /* Pairs with the fence in osi_thead_work_queue_get(): either the
+     * consumer sees waiters != 0 and gives space_sem, or the try_put below
+     * sees the cell it freed.
+     */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    while (!(ret = osi_thead_work_queue_try_put(wq, item))) {
+        if (osi_sem_take(&wq->space_sem, timeout) != 0) {
+            ret = osi_thead_work_queue_try_put(wq, item);
+            break;
+        }
+    }
+    __atomic_fetch_sub(&wq->waiters, 1, __ATOMIC_RELAXED);
+
+    return ret;
+}
+
+static size_t osi_thead_work_queue_len(struct work_queue *wq)
+{
+    assert (wq != NULL);
+    assert (wq->cells != NULL);
+    assert (wq->capacity != 0);
+
+    uint32_t head = __atomic_load_n(&wq->head, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&wq->tail, __ATOMIC_RELAXED);
+    size_t len = (size_t)(tail - head);
+
+    /* Claimed cells may not be filled yet, the length is only a hint */
+    return (len <= wq->capacity) ? len : wq->capacity;
+}
+
+static void osi_thread_wakeup(osi_thread_t *thread)
+{
+    /* Only the first producer after the thread started draining gives the
+     * semaphore, the others find their items in the same drain pass. The
+     * fence pairs with the one after clearing wake_pending: either the
+     * thread sees the item published before, or we see wake_pending clear.
+     */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (!__atomic_exchange_n(&thread->wake_pending, 1, __ATOMIC_ACQ_REL)) {
+        osi_sem_give(&thread->work_sem);
+    }
+}
+#else /* OSI_THREAD_LOCKFREE_QUEUE */
 static struct work_queue *osi_work_queue_create(size_t capacity)
 {
     if (capacity == 0) {
@@ -143,6 +341,12 @@ static size_t osi_thead_work_queue_len(struct work_queue *wq)
     return 0;
 }
 
+static void osi_thread_wakeup(osi_thread_t *thread)
+{
+    osi_sem_give(&thread->work_sem);
+}
+#endif /* OSI_THREAD_LOCKFREE_QUEUE */
+
 static void osi_thread_run(void *arg)
 {
     struct osi_thread_start_arg *start = (struct osi_thread_start_arg *)arg;
@@ -154,11 +358,18 @@ static void osi_thread_run(void *arg)
         int idx = 0;
 
         osi_sem_take(&thread->work_sem, OSI_SEM_MAX_TIMEOUT);
+        thread->wake_cnt++;
 
         if (thread->stop) {
             break;
         }
 
+#if OSI_THREAD_LOCKFREE_QUEUE
+        /* Clear before draining, so that items posted from now on wake us up again */
+        __atomic_store_n(&thread->wake_pending, 0, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+
         struct work_item item;
         while (!thread->stop && idx < thread->work_queue_num) {
             if (osi_thead_work_queue_get(thread->work_queues[idx], &item) == true) {
@@ -345,7 +556,7 @@ bool osi_thread_post(osi_thread_t *thread, osi_thread_func_t func, void *context
         return false;
     }
 
-    osi_sem_give(&thread->work_sem);
+    osi_thread_wakeup(thread);
 
     return true;
 }
@@ -374,6 +585,13 @@ int osi_thread_queue_wait_size(osi_thread_t *thread, int wq_idx)
     return (int)(osi_thead_work_queue_len(thread->work_queues[wq_idx]));
 }
 
+uint32_t osi_thread_wake_count(osi_thread_t *thread)
+{
+    assert(thread != NULL);
+
+    return thread->wake_cnt;
+}
+
 
 struct osi_event *osi_event_create(osi_thread_func_t func, void *context)
 {
@@ -70,6 +70,29 @@ const esp_ble_mesh_comp_t *esp_ble_mesh_get_composition_data(void)
     return btc_ble_mesh_comp_get();
 }
 
+esp_err_t esp_ble_mesh_get_relay_stats(esp_ble_mesh_relay_stats_t *stats)
+{
+#if CONFIG_BLE_MESH_RELAY_ADV_BUF
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    btc_ble_mesh_relay_stats_get(stats);
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t esp_ble_mesh_reset_relay_stats(void)
+{
+#if CONFIG_BLE_MESH_RELAY_ADV_BUF
+    btc_ble_mesh_relay_stats_reset();
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
 esp_err_t esp_ble_mesh_model_subscribe_group_addr(uint16_t element_addr, uint16_t company_id,
                                                   uint16_t model_id, uint16_t group_addr)
 {
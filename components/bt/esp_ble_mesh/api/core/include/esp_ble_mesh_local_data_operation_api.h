@@ -102,6 +102,28 @@ esp_ble_mesh_model_t *esp_ble_mesh_find_sig_model(const esp_ble_mesh_elem_t *ele
  */
 const esp_ble_mesh_comp_t *esp_ble_mesh_get_composition_data(void);
 
+/**
+ * @brief        Get the counters of the relay queue.
+ *
+ * @note         The average time a relay packet spent in the relay queue is
+ *               latency_total / sent. Only available with CONFIG_BLE_MESH_RELAY_ADV_BUF.
+ *
+ * @param[out]   stats: Relay queue counters.
+ *
+ * @return       ESP_OK on success, ESP_ERR_NOT_SUPPORTED if relay advertising buffers are not used,
+ *               or ESP_ERR_INVALID_ARG if stats is NULL.
+ *
+ */
+esp_err_t esp_ble_mesh_get_relay_stats(esp_ble_mesh_relay_stats_t *stats);
+
+/**
+ * @brief        Reset the counters of the relay queue.
+ *
+ * @return       ESP_OK on success, or ESP_ERR_NOT_SUPPORTED if relay advertising buffers are not used.
+ *
+ */
+esp_err_t esp_ble_mesh_reset_relay_stats(void);
+
 /**
  * @brief        A local model of node or Provisioner subscribes a group address.
  *
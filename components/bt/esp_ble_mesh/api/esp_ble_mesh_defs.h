@@ -689,6 +689,20 @@ typedef struct {
     esp_ble_mesh_elem_t *elements;  /*!< A sequence of elements */
 } esp_ble_mesh_comp_t;
 
+/** Counters of the relay queue, used with CONFIG_BLE_MESH_RELAY_ADV_BUF.
+ *  This structure is associated with struct bt_mesh_relay_stats in adv.h
+ */
+typedef struct {
+    uint32_t queued;        /*!< Relay packets posted to the relay queue */
+    uint32_t sent;          /*!< Relay packets handed to the advertising bearer */
+    uint32_t dropped_dup;   /*!< Duplicates suppressed before buffer allocation */
+    uint32_t dropped_nobuf; /*!< Relay packets dropped for lack of relay buffers */
+    uint32_t dropped_full;  /*!< Relay packets dropped, or replaced by one with a higher or equal TTL, because the queue was full */
+    uint32_t dropped_stale; /*!< Relay packets which stayed in the queue too long */
+    uint32_t latency_total; /*!< Sum of the queueing latency of sent packets, in ms */
+    uint32_t latency_max;   /*!< Maximum queueing latency of a sent packet, in ms */
+} esp_ble_mesh_relay_stats_t;
+
 /*!< This enum value is the role of the device */
 typedef enum {
     ROLE_NODE = 0,
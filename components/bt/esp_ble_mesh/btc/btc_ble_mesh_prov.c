@@ -1126,6 +1126,29 @@ const esp_ble_mesh_comp_t *btc_ble_mesh_comp_get(void)
     return (const esp_ble_mesh_comp_t *)bt_mesh_comp_get();
 }
 
+#if CONFIG_BLE_MESH_RELAY_ADV_BUF
+void btc_ble_mesh_relay_stats_get(esp_ble_mesh_relay_stats_t *stats)
+{
+    struct bt_mesh_relay_stats relay_stats = {0};
+
+    bt_mesh_relay_stats_get(&relay_stats);
+
+    stats->queued = relay_stats.queued;
+    stats->sent = relay_stats.sent;
+    stats->dropped_dup = relay_stats.dropped_dup;
+    stats->dropped_nobuf = relay_stats.dropped_nobuf;
+    stats->dropped_full = relay_stats.dropped_full;
+    stats->dropped_stale = relay_stats.dropped_stale;
+    stats->latency_total = relay_stats.latency_total;
+    stats->latency_max = relay_stats.latency_max;
+}
+
+void btc_ble_mesh_relay_stats_reset(void)
+{
+    bt_mesh_relay_stats_reset();
+}
+#endif /* CONFIG_BLE_MESH_RELAY_ADV_BUF */
+
 /* Configuration Models */
 extern const struct bt_mesh_model_op bt_mesh_cfg_srv_op[];
 extern const struct bt_mesh_model_cb bt_mesh_cfg_srv_cb;
@@ -378,6 +378,10 @@ esp_ble_mesh_model_t *btc_ble_mesh_model_find(const esp_ble_mesh_elem_t *elem, u
 
 const esp_ble_mesh_comp_t *btc_ble_mesh_comp_get(void);
 
+void btc_ble_mesh_relay_stats_get(esp_ble_mesh_relay_stats_t *stats);
+
+void btc_ble_mesh_relay_stats_reset(void);
+
 const char *btc_ble_mesh_provisioner_get_settings_uid(uint8_t index);
 
 uint8_t btc_ble_mesh_provisioner_get_settings_index(const char *uid);
@@ -39,6 +39,9 @@ void bt_mesh_buf_unlock(void);
 void bt_mesh_atomic_lock(void);
 void bt_mesh_atomic_unlock(void);
 
+void bt_mesh_crypto_lock(void);
+void bt_mesh_crypto_unlock(void);
+
 void bt_mesh_mutex_init(void);
 void bt_mesh_mutex_deinit(void);
 
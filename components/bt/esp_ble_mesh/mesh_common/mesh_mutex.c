@@ -10,6 +10,7 @@ static bt_mesh_mutex_t alarm_lock;
 static bt_mesh_mutex_t list_lock;
 static bt_mesh_mutex_t buf_lock;
 static bt_mesh_mutex_t atomic_lock;
+static bt_mesh_mutex_t crypto_lock;
 
 void bt_mesh_mutex_create(bt_mesh_mutex_t *mutex)
 {
@@ -142,12 +143,30 @@ void bt_mesh_atomic_unlock(void)
     bt_mesh_mutex_unlock(&atomic_lock);
 }
 
+static inline void bt_mesh_crypto_mutex_new(void)
+{
+    if (!crypto_lock.mutex) {
+        bt_mesh_mutex_create(&crypto_lock);
+    }
+}
+
+void bt_mesh_crypto_lock(void)
+{
+    bt_mesh_mutex_lock(&crypto_lock);
+}
+
+void bt_mesh_crypto_unlock(void)
+{
+    bt_mesh_mutex_unlock(&crypto_lock);
+}
+
 void bt_mesh_mutex_init(void)
 {
     bt_mesh_alarm_mutex_new();
     bt_mesh_list_mutex_new();
     bt_mesh_buf_mutex_new();
     bt_mesh_atomic_mutex_new();
+    bt_mesh_crypto_mutex_new();
 }
 
 #if CONFIG_BLE_MESH_DEINIT
@@ -171,11 +190,17 @@ static inline void bt_mesh_atomic_mutex_free(void)
     bt_mesh_mutex_free(&atomic_lock);
 }
 
+static inline void bt_mesh_crypto_mutex_free(void)
+{
+    bt_mesh_mutex_free(&crypto_lock);
+}
+
 void bt_mesh_mutex_deinit(void)
 {
     bt_mesh_alarm_mutex_free();
     bt_mesh_list_mutex_free();
     bt_mesh_buf_mutex_free();
     bt_mesh_atomic_mutex_free();
+    bt_mesh_crypto_mutex_free();
 }
 #endif /* CONFIG_BLE_MESH_DEINIT */
@@ -16,6 +16,7 @@
 #include "mesh_hci.h"
 #include "mesh_common.h"
 #include "adv.h"
+#include "relay_queue.h"
 #include "beacon.h"
 #include "prov.h"
 #include "foundation.h"
@@ -69,16 +70,33 @@ NET_BUF_POOL_DEFINE(relay_adv_buf_pool, CONFIG_BLE_MESH_RELAY_ADV_BUF_COUNT,
 
 static struct bt_mesh_adv relay_adv_pool[CONFIG_BLE_MESH_RELAY_ADV_BUF_COUNT];
 
+/* Relay packets are kept ordered by priority in relay_prio_queue, the
+ * FreeRTOS relay_queue only holds one token per packet, so that the adv
+ * task keeps waiting on both queues through mesh_queue_set.
+ */
 static struct bt_mesh_queue relay_queue;
 #define BLE_MESH_RELAY_QUEUE_SIZE   CONFIG_BLE_MESH_RELAY_ADV_BUF_COUNT
 
+static struct bt_mesh_relay_queue relay_prio_queue;
+static bt_mesh_msg_t relay_prio_msgs[BLE_MESH_RELAY_QUEUE_SIZE];
+static bt_mesh_mutex_t relay_prio_lock;
+
 static QueueSetHandle_t mesh_queue_set;
 #define BLE_MESH_QUEUE_SET_SIZE     (BLE_MESH_ADV_QUEUE_SIZE + BLE_MESH_RELAY_QUEUE_SIZE)
 
 #define BLE_MESH_RELAY_TIME_INTERVAL     K_SECONDS(6)
 #define BLE_MESH_MAX_TIME_INTERVAL       0xFFFFFFFF
 
-static bool ignore_relay_packet(uint32_t timestamp);
+/* Updated by the adv task and the tasks relaying packets, read by the
+ * application, hence protected by relay_stats_lock.
+ */
+static struct bt_mesh_relay_stats relay_stats;
+static bt_mesh_mutex_t relay_stats_lock;
+
+static uint32_t relay_packet_age(uint32_t timestamp);
+static bool relay_queue_receive(bt_mesh_msg_t *msg);
+static void relay_stats_queued(void);
+static void relay_stats_sent(uint32_t age);
 #endif /* defined(CONFIG_BLE_MESH_RELAY_ADV_BUF) */
 
 #if CONFIG_BLE_MESH_SUPPORT_BLE_ADV
@@ -274,7 +292,7 @@ static void adv_thread(void *p)
             if (uxQueueMessagesWaiting(adv_queue.handle)) {
                 xQueueReceive(adv_queue.handle, &msg, K_NO_WAIT);
             } else if (uxQueueMessagesWaiting(relay_queue.handle)) {
-                xQueueReceive(relay_queue.handle, &msg, K_NO_WAIT);
+                relay_queue_receive(&msg);
             }
         } else {
             while (!(*buf)) {
@@ -289,7 +307,7 @@ static void adv_thread(void *p)
                     if (uxQueueMessagesWaiting(adv_queue.handle)) {
                         xQueueReceive(adv_queue.handle, &msg, K_NO_WAIT);
                     } else if (uxQueueMessagesWaiting(relay_queue.handle)) {
-                        xQueueReceive(relay_queue.handle, &msg, K_NO_WAIT);
+                        relay_queue_receive(&msg);
                     }
                 }
             }
@@ -300,7 +318,7 @@ static void adv_thread(void *p)
             if (uxQueueMessagesWaiting(adv_queue.handle)) {
                 xQueueReceive(adv_queue.handle, &msg, K_NO_WAIT);
             } else if (uxQueueMessagesWaiting(relay_queue.handle)) {
-                xQueueReceive(relay_queue.handle, &msg, K_NO_WAIT);
+                relay_queue_receive(&msg);
             }
         }
 #endif /* (CONFIG_BLE_MESH_NODE && CONFIG_BLE_MESH_PB_GATT) || CONFIG_BLE_MESH_GATT_PROXY_SERVER */
@@ -317,13 +335,19 @@ static void adv_thread(void *p)
                 BT_WARN("Failed to send adv packet");
             }
 #else /* !defined(CONFIG_BLE_MESH_RELAY_ADV_BUF) */
-            if (msg.relay && ignore_relay_packet(msg.timestamp)) {
+            uint32_t age = msg.relay ? relay_packet_age(msg.timestamp) : 0U;
+
+            if (msg.relay && age >= BLE_MESH_RELAY_TIME_INTERVAL) {
                 /* If the interval between "current time - msg.timestamp" is bigger than
                  * BLE_MESH_RELAY_TIME_INTERVAL, this relay packet will not be sent.
                  */
                 BT_INFO("Ignore relay packet");
+                bt_mesh_relay_stats_drop(BLE_MESH_RELAY_DROP_STALE);
                 net_buf_unref(*buf);
             } else {
+                if (msg.relay) {
+                    relay_stats_sent(age);
+                }
                 if (adv_send(*buf)) {
                     BT_WARN("Failed to send adv packet");
                 }
@@ -491,18 +515,15 @@ void bt_mesh_adv_update(void)
 }
 
 #if defined(CONFIG_BLE_MESH_RELAY_ADV_BUF)
-static bool ignore_relay_packet(uint32_t timestamp)
+static uint32_t relay_packet_age(uint32_t timestamp)
 {
     uint32_t now = k_uptime_get_32();
-    uint32_t interval = 0U;
 
     if (now >= timestamp) {
-        interval = now - timestamp;
-    } else {
-        interval = BLE_MESH_MAX_TIME_INTERVAL - (timestamp - now) + 1;
+        return now - timestamp;
     }
 
-    return (interval >= BLE_MESH_RELAY_TIME_INTERVAL) ? true : false;
+    return BLE_MESH_MAX_TIME_INTERVAL - (timestamp - now) + 1;
 }
 
 static struct bt_mesh_adv *relay_adv_alloc(int id)
@@ -517,10 +538,11 @@ struct net_buf *bt_mesh_relay_adv_create(enum bt_mesh_adv_type type, uint8_t xmi
                                         xmit, timeout);
 }
 
-static void ble_mesh_relay_task_post(bt_mesh_msg_t *msg, uint32_t timeout)
+static void ble_mesh_relay_task_post(bt_mesh_msg_t *msg)
 {
-    QueueSetMemberHandle_t handle = NULL;
-    bt_mesh_msg_t old_msg = {0};
+    enum bt_mesh_relay_queue_put ret = BLE_MESH_RELAY_QUEUE_ADDED;
+    bt_mesh_msg_t dropped = {0};
+    uint8_t token = 0U;
 
     BT_DBG("%s", __func__);
 
@@ -529,42 +551,65 @@ static void ble_mesh_relay_task_post(bt_mesh_msg_t *msg, uint32_t timeout)
         return;
     }
 
-    if (xQueueSend(relay_queue.handle, msg, timeout) == pdTRUE) {
-        return;
-    }
-
     /**
-     * If failed to send packet to the relay queue(queue is full), we will
-     * remove the oldest packet in the queue and put the new one into it.
+     * If the relay queue is full, a stale packet is dropped first, then
+     * the oldest packet with the lowest TTL, unless all the queued packets
+     * have a higher TTL than the new one, which is dropped instead.
      */
-    handle = xQueueSelectFromSet(mesh_queue_set, K_NO_WAIT);
-    if (handle && uxQueueMessagesWaiting(relay_queue.handle)) {
-        BT_INFO("Full queue, remove the oldest relay packet");
-        /* Remove the oldest relay packet from queue */
-        if (xQueueReceive(relay_queue.handle, &old_msg, K_NO_WAIT) != pdTRUE) {
-            BT_ERR("Failed to remove item from relay queue");
-            bt_mesh_unref_buf(msg);
-            return;
-        }
-        /* Unref buf used for the oldest relay packet */
-        bt_mesh_unref_buf(&old_msg);
-        /* Send the latest relay packet to queue */
-        if (xQueueSend(relay_queue.handle, msg, K_NO_WAIT) != pdTRUE) {
+    bt_mesh_mutex_lock(&relay_prio_lock);
+    ret = bt_mesh_relay_queue_put(&relay_prio_queue, msg, k_uptime_get_32(),
+                                  BLE_MESH_RELAY_TIME_INTERVAL, &dropped);
+    bt_mesh_mutex_unlock(&relay_prio_lock);
+
+    switch (ret) {
+    case BLE_MESH_RELAY_QUEUE_ADDED:
+        /* The packet is queued before its token, the adv task always finds it */
+        if (xQueueSend(relay_queue.handle, &token, K_NO_WAIT) != pdTRUE) {
             BT_ERR("Failed to send item to relay queue");
-            bt_mesh_unref_buf(msg);
-            return;
         }
-    } else {
-        BT_WARN("Empty queue, but failed to send the relay packet");
-        bt_mesh_unref_buf(msg);
+        relay_stats_queued();
+        return;
+    case BLE_MESH_RELAY_QUEUE_REPLACED_STALE:
+        BT_INFO("Full queue, remove a stale relay packet");
+        bt_mesh_relay_stats_drop(BLE_MESH_RELAY_DROP_STALE);
+        relay_stats_queued();
+        break;
+    case BLE_MESH_RELAY_QUEUE_REPLACED_TTL:
+        BT_INFO("Full queue, remove relay packet with TTL %u", dropped.ttl);
+        bt_mesh_relay_stats_drop(BLE_MESH_RELAY_DROP_FULL);
+        relay_stats_queued();
+        break;
+    default:
+        BT_INFO("Full queue, drop relay packet with TTL %u", msg->ttl);
+        bt_mesh_relay_stats_drop(BLE_MESH_RELAY_DROP_FULL);
+        break;
+    }
+
+    bt_mesh_unref_buf(&dropped);
+}
+
+static bool relay_queue_receive(bt_mesh_msg_t *msg)
+{
+    uint8_t token = 0U;
+    bool ret = false;
+
+    if (xQueueReceive(relay_queue.handle, &token, K_NO_WAIT) != pdTRUE) {
+        return false;
     }
+
+    bt_mesh_mutex_lock(&relay_prio_lock);
+    ret = bt_mesh_relay_queue_get(&relay_prio_queue, msg);
+    bt_mesh_mutex_unlock(&relay_prio_lock);
+
+    return ret;
 }
 
 void bt_mesh_relay_adv_send(struct net_buf *buf, const struct bt_mesh_send_cb *cb,
-                            void *cb_data, uint16_t src, uint16_t dst)
+                            void *cb_data, uint16_t src, uint16_t dst, uint8_t ttl)
 {
     bt_mesh_msg_t msg = {
         .relay = true,
+        .ttl = ttl,
     };
 
     BT_DBG("type 0x%02x len %u: %s", BLE_MESH_ADV(buf)->type, buf->len,
@@ -578,14 +623,68 @@ void bt_mesh_relay_adv_send(struct net_buf *buf, const struct bt_mesh_send_cb *c
     msg.src = src;
     msg.dst = dst;
     msg.timestamp = k_uptime_get_32();
-    /* Use K_NO_WAIT here, if relay_queue is full return immediately */
-    ble_mesh_relay_task_post(&msg, K_NO_WAIT);
+    /* Never blocks, if the relay queue is full a packet is dropped */
+    ble_mesh_relay_task_post(&msg);
 }
 
 uint16_t bt_mesh_get_stored_relay_count(void)
 {
     return (uint16_t)uxQueueMessagesWaiting(relay_queue.handle);
 }
+
+static void relay_stats_queued(void)
+{
+    bt_mesh_mutex_lock(&relay_stats_lock);
+    relay_stats.queued++;
+    bt_mesh_mutex_unlock(&relay_stats_lock);
+}
+
+static void relay_stats_sent(uint32_t age)
+{
+    bt_mesh_mutex_lock(&relay_stats_lock);
+    relay_stats.sent++;
+    relay_stats.latency_total += age;
+    if (age > relay_stats.latency_max) {
+        relay_stats.latency_max = age;
+    }
+    bt_mesh_mutex_unlock(&relay_stats_lock);
+}
+
+void bt_mesh_relay_stats_drop(enum bt_mesh_relay_drop reason)
+{
+    bt_mesh_mutex_lock(&relay_stats_lock);
+    switch (reason) {
+    case BLE_MESH_RELAY_DROP_DUP:
+        relay_stats.dropped_dup++;
+        break;
+    case BLE_MESH_RELAY_DROP_NOBUF:
+        relay_stats.dropped_nobuf++;
+        break;
+    case BLE_MESH_RELAY_DROP_FULL:
+        relay_stats.dropped_full++;
+        break;
+    case BLE_MESH_RELAY_DROP_STALE:
+        relay_stats.dropped_stale++;
+        break;
+    default:
+        break;
+    }
+    bt_mesh_mutex_unlock(&relay_stats_lock);
+}
+
+void bt_mesh_relay_stats_get(struct bt_mesh_relay_stats *stats)
+{
+    bt_mesh_mutex_lock(&relay_stats_lock);
+    *stats = relay_stats;
+    bt_mesh_mutex_unlock(&relay_stats_lock);
+}
+
+void bt_mesh_relay_stats_reset(void)
+{
+    bt_mesh_mutex_lock(&relay_stats_lock);
+    (void)memset(&relay_stats, 0, sizeof(relay_stats));
+    bt_mesh_mutex_unlock(&relay_stats_lock);
+}
 #endif /* #if defined(CONFIG_BLE_MESH_RELAY_ADV_BUF) */
 
 void bt_mesh_adv_init(void)
@@ -612,7 +711,7 @@ void bt_mesh_adv_init(void)
 
 #if defined(CONFIG_BLE_MESH_RELAY_ADV_BUF)
 #if !CONFIG_BLE_MESH_FREERTOS_STATIC_ALLOC
-    relay_queue.handle = xQueueCreate(BLE_MESH_RELAY_QUEUE_SIZE, sizeof(bt_mesh_msg_t));
+    relay_queue.handle = xQueueCreate(BLE_MESH_RELAY_QUEUE_SIZE, sizeof(uint8_t));
     __ASSERT(relay_queue.handle, "Failed to create relay queue");
 #else /* !CONFIG_BLE_MESH_FREERTOS_STATIC_ALLOC */
 #if CONFIG_BLE_MESH_FREERTOS_STATIC_ALLOC_EXTERNAL
@@ -622,12 +721,12 @@ void bt_mesh_adv_init(void)
 #endif
     __ASSERT(relay_queue.buffer, "Failed to create relay queue buffer");
 #if CONFIG_BLE_MESH_FREERTOS_STATIC_ALLOC_EXTERNAL
-    relay_queue.storage = heap_caps_calloc_prefer(1, (BLE_MESH_RELAY_QUEUE_SIZE * sizeof(bt_mesh_msg_t)), 2, MALLOC_CAP_SPIRAM|MALLOC_CAP_8BIT, MALLOC_CAP_INTERNAL|MALLOC_CAP_8BIT);
+    relay_queue.storage = heap_caps_calloc_prefer(1, (BLE_MESH_RELAY_QUEUE_SIZE * sizeof(uint8_t)), 2, MALLOC_CAP_SPIRAM|MALLOC_CAP_8BIT, MALLOC_CAP_INTERNAL|MALLOC_CAP_8BIT);
 #elif CONFIG_BLE_MESH_FREERTOS_STATIC_ALLOC_IRAM_8BIT
-    relay_queue.storage = heap_caps_calloc_prefer(1, (BLE_MESH_RELAY_QUEUE_SIZE * sizeof(bt_mesh_msg_t)), 2, MALLOC_CAP_INTERNAL|MALLOC_CAP_IRAM_8BIT, MALLOC_CAP_INTERNAL|MALLOC_CAP_8BIT);
+    relay_queue.storage = heap_caps_calloc_prefer(1, (BLE_MESH_RELAY_QUEUE_SIZE * sizeof(uint8_t)), 2, MALLOC_CAP_INTERNAL|MALLOC_CAP_IRAM_8BIT, MALLOC_CAP_INTERNAL|MALLOC_CAP_8BIT);
 #endif
     __ASSERT(relay_queue.storage, "Failed to create relay queue storage");
-    relay_queue.handle = xQueueCreateStatic(BLE_MESH_RELAY_QUEUE_SIZE, sizeof(bt_mesh_msg_t), (uint8_t*)relay_queue.storage, relay_queue.buffer);
+    relay_queue.handle = xQueueCreateStatic(BLE_MESH_RELAY_QUEUE_SIZE, sizeof(uint8_t), (uint8_t*)relay_queue.storage, relay_queue.buffer);
     __ASSERT(relay_queue.handle, "Failed to create static relay queue");
 #endif /* !CONFIG_BLE_MESH_FREERTOS_STATIC_ALLOC */
 
@@ -635,6 +734,10 @@ void bt_mesh_adv_init(void)
     __ASSERT(mesh_queue_set, "Failed to create queue set");
     xQueueAddToSet(adv_queue.handle, mesh_queue_set);
     xQueueAddToSet(relay_queue.handle, mesh_queue_set);
+
+    bt_mesh_relay_queue_init(&relay_prio_queue, relay_prio_msgs, BLE_MESH_RELAY_QUEUE_SIZE);
+    bt_mesh_mutex_create(&relay_prio_lock);
+    bt_mesh_mutex_create(&relay_stats_lock);
 #endif /* defined(CONFIG_BLE_MESH_RELAY_ADV_BUF) */
 
 #if (CONFIG_BLE_MESH_FREERTOS_STATIC_ALLOC_EXTERNAL && \
@@ -688,6 +791,10 @@ void bt_mesh_adv_deinit(void)
 
     bt_mesh_unref_buf_from_pool(&relay_adv_buf_pool);
     memset(relay_adv_pool, 0, sizeof(relay_adv_pool));
+    bt_mesh_relay_queue_init(&relay_prio_queue, relay_prio_msgs, BLE_MESH_RELAY_QUEUE_SIZE);
+    bt_mesh_mutex_free(&relay_prio_lock);
+    bt_mesh_relay_stats_reset();
+    bt_mesh_mutex_free(&relay_stats_lock);
 
     vQueueDelete(mesh_queue_set);
     mesh_queue_set = NULL;
@@ -29,6 +29,7 @@ extern "C" {
 
 typedef struct bt_mesh_msg {
     bool  relay;        /* Flag indicates if the packet is a relayed one */
+    uint8_t ttl;        /* TTL of relay packets, used when the relay queue is full */
     void *arg;          /* Pointer to the struct net_buf */
     uint16_t src;       /* Source address for relay packets */
     uint16_t dst;       /* Destination address for relay packets */
@@ -83,10 +84,36 @@ struct net_buf *bt_mesh_relay_adv_create(enum bt_mesh_adv_type type, uint8_t xmi
                                          int32_t timeout);
 
 void bt_mesh_relay_adv_send(struct net_buf *buf, const struct bt_mesh_send_cb *cb,
-                            void *cb_data, uint16_t src, uint16_t dst);
+                            void *cb_data, uint16_t src, uint16_t dst, uint8_t ttl);
 
 uint16_t bt_mesh_get_stored_relay_count(void);
 
+/* Counters of the relay pipeline, the average time a relay packet spent
+ * in the relay queue is latency_total / sent (in ms).
+ */
+struct bt_mesh_relay_stats {
+    uint32_t queued;        /* Relay packets posted to the relay queue */
+    uint32_t sent;          /* Relay packets handed to the advertising bearer */
+    uint32_t dropped_dup;   /* Duplicates suppressed before buffer allocation */
+    uint32_t dropped_nobuf; /* Relay packets dropped for lack of relay buffers */
+    uint32_t dropped_full;  /* Relay packets dropped, or replaced by one with a higher or equal TTL, because the queue was full */
+    uint32_t dropped_stale; /* Relay packets which stayed in the queue too long */
+    uint32_t latency_total; /* Sum of the queueing latency of sent packets */
+    uint32_t latency_max;   /* Maximum queueing latency of a sent packet */
+};
+
+enum bt_mesh_relay_drop {
+    BLE_MESH_RELAY_DROP_DUP,
+    BLE_MESH_RELAY_DROP_NOBUF,
+    BLE_MESH_RELAY_DROP_FULL,
+    BLE_MESH_RELAY_DROP_STALE,
+};
+
+void bt_mesh_relay_stats_drop(enum bt_mesh_relay_drop reason);
+
+void bt_mesh_relay_stats_get(struct bt_mesh_relay_stats *stats);
+void bt_mesh_relay_stats_reset(void);
+
 void bt_mesh_adv_update(void);
 
 void bt_mesh_adv_init(void);
@@ -438,6 +438,7 @@ static uint8_t app_key_set(uint16_t net_idx, uint16_t app_idx, const uint8_t val
 
         return STATUS_STORAGE_FAIL;
     }
+    bt_mesh_app_key_aid_index_invalidate();
 
     BT_DBG("app_idx 0x%04x AID 0x%02x", app_idx, keys->id);
 
@@ -549,6 +550,7 @@ void bt_mesh_app_key_del(struct bt_mesh_app_key *key, bool store)
 
     key->net_idx = BLE_MESH_KEY_UNUSED;
     (void)memset(key->keys, 0, sizeof(key->keys));
+    bt_mesh_crypto_key_cache_clear();
 }
 
 static void app_key_del(struct bt_mesh_model *model,
@@ -3689,4 +3691,5 @@ void bt_mesh_subnet_del(struct bt_mesh_subnet *sub, bool store)
 
     (void)memset(sub, 0, sizeof(*sub));
     sub->net_idx = BLE_MESH_KEY_UNUSED;
+    bt_mesh_crypto_key_cache_clear();
 }
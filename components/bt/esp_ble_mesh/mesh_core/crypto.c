@@ -14,6 +14,11 @@
 #include <tinycrypt/aes.h>
 #include <tinycrypt/constants.h>
 #include <tinycrypt/cmac_mode.h>
+#include <tinycrypt/utils.h>
+
+#if CONFIG_MBEDTLS_HARDWARE_AES
+#include "mbedtls/aes.h"
+#endif
 
 #include "crypto.h"
 #include "mesh_common.h"
@@ -22,6 +27,136 @@
 #define NET_MIC_LEN(pdu) (((pdu)[1] & 0x80) ? 8 : 4)
 #define APP_MIC_LEN(aszmic) ((aszmic) ? 8 : 4)
 
+/* Expanded AES-128 key. The same backend as bt_mesh_encrypt_be() is used,
+ * i.e. the AES accelerator through mbedtls if available, tinycrypt otherwise.
+ */
+struct bt_mesh_aes_key {
+#if CONFIG_MBEDTLS_HARDWARE_AES
+    mbedtls_aes_context ctx;
+#else
+    struct tc_aes_key_sched_struct sched;
+#endif
+};
+
+/* Recently used expanded keys. All the blocks of a CCM operation, the
+ * obfuscation, consecutive segments and relayed PDUs mostly use the same
+ * few EncKeys/PrivacyKeys/AppKeys, so each key is expanded once instead of
+ * once for every AES block. Entries are copied out under the lock, since
+ * PDUs may be encrypted from different tasks.
+ */
+#define AES_KEY_CACHE_SIZE  4
+
+static struct {
+    bool    valid;
+    uint8_t key[16];
+    struct bt_mesh_aes_key aes;
+} aes_key_cache[AES_KEY_CACHE_SIZE];
+static uint8_t aes_key_cache_next;
+
+static int aes_key_expand(const uint8_t key[16], struct bt_mesh_aes_key *aes)
+{
+#if CONFIG_MBEDTLS_HARDWARE_AES
+    mbedtls_aes_init(&aes->ctx);
+
+    if (mbedtls_aes_setkey_enc(&aes->ctx, key, 128) != 0) {
+        mbedtls_aes_free(&aes->ctx);
+        return -EINVAL;
+    }
+#else /* CONFIG_MBEDTLS_HARDWARE_AES */
+    if (tc_aes128_set_encrypt_key(&aes->sched, key) == TC_CRYPTO_FAIL) {
+        return -EINVAL;
+    }
+#endif /* CONFIG_MBEDTLS_HARDWARE_AES */
+
+    return 0;
+}
+
+static void aes_key_free(struct bt_mesh_aes_key *aes)
+{
+#if CONFIG_MBEDTLS_HARDWARE_AES
+    mbedtls_aes_free(&aes->ctx);
+#else
+    _set_secure(&aes->sched, 0, sizeof(aes->sched));
+#endif
+}
+
+static int aes_key_get(const uint8_t key[16], struct bt_mesh_aes_key *aes)
+{
+    int err = 0;
+    int i;
+
+    bt_mesh_crypto_lock();
+
+    for (i = 0; i < ARRAY_SIZE(aes_key_cache); i++) {
+        if (aes_key_cache[i].valid &&
+            !memcmp(aes_key_cache[i].key, key, 16)) {
+            memcpy(aes, &aes_key_cache[i].aes, sizeof(*aes));
+            bt_mesh_crypto_unlock();
+            return 0;
+        }
+    }
+
+    bt_mesh_crypto_unlock();
+
+    err = aes_key_expand(key, aes);
+    if (err) {
+        return err;
+    }
+
+    bt_mesh_crypto_lock();
+
+    i = aes_key_cache_next++;
+    aes_key_cache_next %= ARRAY_SIZE(aes_key_cache);
+
+    if (aes_key_cache[i].valid) {
+        aes_key_free(&aes_key_cache[i].aes);
+    }
+
+    memcpy(aes_key_cache[i].key, key, 16);
+    memcpy(&aes_key_cache[i].aes, aes, sizeof(*aes));
+    aes_key_cache[i].valid = true;
+
+    bt_mesh_crypto_unlock();
+
+    return 0;
+}
+
+static int aes_key_encrypt(struct bt_mesh_aes_key *aes,
+                           const uint8_t plaintext[16],
+                           uint8_t enc_data[16])
+{
+#if CONFIG_MBEDTLS_HARDWARE_AES
+    if (mbedtls_aes_crypt_ecb(&aes->ctx, MBEDTLS_AES_ENCRYPT,
+                              plaintext, enc_data) != 0) {
+        return -EINVAL;
+    }
+#else /* CONFIG_MBEDTLS_HARDWARE_AES */
+    if (tc_aes_encrypt(enc_data, plaintext, &aes->sched) == TC_CRYPTO_FAIL) {
+        return -EINVAL;
+    }
+#endif /* CONFIG_MBEDTLS_HARDWARE_AES */
+
+    return 0;
+}
+
+void bt_mesh_crypto_key_cache_clear(void)
+{
+    int i;
+
+    bt_mesh_crypto_lock();
+
+    for (i = 0; i < ARRAY_SIZE(aes_key_cache); i++) {
+        if (aes_key_cache[i].valid) {
+            aes_key_free(&aes_key_cache[i].aes);
+        }
+    }
+
+    (void)memset(aes_key_cache, 0, sizeof(aes_key_cache));
+    aes_key_cache_next = 0U;
+
+    bt_mesh_crypto_unlock();
+}
+
 int bt_mesh_aes_cmac(const uint8_t key[16], struct bt_mesh_sg *sg,
                      size_t sg_len, uint8_t mac[16])
 {
@@ -192,10 +327,10 @@ int bt_mesh_id128(const uint8_t n[16], const char *s, uint8_t out[16])
     return bt_mesh_k1(n, 16, salt, id128, out);
 }
 
-static int bt_mesh_ccm_decrypt(const uint8_t key[16], uint8_t nonce[13],
-                               const uint8_t *enc_msg, size_t msg_len,
-                               const uint8_t *aad, size_t aad_len,
-                               uint8_t *out_msg, size_t mic_size)
+static int ccm_decrypt(struct bt_mesh_aes_key *aes, uint8_t nonce[13],
+                       const uint8_t *enc_msg, size_t msg_len,
+                       const uint8_t *aad, size_t aad_len,
+                       uint8_t *out_msg, size_t mic_size)
 {
     uint8_t msg[16] = {0}, pmsg[16] = {0}, cmic[16] = {0},
             cmsg[16] = {0}, Xn[16] = {0}, mic[16] = {0};
@@ -212,7 +347,7 @@ static int bt_mesh_ccm_decrypt(const uint8_t key[16], uint8_t nonce[13],
     memcpy(pmsg + 1, nonce, 13);
     sys_put_be16(0x0000, pmsg + 14);
 
-    err = bt_mesh_encrypt_be(key, pmsg, cmic);
+    err = aes_key_encrypt(aes, pmsg, cmic);
     if (err) {
         return err;
     }
@@ -227,7 +362,7 @@ static int bt_mesh_ccm_decrypt(const uint8_t key[16], uint8_t nonce[13],
     memcpy(pmsg + 1, nonce, 13);
     sys_put_be16(msg_len, pmsg + 14);
 
-    err = bt_mesh_encrypt_be(key, pmsg, Xn);
+    err = aes_key_encrypt(aes, pmsg, Xn);
     if (err) {
         return err;
     }
@@ -251,7 +386,7 @@ static int bt_mesh_ccm_decrypt(const uint8_t key[16], uint8_t nonce[13],
             aad_len -= 16;
             i = 0;
 
-            err = bt_mesh_encrypt_be(key, pmsg, Xn);
+            err = aes_key_encrypt(aes, pmsg, Xn);
             if (err) {
                 return err;
             }
@@ -265,7 +400,7 @@ static int bt_mesh_ccm_decrypt(const uint8_t key[16], uint8_t nonce[13],
             pmsg[i] = Xn[i];
         }
 
-        err = bt_mesh_encrypt_be(key, pmsg, Xn);
+        err = aes_key_encrypt(aes, pmsg, Xn);
         if (err) {
             return err;
         }
@@ -284,7 +419,7 @@ static int bt_mesh_ccm_decrypt(const uint8_t key[16], uint8_t nonce[13],
             memcpy(pmsg + 1, nonce, 13);
             sys_put_be16(j + 1, pmsg + 14);
 
-            err = bt_mesh_encrypt_be(key, pmsg, cmsg);
+            err = aes_key_encrypt(aes, pmsg, cmsg);
             if (err) {
                 return err;
             }
@@ -305,7 +440,7 @@ static int bt_mesh_ccm_decrypt(const uint8_t key[16], uint8_t nonce[13],
                 pmsg[i] = Xn[i] ^ 0x00;
             }
 
-            err = bt_mesh_encrypt_be(key, pmsg, Xn);
+            err = aes_key_encrypt(aes, pmsg, Xn);
             if (err) {
                 return err;
             }
@@ -320,7 +455,7 @@ static int bt_mesh_ccm_decrypt(const uint8_t key[16], uint8_t nonce[13],
             memcpy(pmsg + 1, nonce, 13);
             sys_put_be16(j + 1, pmsg + 14);
 
-            err = bt_mesh_encrypt_be(key, pmsg, cmsg);
+            err = aes_key_encrypt(aes, pmsg, cmsg);
             if (err) {
                 return err;
             }
@@ -337,7 +472,7 @@ static int bt_mesh_ccm_decrypt(const uint8_t key[16], uint8_t nonce[13],
                 pmsg[i] = Xn[i] ^ msg[i];
             }
 
-            err = bt_mesh_encrypt_be(key, pmsg, Xn);
+            err = aes_key_encrypt(aes, pmsg, Xn);
             if (err) {
                 return err;
             }
@@ -351,10 +486,31 @@ static int bt_mesh_ccm_decrypt(const uint8_t key[16], uint8_t nonce[13],
     return 0;
 }
 
-static int bt_mesh_ccm_encrypt(const uint8_t key[16], uint8_t nonce[13],
-                               const uint8_t *msg, size_t msg_len,
+static int bt_mesh_ccm_decrypt(const uint8_t key[16], uint8_t nonce[13],
+                               const uint8_t *enc_msg, size_t msg_len,
                                const uint8_t *aad, size_t aad_len,
                                uint8_t *out_msg, size_t mic_size)
+{
+    struct bt_mesh_aes_key aes = {0};
+    int err = 0;
+
+    err = aes_key_get(key, &aes);
+    if (err) {
+        return err;
+    }
+
+    err = ccm_decrypt(&aes, nonce, enc_msg, msg_len, aad, aad_len, out_msg, mic_size);
+
+    /* Don't leave the expanded key on the stack */
+    aes_key_free(&aes);
+
+    return err;
+}
+
+static int ccm_encrypt(struct bt_mesh_aes_key *aes, uint8_t nonce[13],
+                       const uint8_t *msg, size_t msg_len,
+                       const uint8_t *aad, size_t aad_len,
+                       uint8_t *out_msg, size_t mic_size)
 {
     uint8_t pmsg[16] = {0}, cmic[16] = {0}, cmsg[16] = {0},
             mic[16] = {0}, Xn[16] = {0};
@@ -362,7 +518,6 @@ static int bt_mesh_ccm_encrypt(const uint8_t key[16], uint8_t nonce[13],
     size_t i = 0U, j = 0U;
     int err = 0;
 
-    BT_DBG("key %s", bt_hex(key, 16));
     BT_DBG("nonce %s", bt_hex(nonce, 13));
     BT_DBG("msg (len %u) %s", msg_len, bt_hex(msg, msg_len));
     BT_DBG("aad_len %u mic_size %u", aad_len, mic_size);
@@ -377,7 +532,7 @@ static int bt_mesh_ccm_encrypt(const uint8_t key[16], uint8_t nonce[13],
     memcpy(pmsg + 1, nonce, 13);
     sys_put_be16(0x0000, pmsg + 14);
 
-    err = bt_mesh_encrypt_be(key, pmsg, cmic);
+    err = aes_key_encrypt(aes, pmsg, cmic);
     if (err) {
         return err;
     }
@@ -392,7 +547,7 @@ static int bt_mesh_ccm_encrypt(const uint8_t key[16], uint8_t nonce[13],
     memcpy(pmsg + 1, nonce, 13);
     sys_put_be16(msg_len, pmsg + 14);
 
-    err = bt_mesh_encrypt_be(key, pmsg, Xn);
+    err = aes_key_encrypt(aes, pmsg, Xn);
     if (err) {
         return err;
     }
@@ -416,7 +571,7 @@ static int bt_mesh_ccm_encrypt(const uint8_t key[16], uint8_t nonce[13],
             aad_len -= 16;
             i = 0;
 
-            err = bt_mesh_encrypt_be(key, pmsg, Xn);
+            err = aes_key_encrypt(aes, pmsg, Xn);
             if (err) {
                 return err;
             }
@@ -430,7 +585,7 @@ static int bt_mesh_ccm_encrypt(const uint8_t key[16], uint8_t nonce[13],
             pmsg[i] = Xn[i];
         }
 
-        err = bt_mesh_encrypt_be(key, pmsg, Xn);
+        err = aes_key_encrypt(aes, pmsg, Xn);
         if (err) {
             return err;
         }
@@ -452,7 +607,7 @@ static int bt_mesh_ccm_encrypt(const uint8_t key[16], uint8_t nonce[13],
                 pmsg[i] = Xn[i] ^ 0x00;
             }
 
-            err = bt_mesh_encrypt_be(key, pmsg, Xn);
+            err = aes_key_encrypt(aes, pmsg, Xn);
             if (err) {
                 return err;
             }
@@ -467,7 +622,7 @@ static int bt_mesh_ccm_encrypt(const uint8_t key[16], uint8_t nonce[13],
             memcpy(pmsg + 1, nonce, 13);
             sys_put_be16(j + 1, pmsg + 14);
 
-            err = bt_mesh_encrypt_be(key, pmsg, cmsg);
+            err = aes_key_encrypt(aes, pmsg, cmsg);
             if (err) {
                 return err;
             }
@@ -483,7 +638,7 @@ static int bt_mesh_ccm_encrypt(const uint8_t key[16], uint8_t nonce[13],
                 pmsg[i] = Xn[i] ^ msg[(j * 16) + i];
             }
 
-            err = bt_mesh_encrypt_be(key, pmsg, Xn);
+            err = aes_key_encrypt(aes, pmsg, Xn);
             if (err) {
                 return err;
             }
@@ -493,7 +648,7 @@ static int bt_mesh_ccm_encrypt(const uint8_t key[16], uint8_t nonce[13],
             memcpy(pmsg + 1, nonce, 13);
             sys_put_be16(j + 1, pmsg + 14);
 
-            err = bt_mesh_encrypt_be(key, pmsg, cmsg);
+            err = aes_key_encrypt(aes, pmsg, cmsg);
             if (err) {
                 return err;
             }
@@ -512,6 +667,29 @@ static int bt_mesh_ccm_encrypt(const uint8_t key[16], uint8_t nonce[13],
     return 0;
 }
 
+static int bt_mesh_ccm_encrypt(const uint8_t key[16], uint8_t nonce[13],
+                               const uint8_t *msg, size_t msg_len,
+                               const uint8_t *aad, size_t aad_len,
+                               uint8_t *out_msg, size_t mic_size)
+{
+    struct bt_mesh_aes_key aes = {0};
+    int err = 0;
+
+    BT_DBG("key %s", bt_hex(key, 16));
+
+    err = aes_key_get(key, &aes);
+    if (err) {
+        return err;
+    }
+
+    err = ccm_encrypt(&aes, nonce, msg, msg_len, aad, aad_len, out_msg, mic_size);
+
+    /* Don't leave the expanded key on the stack */
+    aes_key_free(&aes);
+
+    return err;
+}
+
 #if defined(CONFIG_BLE_MESH_PROXY)
 static void create_proxy_nonce(uint8_t nonce[13], const uint8_t *pdu,
                                uint32_t iv_index)
@@ -566,21 +744,19 @@ static void create_net_nonce(uint8_t nonce[13], const uint8_t *pdu,
     sys_put_be32(iv_index, &nonce[9]);
 }
 
-int bt_mesh_net_obfuscate(uint8_t *pdu, uint32_t iv_index,
-                          const uint8_t privacy_key[16])
+static int net_obfuscate(struct bt_mesh_aes_key *aes, uint8_t *pdu,
+                         uint32_t iv_index)
 {
     uint8_t priv_rand[16] = { 0x00, 0x00, 0x00, 0x00, 0x00, };
     uint8_t tmp[16] = {0};
     int err = 0, i;
 
-    BT_DBG("IVIndex %u, PrivacyKey %s", iv_index, bt_hex(privacy_key, 16));
-
     sys_put_be32(iv_index, &priv_rand[5]);
     memcpy(&priv_rand[9], &pdu[7], 7);
 
     BT_DBG("PrivacyRandom %s", bt_hex(priv_rand, 16));
 
-    err = bt_mesh_encrypt_be(privacy_key, priv_rand, tmp);
+    err = aes_key_encrypt(aes, priv_rand, tmp);
     if (err) {
         return err;
     }
@@ -592,15 +768,34 @@ int bt_mesh_net_obfuscate(uint8_t *pdu, uint32_t iv_index,
     return 0;
 }
 
-int bt_mesh_net_encrypt(const uint8_t key[16], struct net_buf_simple *buf,
-                        uint32_t iv_index, bool proxy)
+int bt_mesh_net_obfuscate(uint8_t *pdu, uint32_t iv_index,
+                          const uint8_t privacy_key[16])
+{
+    struct bt_mesh_aes_key aes = {0};
+    int err = 0;
+
+    BT_DBG("IVIndex %u, PrivacyKey %s", iv_index, bt_hex(privacy_key, 16));
+
+    err = aes_key_get(privacy_key, &aes);
+    if (err) {
+        return err;
+    }
+
+    err = net_obfuscate(&aes, pdu, iv_index);
+
+    aes_key_free(&aes);
+
+    return err;
+}
+
+static int net_encrypt(struct bt_mesh_aes_key *aes, struct net_buf_simple *buf,
+                       uint32_t iv_index, bool proxy)
 {
     uint8_t mic_len = NET_MIC_LEN(buf->data);
     uint8_t nonce[13] = {0};
     int err = 0;
 
-    BT_DBG("IVIndex %u EncKey %s mic_len %u", iv_index, bt_hex(key, 16),
-           mic_len);
+    BT_DBG("IVIndex %u mic_len %u", iv_index, mic_len);
     BT_DBG("PDU (len %u) %s", buf->len, bt_hex(buf->data, buf->len));
 
 #if defined(CONFIG_BLE_MESH_PROXY)
@@ -615,8 +810,8 @@ int bt_mesh_net_encrypt(const uint8_t key[16], struct net_buf_simple *buf,
 
     BT_DBG("Nonce %s", bt_hex(nonce, 13));
 
-    err = bt_mesh_ccm_encrypt(key, nonce, &buf->data[7], buf->len - 7,
-                              NULL, 0, &buf->data[7], mic_len);
+    err = ccm_encrypt(aes, nonce, &buf->data[7], buf->len - 7,
+                      NULL, 0, &buf->data[7], mic_len);
     if (!err) {
         net_buf_simple_add(buf, mic_len);
     }
@@ -624,6 +819,26 @@ int bt_mesh_net_encrypt(const uint8_t key[16], struct net_buf_simple *buf,
     return err;
 }
 
+int bt_mesh_net_encrypt(const uint8_t key[16], struct net_buf_simple *buf,
+                        uint32_t iv_index, bool proxy)
+{
+    struct bt_mesh_aes_key aes = {0};
+    int err = 0;
+
+    BT_DBG("EncKey %s", bt_hex(key, 16));
+
+    err = aes_key_get(key, &aes);
+    if (err) {
+        return err;
+    }
+
+    err = net_encrypt(&aes, buf, iv_index, proxy);
+
+    aes_key_free(&aes);
+
+    return err;
+}
+
 int bt_mesh_net_decrypt(const uint8_t key[16], struct net_buf_simple *buf,
                         uint32_t iv_index, bool proxy)
 {
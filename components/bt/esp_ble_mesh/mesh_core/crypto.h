@@ -129,6 +129,8 @@ static inline int bt_mesh_prov_salt(const uint8_t conf_salt[16],
     return bt_mesh_aes_cmac(prov_salt_key, sg, ARRAY_SIZE(sg), prov_salt);
 }
 
+void bt_mesh_crypto_key_cache_clear(void);
+
 int bt_mesh_net_obfuscate(uint8_t *pdu, uint32_t iv_index,
                           const uint8_t privacy_key[16]);
 
@@ -276,6 +276,7 @@ int bt_mesh_node_local_app_key_add(uint16_t net_idx, uint16_t app_idx,
             BT_ERR("Failed to generate AID");
             return -EIO;
         }
+        bt_mesh_app_key_aid_index_invalidate();
 
         key->net_idx = net_idx;
         key->app_idx = app_idx;
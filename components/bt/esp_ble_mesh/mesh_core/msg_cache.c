@@ -0,0 +1,155 @@
+/*  Bluetooth Mesh */
+
+/*
+ * SPDX-FileCopyrightText: 2017 Intel Corporation
+ * SPDX-FileContributor: 2018-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+
+#include "net.h"
+#include "mesh_common.h"
+
+#define SEQ(pdu)           (sys_get_be24(&(pdu)[2]))
+#define SRC(pdu)           (sys_get_be16(&(pdu)[5]))
+
+static struct {
+    uint32_t src:15, /* MSB of source address is always 0 */
+             seq:17;
+} msg_cache[CONFIG_BLE_MESH_MSG_CACHE_SIZE];
+static uint16_t msg_cache_next;
+
+/* Hash index over msg_cache keyed by (src, seq). Each bucket holds the
+ * index (plus one, zero meaning empty) of the first entry in the bucket,
+ * and entries of the same bucket are chained through msg_cache_link.
+ * This keeps the lookup for every received PDU constant on average,
+ * regardless of CONFIG_BLE_MESH_MSG_CACHE_SIZE.
+ */
+static uint16_t msg_cache_bucket[CONFIG_BLE_MESH_MSG_CACHE_SIZE];
+static uint16_t msg_cache_link[CONFIG_BLE_MESH_MSG_CACHE_SIZE];
+
+static inline uint16_t msg_cache_hash(uint16_t src, uint32_t seq)
+{
+    uint32_t val = ((uint32_t)src << 17) ^ (seq & BIT_MASK(17));
+
+    val ^= val >> 16;
+    val *= 0x45d9f3bU;
+    val ^= val >> 16;
+
+    return val % ARRAY_SIZE(msg_cache_bucket);
+}
+
+static void msg_cache_unlink(uint16_t idx)
+{
+    uint16_t *link = NULL;
+
+    if (msg_cache[idx].src == BLE_MESH_ADDR_UNASSIGNED) {
+        return;
+    }
+
+    link = &msg_cache_bucket[msg_cache_hash(msg_cache[idx].src, msg_cache[idx].seq)];
+    while (*link) {
+        if (*link == idx + 1) {
+            *link = msg_cache_link[idx];
+            msg_cache_link[idx] = 0U;
+            return;
+        }
+        link = &msg_cache_link[*link - 1];
+    }
+}
+
+void bt_mesh_msg_cache_reset(void)
+{
+    (void)memset(msg_cache, 0, sizeof(msg_cache));
+    (void)memset(msg_cache_bucket, 0, sizeof(msg_cache_bucket));
+    (void)memset(msg_cache_link, 0, sizeof(msg_cache_link));
+    msg_cache_next = 0U;
+}
+
+bool bt_mesh_msg_cache_match(struct net_buf_simple *pdu)
+{
+    uint16_t src = SRC(pdu->data);
+    uint32_t seq = SEQ(pdu->data) & BIT_MASK(17);
+    uint16_t idx = 0U;
+
+    idx = msg_cache_bucket[msg_cache_hash(src, seq)];
+    while (idx) {
+        if (msg_cache[idx - 1].src == src &&
+            msg_cache[idx - 1].seq == seq) {
+            return true;
+        }
+        idx = msg_cache_link[idx - 1];
+    }
+
+    return false;
+}
+
+/* Check if the message cache holds another copy of the received PDU,
+ * i.e. the same message was already accepted through another bearer.
+ */
+bool bt_mesh_msg_cache_dup(struct bt_mesh_net_rx *rx)
+{
+    uint32_t seq = rx->seq & BIT_MASK(17);
+    uint16_t idx = 0U;
+
+    idx = msg_cache_bucket[msg_cache_hash(rx->ctx.addr, seq)];
+    while (idx) {
+        if (idx - 1 != rx->msg_cache_idx &&
+            msg_cache[idx - 1].src == rx->ctx.addr &&
+            msg_cache[idx - 1].seq == seq) {
+            return true;
+        }
+        idx = msg_cache_link[idx - 1];
+    }
+
+    return false;
+}
+
+void bt_mesh_msg_cache_add(struct bt_mesh_net_rx *rx)
+{
+    uint16_t hash = 0U;
+
+    rx->msg_cache_idx = msg_cache_next++;
+    msg_cache_next %= ARRAY_SIZE(msg_cache);
+
+    /* Evict the oldest entry which occupies this slot */
+    msg_cache_unlink(rx->msg_cache_idx);
+
+    msg_cache[rx->msg_cache_idx].src = rx->ctx.addr;
+    msg_cache[rx->msg_cache_idx].seq = rx->seq;
+
+    hash = msg_cache_hash(rx->ctx.addr, rx->seq);
+    msg_cache_link[rx->msg_cache_idx] = msg_cache_bucket[hash];
+    msg_cache_bucket[hash] = rx->msg_cache_idx + 1;
+}
+
+static void msg_cache_remove(uint16_t idx)
+{
+    msg_cache_unlink(idx);
+    (void)memset(&msg_cache[idx], 0, sizeof(msg_cache[idx]));
+}
+
+void bt_mesh_msg_cache_reject(uint16_t idx)
+{
+    msg_cache_remove(idx);
+    /* Rewind the next index now that we're not using this entry */
+    msg_cache_next = idx;
+}
+
+#if CONFIG_BLE_MESH_PROVISIONER
+void bt_mesh_msg_cache_clear(uint16_t unicast_addr, uint8_t elem_num)
+{
+    int i;
+
+    for (i = 0; i < ARRAY_SIZE(msg_cache); i++) {
+        if (msg_cache[i].src >= unicast_addr &&
+            msg_cache[i].src < unicast_addr + elem_num) {
+            msg_cache_remove(i);
+        }
+    }
+}
+#endif /* CONFIG_BLE_MESH_PROVISIONER */
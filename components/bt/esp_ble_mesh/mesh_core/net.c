@@ -59,11 +59,39 @@
 static struct friend_cred friend_cred[FRIEND_CRED_COUNT];
 #endif
 
+#if CONFIG_BLE_MESH_PROVISIONER
+#define NID_INDEX_SUBNET_COUNT  (CONFIG_BLE_MESH_SUBNET_COUNT + \
+                                 CONFIG_BLE_MESH_PROVISIONER_SUBNET_COUNT)
+#else
+#define NID_INDEX_SUBNET_COUNT  CONFIG_BLE_MESH_SUBNET_COUNT
+#endif
+
+/* Both key generations of each subnet, and of each friendship credential
+ * (which may be matched by a node subnet and a provisioner subnet).
+ */
+#define NID_INDEX_CAND_COUNT    (2 * NID_INDEX_SUBNET_COUNT + 4 * FRIEND_CRED_COUNT)
+
+/* Credentials which may be used to decrypt a received Network PDU,
+ * grouped by NID. Candidates of NID n are cand[start[n]] up to (but not
+ * including) cand[start[n + 1]], in the same order as the previous linear
+ * search (friendship credentials of a subnet first, then keys[0], then
+ * keys[1]). Candidates only refer to subnets and credentials by index and
+ * are validated again before being used, so removing a key does not need
+ * a rebuild, while deriving a new NID does (see bt_mesh_net_nid_index_invalidate()).
+ */
 static struct {
-    uint32_t src:15, /* MSB of source address is always 0 */
-             seq:17;
-} msg_cache[CONFIG_BLE_MESH_MSG_CACHE_SIZE];
-static uint16_t msg_cache_next;
+    bool     valid;
+    uint16_t netkey_size;   /* bt_mesh_rx_netkey_size() when built */
+    uint16_t count;
+    uint16_t start[BIT(7) + 1];
+    struct nid_cand {
+        uint16_t sub_idx;   /* Index used with bt_mesh_rx_netkey_get() */
+        uint16_t cred_idx;  /* Index of friend_cred plus one, 0 for NetKey */
+        uint8_t  new_key;   /* keys[1]/cred[1] instead of keys[0]/cred[0] */
+    } cand[NID_INDEX_CAND_COUNT];
+} nid_index;
+
+struct bt_mesh_net_rx_stats bt_mesh_rx_stats;
 
 /* Singleton network context (the implementation only supports one) */
 struct bt_mesh_net bt_mesh = {
@@ -107,43 +135,6 @@ static bool check_dup(struct net_buf_simple *data)
     return false;
 }
 
-static bool msg_cache_match(struct bt_mesh_net_rx *rx,
-                            struct net_buf_simple *pdu)
-{
-    int i;
-
-    for (i = 0; i < ARRAY_SIZE(msg_cache); i++) {
-        if (msg_cache[i].src == SRC(pdu->data) &&
-            msg_cache[i].seq == (SEQ(pdu->data) & BIT_MASK(17))) {
-            return true;
-        }
-    }
-
-    return false;
-}
-
-static void msg_cache_add(struct bt_mesh_net_rx *rx)
-{
-    rx->msg_cache_idx = msg_cache_next++;
-    msg_cache[rx->msg_cache_idx].src = rx->ctx.addr;
-    msg_cache[rx->msg_cache_idx].seq = rx->seq;
-    msg_cache_next %= ARRAY_SIZE(msg_cache);
-}
-
-#if CONFIG_BLE_MESH_PROVISIONER
-void bt_mesh_msg_cache_clear(uint16_t unicast_addr, uint8_t elem_num)
-{
-    int i;
-
-    for (i = 0; i < ARRAY_SIZE(msg_cache); i++) {
-        if (msg_cache[i].src >= unicast_addr &&
-            msg_cache[i].src < unicast_addr + elem_num) {
-            memset(&msg_cache[i], 0, sizeof(msg_cache[i]));
-        }
-    }
-}
-#endif /* CONFIG_BLE_MESH_PROVISIONER */
-
 struct bt_mesh_subnet *bt_mesh_subnet_get(uint16_t net_idx)
 {
     int i;
@@ -177,6 +168,7 @@ int bt_mesh_net_keys_create(struct bt_mesh_subnet_keys *keys,
     memcpy(keys->net, key, 16);
 
     keys->nid = nid;
+    bt_mesh_net_nid_index_invalidate();
 
     BT_DBG("NID 0x%02x EncKey %s", keys->nid, bt_hex(keys->enc, 16));
     BT_DBG("PrivacyKey %s", bt_hex(keys->privacy, 16));
@@ -248,6 +240,8 @@ int friend_cred_set(struct friend_cred *cred, uint8_t idx, const uint8_t net_key
         return err;
     }
 
+    bt_mesh_net_nid_index_invalidate();
+
     BT_DBG("Friend NID 0x%02x EncKey %s", cred->cred[idx].nid,
            bt_hex(cred->cred[idx].enc, 16));
     BT_DBG("Friend PrivacyKey %s", bt_hex(cred->cred[idx].privacy, 16));
@@ -268,6 +262,8 @@ void friend_cred_refresh(uint16_t net_idx)
                    sizeof(cred->cred[0]));
         }
     }
+
+    bt_mesh_net_nid_index_invalidate();
 }
 
 int friend_cred_update(struct bt_mesh_subnet *sub)
@@ -344,6 +340,8 @@ void friend_cred_clear(struct friend_cred *cred)
     cred->lpn_counter = 0U;
     cred->frnd_counter = 0U;
     (void)memset(cred->cred, 0, sizeof(cred->cred));
+
+    bt_mesh_net_nid_index_invalidate();
 }
 
 int friend_cred_del(uint16_t net_idx, uint16_t addr)
@@ -449,8 +447,7 @@ int bt_mesh_net_create(uint16_t idx, uint8_t flags, const uint8_t key[16],
 
     BT_DBG("NetKey %s", bt_hex(key, 16));
 
-    (void)memset(msg_cache, 0, sizeof(msg_cache));
-    msg_cache_next = 0U;
+    bt_mesh_msg_cache_reset();
 
     sub = &bt_mesh.sub[0];
 
@@ -500,6 +497,7 @@ void bt_mesh_net_revoke_keys(struct bt_mesh_subnet *sub)
     BT_DBG("idx 0x%04x", sub->net_idx);
 
     memcpy(&sub->keys[0], &sub->keys[1], sizeof(sub->keys[0]));
+    bt_mesh_net_nid_index_invalidate();
 
     if (IS_ENABLED(CONFIG_BLE_MESH_SETTINGS)) {
         BT_DBG("Store updated NetKey persistently");
@@ -515,12 +513,16 @@ void bt_mesh_net_revoke_keys(struct bt_mesh_subnet *sub)
 
         memcpy(&key->keys[0], &key->keys[1], sizeof(key->keys[0]));
         key->updated = false;
+        bt_mesh_app_key_aid_index_invalidate();
 
         if (IS_ENABLED(CONFIG_BLE_MESH_SETTINGS)) {
             BT_DBG("Store updated AppKey persistently");
             bt_mesh_store_app_key(key);
         }
     }
+
+    /* The old keys may still be expanded in the crypto layer */
+    bt_mesh_crypto_key_cache_clear();
 }
 
 bool bt_mesh_kr_update(struct bt_mesh_subnet *sub, uint8_t new_kr, bool new_key)
@@ -588,7 +590,7 @@ void bt_mesh_rpl_reset(void)
 
         if (rpl->src) {
             if (rpl->old_iv) {
-                (void)memset(rpl, 0, sizeof(*rpl));
+                bt_mesh_rpl_remove(rpl);
             } else {
                 rpl->old_iv = true;
             }
@@ -679,7 +681,7 @@ bool bt_mesh_net_iv_update(uint32_t iv_index, bool iv_update)
 #endif
             ) {
             BT_WARN("Performing IV Index Recovery");
-            (void)memset(bt_mesh.rpl, 0, sizeof(bt_mesh.rpl));
+            bt_mesh_rpl_clear();
             bt_mesh.iv_index = iv_index;
             bt_mesh.seq = 0U;
             goto do_update;
@@ -1089,7 +1091,7 @@ static int net_decrypt(struct bt_mesh_subnet *sub, const uint8_t *enc,
         return -EINVAL;
     }
 
-    if (rx->net_if == BLE_MESH_NET_IF_ADV && msg_cache_match(rx, buf)) {
+    if (rx->net_if == BLE_MESH_NET_IF_ADV && bt_mesh_msg_cache_match(buf)) {
         BT_DBG("Duplicate found in Network Message Cache");
         return -EALREADY;
     }
@@ -1105,102 +1107,187 @@ static int net_decrypt(struct bt_mesh_subnet *sub, const uint8_t *enc,
     return bt_mesh_net_decrypt(enc, buf, BLE_MESH_NET_IVI_RX(rx), false);
 }
 
-#if (defined(CONFIG_BLE_MESH_LOW_POWER) || \
-     defined(CONFIG_BLE_MESH_FRIEND))
-static int friend_decrypt(struct bt_mesh_subnet *sub, const uint8_t *data,
-                          size_t data_len, struct bt_mesh_net_rx *rx,
-                          struct net_buf_simple *buf)
+void bt_mesh_net_nid_index_invalidate(void)
 {
-    int i;
-
-    BT_DBG("NID 0x%02x net_idx 0x%04x", NID(data), sub->net_idx);
+    nid_index.valid = false;
+}
 
-    for (i = 0; i < ARRAY_SIZE(friend_cred); i++) {
-        struct friend_cred *cred = &friend_cred[i];
+static void nid_index_add(uint8_t nid, uint16_t sub_idx, uint16_t cred_idx,
+                          uint8_t new_key, bool place)
+{
+    struct nid_cand *cand = NULL;
 
-        if (cred->net_idx != sub->net_idx) {
-            continue;
+    if (!place) {
+        if (nid_index.count >= ARRAY_SIZE(nid_index.cand)) {
+            BT_WARN("NID index is full");
+            return;
         }
 
-        if (NID(data) == cred->cred[0].nid &&
-                !net_decrypt(sub, cred->cred[0].enc, cred->cred[0].privacy,
-                             data, data_len, rx, buf)) {
-            return 0;
-        }
+        nid_index.count++;
+        nid_index.start[nid + 1]++;
+        return;
+    }
 
-        if (sub->kr_phase == BLE_MESH_KR_NORMAL) {
+    /* Candidates skipped while counting are the last ones, skip them again */
+    if (nid_index.count >= ARRAY_SIZE(nid_index.cand)) {
+        return;
+    }
+    nid_index.count++;
+
+    cand = &nid_index.cand[nid_index.start[nid]++];
+    cand->sub_idx = sub_idx;
+    cand->cred_idx = cred_idx;
+    cand->new_key = new_key;
+}
+
+static void nid_index_walk(size_t array_size, bool place)
+{
+    struct bt_mesh_subnet *sub = NULL;
+    int i;
+#if FRIEND_CRED_COUNT > 0
+    int j;
+#endif
+
+    for (i = 0; i < array_size; i++) {
+        sub = bt_mesh_rx_netkey_get(i);
+        if (!sub || sub->net_idx == BLE_MESH_KEY_UNUSED) {
             continue;
         }
 
-        if (NID(data) == cred->cred[1].nid &&
-                !net_decrypt(sub, cred->cred[1].enc, cred->cred[1].privacy,
-                             data, data_len, rx, buf)) {
-            rx->new_key = 1U;
-            return 0;
+#if FRIEND_CRED_COUNT > 0
+        for (j = 0; j < ARRAY_SIZE(friend_cred); j++) {
+            struct friend_cred *cred = &friend_cred[j];
+
+            if (cred->addr == BLE_MESH_ADDR_UNASSIGNED ||
+                cred->net_idx != sub->net_idx) {
+                continue;
+            }
+
+            nid_index_add(cred->cred[0].nid, i, j + 1, 0U, place);
+            nid_index_add(cred->cred[1].nid, i, j + 1, 1U, place);
         }
+#endif
+
+        nid_index_add(sub->keys[0].nid, i, 0U, 0U, place);
+        nid_index_add(sub->keys[1].nid, i, 0U, 1U, place);
     }
+}
 
-    return -ENOENT;
+static void nid_index_rebuild(void)
+{
+    size_t array_size = 0U;
+    int i;
+
+    array_size = bt_mesh_rx_netkey_size();
+
+    (void)memset(nid_index.start, 0, sizeof(nid_index.start));
+
+    /* Count the candidates of each NID */
+    nid_index.count = 0U;
+    nid_index_walk(array_size, false);
+
+    for (i = 0; i < BIT(7); i++) {
+        nid_index.start[i + 1] += nid_index.start[i];
+    }
+
+    /* Place them, which moves start[n] to the end of NID n */
+    nid_index.count = 0U;
+    nid_index_walk(array_size, true);
+
+    memmove(&nid_index.start[1], &nid_index.start[0],
+            BIT(7) * sizeof(nid_index.start[0]));
+    nid_index.start[0] = 0U;
+
+    nid_index.netkey_size = array_size;
+    nid_index.valid = true;
+
+    BT_DBG("NID index rebuilt, %u candidates", nid_index.count);
 }
-#endif
 
 static bool net_find_and_decrypt(const uint8_t *data, size_t data_len,
                                  struct bt_mesh_net_rx *rx,
                                  struct net_buf_simple *buf)
 {
     struct bt_mesh_subnet *sub = NULL;
-    size_t array_size = 0U;
+    const uint8_t *enc = NULL, *priv = NULL;
+    uint8_t nid = NID(data);
+    struct nid_cand *cand = NULL;
     int i;
 
     BT_DBG("%s", __func__);
 
-    array_size = bt_mesh_rx_netkey_size();
+    if (!nid_index.valid ||
+        nid_index.netkey_size != bt_mesh_rx_netkey_size()) {
+        nid_index_rebuild();
+    }
 
-    for (i = 0; i < array_size; i++) {
-        sub = bt_mesh_rx_netkey_get(i);
-        if (!sub) {
-            BT_DBG("Subnet not found");
+    bt_mesh_rx_stats.net_pdu++;
+
+    for (i = nid_index.start[nid]; i < nid_index.start[nid + 1]; i++) {
+        cand = &nid_index.cand[i];
+
+        sub = bt_mesh_rx_netkey_get(cand->sub_idx);
+        if (!sub || sub->net_idx == BLE_MESH_KEY_UNUSED) {
             continue;
         }
 
-        if (sub->net_idx == BLE_MESH_KEY_UNUSED) {
+        if (cand->new_key && sub->kr_phase == BLE_MESH_KR_NORMAL) {
             continue;
         }
 
-#if (defined(CONFIG_BLE_MESH_LOW_POWER) || defined(CONFIG_BLE_MESH_FRIEND))
-        if (!friend_decrypt(sub, data, data_len, rx, buf)) {
-            rx->friend_cred = 1;
-            rx->ctx.net_idx = sub->net_idx;
-            rx->sub = sub;
-            return true;
-        }
+#if FRIEND_CRED_COUNT > 0
+        if (cand->cred_idx) {
+            struct friend_cred *cred = &friend_cred[cand->cred_idx - 1];
+
+            if (cred->addr == BLE_MESH_ADDR_UNASSIGNED ||
+                cred->net_idx != sub->net_idx ||
+                cred->cred[cand->new_key].nid != nid) {
+                continue;
+            }
+
+            enc = cred->cred[cand->new_key].enc;
+            priv = cred->cred[cand->new_key].privacy;
+        } else
 #endif
+        {
+            if (sub->keys[cand->new_key].nid != nid) {
+                continue;
+            }
 
-        if (NID(data) == sub->keys[0].nid &&
-                !net_decrypt(sub, sub->keys[0].enc, sub->keys[0].privacy,
-                             data, data_len, rx, buf)) {
-            rx->ctx.net_idx = sub->net_idx;
-            rx->sub = sub;
-            return true;
+            enc = sub->keys[cand->new_key].enc;
+            priv = sub->keys[cand->new_key].privacy;
         }
 
-        if (sub->kr_phase == BLE_MESH_KR_NORMAL) {
+        bt_mesh_rx_stats.net_trial++;
+
+        if (net_decrypt(sub, enc, priv, data, data_len, rx, buf)) {
             continue;
         }
 
-        if (NID(data) == sub->keys[1].nid &&
-                !net_decrypt(sub, sub->keys[1].enc, sub->keys[1].privacy,
-                             data, data_len, rx, buf)) {
+        if (cand->cred_idx) {
+            rx->friend_cred = 1;
+        }
+        if (cand->new_key) {
             rx->new_key = 1U;
-            rx->ctx.net_idx = sub->net_idx;
-            rx->sub = sub;
-            return true;
         }
+        rx->ctx.net_idx = sub->net_idx;
+        rx->sub = sub;
+        return true;
     }
 
     return false;
 }
 
+void bt_mesh_net_rx_stats_get(struct bt_mesh_net_rx_stats *stats)
+{
+    *stats = bt_mesh_rx_stats;
+}
+
+void bt_mesh_net_rx_stats_reset(void)
+{
+    (void)memset(&bt_mesh_rx_stats, 0, sizeof(bt_mesh_rx_stats));
+}
+
 /* Relaying from advertising to the advertising bearer should only happen
  * if the Relay state is set to enabled. Locally originated packets always
  * get sent to the advertising bearer. If the packet came in through GATT,
@@ -1269,6 +1356,20 @@ static void bt_mesh_net_relay(struct net_buf_simple *sbuf,
      * the relay queue.
      */
 
+    /* Packets received over the advertising bearer have been checked
+     * against the message cache already; a copy coming from a Proxy
+     * Client may have been relayed when received over advertising,
+     * so drop it here before a relay buffer is allocated for it.
+     */
+    if (rx->net_if == BLE_MESH_NET_IF_PROXY && bt_mesh_msg_cache_dup(rx)) {
+        BT_DBG("Duplicate relay packet, src 0x%04x seq 0x%06x",
+               rx->ctx.addr, rx->seq);
+#if defined(CONFIG_BLE_MESH_RELAY_ADV_BUF)
+        bt_mesh_relay_stats_drop(BLE_MESH_RELAY_DROP_DUP);
+#endif
+        return;
+    }
+
 #if !defined(CONFIG_BLE_MESH_RELAY_ADV_BUF)
     buf = bt_mesh_adv_create(BLE_MESH_ADV_DATA, transmit, K_NO_WAIT);
 #else
@@ -1284,6 +1385,9 @@ static void bt_mesh_net_relay(struct net_buf_simple *sbuf,
 
     if (!buf) {
         BT_INFO("Out of relay buffers");
+#if defined(CONFIG_BLE_MESH_RELAY_ADV_BUF)
+        bt_mesh_relay_stats_drop(BLE_MESH_RELAY_DROP_NOBUF);
+#endif
         return;
     }
 
@@ -1339,7 +1443,10 @@ static void bt_mesh_net_relay(struct net_buf_simple *sbuf,
 #if !defined(CONFIG_BLE_MESH_RELAY_ADV_BUF)
         bt_mesh_adv_send(buf, NULL, NULL);
 #else
-        bt_mesh_relay_adv_send(buf, NULL, NULL, rx->ctx.addr, rx->ctx.recv_dst);
+        /* The TTL field has been obfuscated by now */
+        bt_mesh_relay_adv_send(buf, NULL, NULL, rx->ctx.addr, rx->ctx.recv_dst,
+                               rx->net_if == BLE_MESH_NET_IF_LOCAL ?
+                               rx->ctx.recv_ttl : rx->ctx.recv_ttl - 1U);
 #endif
     }
 
@@ -1421,7 +1528,7 @@ int bt_mesh_net_decode(struct net_buf_simple *data, enum bt_mesh_net_if net_if,
            rx->ctx.recv_ttl);
     BT_DBG("PDU: %s", bt_hex(buf->data, buf->len));
 
-    msg_cache_add(rx);
+    bt_mesh_msg_cache_add(rx);
 
     return 0;
 }
@@ -1516,9 +1623,7 @@ void bt_mesh_net_recv(struct net_buf_simple *data, int8_t rssi,
     */
     if (bt_mesh_trans_recv(&buf, &rx) == -EAGAIN) {
         BT_WARN("Removing rejected message from Network Message Cache");
-        msg_cache[rx.msg_cache_idx].src = BLE_MESH_ADDR_UNASSIGNED;
-        /* Rewind the next index now that we're not using this entry */
-        msg_cache_next = rx.msg_cache_idx;
+        bt_mesh_msg_cache_reject(rx.msg_cache_idx);
     }
 
     /* Relay if this was a group/virtual address, or if the destination
@@ -1621,12 +1726,15 @@ void bt_mesh_net_reset(void)
     memset(friend_cred, 0, sizeof(friend_cred));
 #endif
 
-    memset(msg_cache, 0, sizeof(msg_cache));
-    msg_cache_next = 0U;
+    bt_mesh_msg_cache_reset();
 
     memset(dup_cache, 0, sizeof(dup_cache));
     dup_cache_next = 0U;
 
+    bt_mesh_net_nid_index_invalidate();
+    bt_mesh_net_rx_stats_reset();
+    bt_mesh_crypto_key_cache_clear();
+
     bt_mesh.iv_index = 0U;
     bt_mesh.seq = 0U;
 }
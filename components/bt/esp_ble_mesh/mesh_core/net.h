@@ -314,6 +314,19 @@ struct bt_mesh_net_tx {
 
 extern struct bt_mesh_net bt_mesh;
 
+/* Counters of the key lookup done for received messages, the average
+ * number of trial decryptions per PDU is net_trial / net_pdu (resp.
+ * app_trial / app_pdu).
+ */
+struct bt_mesh_net_rx_stats {
+    uint32_t net_pdu;   /* Network PDUs looked up by NID */
+    uint32_t net_trial; /* Trial decryptions with NetKeys & friend credentials */
+    uint32_t app_pdu;   /* Access PDUs looked up by AID */
+    uint32_t app_trial; /* Trial decryptions with AppKeys */
+};
+
+extern struct bt_mesh_net_rx_stats bt_mesh_rx_stats;
+
 #define BLE_MESH_NET_IVI_TX (bt_mesh.iv_index - \
                              bt_mesh_atomic_test_bit(bt_mesh.flags, \
                              BLE_MESH_IVU_IN_PROGRESS))
@@ -321,11 +334,28 @@ extern struct bt_mesh_net bt_mesh;
 
 #define BLE_MESH_NET_HDR_LEN 9
 
+/* Network message cache, see msg_cache.c */
+void bt_mesh_msg_cache_reset(void);
+
+bool bt_mesh_msg_cache_match(struct net_buf_simple *pdu);
+
+bool bt_mesh_msg_cache_dup(struct bt_mesh_net_rx *rx);
+
+void bt_mesh_msg_cache_add(struct bt_mesh_net_rx *rx);
+
+void bt_mesh_msg_cache_reject(uint16_t idx);
+
 void bt_mesh_msg_cache_clear(uint16_t unicast_addr, uint8_t elem_num);
 
 int bt_mesh_net_keys_create(struct bt_mesh_subnet_keys *keys,
                             const uint8_t key[16]);
 
+void bt_mesh_net_nid_index_invalidate(void);
+
+void bt_mesh_net_rx_stats_get(struct bt_mesh_net_rx_stats *stats);
+
+void bt_mesh_net_rx_stats_reset(void);
+
 int bt_mesh_net_create(uint16_t idx, uint8_t flags, const uint8_t key[16],
                        uint32_t iv_index);
 
@@ -1001,6 +1001,7 @@ int bt_mesh_provisioner_local_app_key_add(const uint8_t app_key[16],
         bt_mesh_free(key);
         return -EIO;
     }
+    bt_mesh_app_key_aid_index_invalidate();
 
     memcpy(keys->val, p_key, 16);
     key->net_idx = net_idx;
@@ -1065,9 +1066,11 @@ int bt_mesh_provisioner_local_app_key_update(const uint8_t app_key[16],
         BT_ERR("Failed to generate AID");
         return -EIO;
     }
+    bt_mesh_app_key_aid_index_invalidate();
 
     memset(keys->val, 0, 16);
     memcpy(keys->val, app_key, 16);
+    bt_mesh_crypto_key_cache_clear();
 
     key->updated = false;
 
@@ -1204,6 +1207,7 @@ int bt_mesh_provisioner_local_app_key_del(uint16_t net_idx, uint16_t app_idx, bo
 
             bt_mesh_free(bt_mesh.p_app_keys[i]);
             bt_mesh.p_app_keys[i] = NULL;
+            bt_mesh_crypto_key_cache_clear();
             return 0;
         }
     }
@@ -1326,6 +1330,7 @@ int bt_mesh_provisioner_local_net_key_update(const uint8_t net_key[16], uint16_t
 
     memset(sub->keys[0].net, 0, 16);
     memcpy(sub->keys[0].net, net_key, 16);
+    bt_mesh_crypto_key_cache_clear();
 
     sub->kr_phase = BLE_MESH_KR_NORMAL;
     sub->kr_flag = false;
@@ -1399,6 +1404,7 @@ int bt_mesh_provisioner_local_net_key_del(uint16_t net_idx, bool store)
 
             bt_mesh_free(bt_mesh.p_sub[i]);
             bt_mesh.p_sub[i] = NULL;
+            bt_mesh_crypto_key_cache_clear();
             return 0;
         }
     }
@@ -0,0 +1,97 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include "relay_queue.h"
+
+void bt_mesh_relay_queue_init(struct bt_mesh_relay_queue *queue,
+                              bt_mesh_msg_t *msgs, uint16_t size)
+{
+    queue->msgs = msgs;
+    queue->size = size;
+    queue->count = 0U;
+}
+
+static void relay_queue_remove(struct bt_mesh_relay_queue *queue, uint16_t idx)
+{
+    queue->count--;
+    memmove(&queue->msgs[idx], &queue->msgs[idx + 1],
+            (queue->count - idx) * sizeof(queue->msgs[0]));
+}
+
+static void relay_queue_insert(struct bt_mesh_relay_queue *queue, const bt_mesh_msg_t *msg)
+{
+    uint16_t idx = queue->count;
+
+    /* After all the packets with a higher or equal TTL */
+    while (idx && queue->msgs[idx - 1].ttl < msg->ttl) {
+        idx--;
+    }
+
+    memmove(&queue->msgs[idx + 1], &queue->msgs[idx],
+            (queue->count - idx) * sizeof(queue->msgs[0]));
+    queue->msgs[idx] = *msg;
+    queue->count++;
+}
+
+enum bt_mesh_relay_queue_put bt_mesh_relay_queue_put(struct bt_mesh_relay_queue *queue,
+                                                     const bt_mesh_msg_t *msg,
+                                                     uint32_t now, uint32_t max_age,
+                                                     bt_mesh_msg_t *dropped)
+{
+    uint32_t age = 0U, oldest = 0U;
+    uint16_t victim = 0U;
+    uint16_t i;
+
+    if (queue->count < queue->size) {
+        relay_queue_insert(queue, msg);
+        return BLE_MESH_RELAY_QUEUE_ADDED;
+    }
+
+    /* Timestamps wrap around, the age is the difference modulo 2^32 */
+    for (i = 0U; i < queue->count; i++) {
+        age = now - queue->msgs[i].timestamp;
+        if (age >= max_age && age >= oldest) {
+            oldest = age;
+            victim = i + 1;
+        }
+    }
+
+    if (victim) {
+        *dropped = queue->msgs[victim - 1];
+        relay_queue_remove(queue, victim - 1);
+        relay_queue_insert(queue, msg);
+        return BLE_MESH_RELAY_QUEUE_REPLACED_STALE;
+    }
+
+    /* The oldest packet with the lowest TTL is the first of the last run */
+    victim = queue->count - 1;
+    if (queue->msgs[victim].ttl > msg->ttl) {
+        *dropped = *msg;
+        return BLE_MESH_RELAY_QUEUE_REJECTED;
+    }
+
+    while (victim && queue->msgs[victim - 1].ttl == queue->msgs[victim].ttl) {
+        victim--;
+    }
+
+    *dropped = queue->msgs[victim];
+    relay_queue_remove(queue, victim);
+    relay_queue_insert(queue, msg);
+    return BLE_MESH_RELAY_QUEUE_REPLACED_TTL;
+}
+
+bool bt_mesh_relay_queue_get(struct bt_mesh_relay_queue *queue, bt_mesh_msg_t *msg)
+{
+    if (queue->count == 0U) {
+        return false;
+    }
+
+    *msg = queue->msgs[0];
+    relay_queue_remove(queue, 0U);
+    return true;
+}
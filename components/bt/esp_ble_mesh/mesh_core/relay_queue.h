@@ -0,0 +1,54 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _RELAY_QUEUE_H_
+#define _RELAY_QUEUE_H_
+
+#include "adv.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Relay packets waiting to be advertised. Packets are served by decreasing
+ * TTL, i.e. those expected to reach more nodes first, and in posting order
+ * for the same TTL. The queue does no locking of its own.
+ */
+struct bt_mesh_relay_queue {
+    bt_mesh_msg_t *msgs;    /* Sorted by decreasing TTL, then by age */
+    uint16_t size;
+    uint16_t count;
+};
+
+enum bt_mesh_relay_queue_put {
+    BLE_MESH_RELAY_QUEUE_ADDED,          /* Queued, the queue has one more packet */
+    BLE_MESH_RELAY_QUEUE_REPLACED_STALE, /* Queued in place of a stale packet */
+    BLE_MESH_RELAY_QUEUE_REPLACED_TTL,   /* Queued in place of a packet with a lower or equal TTL */
+    BLE_MESH_RELAY_QUEUE_REJECTED,       /* Not queued, all the queued packets have a higher TTL */
+};
+
+void bt_mesh_relay_queue_init(struct bt_mesh_relay_queue *queue,
+                              bt_mesh_msg_t *msgs, uint16_t size);
+
+/* Queue a relay packet. When the queue is full, the oldest packet which
+ * stayed longer than max_age (in ms) is dropped first, then the oldest
+ * packet with the lowest TTL, unless that TTL is higher than the one of
+ * the new packet. The dropped packet, either a queued one or msg itself,
+ * is returned in dropped.
+ */
+enum bt_mesh_relay_queue_put bt_mesh_relay_queue_put(struct bt_mesh_relay_queue *queue,
+                                                     const bt_mesh_msg_t *msg,
+                                                     uint32_t now, uint32_t max_age,
+                                                     bt_mesh_msg_t *dropped);
+
+/* Take the next packet to be advertised, returns false if empty */
+bool bt_mesh_relay_queue_get(struct bt_mesh_relay_queue *queue, bt_mesh_msg_t *msg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RELAY_QUEUE_H_ */
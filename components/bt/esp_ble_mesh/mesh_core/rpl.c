@@ -0,0 +1,214 @@
+/*  Bluetooth Mesh */
+
+/*
+ * SPDX-FileCopyrightText: 2017 Intel Corporation
+ * SPDX-FileContributor: 2018-2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <errno.h>
+
+#include "settings.h"
+#include "transport.h"
+#include "mesh_common.h"
+
+/* Hash index over bt_mesh.rpl keyed by source address. Each bucket holds
+ * the index (plus one, zero meaning empty) of the first entry in the bucket,
+ * and entries of the same bucket are chained through rpl_link. Entries below
+ * rpl_used may be either in use or released, entries above it are known to
+ * be free, so that a new source normally gets a slot without scanning.
+ */
+static uint16_t rpl_bucket[CONFIG_BLE_MESH_CRPL];
+static uint16_t rpl_link[CONFIG_BLE_MESH_CRPL];
+static uint16_t rpl_used;
+
+static inline uint16_t rpl_hash(uint16_t src)
+{
+    uint32_t val = src;
+
+    val *= 0x9e3779b1U;
+    val ^= val >> 16;
+
+    return val % ARRAY_SIZE(rpl_bucket);
+}
+
+static inline uint16_t rpl_index(struct bt_mesh_rpl *rpl)
+{
+    return rpl - bt_mesh.rpl;
+}
+
+static void rpl_link_add(struct bt_mesh_rpl *rpl, uint16_t src)
+{
+    uint16_t idx = rpl_index(rpl);
+    uint16_t hash = rpl_hash(src);
+
+    rpl->src = src;
+    rpl_link[idx] = rpl_bucket[hash];
+    rpl_bucket[hash] = idx + 1;
+
+    if (idx >= rpl_used) {
+        rpl_used = idx + 1;
+    }
+}
+
+static void rpl_link_del(struct bt_mesh_rpl *rpl)
+{
+    uint16_t idx = rpl_index(rpl);
+    uint16_t *link = NULL;
+
+    if (rpl->src == BLE_MESH_ADDR_UNASSIGNED) {
+        return;
+    }
+
+    link = &rpl_bucket[rpl_hash(rpl->src)];
+    while (*link) {
+        if (*link == idx + 1) {
+            *link = rpl_link[idx];
+            rpl_link[idx] = 0U;
+            return;
+        }
+        link = &rpl_link[*link - 1];
+    }
+}
+
+/* Get a free RPL slot without claiming it. The slot is claimed once
+ * the source address is assigned through rpl_link_add().
+ */
+static struct bt_mesh_rpl *rpl_get_free(void)
+{
+    int i;
+
+    if (rpl_used < ARRAY_SIZE(bt_mesh.rpl)) {
+        return &bt_mesh.rpl[rpl_used];
+    }
+
+    /* Only reached after entries have been released */
+    for (i = 0; i < ARRAY_SIZE(bt_mesh.rpl); i++) {
+        if (bt_mesh.rpl[i].src == BLE_MESH_ADDR_UNASSIGNED) {
+            return &bt_mesh.rpl[i];
+        }
+    }
+
+    return NULL;
+}
+
+struct bt_mesh_rpl *bt_mesh_rpl_find(uint16_t src)
+{
+    uint16_t idx = 0U;
+
+    if (src == BLE_MESH_ADDR_UNASSIGNED) {
+        return NULL;
+    }
+
+    idx = rpl_bucket[rpl_hash(src)];
+    while (idx) {
+        if (bt_mesh.rpl[idx - 1].src == src) {
+            return &bt_mesh.rpl[idx - 1];
+        }
+        idx = rpl_link[idx - 1];
+    }
+
+    return NULL;
+}
+
+struct bt_mesh_rpl *bt_mesh_rpl_alloc(uint16_t src)
+{
+    struct bt_mesh_rpl *rpl = NULL;
+
+    rpl = rpl_get_free();
+    if (rpl) {
+        rpl_link_add(rpl, src);
+    }
+
+    return rpl;
+}
+
+void bt_mesh_rpl_remove(struct bt_mesh_rpl *rpl)
+{
+    rpl_link_del(rpl);
+    (void)memset(rpl, 0, sizeof(*rpl));
+}
+
+void bt_mesh_rpl_clear(void)
+{
+    (void)memset(bt_mesh.rpl, 0, sizeof(bt_mesh.rpl));
+    (void)memset(rpl_bucket, 0, sizeof(rpl_bucket));
+    (void)memset(rpl_link, 0, sizeof(rpl_link));
+    rpl_used = 0U;
+}
+
+void bt_mesh_rpl_update(struct bt_mesh_rpl *rpl, struct bt_mesh_net_rx *rx)
+{
+    if (rpl->src != rx->ctx.addr) {
+        rpl_link_del(rpl);
+        rpl_link_add(rpl, rx->ctx.addr);
+    }
+
+    rpl->seq = rx->seq;
+    rpl->old_iv = rx->old_iv;
+
+    if (IS_ENABLED(CONFIG_BLE_MESH_SETTINGS)) {
+        bt_mesh_store_rpl(rpl);
+    }
+}
+
+/* Check the Replay Protection List for a replay attempt. If non-NULL match
+ * parameter is given the RPL slot is returned but it is not immediately
+ * updated (needed for segmented messages), whereas if a NULL match is given
+ * the RPL is immediately updated (used for unsegmented messages).
+ */
+bool bt_mesh_rpl_check(struct bt_mesh_net_rx *rx, struct bt_mesh_rpl **match)
+{
+    struct bt_mesh_rpl *rpl = NULL;
+
+    /* Don't bother checking messages from ourselves */
+    if (rx->net_if == BLE_MESH_NET_IF_LOCAL) {
+        return false;
+    }
+
+    /* The RPL is used only for the local node */
+    if (!rx->local_match) {
+        return false;
+    }
+
+    /* Existing slot for given address */
+    rpl = bt_mesh_rpl_find(rx->ctx.addr);
+    if (rpl) {
+        if (rx->old_iv && !rpl->old_iv) {
+            return true;
+        }
+
+        if ((!rx->old_iv && rpl->old_iv) ||
+                rpl->seq < rx->seq) {
+            if (match) {
+                *match = rpl;
+            } else {
+                bt_mesh_rpl_update(rpl, rx);
+            }
+
+            return false;
+        }
+
+#if CONFIG_BLE_MESH_NOT_RELAY_REPLAY_MSG
+        rx->replay_msg = 1;
+#endif
+        return true;
+    }
+
+    /* Empty slot */
+    rpl = rpl_get_free();
+    if (rpl) {
+        if (match) {
+            *match = rpl;
+        } else {
+            bt_mesh_rpl_update(rpl, rx);
+        }
+
+        return false;
+    }
+
+    BT_ERR("RPL is full!");
+    return true;
+}
@@ -316,33 +316,6 @@ static int seq_set(const char *name)
     return 0;
 }
 
-static struct bt_mesh_rpl *rpl_find(uint16_t src)
-{
-    int i;
-
-    for (i = 0; i < ARRAY_SIZE(bt_mesh.rpl); i++) {
-        if (bt_mesh.rpl[i].src == src) {
-            return &bt_mesh.rpl[i];
-        }
-    }
-
-    return NULL;
-}
-
-static struct bt_mesh_rpl *rpl_alloc(uint16_t src)
-{
-    int i;
-
-    for (i = 0; i < ARRAY_SIZE(bt_mesh.rpl); i++) {
-        if (bt_mesh.rpl[i].src == BLE_MESH_ADDR_UNASSIGNED) {
-            bt_mesh.rpl[i].src = src;
-            return &bt_mesh.rpl[i];
-        }
-    }
-
-    return NULL;
-}
-
 static int rpl_set(const char *name)
 {
     struct net_buf_simple *buf = NULL;
@@ -383,9 +356,9 @@ static int rpl_set(const char *name)
             continue;
         }
 
-        entry = rpl_find(src);
+        entry = bt_mesh_rpl_find(src);
         if (!entry) {
-            entry = rpl_alloc(src);
+            entry = bt_mesh_rpl_alloc(src);
             if (!entry) {
                 BT_ERR("No space for a new RPL 0x%04x", src);
                 err = -ENOMEM;
@@ -536,6 +509,7 @@ static int app_key_set(const char *name)
         memcpy(app->keys[1].val, key.val[1], 16);
         bt_mesh_app_id(app->keys[0].val, &app->keys[0].id);
         bt_mesh_app_id(app->keys[1].val, &app->keys[1].id);
+        bt_mesh_app_key_aid_index_invalidate();
 
         BT_INFO("Restored AppKeyIndex 0x%03x, NetKeyIndex 0x%03x",
             app->app_idx, app->net_idx);
@@ -1065,6 +1039,7 @@ static int p_app_key_set(const char *name)
         memcpy(app->keys[1].val, key.val[1], 16);
         bt_mesh_app_id(app->keys[0].val, &app->keys[0].id);
         bt_mesh_app_id(app->keys[1].val, &app->keys[1].id);
+        bt_mesh_app_key_aid_index_invalidate();
 
         BT_INFO("Restored AppKeyIndex 0x%03x, NetKeyIndex 0x%03x",
             app->app_idx, app->net_idx);
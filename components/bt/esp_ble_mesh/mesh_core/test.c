@@ -16,6 +16,7 @@
 #include "test.h"
 #include "crypto.h"
 #include "access.h"
+#include "transport.h"
 #include "foundation.h"
 #include "mesh_main.h"
 
@@ -77,6 +78,7 @@ int bt_mesh_device_auto_enter_network(struct bt_mesh_device_network_info *info)
         BT_ERR("Failed to calculate AID, 0x%04x", info->app_idx);
         return -EIO;
     }
+    bt_mesh_app_key_aid_index_invalidate();
 
     key->net_idx = info->net_idx;
     key->app_idx = info->app_idx;
@@ -659,76 +659,89 @@ int bt_mesh_trans_send(struct bt_mesh_net_tx *tx, struct net_buf_simple *msg,
     return err;
 }
 
-static void update_rpl(struct bt_mesh_rpl *rpl, struct bt_mesh_net_rx *rx)
-{
-    rpl->src = rx->ctx.addr;
-    rpl->seq = rx->seq;
-    rpl->old_iv = rx->old_iv;
-
-    if (IS_ENABLED(CONFIG_BLE_MESH_SETTINGS)) {
-        bt_mesh_store_rpl(rpl);
-    }
-}
+#if CONFIG_BLE_MESH_PROVISIONER
+#define AID_INDEX_APP_KEY_COUNT     (CONFIG_BLE_MESH_APP_KEY_COUNT + \
+                                     CONFIG_BLE_MESH_PROVISIONER_APP_KEY_COUNT)
+#else
+#define AID_INDEX_APP_KEY_COUNT     CONFIG_BLE_MESH_APP_KEY_COUNT
+#endif
 
-/* Check the Replay Protection List for a replay attempt. If non-NULL match
- * parameter is given the RPL slot is returned but it is not immediately
- * updated (needed for segmented messages), whereas if a NULL match is given
- * the RPL is immediately updated (used for unsegmented messages).
+/* AppKeys which may be used to decrypt a received Access PDU, grouped by
+ * AID. Candidates of AID n are cand[start[n]] up to (but not including)
+ * cand[start[n + 1]], in AppKey order. As for the NID index in net.c, the
+ * candidates are validated again before being used, and the index needs
+ * to be invalidated only when an AID is derived or a key is revoked.
  */
-bool bt_mesh_rpl_check(struct bt_mesh_net_rx *rx, struct bt_mesh_rpl **match)
+static struct {
+    bool     valid;
+    uint16_t appkey_size;   /* bt_mesh_rx_appkey_size() when built */
+    uint16_t start[AID_MASK + 2];
+    struct aid_cand {
+        uint16_t key_idx;   /* Index used with bt_mesh_rx_appkey_get() */
+        uint8_t  new_key;   /* keys[1] instead of keys[0] */
+    } cand[2 * AID_INDEX_APP_KEY_COUNT];
+} aid_index;
+
+void bt_mesh_app_key_aid_index_invalidate(void)
 {
-    int i;
+    aid_index.valid = false;
+}
 
-    /* Don't bother checking messages from ourselves */
-    if (rx->net_if == BLE_MESH_NET_IF_LOCAL) {
-        return false;
-    }
+static void aid_index_walk(size_t array_size, bool place)
+{
+    struct bt_mesh_app_key *key = NULL;
+    struct aid_cand *cand = NULL;
+    uint8_t aid = 0U;
+    int i, j;
 
-    /* The RPL is used only for the local node */
-    if (!rx->local_match) {
-        return false;
-    }
+    for (i = 0; i < array_size; i++) {
+        key = bt_mesh_rx_appkey_get(i);
+        if (!key || key->net_idx == BLE_MESH_KEY_UNUSED) {
+            continue;
+        }
 
-    for (i = 0; i < ARRAY_SIZE(bt_mesh.rpl); i++) {
-        struct bt_mesh_rpl *rpl = &bt_mesh.rpl[i];
+        for (j = 0; j < ARRAY_SIZE(key->keys); j++) {
+            aid = key->keys[j].id & AID_MASK;
 
-        /* Empty slot */
-        if (!rpl->src) {
-            if (match) {
-                *match = rpl;
-            } else {
-                update_rpl(rpl, rx);
+            if (!place) {
+                aid_index.start[aid + 1]++;
+                continue;
             }
 
-            return false;
+            cand = &aid_index.cand[aid_index.start[aid]++];
+            cand->key_idx = i;
+            cand->new_key = j;
         }
+    }
+}
 
-        /* Existing slot for given address */
-        if (rpl->src == rx->ctx.addr) {
-            if (rx->old_iv && !rpl->old_iv) {
-                return true;
-            }
+static void aid_index_rebuild(void)
+{
+    size_t array_size = 0U;
+    int i;
 
-            if ((!rx->old_iv && rpl->old_iv) ||
-                    rpl->seq < rx->seq) {
-                if (match) {
-                    *match = rpl;
-                } else {
-                    update_rpl(rpl, rx);
-                }
+    array_size = MIN(bt_mesh_rx_appkey_size(), AID_INDEX_APP_KEY_COUNT);
 
-                return false;
-            } else {
-#if CONFIG_BLE_MESH_NOT_RELAY_REPLAY_MSG
-                rx->replay_msg = 1;
-#endif
-                return true;
-            }
-        }
+    (void)memset(aid_index.start, 0, sizeof(aid_index.start));
+
+    /* Count the candidates of each AID */
+    aid_index_walk(array_size, false);
+
+    for (i = 0; i <= AID_MASK; i++) {
+        aid_index.start[i + 1] += aid_index.start[i];
     }
 
-    BT_ERR("RPL is full!");
-    return true;
+    /* Place them, which moves start[n] to the end of AID n */
+    aid_index_walk(array_size, true);
+
+    memmove(&aid_index.start[1], &aid_index.start[0],
+            (AID_MASK + 1) * sizeof(aid_index.start[0]));
+    aid_index.start[0] = 0U;
+
+    aid_index.appkey_size = bt_mesh_rx_appkey_size();
+    aid_index.valid = true;
+
+    BT_DBG("AID index rebuilt, %u candidates", aid_index.start[AID_MASK + 1]);
 }
 
 static int sdu_recv(struct bt_mesh_net_rx *rx, uint32_t seq, uint8_t hdr,
@@ -810,13 +823,19 @@ static int sdu_recv(struct bt_mesh_net_rx *rx, uint32_t seq, uint8_t hdr,
         return -ENODEV;
     }
 
-    array_size = bt_mesh_rx_appkey_size();
+    if (!aid_index.valid ||
+        aid_index.appkey_size != bt_mesh_rx_appkey_size()) {
+        aid_index_rebuild();
+    }
+
+    bt_mesh_rx_stats.app_pdu++;
 
-    for (i = 0U; i < array_size; i++) {
+    for (i = aid_index.start[AID(&hdr)]; i < aid_index.start[AID(&hdr) + 1]; i++) {
+        struct aid_cand *cand = &aid_index.cand[i];
         struct bt_mesh_app_keys *keys = NULL;
         struct bt_mesh_app_key *key = NULL;
 
-        key = bt_mesh_rx_appkey_get(i);
+        key = bt_mesh_rx_appkey_get(cand->key_idx);
         if (!key) {
             BT_DBG("AppKey not found");
             continue;
@@ -827,17 +846,20 @@ static int sdu_recv(struct bt_mesh_net_rx *rx, uint32_t seq, uint8_t hdr,
             continue;
         }
 
-        if (rx->new_key && key->updated) {
-            keys = &key->keys[1];
-        } else {
-            keys = &key->keys[0];
+        /* Only the key generation used for this PDU is a candidate */
+        if (cand->new_key != (rx->new_key && key->updated)) {
+            continue;
         }
 
+        keys = &key->keys[cand->new_key];
+
         /* Check that the AppKey ID matches */
         if (AID(&hdr) != keys->id) {
             continue;
         }
 
+        bt_mesh_rx_stats.app_trial++;
+
         net_buf_simple_reset(sdu);
         err = bt_mesh_app_decrypt(keys->val, false, aszmic, buf,
                                   sdu, ad, rx->ctx.addr,
@@ -1592,7 +1614,7 @@ static int trans_seg(struct net_buf_simple *buf, struct bt_mesh_net_rx *net_rx,
                      seq_auth, rx->block, rx->obo);
 
             if (rpl) {
-                update_rpl(rpl, net_rx);
+                bt_mesh_rpl_update(rpl, net_rx);
             }
 
             return -EALREADY;
@@ -1699,7 +1721,7 @@ found_rx:
     BT_DBG("Complete SDU");
 
     if (rpl) {
-        update_rpl(rpl, net_rx);
+        bt_mesh_rpl_update(rpl, net_rx);
     }
 
     *pdu_type = BLE_MESH_FRIEND_PDU_COMPLETE;
@@ -1815,7 +1837,7 @@ void bt_mesh_rx_reset(bool erase)
         seg_rx_reset(&seg_rx[i], true);
     }
 
-    (void)memset(bt_mesh.rpl, 0, sizeof(bt_mesh.rpl));
+    bt_mesh_rpl_clear();
 
     if (IS_ENABLED(CONFIG_BLE_MESH_SETTINGS) && erase) {
         bt_mesh_clear_rpl();
@@ -1836,6 +1858,7 @@ void bt_mesh_tx_reset(void)
 #if CONFIG_BLE_MESH_PROVISIONER
 void bt_mesh_rx_reset_single(uint16_t src)
 {
+    struct bt_mesh_rpl *rpl = NULL;
     int i;
 
     if (!BLE_MESH_ADDR_IS_UNICAST(src)) {
@@ -1849,13 +1872,11 @@ void bt_mesh_rx_reset_single(uint16_t src)
         }
     }
 
-    for (i = 0; i < ARRAY_SIZE(bt_mesh.rpl); i++) {
-        struct bt_mesh_rpl *rpl = &bt_mesh.rpl[i];
-        if (src == rpl->src) {
-            memset(rpl, 0, sizeof(struct bt_mesh_rpl));
-            if (IS_ENABLED(CONFIG_BLE_MESH_SETTINGS)) {
-                bt_mesh_clear_rpl_single(src);
-            }
+    rpl = bt_mesh_rpl_find(src);
+    if (rpl) {
+        bt_mesh_rpl_remove(rpl);
+        if (IS_ENABLED(CONFIG_BLE_MESH_SETTINGS)) {
+            bt_mesh_clear_rpl_single(src);
         }
     }
 }
@@ -116,8 +116,17 @@ void bt_mesh_trans_deinit(bool erase);
 
 bool bt_mesh_rpl_check(struct bt_mesh_net_rx *rx, struct bt_mesh_rpl **match);
 
+void bt_mesh_rpl_update(struct bt_mesh_rpl *rpl, struct bt_mesh_net_rx *rx);
+
+struct bt_mesh_rpl *bt_mesh_rpl_find(uint16_t src);
+struct bt_mesh_rpl *bt_mesh_rpl_alloc(uint16_t src);
+void bt_mesh_rpl_remove(struct bt_mesh_rpl *rpl);
+void bt_mesh_rpl_clear(void);
+
 void bt_mesh_heartbeat_send(void);
 
+void bt_mesh_app_key_aid_index_invalidate(void);
+
 int bt_mesh_app_key_get(const struct bt_mesh_subnet *subnet, uint16_t app_idx,
                         const uint8_t **key, uint8_t *aid,  uint8_t role, uint16_t dst);
 
@@ -0,0 +1,164 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Host test and benchmark of the Network PDU encryption of crypto.c, with the tinycrypt backend.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include "crypto.h"
+
+#define BENCH_PDUS      20000
+#define BENCH_BUFS     32
+#define PDU_SIZE        29
+
+unsigned int test_crypto_lock_count;
+
+/* Mesh Profile specification, sample data 8.3.1, message #1 */
+static const uint8_t s_enc_key[16] = {
+    0x09, 0x53, 0xfa, 0x93, 0xe7, 0xca, 0xac, 0x96, 0x38, 0xf5, 0x88, 0x20, 0x22, 0x0a, 0x39, 0x8e
+};
+static const uint8_t s_privacy_key[16] = {
+    0x8b, 0x84, 0xee, 0xde, 0xc1, 0x00, 0x06, 0x7d, 0x67, 0x09, 0x71, 0xdd, 0x2a, 0xa7, 0x00, 0xcf
+};
+static const uint32_t s_iv_index = 0x12345678;
+/* IVI/NID, CTL/TTL, SEQ, SRC, DST, TransportPDU */
+static const uint8_t s_plain_pdu[] = {
+    0x68, 0x80, 0x00, 0x00, 0x01, 0x12, 0x01, 0xff, 0xfd,
+    0x03, 0x4b, 0x50, 0x05, 0x7e, 0x40, 0x00, 0x00, 0x01, 0x00, 0x00
+};
+static const uint8_t s_net_pdu[] = {
+    0x68, 0xec, 0xa4, 0x87, 0x51, 0x67, 0x65, 0xb5, 0xe5, 0xbf, 0xda, 0xcb, 0xaf, 0x6c,
+    0xb7, 0xfb, 0x6b, 0xff, 0x87, 0x1f, 0x03, 0x54, 0x44, 0xce, 0x83, 0xa6, 0x70, 0xdf
+};
+
+typedef struct {
+    struct net_buf_simple buf;
+    uint8_t storage[PDU_SIZE];
+} pdu_t;
+
+static void pdu_init(pdu_t *pdu, uint32_t seq)
+{
+    memcpy(pdu->storage, s_plain_pdu, sizeof(s_plain_pdu));
+    pdu->storage[2] = seq >> 16;
+    pdu->storage[3] = seq >> 8;
+    pdu->storage[4] = seq;
+    pdu->buf = (struct net_buf_simple) {
+        .data = pdu->storage, .len = sizeof(s_plain_pdu), .size = sizeof(pdu->storage), .__buf = pdu->storage,
+    };
+}
+
+static void check_sample_data(void)
+{
+    pdu_t pdus[3];
+
+    pdu_init(&pdus[0], 1);
+    assert(bt_mesh_net_encrypt(s_enc_key, &pdus[0].buf, s_iv_index, false) == 0);
+    assert(bt_mesh_net_obfuscate(pdus[0].buf.data, s_iv_index, s_privacy_key) == 0);
+    assert(pdus[0].buf.len == sizeof(s_net_pdu) && memcmp(pdus[0].buf.data, s_net_pdu, sizeof(s_net_pdu)) == 0);
+
+    /* Other sequence numbers give other PDUs, which decrypt back */
+    for (int i = 0; i < 3; i++) {
+        pdu_init(&pdus[i], 0x100 + i);
+        assert(bt_mesh_net_encrypt(s_enc_key, &pdus[i].buf, s_iv_index, false) == 0);
+        assert(bt_mesh_net_obfuscate(pdus[i].buf.data, s_iv_index, s_privacy_key) == 0);
+    }
+    assert(memcmp(pdus[0].buf.data, pdus[2].buf.data, sizeof(s_net_pdu)) != 0);
+    for (int i = 0; i < 3; i++) {
+        assert(bt_mesh_net_obfuscate(pdus[i].buf.data, s_iv_index, s_privacy_key) == 0);
+        assert(bt_mesh_net_decrypt(s_enc_key, &pdus[i].buf, s_iv_index, false) == 0);
+        assert(pdus[i].buf.len == sizeof(s_plain_pdu));
+        assert(memcmp(pdus[i].buf.data + 7, s_plain_pdu + 7, sizeof(s_plain_pdu) - 7) == 0);
+    }
+
+    /* A tampered PDU fails the NetMIC check */
+    pdu_init(&pdus[0], 1);
+    assert(bt_mesh_net_encrypt(s_enc_key, &pdus[0].buf, s_iv_index, false) == 0);
+    pdus[0].buf.data[10] ^= 1;
+    assert(bt_mesh_net_decrypt(s_enc_key, &pdus[0].buf, s_iv_index, false) != 0);
+}
+
+static void check_key_cache(void)
+{
+    pdu_t pdu;
+
+    /* Two misses: lookup and insertion of each key */
+    bt_mesh_crypto_key_cache_clear();
+    test_crypto_lock_count = 0;
+    pdu_init(&pdu, 0);
+    assert(bt_mesh_net_encrypt(s_enc_key, &pdu.buf, s_iv_index, false) == 0);
+    assert(bt_mesh_net_obfuscate(pdu.buf.data, s_iv_index, s_privacy_key) == 0);
+    assert(test_crypto_lock_count == 4);
+
+    /* Then one hit per key and PDU */
+    test_crypto_lock_count = 0;
+    for (int i = 0; i < BENCH_BUFS; i++) {
+        pdu_init(&pdu, i);
+        assert(bt_mesh_net_encrypt(s_enc_key, &pdu.buf, s_iv_index, false) == 0);
+        assert(bt_mesh_net_obfuscate(pdu.buf.data, s_iv_index, s_privacy_key) == 0);
+    }
+    assert(test_crypto_lock_count == 2 * BENCH_BUFS);
+
+    /* Once cleared, the keys are expanded again and give the same result */
+    bt_mesh_crypto_key_cache_clear();
+    pdu_init(&pdu, 1);
+    assert(bt_mesh_net_encrypt(s_enc_key, &pdu.buf, s_iv_index, false) == 0);
+    assert(bt_mesh_net_obfuscate(pdu.buf.data, s_iv_index, s_privacy_key) == 0);
+    assert(memcmp(pdu.buf.data, s_net_pdu, sizeof(s_net_pdu)) == 0);
+}
+
+static double elapsed_s(const struct timespec *start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+typedef enum {
+    BENCH_EXPAND_EACH,  /* One call per PDU, keys expanded for each PDU */
+    BENCH_CACHED,       /* One call per PDU, expanded keys taken from the cache */
+} bench_mode_t;
+
+static double bench(bench_mode_t mode)
+{
+    static pdu_t pdus[BENCH_BUFS];
+    struct net_buf_simple *bufs[BENCH_BUFS];
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int done = 0; done < BENCH_PDUS; done += BENCH_BUFS) {
+        for (int i = 0; i < BENCH_BUFS; i++) {
+            pdu_init(&pdus[i], done + i);
+            bufs[i] = &pdus[i].buf;
+        }
+        for (int i = 0; i < BENCH_BUFS; i++) {
+            if (mode == BENCH_EXPAND_EACH) {
+                bt_mesh_crypto_key_cache_clear();
+            }
+            assert(bt_mesh_net_encrypt(s_enc_key, bufs[i], s_iv_index, false) == 0);
+            if (mode == BENCH_EXPAND_EACH) {
+                bt_mesh_crypto_key_cache_clear();
+            }
+            assert(bt_mesh_net_obfuscate(bufs[i]->data, s_iv_index, s_privacy_key) == 0);
+        }
+    }
+    return BENCH_PDUS / elapsed_s(&start);
+}
+
+int main(void)
+{
+    check_sample_data();
+    check_key_cache();
+    double expand_each = bench(BENCH_EXPAND_EACH);
+    double cached = bench(BENCH_CACHED);
+    printf("PDUs/s: keys expanded per PDU %.0f, cached keys %.0f\n", expand_each, cached);
+    printf("All tests passed\n");
+    return 0;
+}
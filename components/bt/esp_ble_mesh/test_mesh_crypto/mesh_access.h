@@ -0,0 +1,55 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Host stub of mesh_access.h, only what net.h, adv.h and the other headers rpl.c and msg_cache.c include use */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "mesh_common.h"
+#include "mesh_buf.h"
+
+#define __packed                        __attribute__((__packed__))
+
+#define BLE_MESH_ADDR_UNASSIGNED        0x0000
+
+#define BLE_MESH_ATOMIC_DEFINE(name, num_bits)  uint32_t name[((num_bits) + 31) / 32]
+
+typedef struct {
+    void *head;
+    void *tail;
+} sys_slist_t;
+
+struct k_work {
+    void *handler;
+};
+
+struct k_delayed_work {
+    struct k_work work;
+};
+
+struct bt_mesh_msg_ctx {
+    uint16_t net_idx;
+    uint16_t app_idx;
+    uint16_t addr;
+    uint16_t recv_dst;
+    int8_t   recv_rssi;
+    uint8_t  recv_ttl;
+    uint8_t  send_rel;
+    uint8_t  send_ttl;
+    uint32_t recv_op;
+    void    *model;
+    bool     srv_send;
+};
+
+struct bt_mesh_send_cb {
+    void (*start)(uint16_t duration, int err, void *cb_data);
+    void (*end)(int err, void *cb_data);
+};
+
+struct bt_mesh_model;
@@ -0,0 +1,11 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Host stub of mesh_atomic.h, only the type adv.h uses */
+
+#pragma once
+
+typedef int bt_mesh_atomic_t;
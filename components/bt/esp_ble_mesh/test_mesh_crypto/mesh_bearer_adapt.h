@@ -0,0 +1,16 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Host stub of mesh_bearer_adapt.h, only the address type provisioner_main.h uses */
+
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+    uint8_t type;
+    uint8_t val[6];
+} bt_mesh_addr_t;
@@ -0,0 +1,33 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Host stub of mesh_buf.h, only what crypto.c uses and the pool type adv.h uses */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "mesh_common.h"
+
+struct net_buf_pool;
+
+struct net_buf_simple {
+    uint8_t *data;
+    uint16_t len;
+    uint16_t size;
+    uint8_t *__buf;
+};
+
+static inline void *net_buf_simple_add(struct net_buf_simple *buf, size_t len)
+{
+    uint8_t *tail = buf->data + buf->len;
+
+    assert(tail + len <= buf->__buf + buf->size);
+    buf->len += len;
+    return tail;
+}
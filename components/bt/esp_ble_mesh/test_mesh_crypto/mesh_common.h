@@ -0,0 +1,69 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Host stub of mesh_common.h, only what crypto.c, msg_cache.c and rpl.c use */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define ARRAY_SIZE(array)   (sizeof(array) / sizeof((array)[0]))
+#define BIT_MASK(n)         (BIT(n) - 1)
+#define BIT(n)              (1UL << (n))
+
+/* Same expansion trick as mesh_util.h, the config macro must be defined to 1 */
+#define IS_ENABLED(config_macro)        Z_IS_ENABLED1(config_macro)
+#define Z_IS_ENABLED1(config_macro)     Z_IS_ENABLED2(_XXXX##config_macro)
+#define _XXXX1                          _YYYY,
+#define Z_IS_ENABLED2(one_or_two_args)  Z_IS_ENABLED3(one_or_two_args 1, 0)
+#define Z_IS_ENABLED3(ignore_this, val, ...) val
+
+#define BT_DBG(fmt, ...)    do { } while (0)
+#define BT_WARN(fmt, ...)   do { } while (0)
+#define BT_ERR(fmt, ...)    do { } while (0)
+
+static inline const char *bt_hex(const void *buf, size_t len)
+{
+    (void)buf;
+    (void)len;
+    return "";
+}
+
+static inline void sys_put_be16(uint16_t val, uint8_t dst[2])
+{
+    dst[0] = val >> 8;
+    dst[1] = val;
+}
+
+static inline void sys_put_be32(uint32_t val, uint8_t dst[4])
+{
+    sys_put_be16(val >> 16, dst);
+    sys_put_be16(val, &dst[2]);
+}
+
+static inline uint16_t sys_get_be16(const uint8_t src[2])
+{
+    return ((uint16_t)src[0] << 8) | src[1];
+}
+
+static inline uint32_t sys_get_be24(const uint8_t src[3])
+{
+    return ((uint32_t)src[0] << 16) | sys_get_be16(&src[1]);
+}
+
+/* Counts the calls, the test checks the key cache with them */
+extern unsigned int test_crypto_lock_count;
+
+static inline void bt_mesh_crypto_lock(void)
+{
+    test_crypto_lock_count++;
+}
+
+static inline void bt_mesh_crypto_unlock(void)
+{
+}
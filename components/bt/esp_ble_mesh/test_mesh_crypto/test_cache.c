@@ -0,0 +1,303 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Host test and benchmark of the network message cache of msg_cache.c and of the replay
+ * protection list of rpl.c, against linear reference implementations.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include "net.h"
+#include "transport.h"
+#include "settings.h"
+
+#define CACHE_SIZE      CONFIG_BLE_MESH_MSG_CACHE_SIZE
+#define RPL_SIZE        CONFIG_BLE_MESH_CRPL
+/* More sources than RPL entries, so that the list gets full */
+#define SRC_COUNT       (RPL_SIZE + RPL_SIZE / 2)
+#define TEST_ROUNDS     (20 * CACHE_SIZE)
+#define BENCH_LOOKUPS   200000
+
+struct bt_mesh_net bt_mesh;
+
+/* Settings storage of the RPL, indexed by source address */
+static struct {
+    bool     stored;
+    bool     old_iv;
+    uint32_t seq;
+} s_flash[0x8000];
+static unsigned int s_store_count;
+
+void bt_mesh_store_rpl(struct bt_mesh_rpl *entry)
+{
+    s_flash[entry->src].stored = true;
+    s_flash[entry->src].old_iv = entry->old_iv;
+    s_flash[entry->src].seq = entry->seq;
+    s_store_count++;
+}
+
+/* Linear message cache, as it was before the hash index */
+static struct {
+    uint32_t src:15,
+             seq:17;
+} s_ref_cache[CACHE_SIZE];
+static uint16_t s_ref_cache_next;
+
+static bool ref_cache_match(uint16_t src, uint32_t seq, int skip)
+{
+    for (int i = 0; i < CACHE_SIZE; i++) {
+        if (i != skip && s_ref_cache[i].src == src && s_ref_cache[i].seq == (seq & BIT_MASK(17))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint16_t ref_cache_add(uint16_t src, uint32_t seq)
+{
+    uint16_t idx = s_ref_cache_next++;
+
+    s_ref_cache_next %= CACHE_SIZE;
+    s_ref_cache[idx].src = src;
+    s_ref_cache[idx].seq = seq;
+    return idx;
+}
+
+/* Linear replay protection list, as it was before the hash index */
+static struct bt_mesh_rpl s_ref_rpl[RPL_SIZE];
+
+static struct bt_mesh_rpl *ref_rpl_find(uint16_t src)
+{
+    for (int i = 0; i < RPL_SIZE; i++) {
+        if (s_ref_rpl[i].src == src) {
+            return &s_ref_rpl[i];
+        }
+    }
+    return NULL;
+}
+
+static bool ref_rpl_check(const struct bt_mesh_net_rx *rx)
+{
+    struct bt_mesh_rpl *rpl = ref_rpl_find(rx->ctx.addr);
+
+    if (rpl) {
+        if (rx->old_iv && !rpl->old_iv) {
+            return true;
+        }
+        if ((!rx->old_iv && rpl->old_iv) || rpl->seq < rx->seq) {
+            rpl->seq = rx->seq;
+            rpl->old_iv = rx->old_iv;
+            return false;
+        }
+        return true;
+    }
+
+    rpl = ref_rpl_find(BLE_MESH_ADDR_UNASSIGNED);
+    if (rpl) {
+        rpl->src = rx->ctx.addr;
+        rpl->seq = rx->seq;
+        rpl->old_iv = rx->old_iv;
+        return false;
+    }
+    return true;
+}
+
+static void pdu_init(struct net_buf_simple *buf, uint8_t storage[7], uint16_t src, uint32_t seq)
+{
+    storage[2] = seq >> 16;
+    storage[3] = seq >> 8;
+    storage[4] = seq;
+    sys_put_be16(src, &storage[5]);
+    *buf = (struct net_buf_simple) {
+        .data = storage, .len = 7, .size = 7, .__buf = storage,
+    };
+}
+
+static bool cache_match(uint16_t src, uint32_t seq)
+{
+    struct net_buf_simple buf;
+    uint8_t storage[7] = {0};
+
+    pdu_init(&buf, storage, src, seq);
+    return bt_mesh_msg_cache_match(&buf);
+}
+
+static void check_msg_cache(void)
+{
+    struct bt_mesh_net_rx rx = {0};
+
+    bt_mesh_msg_cache_reset();
+    for (int round = 0; round < TEST_ROUNDS; round++) {
+        /* Few sources and a narrow sequence range, so that many lookups hit */
+        uint16_t src = 1 + rand() % 64;
+        uint32_t seq = rand() % (4 * CACHE_SIZE);
+        if (rand() % 8 == 0) {
+            /* Same low 17 bits as another sequence number */
+            seq |= BIT(17 + rand() % 7);
+        }
+
+        bool match = cache_match(src, seq);
+        assert(match == ref_cache_match(src, seq, -1));
+        if (match) {
+            continue;
+        }
+
+        rx.ctx.addr = src;
+        rx.seq = seq;
+        bt_mesh_msg_cache_add(&rx);
+        assert(rx.msg_cache_idx == ref_cache_add(src, seq));
+        assert(cache_match(src, seq));
+        assert(bt_mesh_msg_cache_dup(&rx) == ref_cache_match(src, seq, rx.msg_cache_idx));
+
+        if (rand() % 16 == 0) {
+            /* Rejected by the upper layers, as on -EAGAIN in bt_mesh_net_recv() */
+            bt_mesh_msg_cache_reject(rx.msg_cache_idx);
+            memset(&s_ref_cache[rx.msg_cache_idx], 0, sizeof(s_ref_cache[0]));
+            s_ref_cache_next = rx.msg_cache_idx;
+        }
+    }
+
+    /* Every entry left, and everything evicted, is reported as by the linear cache */
+    for (uint16_t src = 1; src <= 64; src++) {
+        for (uint32_t seq = 0; seq < 4 * CACHE_SIZE; seq++) {
+            assert(cache_match(src, seq) == ref_cache_match(src, seq, -1));
+        }
+    }
+}
+
+static void rpl_check_all(void)
+{
+    for (uint16_t src = 1; src <= SRC_COUNT; src++) {
+        struct bt_mesh_rpl *rpl = bt_mesh_rpl_find(src);
+        struct bt_mesh_rpl *ref = ref_rpl_find(src);
+        assert(!rpl == !ref);
+        if (rpl) {
+            assert(rpl->seq == ref->seq && rpl->old_iv == ref->old_iv);
+        }
+    }
+}
+
+/* Same as rpl_set() of settings.c does on boot */
+static void rpl_restore(void)
+{
+    bt_mesh_rpl_clear();
+    for (uint16_t src = 1; src <= SRC_COUNT; src++) {
+        if (!s_flash[src].stored) {
+            continue;
+        }
+        struct bt_mesh_rpl *rpl = bt_mesh_rpl_find(src);
+        if (!rpl) {
+            rpl = bt_mesh_rpl_alloc(src);
+        }
+        assert(rpl);
+        rpl->seq = s_flash[src].seq;
+        rpl->old_iv = s_flash[src].old_iv;
+    }
+}
+
+static void check_rpl(void)
+{
+    struct bt_mesh_net_rx rx = {
+        .net_if = BLE_MESH_NET_IF_ADV,
+        .local_match = 1,
+    };
+    uint32_t seq[SRC_COUNT + 1] = {0};
+
+    bt_mesh_rpl_clear();
+    for (int round = 0; round < TEST_ROUNDS; round++) {
+        uint16_t src = 1 + rand() % SRC_COUNT;
+
+        rx.ctx.addr = src;
+        rx.old_iv = rand() % 32 == 0;
+        /* Mostly new messages, some replays */
+        if (rand() % 4 == 0 && seq[src]) {
+            rx.seq = seq[src] - rand() % 4;
+        } else {
+            rx.seq = ++seq[src];
+        }
+
+        bool ref = ref_rpl_check(&rx);
+        if (rand() % 2) {
+            assert(bt_mesh_rpl_check(&rx, NULL) == ref);
+        } else {
+            /* Segmented messages update the entry once complete */
+            struct bt_mesh_rpl *match = NULL;
+            assert(bt_mesh_rpl_check(&rx, &match) == ref);
+            assert(!match == ref);
+            if (match) {
+                bt_mesh_rpl_update(match, &rx);
+            }
+        }
+
+        if (rand() % 64 == 0) {
+            /* Same as bt_mesh_clear_rpl_single() */
+            struct bt_mesh_rpl *rpl = bt_mesh_rpl_find(src);
+            if (rpl) {
+                bt_mesh_rpl_remove(rpl);
+                memset(ref_rpl_find(src), 0, sizeof(struct bt_mesh_rpl));
+                s_flash[src].stored = false;
+            }
+        }
+    }
+    rpl_check_all();
+
+    /* The list is full, new sources are rejected */
+    rx.ctx.addr = SRC_COUNT + 1;
+    rx.seq = 1;
+    rx.old_iv = 0;
+    if (!ref_rpl_find(BLE_MESH_ADDR_UNASSIGNED)) {
+        assert(bt_mesh_rpl_check(&rx, NULL));
+    }
+
+    /* Everything accepted was stored, and the list comes back the same after a reboot */
+    assert(s_store_count > 0);
+    rpl_restore();
+    rpl_check_all();
+}
+
+static double elapsed_s(const struct timespec *start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static double bench(bool linear)
+{
+    struct timespec start;
+    volatile int found = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCH_LOOKUPS; i++) {
+        uint16_t src = 1 + i % SRC_COUNT;
+        uint32_t seq = i % (4 * CACHE_SIZE);
+        if (linear) {
+            found += ref_cache_match(src % 64 + 1, seq, -1);
+            found += !!ref_rpl_find(src);
+        } else {
+            found += cache_match(src % 64 + 1, seq);
+            found += !!bt_mesh_rpl_find(src);
+        }
+    }
+    return BENCH_LOOKUPS / elapsed_s(&start);
+}
+
+int main(void)
+{
+    srand(1);
+    check_msg_cache();
+    check_rpl();
+    double linear = bench(true);
+    double hashed = bench(false);
+    printf("Lookups/s with %d cache and %d RPL entries: linear %.0f, hash index %.0f\n",
+           CACHE_SIZE, RPL_SIZE, linear, hashed);
+    printf("All tests passed\n");
+    return 0;
+}
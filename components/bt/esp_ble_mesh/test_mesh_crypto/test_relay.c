@@ -0,0 +1,203 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Host test of the relay queue of relay_queue.c: service order, and which packet is dropped
+ * when the queue is full, against a reference implementation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "relay_queue.h"
+
+#define MAX_AGE         6000
+#define QUEUE_SIZE      16
+#define TEST_ROUNDS     200000
+
+static bt_mesh_msg_t msg_init(uint16_t src, uint8_t ttl, uint32_t timestamp)
+{
+    return (bt_mesh_msg_t) {
+        .relay = true, .src = src, .ttl = ttl, .timestamp = timestamp,
+    };
+}
+
+static void check_order(void)
+{
+    static const uint8_t ttls[] = { 3, 7, 3, 5, 7, 1, 127, 0 };
+    /* Decreasing TTL, posting order for the same TTL */
+    static const uint16_t order[] = { 6, 1, 4, 3, 0, 2, 5, 7 };
+    bt_mesh_msg_t msgs[ARRAY_SIZE(ttls)], msg, dropped;
+    struct bt_mesh_relay_queue queue;
+
+    bt_mesh_relay_queue_init(&queue, msgs, ARRAY_SIZE(msgs));
+    assert(!bt_mesh_relay_queue_get(&queue, &msg));
+    for (int i = 0; i < ARRAY_SIZE(ttls); i++) {
+        msg = msg_init(i, ttls[i], i);
+        assert(bt_mesh_relay_queue_put(&queue, &msg, i, MAX_AGE, &dropped) == BLE_MESH_RELAY_QUEUE_ADDED);
+    }
+    for (int i = 0; i < ARRAY_SIZE(order); i++) {
+        assert(bt_mesh_relay_queue_get(&queue, &msg));
+        assert(msg.src == order[i]);
+    }
+    assert(!bt_mesh_relay_queue_get(&queue, &msg));
+}
+
+static void check_full(void)
+{
+    bt_mesh_msg_t msgs[4], msg, dropped;
+    struct bt_mesh_relay_queue queue;
+    uint32_t now = 100;
+
+    bt_mesh_relay_queue_init(&queue, msgs, ARRAY_SIZE(msgs));
+    for (int i = 0; i < 4; i++) {
+        msg = msg_init(i, i < 2 ? 5 : 3, now);
+        assert(bt_mesh_relay_queue_put(&queue, &msg, now, MAX_AGE, &dropped) == BLE_MESH_RELAY_QUEUE_ADDED);
+    }
+
+    /* The oldest packet with the lowest TTL makes room for a higher TTL */
+    msg = msg_init(4, 4, now);
+    assert(bt_mesh_relay_queue_put(&queue, &msg, now, MAX_AGE, &dropped) == BLE_MESH_RELAY_QUEUE_REPLACED_TTL);
+    assert(dropped.src == 2);
+
+    /* And for the same TTL */
+    msg = msg_init(5, 3, now);
+    assert(bt_mesh_relay_queue_put(&queue, &msg, now, MAX_AGE, &dropped) == BLE_MESH_RELAY_QUEUE_REPLACED_TTL);
+    assert(dropped.src == 3);
+
+    /* A lower TTL than all the queued packets is dropped */
+    msg = msg_init(6, 2, now);
+    assert(bt_mesh_relay_queue_put(&queue, &msg, now, MAX_AGE, &dropped) == BLE_MESH_RELAY_QUEUE_REJECTED);
+    assert(dropped.src == 6);
+
+    /* Unless a packet is stale, whatever its TTL, the oldest one first */
+    now += MAX_AGE;
+    msgs[0].timestamp = now - MAX_AGE - 1;
+    msgs[1].timestamp = now - MAX_AGE - 2;
+    assert(bt_mesh_relay_queue_put(&queue, &msg, now, MAX_AGE, &dropped) == BLE_MESH_RELAY_QUEUE_REPLACED_STALE);
+    assert(dropped.ttl == 5 && dropped.timestamp == now - MAX_AGE - 2);
+
+    /* Ages are computed across the wraparound of the timestamps */
+    bt_mesh_relay_queue_init(&queue, msgs, ARRAY_SIZE(msgs));
+    for (int i = 0; i < 4; i++) {
+        msg = msg_init(i, 10, UINT32_MAX - 10 + i);
+        assert(bt_mesh_relay_queue_put(&queue, &msg, UINT32_MAX - 10 + i, MAX_AGE, &dropped) == BLE_MESH_RELAY_QUEUE_ADDED);
+    }
+    msg = msg_init(4, 1, 20);
+    assert(bt_mesh_relay_queue_put(&queue, &msg, 20, MAX_AGE, &dropped) == BLE_MESH_RELAY_QUEUE_REJECTED);
+    msg = msg_init(5, 1, MAX_AGE);
+    assert(bt_mesh_relay_queue_put(&queue, &msg, MAX_AGE, MAX_AGE, &dropped) == BLE_MESH_RELAY_QUEUE_REPLACED_STALE);
+    assert(dropped.src == 0);
+}
+
+/* Unordered reference, every decision taken by a full scan */
+static struct {
+    bt_mesh_msg_t msg;
+    uint32_t posted;
+} s_ref[QUEUE_SIZE];
+static int s_ref_count;
+static uint32_t s_ref_posted;
+
+static int ref_find(bool lowest)
+{
+    int found = -1;
+
+    for (int i = 0; i < s_ref_count; i++) {
+        if (found < 0) {
+            found = i;
+            continue;
+        }
+        int diff = (int)s_ref[i].msg.ttl - s_ref[found].msg.ttl;
+        if ((lowest ? -diff : diff) > 0 ||
+                (diff == 0 && s_ref[i].posted < s_ref[found].posted)) {
+            found = i;
+        }
+    }
+    return found;
+}
+
+static void ref_remove(int idx)
+{
+    s_ref[idx] = s_ref[--s_ref_count];
+}
+
+static enum bt_mesh_relay_queue_put ref_put(const bt_mesh_msg_t *msg, uint32_t now, bt_mesh_msg_t *dropped)
+{
+    enum bt_mesh_relay_queue_put ret = BLE_MESH_RELAY_QUEUE_ADDED;
+
+    if (s_ref_count == QUEUE_SIZE) {
+        int victim = -1;
+        for (int i = 0; i < s_ref_count; i++) {
+            if (now - s_ref[i].msg.timestamp >= MAX_AGE &&
+                    (victim < 0 || now - s_ref[i].msg.timestamp > now - s_ref[victim].msg.timestamp)) {
+                victim = i;
+            }
+        }
+        ret = BLE_MESH_RELAY_QUEUE_REPLACED_STALE;
+        if (victim < 0) {
+            victim = ref_find(true);
+            ret = BLE_MESH_RELAY_QUEUE_REPLACED_TTL;
+            if (s_ref[victim].msg.ttl > msg->ttl) {
+                *dropped = *msg;
+                return BLE_MESH_RELAY_QUEUE_REJECTED;
+            }
+        }
+        *dropped = s_ref[victim].msg;
+        ref_remove(victim);
+    }
+    s_ref[s_ref_count].msg = *msg;
+    s_ref[s_ref_count].posted = s_ref_posted++;
+    s_ref_count++;
+    return ret;
+}
+
+static void check_random(void)
+{
+    bt_mesh_msg_t msgs[QUEUE_SIZE], msg, dropped, ref_dropped;
+    struct bt_mesh_relay_queue queue;
+    uint32_t now = UINT32_MAX - 1000;
+    unsigned int count[4] = {0};
+
+    srand(1);
+    bt_mesh_relay_queue_init(&queue, msgs, QUEUE_SIZE);
+    for (int round = 0; round < TEST_ROUNDS; round++) {
+        now += rand() % 200;
+        /* More posts than gets, so that the queue is full most of the time */
+        if (rand() % 3) {
+            /* Distinct timestamps, so that the oldest stale packet is unique */
+            msg = msg_init(round, rand() % 8, now);
+            now++;
+            enum bt_mesh_relay_queue_put ret = bt_mesh_relay_queue_put(&queue, &msg, now, MAX_AGE, &dropped);
+            assert(ret == ref_put(&msg, now, &ref_dropped));
+            if (ret != BLE_MESH_RELAY_QUEUE_ADDED) {
+                assert(dropped.src == ref_dropped.src);
+            }
+            count[ret]++;
+        } else {
+            int idx = ref_find(false);
+            assert(bt_mesh_relay_queue_get(&queue, &msg) == (idx >= 0));
+            if (idx >= 0) {
+                assert(msg.src == s_ref[idx].msg.src);
+                ref_remove(idx);
+            }
+        }
+        assert(queue.count == s_ref_count);
+    }
+    /* Every case was exercised */
+    for (int i = 0; i < ARRAY_SIZE(count); i++) {
+        assert(count[i] > 0);
+    }
+}
+
+int main(void)
+{
+    check_order();
+    check_full();
+    check_random();
+    printf("All tests passed\n");
+    return 0;
+}
@@ -0,0 +1,203 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/*
+ Tests for the osi_thread work queues
+*/
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "unity.h"
+#include "esp_timer.h"
+
+#include "osi/thread.h"
+
+#define TEST_PRODUCER_MAX   4
+#define TEST_ITEM_NUM       20000
+#define TEST_DONE_TIMEOUT   pdMS_TO_TICKS(10000)
+
+typedef enum {
+    TEST_QUEUE_PER_PRODUCER,    /* Each producer posts to its own work queue */
+    TEST_QUEUE_SHARED,          /* All the producers post to work queue 0 */
+    TEST_QUEUE_LOCKED_REF,      /* Same workload on a FreeRTOS queue, as the locked work queues do */
+} test_queue_mode_t;
+
+static volatile uint32_t s_item_cnt[TEST_PRODUCER_MAX];
+static volatile uint32_t s_item_err;
+static osi_thread_t *s_thread;
+static SemaphoreHandle_t s_done;
+static uint32_t s_post_timeout;
+static test_queue_mode_t s_mode;
+
+/* Locked reference: one FreeRTOS queue, and a binary semaphore given on each post to wake the consumer */
+static QueueHandle_t s_ref_queue;
+static SemaphoreHandle_t s_ref_sem;
+static TaskHandle_t s_ref_consumer;
+
+static void work_func(void *context)
+{
+    uint32_t val = (uint32_t)context;
+    uint32_t id = val >> 24;
+
+    /* Items of one producer must come once each and in posting order, even through a shared queue */
+    if ((val & 0xffffff) != s_item_cnt[id] + 1) {
+        s_item_err++;
+    }
+    s_item_cnt[id] = val & 0xffffff;
+}
+
+static void ref_consumer_task(void *arg)
+{
+    void *context;
+
+    while (1) {
+        xSemaphoreTake(s_ref_sem, portMAX_DELAY);
+        while (xQueueReceive(s_ref_queue, &context, 0) == pdTRUE) {
+            work_func(context);
+        }
+    }
+}
+
+static bool ref_post(void *context)
+{
+    if (xQueueSend(s_ref_queue, &context, s_post_timeout == OSI_THREAD_MAX_TIMEOUT ?
+                   portMAX_DELAY : pdMS_TO_TICKS(s_post_timeout)) != pdTRUE) {
+        return false;
+    }
+    xSemaphoreGive(s_ref_sem);
+    return true;
+}
+
+static void producer_task(void *arg)
+{
+    uint32_t id = (uint32_t)arg;
+    bool ret;
+
+    for (uint32_t i = 1; i <= TEST_ITEM_NUM; i++) {
+        void *context = (void *)((id << 24) | i);
+        if (s_mode == TEST_QUEUE_LOCKED_REF) {
+            ret = ref_post(context);
+        } else {
+            ret = osi_thread_post(s_thread, work_func, context, s_mode == TEST_QUEUE_SHARED ? 0 : id, s_post_timeout);
+        }
+        if (!ret) {
+            s_item_err++;
+            break;
+        }
+    }
+
+    xSemaphoreGive(s_done);
+    vTaskDelete(NULL);
+}
+
+static bool all_items_done(int producer_num)
+{
+    for (int i = 0; i < producer_num; i++) {
+        if (s_item_cnt[i] != TEST_ITEM_NUM) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Returns the number of items processed per second */
+static int64_t run_producers(test_queue_mode_t mode, int producer_num, size_t queue_len, uint32_t post_timeout)
+{
+    size_t work_queue_len[TEST_PRODUCER_MAX];
+    int queue_num = mode == TEST_QUEUE_PER_PRODUCER ? producer_num : 1;
+    int64_t start, end;
+
+    s_item_err = 0;
+    s_post_timeout = post_timeout;
+    s_mode = mode;
+    for (int i = 0; i < TEST_PRODUCER_MAX; i++) {
+        s_item_cnt[i] = 0;
+        work_queue_len[i] = queue_len;
+    }
+
+    s_done = xSemaphoreCreateCounting(producer_num, 0);
+    TEST_ASSERT_NOT_NULL(s_done);
+    if (mode == TEST_QUEUE_LOCKED_REF) {
+        s_ref_queue = xQueueCreate(queue_len, sizeof(void *));
+        s_ref_sem = xSemaphoreCreateCounting(1, 0);
+        TEST_ASSERT_NOT_NULL(s_ref_queue);
+        TEST_ASSERT_NOT_NULL(s_ref_sem);
+        TEST_ASSERT_EQUAL(pdPASS, xTaskCreatePinnedToCore(ref_consumer_task, "osi_ref", 2048, NULL, 5,
+                                                          &s_ref_consumer, OSI_THREAD_CORE_AFFINITY));
+    } else {
+        s_thread = osi_thread_create("osi_test", 2048, 5, OSI_THREAD_CORE_AFFINITY, queue_num, work_queue_len);
+        TEST_ASSERT_NOT_NULL(s_thread);
+    }
+
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < producer_num; i++) {
+        xTaskCreatePinnedToCore(producer_task, "osi_prod", 2048, (void *)i, 4, NULL, i % portNUM_PROCESSORS);
+    }
+    for (int i = 0; i < producer_num; i++) {
+        TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(s_done, TEST_DONE_TIMEOUT));
+    }
+    TickType_t wait_start = xTaskGetTickCount();
+    while (s_item_err == 0 && !all_items_done(producer_num) &&
+           xTaskGetTickCount() - wait_start < TEST_DONE_TIMEOUT) {
+        vTaskDelay(1);
+    }
+    end = esp_timer_get_time();
+
+    int64_t rate = (int64_t)producer_num * TEST_ITEM_NUM * 1000000 / (end - start);
+    if (mode == TEST_QUEUE_LOCKED_REF) {
+        printf("%d producers, %d items in %lld us, %lld items/s (locked reference)\n",
+               producer_num, producer_num * TEST_ITEM_NUM, end - start, rate);
+        vTaskDelete(s_ref_consumer);
+        vQueueDelete(s_ref_queue);
+        vSemaphoreDelete(s_ref_sem);
+    } else {
+        printf("%d producers, %d items in %lld us, %lld items/s, %" PRIu32 " wake-ups\n",
+               producer_num, producer_num * TEST_ITEM_NUM, end - start, rate, osi_thread_wake_count(s_thread));
+        osi_thread_free(s_thread);
+    }
+    vSemaphoreDelete(s_done);
+
+    TEST_ASSERT_EQUAL(0, s_item_err);
+    TEST_ASSERT_TRUE(all_items_done(producer_num));
+    return rate;
+}
+
+TEST_CASE("osi_thread work queue throughput", "[bt_common]")
+{
+    run_producers(TEST_QUEUE_PER_PRODUCER, 2, 32, OSI_THREAD_MAX_TIMEOUT);
+}
+
+TEST_CASE("osi_thread producers blocked on a full work queue are woken up", "[bt_common]")
+{
+    /* The rings are full most of the time: each post goes through the slow
+     * path, a lost wake-up makes it time out and counts as an error.
+     */
+    run_producers(TEST_QUEUE_PER_PRODUCER, 2, 2, 1000);
+}
+
+TEST_CASE("osi_thread work queue shared by several producers loses, duplicates and reorders nothing", "[bt_common]")
+{
+    run_producers(TEST_QUEUE_SHARED, TEST_PRODUCER_MAX, 32, OSI_THREAD_MAX_TIMEOUT);
+    /* Producers race for the last free slots of a nearly always full ring */
+    run_producers(TEST_QUEUE_SHARED, TEST_PRODUCER_MAX, 4, 1000);
+}
+
+TEST_CASE("osi_thread work queue throughput against a locked FreeRTOS queue", "[bt_common]")
+{
+    int64_t ref, osi;
+
+    for (size_t queue_len = 4; queue_len <= 64; queue_len *= 4) {
+        ref = run_producers(TEST_QUEUE_LOCKED_REF, TEST_PRODUCER_MAX, queue_len, OSI_THREAD_MAX_TIMEOUT);
+        osi = run_producers(TEST_QUEUE_SHARED, TEST_PRODUCER_MAX, queue_len, OSI_THREAD_MAX_TIMEOUT);
+        printf("queue length %d: osi_thread (%s) %lld items/s, locked FreeRTOS queue %lld items/s, %lld%%\n",
+               (int)queue_len, OSI_THREAD_LOCKFREE_QUEUE ? "lock-free" : "locked", osi, ref, osi * 100 / ref);
+    }
+}
@@ -0,0 +1,17 @@
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: CC0-1.0
+
+import pytest
+from pytest_embedded import Dut
+
+
+@pytest.mark.esp32
+@pytest.mark.esp32c3
+@pytest.mark.esp32s3
+@pytest.mark.generic
+@pytest.mark.parametrize('config', [
+    'locked',
+    'lockfree',
+], indirect=True)
+def test_osi_thread(dut: Dut) -> None:
+    dut.run_all_single_board_cases(timeout=120)
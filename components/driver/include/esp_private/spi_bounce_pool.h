@@ -0,0 +1,111 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Internal header, don't use it in the user code
+
+/**
+ * @brief
+ * Pool of DMA-capable bounce buffers of an SPI master bus.
+ *
+ * When the buffer of a transaction can't be accessed by the DMA (external memory, or RX buffer not aligned to 4
+ * bytes), the data goes through a DMA-capable bounce buffer. The pool is a DMA-capable area allocated when the bus
+ * is initialized and cut into chunks of the same size; a bounce buffer is a run of consecutive free chunks, so a
+ * large transfer takes as many chunks as it needs. The chunks are claimed and given back lock-free, from tasks or
+ * from the ISR. When the pool is disabled, too small or exhausted, the bounce buffer is allocated from the heap.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Maximum number of chunks of a pool
+#define SPI_BOUNCE_POOL_MAX_CHUNKS  32
+
+typedef struct {
+    uint8_t *mem;                       ///< chunk_num * chunk_size bytes of DMA-capable memory, NULL if the pool is disabled
+    size_t chunk_size;                  ///< Size of a chunk, multiple of 4
+    uint32_t chunk_num;                 ///< Number of chunks
+    volatile uint32_t free_mask;        ///< Bit i is set when chunk i is free
+    uint8_t run_len[SPI_BOUNCE_POOL_MAX_CHUNKS];    ///< Number of chunks of the bounce buffer starting at each chunk
+
+    volatile uint32_t pool_hits;        ///< Bounce buffers taken from the pool
+    volatile uint32_t heap_allocs;      ///< Bounce buffers allocated from the heap
+    volatile uint32_t alloc_failures;   ///< Bounce buffers which could not be allocated at all
+    volatile uint32_t bounced_bytes;    ///< Bytes which went through a bounce buffer
+} spi_bounce_pool_t;
+
+/**
+ * @brief Allocate the memory of a pool
+ *
+ * @param pool       Pool to initialize
+ * @param chunk_size Size of a chunk, rounded up to a multiple of 4
+ * @param chunk_num  Number of chunks, 0 disables the pool: all the bounce buffers are then allocated from the heap
+ *
+ * @return
+ *      - ESP_OK: Pool initialized
+ *      - ESP_ERR_INVALID_ARG: chunk_num is above SPI_BOUNCE_POOL_MAX_CHUNKS, or chunk_size is 0 with chunks
+ *      - ESP_ERR_NO_MEM: Not enough DMA-capable memory
+ */
+esp_err_t spi_bounce_pool_init(spi_bounce_pool_t *pool, size_t chunk_size, uint32_t chunk_num);
+
+/**
+ * @brief Free the memory of a pool, no bounce buffer of the pool may be in use
+ */
+void spi_bounce_pool_deinit(spi_bounce_pool_t *pool);
+
+/**
+ * @brief Get the buffer the DMA sends a transaction from
+ *
+ * @param pool Pool of the bus
+ * @param buf  TX buffer of the transaction, or NULL
+ * @param len  Length of the data to send, in bytes
+ *
+ * @return buf if the DMA can read it, a bounce buffer holding a copy of the data otherwise, NULL if no bounce
+ *         buffer could be allocated. To be given back with spi_bounce_release().
+ */
+const void *spi_bounce_tx_setup(spi_bounce_pool_t *pool, const void *buf, size_t len);
+
+/**
+ * @brief Get the buffer the DMA receives a transaction into
+ *
+ * @param pool Pool of the bus
+ * @param buf  RX buffer of the transaction, or NULL
+ * @param len  Length of the data to receive, in bytes. The DMA writes whole words, a bounce buffer is rounded up to
+ *             a multiple of 4 bytes.
+ *
+ * @return buf if the DMA can write it, a bounce buffer otherwise, NULL if no bounce buffer could be allocated.
+ *         To be given back with spi_bounce_rx_finish().
+ */
+void *spi_bounce_rx_setup(spi_bounce_pool_t *pool, void *buf, size_t len);
+
+/**
+ * @brief Copy the received data to the RX buffer of the transaction and give back the bounce buffer, if any
+ *
+ * @param pool   Pool of the bus
+ * @param buf    RX buffer of the transaction
+ * @param bounce Buffer returned by spi_bounce_rx_setup()
+ * @param len    Length of the received data, in bytes
+ */
+void spi_bounce_rx_finish(spi_bounce_pool_t *pool, void *buf, void *bounce, size_t len);
+
+/**
+ * @brief Give back the bounce buffer of a TX buffer, if any
+ *
+ * @param pool   Pool of the bus
+ * @param buf    TX buffer of the transaction
+ * @param bounce Buffer returned by spi_bounce_tx_setup()
+ */
+void spi_bounce_release(spi_bounce_pool_t *pool, const void *buf, const void *bounce);
+
+#ifdef __cplusplus
+}
+#endif
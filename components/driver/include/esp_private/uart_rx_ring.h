@@ -0,0 +1,101 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Internal header, don't use it in the user code
+
+/**
+ * @brief
+ * RX byte ring of the UART zero-copy mode.
+ *
+ * The UART ISR reads the RX FIFO straight into the free space of the ring, and the reader borrows the received data
+ * in place, as contiguous spans. There is one producer (the ISR) and one consumer (the task holding the RX mutex of
+ * the port): each side only advances its own counter, so no lock is needed between them.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "hal/uart_hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint8_t *buf;                   ///< Storage of the ring
+    uint32_t size;                  ///< Size of the storage, in bytes
+    atomic_uint_fast32_t head;      ///< Write counter, modulo 2 * size, advanced by the producer only
+    atomic_uint_fast32_t tail;      ///< Read counter, modulo 2 * size, advanced by the consumer only
+} uart_rx_ring_t;
+
+/**
+ * @brief Initialize an empty ring on a storage buffer
+ */
+void uart_rx_ring_init(uart_rx_ring_t *ring, uint8_t *buf, uint32_t size);
+
+/**
+ * @brief Get the number of bytes waiting to be consumed
+ */
+uint32_t uart_rx_ring_data_len(uart_rx_ring_t *ring);
+
+/**
+ * @brief Get the contiguous free space following the written data, producer side
+ *
+ * @param ring Ring
+ * @param[out] span Start of the free space
+ *
+ * @return Size of the free space, the free space after a wrap is returned by the next call once this one is committed
+ */
+uint32_t uart_rx_ring_write_span(uart_rx_ring_t *ring, uint8_t **span);
+
+/**
+ * @brief Make bytes written to the span returned by uart_rx_ring_write_span() available to the consumer
+ */
+void uart_rx_ring_commit(uart_rx_ring_t *ring, uint32_t len);
+
+/**
+ * @brief Read the RX FIFO into the ring, producer side
+ *
+ * @param ring Ring
+ * @param hal  HAL context of the UART
+ * @param len  Number of bytes to read from the FIFO
+ *
+ * @return Number of bytes read, less than len when the ring is full: the other bytes stay in the FIFO
+ */
+int uart_rx_ring_fill_from_fifo(uart_rx_ring_t *ring, uart_hal_context_t *hal, int len);
+
+/**
+ * @brief Get the contiguous data following the consumed data, consumer side
+ *
+ * @param ring Ring
+ * @param[out] span Start of the data
+ *
+ * @return Size of the data, the data after a wrap is returned by the next call once this one is consumed
+ */
+uint32_t uart_rx_ring_read_span(uart_rx_ring_t *ring, const uint8_t **span);
+
+/**
+ * @brief Give the space of consumed bytes back to the producer
+ */
+void uart_rx_ring_consume(uart_rx_ring_t *ring, uint32_t len);
+
+/**
+ * @brief Find the last run of pat_num pat_chr in freshly written data, like uart_find_pattern_from_last()
+ *
+ * @param ring    Ring
+ * @param start   Value of the head counter before the data was written
+ * @param length  Index of the last byte to check, from start
+ * @param pat_chr Pattern character
+ * @param pat_num Number of pattern characters in a row
+ *
+ * @return Index from start of the first character of the pattern, negative if not found
+ */
+int uart_rx_ring_find_pattern_from_last(uart_rx_ring_t *ring, uint32_t start, int length, uint8_t pat_chr, uint8_t pat_num);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,156 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+#include "esp_private/spi_bounce_pool.h"
+
+// The bounce buffers are set up and given back by the same functions as the transactions
+#ifdef CONFIG_SPI_MASTER_ISR_IN_IRAM
+#define SPI_BOUNCE_ATTR IRAM_ATTR
+#else
+#define SPI_BOUNCE_ATTR
+#endif
+
+static SPI_BOUNCE_ATTR void counter_add(volatile uint32_t *counter, uint32_t value)
+{
+    uint32_t old;
+    do {
+        old = *counter;
+    } while (!esp_cpu_compare_and_set(counter, old, old + value));
+}
+
+esp_err_t spi_bounce_pool_init(spi_bounce_pool_t *pool, size_t chunk_size, uint32_t chunk_num)
+{
+    *pool = (spi_bounce_pool_t) {};
+    if (chunk_num == 0) {
+        return ESP_OK;
+    }
+    if (chunk_num > SPI_BOUNCE_POOL_MAX_CHUNKS || chunk_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pool->chunk_size = (chunk_size + 3) & ~3;
+    pool->mem = heap_caps_malloc(pool->chunk_size * chunk_num, MALLOC_CAP_DMA);
+    if (pool->mem == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    pool->chunk_num = chunk_num;
+    pool->free_mask = (chunk_num == 32) ? UINT32_MAX : ((1U << chunk_num) - 1);
+    return ESP_OK;
+}
+
+void spi_bounce_pool_deinit(spi_bounce_pool_t *pool)
+{
+    free(pool->mem);
+    *pool = (spi_bounce_pool_t) {};
+}
+
+static SPI_BOUNCE_ATTR void *pool_alloc(spi_bounce_pool_t *pool, size_t len)
+{
+    if (pool->mem == NULL || len > pool->chunk_size * pool->chunk_num) {
+        return NULL;
+    }
+    const uint32_t run = (len + pool->chunk_size - 1) / pool->chunk_size;
+    const uint32_t run_mask = (run == 32) ? UINT32_MAX : ((1U << run) - 1);
+
+    while (true) {
+        const uint32_t free_mask = pool->free_mask;
+        uint32_t first = 0;
+        while (first + run <= pool->chunk_num && ((free_mask >> first) & run_mask) != run_mask) {
+            first++;
+        }
+        if (first + run > pool->chunk_num) {
+            return NULL;
+        }
+        // Fails if a chunk was claimed or given back meanwhile, then search again
+        if (esp_cpu_compare_and_set(&pool->free_mask, free_mask, free_mask & ~(run_mask << first))) {
+            pool->run_len[first] = run;
+            return pool->mem + first * pool->chunk_size;
+        }
+    }
+}
+
+static SPI_BOUNCE_ATTR bool pool_free(spi_bounce_pool_t *pool, const void *buf)
+{
+    const uint8_t *p = buf;
+    if (pool->mem == NULL || p < pool->mem || p >= pool->mem + pool->chunk_size * pool->chunk_num) {
+        return false;
+    }
+    const uint32_t first = (p - pool->mem) / pool->chunk_size;
+    const uint32_t run = pool->run_len[first];
+    const uint32_t run_mask = ((run == 32) ? UINT32_MAX : ((1U << run) - 1)) << first;
+
+    uint32_t free_mask;
+    do {
+        free_mask = pool->free_mask;
+    } while (!esp_cpu_compare_and_set(&pool->free_mask, free_mask, free_mask | run_mask));
+    return true;
+}
+
+static SPI_BOUNCE_ATTR void *bounce_alloc(spi_bounce_pool_t *pool, size_t len)
+{
+    void *bounce = pool_alloc(pool, len);
+    if (bounce != NULL) {
+        counter_add(&pool->pool_hits, 1);
+    } else {
+        bounce = heap_caps_malloc(len, MALLOC_CAP_DMA);
+        counter_add(bounce != NULL ? &pool->heap_allocs : &pool->alloc_failures, 1);
+    }
+    if (bounce != NULL) {
+        counter_add(&pool->bounced_bytes, len);
+    }
+    return bounce;
+}
+
+static SPI_BOUNCE_ATTR void bounce_free(spi_bounce_pool_t *pool, const void *bounce)
+{
+    if (!pool_free(pool, bounce)) {
+        free((void *)bounce); //force free, ignore const
+    }
+}
+
+const void *SPI_BOUNCE_ATTR spi_bounce_tx_setup(spi_bounce_pool_t *pool, const void *buf, size_t len)
+{
+    if (buf == NULL || esp_ptr_dma_capable(buf)) {
+        return buf;
+    }
+    void *bounce = bounce_alloc(pool, len);
+    if (bounce != NULL) {
+        memcpy(bounce, buf, len);
+    }
+    return bounce;
+}
+
+void *SPI_BOUNCE_ATTR spi_bounce_rx_setup(spi_bounce_pool_t *pool, void *buf, size_t len)
+{
+    if (buf == NULL || (esp_ptr_dma_capable(buf) && (uintptr_t)buf % 4 == 0)) {
+        return buf;
+    }
+    // The rx buffer need to be length of multiples of 32 bits to avoid heap corruption.
+    return bounce_alloc(pool, (len + 3) & ~3);
+}
+
+void SPI_BOUNCE_ATTR spi_bounce_rx_finish(spi_bounce_pool_t *pool, void *buf, void *bounce, size_t len)
+{
+    if (bounce != NULL && bounce != buf) {
+        memcpy(buf, bounce, len);
+        bounce_free(pool, bounce);
+    }
+}
+
+void SPI_BOUNCE_ATTR spi_bounce_release(spi_bounce_pool_t *pool, const void *buf, const void *bounce)
+{
+    if (bounce != NULL && bounce != buf) {
+        bounce_free(pool, bounce);
+    }
+}
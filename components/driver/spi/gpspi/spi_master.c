@@ -113,6 +113,7 @@ We have two bits to control the interrupt:
 #include <string.h>
 #include <sys/param.h>
 #include "esp_private/spi_common_internal.h"
+#include "esp_private/spi_bounce_pool.h"
 #include "driver/spi_master.h"
 #include "esp_clk_tree.h"
 #include "clk_ctrl_os.h"
@@ -126,8 +127,10 @@ We have two bits to control the interrupt:
 #include "hal/spi_hal.h"
 #include "hal/spi_ll.h"
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
 
 typedef struct spi_device_t spi_device_t;
+typedef struct spi_batch_priv_t spi_batch_priv_t;
 
 /// struct to hold private transaction data (like tx and rx buffer for DMA).
 typedef struct {
@@ -135,8 +138,17 @@ typedef struct {
     const uint32_t *buffer_to_send;   //equals to tx_data, if SPI_TRANS_USE_RXDATA is applied; otherwise if original buffer wasn't in DMA-capable memory, this gets the address of a temporary buffer that is;
                                 //otherwise sets to the original buffer or NULL if no buffer is assigned.
     uint32_t *buffer_to_rcv;    // similar to buffer_to_send
+    spi_batch_priv_t *batch;    // batch the transaction belongs to, NULL if it was queued alone
 } spi_trans_priv_t;
 
+/// Transactions queued together by `spi_device_queue_trans_batch`. Only the first one goes through the queues, the
+/// ISR starts the next ones as soon as the previous one is done, and only the last one is returned.
+struct spi_batch_priv_t {
+    uint32_t trans_num;
+    uint32_t cur;               // index of the transaction in flight, only used by the ISR
+    spi_trans_priv_t trans_bufs[];
+};
+
 typedef struct {
     int id;
     spi_device_t* device[DEV_NUM_MAX];
@@ -145,6 +157,7 @@ typedef struct {
     spi_trans_priv_t cur_trans_buf;
     int cur_cs;     //current device doing transaction
     const spi_bus_attr_t* bus_attr;
+    spi_bounce_pool_t bounce_pool;  //DMA-capable bounce buffers for the transactions of all the devices
 
     /**
      * the bus is permanently controlled by a device until `spi_bus_release_bus`` is called. Otherwise
@@ -165,6 +178,11 @@ struct spi_device_t {
     spi_hal_dev_config_t hal_dev;
     spi_host_t *host;
     spi_bus_lock_dev_handle_t dev_lock;
+
+    //statistics, updated when a transaction is done
+    uint32_t trans_count;
+    uint32_t batch_count;
+    int64_t stats_since_us;
 };
 
 static spi_host_t* bus_driver_ctx[SOC_SPI_PERIPH_NUM] = {};
@@ -229,6 +247,13 @@ static esp_err_t spi_master_init_driver(spi_host_device_t host_id)
         .bus_attr = bus_attr,
     };
 
+    if (bus_attr->dma_enabled) {
+        err = spi_bounce_pool_init(&host->bounce_pool, bus_attr->bus_cfg.bounce_buf_sz, bus_attr->bus_cfg.bounce_buf_num);
+        if (err != ESP_OK) {
+            goto cleanup;
+        }
+    }
+
     // interrupts are not allowed on SPI1 bus
     if (host_id != SPI1_HOST) {
 #if (SOC_CPU_CORES_NUM > 1) && (!CONFIG_FREERTOS_UNICORE)
@@ -279,6 +304,7 @@ cleanup:
         if (host->intr) {
             esp_intr_free(host->intr);
         }
+        spi_bounce_pool_deinit(&host->bounce_pool);
     }
     free(host);
     return err;
@@ -302,6 +328,7 @@ static esp_err_t spi_master_deinit_driver(void* arg)
     if (host->intr) {
         esp_intr_free(host->intr);
     }
+    spi_bounce_pool_deinit(&host->bounce_pool);
     free(host);
     bus_driver_ctx[host_id] = NULL;
     return ESP_OK;
@@ -421,6 +448,7 @@ esp_err_t spi_bus_add_device(spi_host_device_t host_id, const spi_device_interfa
 
     dev->id = freecs;
     dev->dev_lock = dev_handle;
+    dev->stats_since_us = esp_timer_get_time();
 
     //Allocate queues, set defaults
     dev->trans_queue = xQueueCreate(dev_config->queue_size, sizeof(spi_trans_priv_t));
@@ -652,6 +680,7 @@ static void SPI_MASTER_ISR_ATTR spi_post_trans(spi_host_t *host)
     //Call post-transaction callback, if any
     spi_device_t* dev = host->device[host->cur_cs];
     if (dev->cfg.post_cb) dev->cfg.post_cb(cur_trans);
+    dev->trans_count++;
 
     host->cur_cs = DEV_NUM_MAX;
 }
@@ -678,6 +707,28 @@ static void SPI_MASTER_ISR_ATTR spi_intr(void *arg)
         assert(host->cur_cs != DEV_NUM_MAX);
         //Okay, transaction is done.
         const int cs = host->cur_cs;
+        spi_trans_priv_t *const cur_trans_buf = &host->cur_trans_buf;
+        spi_batch_priv_t *const batch = cur_trans_buf->batch;
+
+        if (batch && batch->cur + 1 < batch->trans_num) {
+            //Start the next transaction of the batch right away, without going through the queues and the bus lock.
+            //The DMA channel stays active.
+            spi_device_t *dev = host->device[cs];
+            spi_post_trans(host);
+            batch->cur++;
+            *cur_trans_buf = batch->trans_bufs[batch->cur];
+#if CONFIG_IDF_TARGET_ESP32
+            if (bus_attr->dma_enabled && (cur_trans_buf->buffer_to_rcv || cur_trans_buf->buffer_to_send)) {
+                //This workaround is only for esp32, where tx_dma_chan and rx_dma_chan are always same
+                spicommon_dmaworkaround_transfer_active(bus_attr->tx_dma_chan);
+            }
+#endif  //#if CONFIG_IDF_TARGET_ESP32
+            spi_new_trans(dev, cur_trans_buf);
+            spi_bus_lock_bg_exit(bus_attr->lock, true, &do_yield);
+            if (do_yield) portYIELD_FROM_ISR();
+            return;
+        }
+
         //Tell common code DMA workaround that our DMA channel is idle. If needed, the code will do a DMA reset.
 
 #if CONFIG_IDF_TARGET_ESP32
@@ -689,6 +740,9 @@ static void SPI_MASTER_ISR_ATTR spi_intr(void *arg)
 
         //cur_cs is changed to DEV_NUM_MAX here
         spi_post_trans(host);
+        if (batch) {
+            host->device[cs]->batch_count++;
+        }
 
         if (!(host->device[cs]->cfg.flags & SPI_DEVICE_NO_RETURN_RESULT)) {
             //Return transaction descriptor.
@@ -816,27 +870,18 @@ static SPI_MASTER_ISR_ATTR esp_err_t check_trans_valid(spi_device_handle_t handl
     return ESP_OK;
 }
 
-static SPI_MASTER_ISR_ATTR void uninstall_priv_desc(spi_trans_priv_t* trans_buf)
+static SPI_MASTER_ISR_ATTR void uninstall_priv_desc(spi_host_t *host, spi_trans_priv_t* trans_buf)
 {
     spi_transaction_t *trans_desc = trans_buf->trans;
-    if ((void *)trans_buf->buffer_to_send != &trans_desc->tx_data[0] &&
-        trans_buf->buffer_to_send != trans_desc->tx_buffer) {
-        free((void *)trans_buf->buffer_to_send); //force free, ignore const
-    }
-    // copy data from temporary DMA-capable buffer back to IRAM buffer and free the temporary one.
-    if (trans_buf->buffer_to_rcv &&
-        (void *)trans_buf->buffer_to_rcv != &trans_desc->rx_data[0] &&
-        trans_buf->buffer_to_rcv != trans_desc->rx_buffer) { // NOLINT(clang-analyzer-unix.Malloc)
-        if (trans_desc->flags & SPI_TRANS_USE_RXDATA) {
-            memcpy((uint8_t *) & trans_desc->rx_data[0], trans_buf->buffer_to_rcv, (trans_desc->rxlength + 7) / 8);
-        } else {
-            memcpy(trans_desc->rx_buffer, trans_buf->buffer_to_rcv, (trans_desc->rxlength + 7) / 8);
-        }
-        free(trans_buf->buffer_to_rcv);
-    }
+    const void *send_ptr = (trans_desc->flags & SPI_TRANS_USE_TXDATA) ? &trans_desc->tx_data[0] : trans_desc->tx_buffer;
+    void *rcv_ptr = (trans_desc->flags & SPI_TRANS_USE_RXDATA) ? &trans_desc->rx_data[0] : trans_desc->rx_buffer;
+
+    spi_bounce_release(&host->bounce_pool, send_ptr, trans_buf->buffer_to_send);
+    // copy data from temporary DMA-capable buffer back to IRAM buffer and give the temporary one back.
+    spi_bounce_rx_finish(&host->bounce_pool, rcv_ptr, trans_buf->buffer_to_rcv, (trans_desc->rxlength + 7) / 8);
 }
 
-static SPI_MASTER_ISR_ATTR esp_err_t setup_priv_desc(spi_transaction_t *trans_desc, spi_trans_priv_t* new_desc, bool isdma)
+static SPI_MASTER_ISR_ATTR esp_err_t setup_priv_desc(spi_host_t *host, spi_transaction_t *trans_desc, spi_trans_priv_t* new_desc)
 {
     *new_desc = (spi_trans_priv_t) { .trans = trans_desc, };
 
@@ -848,11 +893,11 @@ static SPI_MASTER_ISR_ATTR esp_err_t setup_priv_desc(spi_transaction_t *trans_de
         //if not use RXDATA neither rx_buffer, buffer_to_rcv assigned to NULL
         rcv_ptr = trans_desc->rx_buffer;
     }
-    if (rcv_ptr && isdma && (!esp_ptr_dma_capable(rcv_ptr) || ((int)rcv_ptr % 4 != 0))) {
-        //if rxbuf in the desc not DMA-capable, malloc a new one. The rx buffer need to be length of multiples of 32 bits to avoid heap corruption.
-        ESP_LOGD(SPI_TAG, "Allocate RX buffer for DMA" );
-        rcv_ptr = heap_caps_malloc(((trans_desc->rxlength + 31) / 32) * 4, MALLOC_CAP_DMA);
-        if (rcv_ptr == NULL) goto clean_up;
+    if (rcv_ptr && host->bus_attr->dma_enabled) {
+        //if rxbuf in the desc not DMA-capable, use a bounce buffer from the pool of the bus, or from the heap.
+        uint32_t *bounce = spi_bounce_rx_setup(&host->bounce_pool, rcv_ptr, (trans_desc->rxlength + 7) / 8);
+        if (bounce == NULL) goto clean_up;
+        rcv_ptr = bounce;
     }
     new_desc->buffer_to_rcv = rcv_ptr;
 
@@ -864,21 +909,18 @@ static SPI_MASTER_ISR_ATTR esp_err_t setup_priv_desc(spi_transaction_t *trans_de
         //if not use TXDATA neither tx_buffer, tx data assigned to NULL
         send_ptr = trans_desc->tx_buffer ;
     }
-    if (send_ptr && isdma && !esp_ptr_dma_capable( send_ptr )) {
-        //if txbuf in the desc not DMA-capable, malloc a new one
-        ESP_LOGD(SPI_TAG, "Allocate TX buffer for DMA" );
-        uint32_t *temp = heap_caps_malloc((trans_desc->length + 7) / 8, MALLOC_CAP_DMA);
-        if (temp == NULL) goto clean_up;
-
-        memcpy( temp, send_ptr, (trans_desc->length + 7) / 8 );
-        send_ptr = temp;
+    if (send_ptr && host->bus_attr->dma_enabled) {
+        //if txbuf in the desc not DMA-capable, copy it to a bounce buffer
+        const uint32_t *bounce = spi_bounce_tx_setup(&host->bounce_pool, send_ptr, (trans_desc->length + 7) / 8);
+        if (bounce == NULL) goto clean_up;
+        send_ptr = bounce;
     }
     new_desc->buffer_to_send = send_ptr;
 
     return ESP_OK;
 
 clean_up:
-    uninstall_priv_desc(new_desc);
+    uninstall_priv_desc(host, new_desc);
     return ESP_ERR_NO_MEM;
 }
 
@@ -898,7 +940,7 @@ esp_err_t SPI_MASTER_ATTR spi_device_queue_trans(spi_device_handle_t handle, spi
     }
 
     spi_trans_priv_t trans_buf;
-    ret = setup_priv_desc(trans_desc, &trans_buf, (host->bus_attr->dma_enabled));
+    ret = setup_priv_desc(host, trans_desc, &trans_buf);
     if (ret != ESP_OK) return ret;
 
 #ifdef CONFIG_PM_ENABLE
@@ -926,7 +968,7 @@ esp_err_t SPI_MASTER_ATTR spi_device_queue_trans(spi_device_handle_t handle, spi
     return ESP_OK;
 
 clean_up:
-    uninstall_priv_desc(&trans_buf);
+    uninstall_priv_desc(host, &trans_buf);
     return ret;
 }
 
@@ -948,8 +990,17 @@ esp_err_t SPI_MASTER_ATTR spi_device_get_trans_result(spi_device_handle_t handle
         return ESP_ERR_TIMEOUT;
     }
     //release temporary buffers
-    uninstall_priv_desc(&trans_buf);
-    (*trans_desc) = trans_buf.trans;
+    if (trans_buf.batch) {
+        spi_batch_priv_t *batch = trans_buf.batch;
+        for (uint32_t i = 0; i < batch->trans_num; i++) {
+            uninstall_priv_desc(handle->host, &batch->trans_bufs[i]);
+        }
+        (*trans_desc) = batch->trans_bufs[0].trans;
+        free(batch);
+    } else {
+        uninstall_priv_desc(handle->host, &trans_buf);
+        (*trans_desc) = trans_buf.trans;
+    }
 
     return ESP_OK;
 }
@@ -970,6 +1021,80 @@ esp_err_t SPI_MASTER_ATTR spi_device_transmit(spi_device_handle_t handle, spi_tr
     return ESP_OK;
 }
 
+esp_err_t SPI_MASTER_ATTR spi_device_queue_trans_batch(spi_device_handle_t handle, spi_transaction_t *trans_desc[], size_t trans_num, TickType_t ticks_to_wait)
+{
+    SPI_CHECK(handle!=NULL, "invalid dev handle", ESP_ERR_INVALID_ARG);
+    SPI_CHECK(trans_desc!=NULL && trans_num!=0, "invalid transactions", ESP_ERR_INVALID_ARG);
+    //the batch is freed when its result is returned
+    SPI_CHECK(!(handle->cfg.flags & SPI_DEVICE_NO_RETURN_RESULT), "API not Supported!", ESP_ERR_NOT_SUPPORTED);
+
+    spi_host_t *host = handle->host;
+    SPI_CHECK(!spi_bus_device_is_polling(handle), "Cannot queue new transaction while previous polling transaction is not terminated.", ESP_ERR_INVALID_STATE );
+
+    esp_err_t ret;
+    for (size_t i = 0; i < trans_num; i++) {
+        ret = check_trans_valid(handle, trans_desc[i]);
+        if (ret != ESP_OK) return ret;
+        if (host->device_acquiring_lock != handle && (trans_desc[i]->flags & SPI_TRANS_CS_KEEP_ACTIVE)) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    spi_batch_priv_t *batch = heap_caps_malloc(sizeof(spi_batch_priv_t) + trans_num * sizeof(spi_trans_priv_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (batch == NULL) return ESP_ERR_NO_MEM;
+    batch->trans_num = trans_num;
+    batch->cur = 0;
+
+    size_t ready;
+    for (ready = 0; ready < trans_num; ready++) {
+        ret = setup_priv_desc(host, trans_desc[ready], &batch->trans_bufs[ready]);
+        if (ret != ESP_OK) goto clean_up;
+        batch->trans_bufs[ready].batch = batch;
+    }
+
+#ifdef CONFIG_PM_ENABLE
+    esp_pm_lock_acquire(host->bus_attr->pm_lock);
+#endif
+    //The whole batch takes one item of the queue
+    BaseType_t r = xQueueSend(handle->trans_queue, (void *)&batch->trans_bufs[0], ticks_to_wait);
+    if (!r) {
+        ret = ESP_ERR_TIMEOUT;
+#ifdef CONFIG_PM_ENABLE
+        //Release APB frequency lock
+        esp_pm_lock_release(host->bus_attr->pm_lock);
+#endif
+        goto clean_up;
+    }
+
+    ret = spi_bus_lock_bg_request(handle->dev_lock);
+    if (ret != ESP_OK) {
+        goto clean_up;
+    }
+    return ESP_OK;
+
+clean_up:
+    for (size_t i = 0; i < ready; i++) {
+        uninstall_priv_desc(host, &batch->trans_bufs[i]);
+    }
+    free(batch);
+    return ret;
+}
+
+esp_err_t SPI_MASTER_ATTR spi_device_transmit_batch(spi_device_handle_t handle, spi_transaction_t *trans_desc[], size_t trans_num)
+{
+    esp_err_t ret;
+    spi_transaction_t *ret_trans;
+
+    ret = spi_device_queue_trans_batch(handle, trans_desc, trans_num, portMAX_DELAY);
+    if (ret != ESP_OK) return ret;
+
+    ret = spi_device_get_trans_result(handle, &ret_trans, portMAX_DELAY);
+    if (ret != ESP_OK) return ret;
+
+    assert(ret_trans == trans_desc[0]);
+    return ESP_OK;
+}
+
 esp_err_t SPI_MASTER_ISR_ATTR spi_device_acquire_bus(spi_device_t *device, TickType_t wait)
 {
     spi_host_t *const host = device->host;
@@ -1058,7 +1183,7 @@ esp_err_t SPI_MASTER_ISR_ATTR spi_device_polling_start(spi_device_handle_t handl
     }
     if (ret != ESP_OK) return ret;
 
-    ret = setup_priv_desc(trans_desc, &host->cur_trans_buf, (host->bus_attr->dma_enabled));
+    ret = setup_priv_desc(host, trans_desc, &host->cur_trans_buf);
     if (ret!=ESP_OK) return ret;
 
     //Polling, no interrupt is used.
@@ -1090,7 +1215,7 @@ esp_err_t SPI_MASTER_ISR_ATTR spi_device_polling_end(spi_device_handle_t handle,
     //deal with the in-flight transaction
     spi_post_trans(host);
     //release temporary buffers
-    uninstall_priv_desc(&host->cur_trans_buf);
+    uninstall_priv_desc(host, &host->cur_trans_buf);
 
     host->polling = false;
     /* Once again here, if device_acquiring_lock is set to `handle`, it means that the user has already
@@ -1129,3 +1254,42 @@ esp_err_t spi_bus_get_max_transaction_len(spi_host_device_t host_id, size_t *max
 
     return ESP_OK;
 }
+
+esp_err_t spi_bus_get_bounce_stats(spi_host_device_t host_id, spi_bus_bounce_stats_t *stats)
+{
+    SPI_CHECK(is_valid_host(host_id), "invalid host", ESP_ERR_INVALID_ARG);
+    if (bus_driver_ctx[host_id] == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const spi_bounce_pool_t *pool = &bus_driver_ctx[host_id]->bounce_pool;
+    *stats = (spi_bus_bounce_stats_t) {
+        .pool_hits = pool->pool_hits,
+        .heap_allocs = pool->heap_allocs,
+        .alloc_failures = pool->alloc_failures,
+        .bounced_bytes = pool->bounced_bytes,
+    };
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_stats(spi_device_handle_t handle, spi_device_stats_t *stats)
+{
+    SPI_CHECK(handle!=NULL && stats!=NULL, "invalid argument", ESP_ERR_INVALID_ARG);
+
+    *stats = (spi_device_stats_t) {
+        .trans_count = handle->trans_count,
+        .batch_count = handle->batch_count,
+        .elapsed_us = esp_timer_get_time() - handle->stats_since_us,
+    };
+    return ESP_OK;
+}
+
+esp_err_t spi_device_reset_stats(spi_device_handle_t handle)
+{
+    SPI_CHECK(handle!=NULL, "invalid dev handle", ESP_ERR_INVALID_ARG);
+
+    handle->trans_count = 0;
+    handle->batch_count = 0;
+    handle->stats_since_us = esp_timer_get_time();
+    return ESP_OK;
+}
@@ -123,6 +123,11 @@ typedef struct {
                            *  by the driver. Note that if ESP_INTR_FLAG_IRAM is set, ALL the callbacks of
                            *  the driver, and their callee functions, should be put in the IRAM.
                            */
+    int bounce_buf_sz;    /**< Size in bytes of the chunks of the DMA bounce buffer pool of the master driver, rounded up
+                           *  to a multiple of 4. Transactions whose buffers are not DMA-capable (e.g. in PSRAM) are
+                           *  copied through runs of consecutive free chunks instead of a buffer allocated per transaction.
+                           */
+    int bounce_buf_num;   ///< Number of chunks of the DMA bounce buffer pool, up to 32. 0 disables the pool.
 } spi_bus_config_t;
 
 
@@ -257,6 +257,50 @@ esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transactio
  */
 esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t *trans_desc);
 
+/**
+ * @brief Queue a batch of SPI transactions for interrupt transaction execution. Get the result by ``spi_device_get_trans_result``.
+ *
+ * The transactions of the batch take a single item of the transaction queue. The ISR starts each transaction as soon
+ * as the previous one is done, without going through the queues nor letting other devices use the bus in between,
+ * which saves most of the overhead of queueing many small transactions (e.g. LCD command and data pairs). The
+ * ``pre_cb`` and ``post_cb`` callbacks are still called for each transaction.
+ *
+ * The batch completes as a whole: ``spi_device_get_trans_result`` returns ``trans_desc[0]`` once all the transactions
+ * are done. The array itself needs not be kept until then, but the transactions do.
+ *
+ * @param handle Device handle obtained using spi_host_add_dev
+ * @param trans_desc Descriptions of the transactions to execute, in order
+ * @param trans_num Number of transactions
+ * @param ticks_to_wait Ticks to wait until there's room in the queue; use portMAX_DELAY to
+ *                      never time out.
+ * @return
+ *         - ESP_ERR_INVALID_ARG   if parameter is invalid, or any transaction is invalid
+ *         - ESP_ERR_NOT_SUPPORTED if flag `SPI_DEVICE_NO_RETURN_RESULT` is set
+ *         - ESP_ERR_TIMEOUT       if there was no room in the queue before ticks_to_wait expired
+ *         - ESP_ERR_NO_MEM        if allocating the batch or a DMA-capable temporary buffer failed
+ *         - ESP_ERR_INVALID_STATE if previous transactions are not finished
+ *         - ESP_OK                on success
+ */
+esp_err_t spi_device_queue_trans_batch(spi_device_handle_t handle, spi_transaction_t *trans_desc[], size_t trans_num, TickType_t ticks_to_wait);
+
+
+/**
+ * @brief Send a batch of SPI transactions and wait for all of them to complete
+ *
+ * This function is the equivalent of calling spi_device_queue_trans_batch() followed by spi_device_get_trans_result(),
+ * with the same restrictions as spi_device_transmit().
+ *
+ * @param handle Device handle obtained using spi_host_add_dev
+ * @param trans_desc Descriptions of the transactions to execute, in order
+ * @param trans_num Number of transactions
+ * @return
+ *         - ESP_ERR_INVALID_ARG   if parameter is invalid
+ *         - ESP_ERR_NOT_SUPPORTED if flag `SPI_DEVICE_NO_RETURN_RESULT` is set
+ *         - ESP_ERR_NO_MEM        if allocating the batch or a DMA-capable temporary buffer failed
+ *         - ESP_OK                on success
+ */
+esp_err_t spi_device_transmit_batch(spi_device_handle_t handle, spi_transaction_t *trans_desc[], size_t trans_num);
+
 
 /**
  * @brief Immediately start a polling transaction.
@@ -403,6 +447,64 @@ int spi_get_freq_limit(bool gpio_is_used, int input_delay_ns);
  */
 esp_err_t spi_bus_get_max_transaction_len(spi_host_device_t host_id, size_t *max_bytes);
 
+/**
+ * @brief Statistics of the DMA bounce buffers of a bus
+ */
+typedef struct {
+    uint32_t pool_hits;         ///< Bounce buffers taken from the pool, see ``spi_bus_config_t::bounce_buf_num``
+    uint32_t heap_allocs;       ///< Bounce buffers allocated from the heap, the pool being disabled, too small or exhausted
+    uint32_t alloc_failures;    ///< Transactions failed with ESP_ERR_NO_MEM because no bounce buffer could be allocated
+    uint32_t bounced_bytes;     ///< Bytes copied through the bounce buffers, wraps around
+} spi_bus_bounce_stats_t;
+
+/**
+ * @brief Get the statistics of the DMA bounce buffers of a bus
+ *
+ * A bounce buffer is used when the buffer of a transaction is not DMA-capable, or is an RX buffer not aligned to 4 bytes.
+ *
+ * @param       host_id  SPI peripheral
+ * @param[out]  stats    Statistics
+ *
+ * @return
+ *        - ESP_OK:               On success
+ *        - ESP_ERR_INVALID_ARG:  Invalid argument
+ */
+esp_err_t spi_bus_get_bounce_stats(spi_host_device_t host_id, spi_bus_bounce_stats_t *stats);
+
+/**
+ * @brief Transaction statistics of a device
+ *
+ * The transaction rate is ``trans_count * 1000000 / elapsed_us`` transactions per second.
+ */
+typedef struct {
+    uint32_t trans_count;       ///< Transactions done, queued, batched or polling
+    uint32_t batch_count;       ///< Batches done, see ``spi_device_queue_trans_batch``
+    uint64_t elapsed_us;        ///< Time since the device was added or its statistics were reset, in microseconds
+} spi_device_stats_t;
+
+/**
+ * @brief Get the transaction statistics of a device
+ *
+ * @param       handle  Device handle obtained using spi_host_add_dev
+ * @param[out]  stats   Statistics
+ *
+ * @return
+ *        - ESP_OK:               On success
+ *        - ESP_ERR_INVALID_ARG:  Invalid argument
+ */
+esp_err_t spi_device_get_stats(spi_device_handle_t handle, spi_device_stats_t *stats);
+
+/**
+ * @brief Reset the transaction statistics of a device
+ *
+ * @param handle Device handle obtained using spi_host_add_dev
+ *
+ * @return
+ *        - ESP_OK:               On success
+ *        - ESP_ERR_INVALID_ARG:  Invalid argument
+ */
+esp_err_t spi_device_reset_stats(spi_device_handle_t handle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,15 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_DMA  (1 << 3)
+
+/* Mocked in main.c: the returned memory is DMA-capable, allocations can be made to fail */
+void *heap_caps_malloc(size_t size, uint32_t caps);
@@ -0,0 +1,12 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+/* Mocked in main.c: only the memory returned by heap_caps_malloc() and the internal RAM of the test is DMA-capable */
+bool esp_ptr_dma_capable(const void *p);
@@ -0,0 +1,269 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Host test of the DMA bounce buffers of the SPI master driver. The heap and the memory layout of the chip are
+ * mocked: the memory returned by heap_caps_malloc() and s_internal_ram are DMA-capable, s_psram is not.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include <pthread.h>
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+#include "esp_private/spi_bounce_pool.h"
+
+#define MAX_HEAP_BLOCKS 64
+#define THREADS         4
+#define ITERATIONS      200000
+
+static uint8_t s_internal_ram[1024] __attribute__((aligned(4)));
+static uint8_t s_psram[1024] __attribute__((aligned(4)));
+
+static pthread_mutex_t s_heap_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct {
+    const uint8_t *ptr;
+    size_t size;
+} s_heap_blocks[MAX_HEAP_BLOCKS];
+static int s_heap_live;
+static bool s_heap_fail;
+
+void __real_free(void *ptr);
+
+void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    assert(caps == MALLOC_CAP_DMA);
+    if (s_heap_fail) {
+        return NULL;
+    }
+    void *ptr = malloc(size);
+    pthread_mutex_lock(&s_heap_lock);
+    for (int i = 0; i < MAX_HEAP_BLOCKS; i++) {
+        if (s_heap_blocks[i].ptr == NULL) {
+            s_heap_blocks[i].ptr = ptr;
+            s_heap_blocks[i].size = size;
+            s_heap_live++;
+            pthread_mutex_unlock(&s_heap_lock);
+            return ptr;
+        }
+    }
+    assert(false && "too many heap blocks");
+    return NULL;
+}
+
+void __wrap_free(void *ptr)
+{
+    pthread_mutex_lock(&s_heap_lock);
+    for (int i = 0; ptr != NULL && i < MAX_HEAP_BLOCKS; i++) {
+        if (s_heap_blocks[i].ptr == ptr) {
+            s_heap_blocks[i].ptr = NULL;
+            s_heap_live--;
+        }
+    }
+    pthread_mutex_unlock(&s_heap_lock);
+    __real_free(ptr);
+}
+
+bool esp_ptr_dma_capable(const void *p)
+{
+    const uint8_t *ptr = p;
+    bool capable = ptr >= s_internal_ram && ptr < s_internal_ram + sizeof(s_internal_ram);
+
+    pthread_mutex_lock(&s_heap_lock);
+    for (int i = 0; !capable && i < MAX_HEAP_BLOCKS; i++) {
+        capable = s_heap_blocks[i].ptr != NULL && ptr >= s_heap_blocks[i].ptr &&
+                  ptr < s_heap_blocks[i].ptr + s_heap_blocks[i].size;
+    }
+    pthread_mutex_unlock(&s_heap_lock);
+    return capable;
+}
+
+static bool in_pool(const spi_bounce_pool_t *pool, const void *p)
+{
+    const uint8_t *ptr = p;
+    return ptr >= pool->mem && ptr < pool->mem + pool->chunk_size * pool->chunk_num;
+}
+
+static void fill(uint8_t *buf, size_t len, uint8_t seed)
+{
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)(seed + i * 7);
+    }
+}
+
+static void check_init(void)
+{
+    spi_bounce_pool_t pool;
+
+    assert(spi_bounce_pool_init(&pool, 64, SPI_BOUNCE_POOL_MAX_CHUNKS + 1) == ESP_ERR_INVALID_ARG);
+    assert(spi_bounce_pool_init(&pool, 0, 4) == ESP_ERR_INVALID_ARG);
+
+    s_heap_fail = true;
+    assert(spi_bounce_pool_init(&pool, 64, 4) == ESP_ERR_NO_MEM);
+    s_heap_fail = false;
+
+    assert(spi_bounce_pool_init(&pool, 61, 4) == ESP_OK);
+    assert(pool.chunk_size == 64 && pool.chunk_num == 4 && pool.free_mask == 0xf);
+    spi_bounce_pool_deinit(&pool);
+
+    assert(spi_bounce_pool_init(&pool, 4, SPI_BOUNCE_POOL_MAX_CHUNKS) == ESP_OK);
+    assert(pool.free_mask == UINT32_MAX);
+    spi_bounce_pool_deinit(&pool);
+    assert(s_heap_live == 0);
+}
+
+static void check_no_pool(void)
+{
+    spi_bounce_pool_t pool;
+    assert(spi_bounce_pool_init(&pool, 0, 0) == ESP_OK);
+
+    /* DMA-capable buffers are used as they are */
+    assert(spi_bounce_tx_setup(&pool, NULL, 16) == NULL);
+    assert(spi_bounce_tx_setup(&pool, s_internal_ram + 1, 16) == s_internal_ram + 1);
+    assert(spi_bounce_rx_setup(&pool, s_internal_ram, 16) == s_internal_ram);
+    assert(pool.heap_allocs == 0 && pool.pool_hits == 0);
+
+    /* TX from external memory: copied to the heap */
+    fill(s_psram, 100, 1);
+    const void *tx = spi_bounce_tx_setup(&pool, s_psram, 100);
+    assert(tx != NULL && tx != s_psram && esp_ptr_dma_capable(tx));
+    assert(memcmp(tx, s_psram, 100) == 0);
+
+    /* RX to unaligned internal memory: received in the heap, then copied */
+    void *rx = spi_bounce_rx_setup(&pool, s_internal_ram + 2, 10);
+    assert(rx != NULL && rx != s_internal_ram + 2);
+    fill(rx, 12, 9);
+    spi_bounce_rx_finish(&pool, s_internal_ram + 2, rx, 10);
+    uint8_t expected[10];
+    fill(expected, 10, 9);
+    assert(memcmp(s_internal_ram + 2, expected, 10) == 0);
+
+    spi_bounce_release(&pool, s_psram, tx);
+    assert(s_heap_live == 0);
+    assert(pool.heap_allocs == 2 && pool.pool_hits == 0 && pool.bounced_bytes == 112);
+
+    /* No memory: the transaction is refused */
+    s_heap_fail = true;
+    assert(spi_bounce_tx_setup(&pool, s_psram, 100) == NULL);
+    s_heap_fail = false;
+    assert(pool.alloc_failures == 1);
+
+    spi_bounce_pool_deinit(&pool);
+}
+
+static void check_pool(void)
+{
+    spi_bounce_pool_t pool;
+    assert(spi_bounce_pool_init(&pool, 64, 4) == ESP_OK);
+    const int pool_block = s_heap_live;
+
+    /* Small transfers take one chunk each */
+    const void *a = spi_bounce_tx_setup(&pool, s_psram, 10);
+    const void *b = spi_bounce_tx_setup(&pool, s_psram, 64);
+    void *c = spi_bounce_rx_setup(&pool, s_psram, 61);
+    assert(in_pool(&pool, a) && in_pool(&pool, b) && in_pool(&pool, c));
+    assert(a != b && b != c && a != c);
+    assert(pool.free_mask == 0x8 && s_heap_live == pool_block);
+
+    /* Chunk 1 given back: a run of two chunks doesn't fit, it comes from the heap */
+    spi_bounce_release(&pool, s_psram, b);
+    const void *d = spi_bounce_tx_setup(&pool, s_psram, 100);
+    assert(d != NULL && !in_pool(&pool, d));
+    assert(pool.heap_allocs == 1);
+    /* One chunk still fits */
+    const void *e = spi_bounce_tx_setup(&pool, s_psram, 4);
+    assert(e == b);
+    spi_bounce_release(&pool, s_psram, d);
+    spi_bounce_release(&pool, s_psram, e);
+    spi_bounce_release(&pool, s_psram, a);
+    spi_bounce_rx_finish(&pool, s_psram, c, 61);
+    assert(pool.free_mask == 0xf && s_heap_live == pool_block);
+
+    /* A large transfer takes a run of consecutive chunks */
+    fill(s_psram, 256, 3);
+    const void *f = spi_bounce_tx_setup(&pool, s_psram, 256);
+    assert(f == pool.mem && pool.free_mask == 0 && pool.run_len[0] == 4);
+    assert(memcmp(f, s_psram, 256) == 0);
+    spi_bounce_release(&pool, s_psram, f);
+    assert(pool.free_mask == 0xf);
+
+    /* Larger than the pool: from the heap */
+    const void *g = spi_bounce_tx_setup(&pool, s_psram, 257);
+    assert(g != NULL && !in_pool(&pool, g));
+    spi_bounce_release(&pool, s_psram, g);
+
+    assert(pool.pool_hits == 5 && pool.heap_allocs == 2 && pool.alloc_failures == 0);
+    spi_bounce_pool_deinit(&pool);
+    assert(s_heap_live == 0);
+}
+
+typedef struct {
+    spi_bounce_pool_t *pool;
+    uint8_t seed;
+    uint32_t calls;
+} thread_arg_t;
+
+static void *stress_thread(void *arg)
+{
+    thread_arg_t *t = arg;
+    uint8_t src[96];
+    uint32_t rand_state = t->seed;
+
+    fill(src, sizeof(src), t->seed);
+    for (int i = 0; i < ITERATIONS; i++) {
+        rand_state = rand_state * 1103515245 + 12345;
+        size_t len = 1 + (rand_state >> 16) % sizeof(src);
+        /* src is on the stack, not DMA-capable */
+        const uint8_t *bounce = spi_bounce_tx_setup(t->pool, src, len);
+        assert(bounce != NULL);
+        /* Another thread writing to the same chunks would corrupt the copy */
+        for (int spin = 0; spin < 8; spin++) {
+            assert(memcmp(bounce, src, len) == 0);
+        }
+        spi_bounce_release(t->pool, src, bounce);
+        t->calls++;
+    }
+    return NULL;
+}
+
+static void check_concurrency(void)
+{
+    spi_bounce_pool_t pool;
+    pthread_t threads[THREADS];
+    thread_arg_t args[THREADS];
+    uint32_t calls = 0;
+
+    assert(spi_bounce_pool_init(&pool, 32, 6) == ESP_OK);
+    for (int i = 0; i < THREADS; i++) {
+        args[i] = (thread_arg_t) { .pool = &pool, .seed = (uint8_t)(i * 37 + 1) };
+        pthread_create(&threads[i], NULL, stress_thread, &args[i]);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        calls += args[i].calls;
+    }
+
+    assert(pool.free_mask == 0x3f);
+    assert(pool.pool_hits + pool.heap_allocs == calls);
+    printf("%u bounce buffers: %u from the pool, %u from the heap\n",
+           (unsigned) calls, (unsigned) pool.pool_hits, (unsigned) pool.heap_allocs);
+    spi_bounce_pool_deinit(&pool);
+    assert(s_heap_live == 0);
+}
+
+int main(void)
+{
+    check_init();
+    check_no_pool();
+    check_pool();
+    check_concurrency();
+    printf("All tests passed\n");
+    return 0;
+}
@@ -0,0 +1,157 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "soc/spi_pins.h"
+#include "driver/spi_master.h"
+#include "unity.h"
+
+#define TEST_SPI_HOST       SPI2_HOST
+#define TEST_PIN_NUM_MOSI   SPI2_IOMUX_PIN_NUM_MOSI
+#define TEST_PIN_NUM_CLK    SPI2_IOMUX_PIN_NUM_CLK
+#define TEST_BATCH_NUM      6
+#define TEST_BUF_SIZE       64
+
+static DRAM_ATTR int s_done_order[TEST_BATCH_NUM + 1];
+static DRAM_ATTR volatile int s_done_num;
+
+static void IRAM_ATTR test_post_cb(spi_transaction_t *trans)
+{
+    if (s_done_num < TEST_BATCH_NUM + 1) {
+        s_done_order[s_done_num] = (int)trans->user;
+    }
+    s_done_num++;
+}
+
+static spi_device_handle_t test_loopback_init(spi_dma_chan_t dma_chan)
+{
+    // MISO is routed to the MOSI pin, every transaction receives what it sends
+    spi_bus_config_t bus_cfg = {
+        .mosi_io_num = TEST_PIN_NUM_MOSI,
+        .miso_io_num = TEST_PIN_NUM_MOSI,
+        .sclk_io_num = TEST_PIN_NUM_CLK,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = TEST_BUF_SIZE,
+    };
+    spi_device_interface_config_t dev_cfg = {
+        .clock_speed_hz = 1 * 1000 * 1000,
+        .mode = 0,
+        .spics_io_num = -1,
+        .queue_size = 2,
+        .post_cb = test_post_cb,
+    };
+    spi_device_handle_t dev;
+
+    TEST_ESP_OK(spi_bus_initialize(TEST_SPI_HOST, &bus_cfg, dma_chan));
+    TEST_ESP_OK(spi_bus_add_device(TEST_SPI_HOST, &dev_cfg, &dev));
+    return dev;
+}
+
+static void test_loopback_deinit(spi_device_handle_t dev)
+{
+    TEST_ESP_OK(spi_bus_remove_device(dev));
+    TEST_ESP_OK(spi_bus_free(TEST_SPI_HOST));
+}
+
+static void test_batch(spi_dma_chan_t dma_chan)
+{
+    spi_device_handle_t dev = test_loopback_init(dma_chan);
+    uint8_t *tx_buf = heap_caps_malloc((TEST_BATCH_NUM + 1) * TEST_BUF_SIZE, MALLOC_CAP_DMA);
+    uint8_t *rx_buf = heap_caps_calloc(TEST_BATCH_NUM + 1, TEST_BUF_SIZE, MALLOC_CAP_DMA);
+    TEST_ASSERT_NOT_NULL(tx_buf);
+    TEST_ASSERT_NOT_NULL(rx_buf);
+    for (int i = 0; i < (TEST_BATCH_NUM + 1) * TEST_BUF_SIZE; i++) {
+        tx_buf[i] = i * 7 + 1;
+    }
+
+    // Transaction i sends (i + 1) * 4 bytes, the last one is queued alone before the batch
+    spi_transaction_t trans[TEST_BATCH_NUM + 1];
+    spi_transaction_t *batch[TEST_BATCH_NUM];
+    for (int i = 0; i < TEST_BATCH_NUM + 1; i++) {
+        trans[i] = (spi_transaction_t) {
+            .length = (i + 1) * 4 * 8,
+            .tx_buffer = tx_buf + i * TEST_BUF_SIZE,
+            .rx_buffer = rx_buf + i * TEST_BUF_SIZE,
+            .user = (void *)i,
+        };
+    }
+    for (int i = 0; i < TEST_BATCH_NUM; i++) {
+        batch[i] = &trans[i];
+    }
+    spi_transaction_t *single = &trans[TEST_BATCH_NUM];
+
+    s_done_num = 0;
+    TEST_ESP_OK(spi_device_reset_stats(dev));
+    TEST_ESP_OK(spi_device_queue_trans(dev, single, portMAX_DELAY));
+    TEST_ESP_OK(spi_device_queue_trans_batch(dev, batch, TEST_BATCH_NUM, portMAX_DELAY));
+
+    // Results are returned in queueing order, the batch as a whole through its first transaction
+    spi_transaction_t *ret_trans;
+    TEST_ESP_OK(spi_device_get_trans_result(dev, &ret_trans, portMAX_DELAY));
+    TEST_ASSERT_EQUAL_PTR(single, ret_trans);
+    TEST_ESP_OK(spi_device_get_trans_result(dev, &ret_trans, portMAX_DELAY));
+    TEST_ASSERT_EQUAL_PTR(&trans[0], ret_trans);
+
+    TEST_ASSERT_EQUAL(TEST_BATCH_NUM + 1, s_done_num);
+    TEST_ASSERT_EQUAL(TEST_BATCH_NUM, s_done_order[0]);
+    for (int i = 0; i < TEST_BATCH_NUM; i++) {
+        TEST_ASSERT_EQUAL(i, s_done_order[i + 1]);
+    }
+    for (int i = 0; i < TEST_BATCH_NUM + 1; i++) {
+        TEST_ASSERT_EQUAL(trans[i].length, trans[i].rxlength);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(trans[i].tx_buffer, trans[i].rx_buffer, trans[i].length / 8);
+        // Nothing is received past the end of the transaction
+        TEST_ASSERT_EQUAL_HEX8(0, ((uint8_t *)trans[i].rx_buffer)[trans[i].length / 8]);
+    }
+
+    spi_device_stats_t stats;
+    TEST_ESP_OK(spi_device_get_stats(dev, &stats));
+    TEST_ASSERT_EQUAL(TEST_BATCH_NUM + 1, stats.trans_count);
+    TEST_ASSERT_EQUAL(1, stats.batch_count);
+    TEST_ASSERT_GREATER_THAN(0, stats.elapsed_us);
+
+    // Blocking variant, on the same descriptors
+    memset(rx_buf, 0, (TEST_BATCH_NUM + 1) * TEST_BUF_SIZE);
+    TEST_ESP_OK(spi_device_transmit_batch(dev, batch, TEST_BATCH_NUM));
+    for (int i = 0; i < TEST_BATCH_NUM; i++) {
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(trans[i].tx_buffer, trans[i].rx_buffer, trans[i].length / 8);
+    }
+    TEST_ESP_OK(spi_device_get_stats(dev, &stats));
+    TEST_ASSERT_EQUAL(2 * TEST_BATCH_NUM + 1, stats.trans_count);
+    TEST_ASSERT_EQUAL(2, stats.batch_count);
+
+    TEST_ESP_OK(spi_device_reset_stats(dev));
+    TEST_ESP_OK(spi_device_get_stats(dev, &stats));
+    TEST_ASSERT_EQUAL(0, stats.trans_count);
+    TEST_ASSERT_EQUAL(0, stats.batch_count);
+    TEST_ASSERT_LESS_THAN(1000, stats.elapsed_us);
+
+    TEST_ESP_OK(spi_device_transmit(dev, single));
+    TEST_ESP_OK(spi_device_get_stats(dev, &stats));
+    TEST_ASSERT_EQUAL(1, stats.trans_count);
+    TEST_ASSERT_EQUAL(0, stats.batch_count);
+
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, spi_device_queue_trans_batch(dev, batch, 0, portMAX_DELAY));
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, spi_device_get_stats(dev, NULL));
+
+    free(tx_buf);
+    free(rx_buf);
+    test_loopback_deinit(dev);
+}
+
+TEST_CASE("SPI master batched transactions, no DMA", "[spi]")
+{
+    test_batch(SPI_DMA_DISABLED);
+}
+
+TEST_CASE("SPI master batched transactions, DMA", "[spi]")
+{
+    test_batch(SPI_DMA_CH_AUTO);
+}
@@ -0,0 +1,77 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "driver/uart.h"
+
+/**
+ * @brief Enable or disable the zero-copy RX mode of a UART port
+ *
+ * In the zero-copy mode, the interrupt handler reads the RX FIFO straight into the RX buffer of the driver, instead
+ * of going through an intermediate buffer and a FreeRTOS ring buffer. The received data can then be borrowed in place
+ * with uart_read_borrow(), or copied once with uart_read_bytes(). When the RX buffer is full, the data is left in
+ * the RX FIFO (and hardware flow control, if enabled, stops the sender) until the reader makes room.
+ *
+ * The RX buffer keeps the size given to uart_driver_install(). The data already buffered is discarded.
+ *
+ * @note Call this function while the port is not receiving, e.g. right after uart_driver_install().
+ *
+ * @param uart_num UART port number
+ * @param enable true to enable the zero-copy mode, false to go back to the default mode
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Invalid port number
+ *     - ESP_ERR_INVALID_STATE Driver not installed, or data borrowed with uart_read_borrow() not given back yet
+ *     - ESP_ERR_NO_MEM Not enough memory to switch the RX buffer
+ */
+esp_err_t uart_set_rx_zero_copy(uart_port_t uart_num, bool enable);
+
+/**
+ * @brief Borrow the received data of a port in zero-copy mode, without copying it
+ *
+ * Waits for data, then returns the longest contiguous span of received data. The span stays valid, and the other
+ * readers of the port are blocked, until it is given back with uart_read_return() by the same task. Data which wraps
+ * around the end of the RX buffer is returned by the next call.
+ *
+ * @param uart_num UART port number
+ * @param[out] data Start of the received data
+ * @param ticks_to_wait Timeout, count in RTOS ticks
+ *
+ * @return
+ *     - (-1) Error, e.g. the port is not in zero-copy mode
+ *     - 0 No data received before the timeout, nothing to give back
+ *     - OTHERS (>0) Length of the span, in bytes
+ */
+int uart_read_borrow(uart_port_t uart_num, const uint8_t **data, TickType_t ticks_to_wait);
+
+/**
+ * @brief Give back data borrowed with uart_read_borrow()
+ *
+ * @param uart_num UART port number
+ * @param length Number of bytes consumed from the start of the span, at most the length of the span. The bytes which
+ *               are not consumed are returned again by the next read.
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Invalid port number, or length larger than the span
+ *     - ESP_ERR_INVALID_STATE No data borrowed
+ */
+esp_err_t uart_read_return(uart_port_t uart_num, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,207 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Host test of the RX ring of the UART zero-copy mode. The UART HAL is mocked: the test fills the RX FIFO, the ring
+ * reads it with uart_hal_read_rxfifo().
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <assert.h>
+#include <time.h>
+#include "esp_private/uart_rx_ring.h"
+
+#define FIFO_THRESHOLD  120
+#define STREAM_BYTES    (64 * 1024 * 1024)
+#define READ_CHUNK      1024
+/* The reader runs once every READ_PERIOD interrupts, slightly slower than the data comes, so the ring gets full */
+#define READ_PERIOD     9
+
+void uart_hal_read_rxfifo(uart_hal_context_t *hal, uint8_t *buf, int *inout_rd_len)
+{
+    if (*inout_rd_len <= 0 || *inout_rd_len > hal->fifo_len) {
+        *inout_rd_len = hal->fifo_len;
+    }
+    memcpy(buf, hal->fifo, *inout_rd_len);
+    memmove(hal->fifo, hal->fifo + *inout_rd_len, hal->fifo_len - *inout_rd_len);
+    hal->fifo_len -= *inout_rd_len;
+}
+
+static void fifo_push(uart_hal_context_t *hal, const char *data)
+{
+    size_t len = strlen(data);
+    assert(hal->fifo_len + len <= sizeof(hal->fifo));
+    memcpy(hal->fifo + hal->fifo_len, data, len);
+    hal->fifo_len += len;
+}
+
+static void check_spans(void)
+{
+    uart_hal_context_t hal = {};
+    uint8_t storage[10];
+    uart_rx_ring_t ring;
+    const uint8_t *span;
+    uart_rx_ring_init(&ring, storage, sizeof(storage));
+
+    assert(uart_rx_ring_read_span(&ring, &span) == 0);
+    fifo_push(&hal, "0123456");
+    assert(uart_rx_ring_fill_from_fifo(&ring, &hal, 7) == 7);
+    assert(hal.fifo_len == 0 && uart_rx_ring_data_len(&ring) == 7);
+    assert(uart_rx_ring_read_span(&ring, &span) == 7 && memcmp(span, "0123456", 7) == 0);
+    uart_rx_ring_consume(&ring, 5);
+
+    /* The data wraps around: read from the FIFO in two spans, borrowed in two spans */
+    fifo_push(&hal, "789abc");
+    assert(uart_rx_ring_fill_from_fifo(&ring, &hal, 6) == 6);
+    assert(uart_rx_ring_data_len(&ring) == 8);
+    assert(uart_rx_ring_read_span(&ring, &span) == 5 && memcmp(span, "56789", 5) == 0);
+    uart_rx_ring_consume(&ring, 5);
+    assert(uart_rx_ring_read_span(&ring, &span) == 3 && memcmp(span, "abc", 3) == 0);
+    assert(span == storage);
+
+    /* Full ring: the rest of the data stays in the FIFO */
+    fifo_push(&hal, "defghijklm");
+    assert(uart_rx_ring_fill_from_fifo(&ring, &hal, 10) == 7);
+    assert(uart_rx_ring_data_len(&ring) == 10 && hal.fifo_len == 3);
+    assert(uart_rx_ring_fill_from_fifo(&ring, &hal, 3) == 0);
+    uart_rx_ring_consume(&ring, 3);
+    assert(uart_rx_ring_read_span(&ring, &span) == 7 && memcmp(span, "defghij", 7) == 0);
+    assert(uart_rx_ring_fill_from_fifo(&ring, &hal, 3) == 3);
+    uart_rx_ring_consume(&ring, 7);
+    assert(uart_rx_ring_read_span(&ring, &span) == 3 && memcmp(span, "klm", 3) == 0);
+    uart_rx_ring_consume(&ring, 3);
+    assert(uart_rx_ring_data_len(&ring) == 0);
+}
+
+static void check_pattern(void)
+{
+    uart_hal_context_t hal = {};
+    uint8_t storage[8];
+    uart_rx_ring_t ring;
+    const uint8_t *span;
+    uart_rx_ring_init(&ring, storage, sizeof(storage));
+
+    fifo_push(&hal, "xxxxxx");
+    uart_rx_ring_fill_from_fifo(&ring, &hal, 6);
+    uart_rx_ring_read_span(&ring, &span);
+    uart_rx_ring_consume(&ring, 6);
+
+    /* "ab+++c" is written across the end of the storage */
+    uint32_t start = atomic_load(&ring.head);
+    fifo_push(&hal, "ab+++c");
+    uart_rx_ring_fill_from_fifo(&ring, &hal, 6);
+    assert(uart_rx_ring_find_pattern_from_last(&ring, start, 5, '+', 3) == 2);
+    assert(uart_rx_ring_find_pattern_from_last(&ring, start, 5, '+', 4) < 0);
+    assert(uart_rx_ring_find_pattern_from_last(&ring, start, 5, 'c', 1) == 5);
+}
+
+typedef struct {
+    uart_rx_ring_t ring;
+    uart_hal_context_t hal;
+    bool zero_copy;
+    uint8_t stash[FIFO_THRESHOLD];  /* copy mode: FIFO data not written to the ring yet */
+    int stash_off;
+    int stash_len;
+    uint8_t produced_seq;
+    size_t produced;
+    uint32_t full;                  /* Interrupts which left data in the FIFO or the stash */
+} stream_t;
+
+/* One run of the interrupt handler: the FIFO is filled up to the threshold, then read into the ring */
+static void stream_isr(stream_t *s)
+{
+    uint8_t *span;
+
+    while (s->hal.fifo_len < FIFO_THRESHOLD && s->produced < STREAM_BYTES) {
+        s->hal.fifo[s->hal.fifo_len++] = s->produced_seq++;
+        s->produced++;
+    }
+    if (s->zero_copy) {
+        uart_rx_ring_fill_from_fifo(&s->ring, &s->hal, s->hal.fifo_len);
+        s->full += s->hal.fifo_len != 0;
+        return;
+    }
+    /* copy mode: the FIFO goes through a stash buffer first, which is kept until the ring has room */
+    if (s->stash_off == s->stash_len) {
+        s->stash_len = s->hal.fifo_len;
+        s->stash_off = 0;
+        uart_hal_read_rxfifo(&s->hal, s->stash, &s->stash_len);
+    }
+    while (s->stash_off < s->stash_len) {
+        uint32_t n = uart_rx_ring_write_span(&s->ring, &span);
+        if (n == 0) {
+            break;
+        }
+        n = n < (uint32_t)(s->stash_len - s->stash_off) ? n : (uint32_t)(s->stash_len - s->stash_off);
+        memcpy(span, s->stash + s->stash_off, n);
+        uart_rx_ring_commit(&s->ring, n);
+        s->stash_off += n;
+    }
+    s->full += s->stash_off != s->stash_len;
+}
+
+/* One read: borrows the data in place, or copies it to the user buffer like uart_read_bytes() */
+static uint32_t stream_read(stream_t *s, uint8_t *seq)
+{
+    static uint8_t user_buf[READ_CHUNK];
+    const uint8_t *span;
+    uint32_t len = uart_rx_ring_read_span(&s->ring, &span);
+
+    len = len < READ_CHUNK ? len : READ_CHUNK;
+    if (!s->zero_copy) {
+        memcpy(user_buf, span, len);
+        span = user_buf;
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        assert(span[i] == *seq);
+        (*seq)++;
+    }
+    uart_rx_ring_consume(&s->ring, len);
+    return len;
+}
+
+/* The interrupt handler and the reader take turns in a single thread, so every run goes through the same steps */
+static double run_stream(bool zero_copy)
+{
+    static uint8_t storage[4096 + 13];
+    static stream_t s;
+    struct timespec start, end;
+    size_t consumed = 0;
+    uint8_t seq = 0;
+    uint32_t step = 0;
+
+    memset(&s, 0, sizeof(s));
+    s.zero_copy = zero_copy;
+    uart_rx_ring_init(&s.ring, storage, sizeof(storage));
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (consumed < STREAM_BYTES) {
+        stream_isr(&s);
+        if (++step % READ_PERIOD == 0 || s.produced == STREAM_BYTES) {
+            consumed += stream_read(&s, &seq);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    assert(consumed == STREAM_BYTES && uart_rx_ring_data_len(&s.ring) == 0);
+    assert(s.hal.fifo_len == 0 && s.stash_off == s.stash_len && s.full > 0);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    return consumed / seconds;
+}
+
+int main(void)
+{
+    check_spans();
+    check_pattern();
+    double copy_rate = run_stream(false);
+    double zero_copy_rate = run_stream(true);
+    printf("copy mode: %.1f MB/s, zero-copy mode: %.1f MB/s\n", copy_rate / 1e6, zero_copy_rate / 1e6);
+    printf("All tests passed\n");
+    return 0;
+}
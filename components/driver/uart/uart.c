@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -23,6 +23,8 @@
 #include "driver/uart.h"
 #include "driver/gpio.h"
 #include "driver/uart_select.h"
+#include "driver/uart_zero_copy.h"
+#include "esp_private/uart_rx_ring.h"
 #include "esp_private/periph_ctrl.h"
 #include "esp_clk_tree.h"
 #include "sdkconfig.h"
@@ -114,6 +116,9 @@ typedef struct {
     uint8_t *rx_head_ptr;               /*!< pointer to the head of RX item*/
     uint8_t rx_data_buf[SOC_UART_FIFO_LEN]; /*!< Data buffer to stash FIFO data*/
     uint8_t rx_stash_len;               /*!< stashed data length.(When using flow control, after reading out FIFO data, if we fail to push to buffer, we can just stash them.) */
+    bool rx_zero_copy;                  /*!< RX FIFO read straight into rx_zc_ring, see uart_set_rx_zero_copy() */
+    uart_rx_ring_t rx_zc_ring;          /*!< RX buffer of the zero-copy mode */
+    uint32_t rx_zc_borrowed;            /*!< Length of the span lent by uart_read_borrow(), 0 if none */
     uint32_t rx_int_usr_mask;           /*!< RX interrupt status. Valid at any time, regardless of RX buffer status. */
     uart_pat_rb_t rx_pattern_pos;
     int tx_buf_size;                    /*!< TX ring buffer size */
@@ -134,6 +139,7 @@ typedef struct {
     SemaphoreHandle_t tx_fifo_sem;      /*!< UART TX FIFO semaphore*/
     SemaphoreHandle_t tx_done_sem;      /*!< UART TX done semaphore*/
     SemaphoreHandle_t tx_brk_sem;       /*!< UART TX send break done semaphore*/
+    SemaphoreHandle_t rx_zc_sem;        /*!< UART RX data semaphore of the zero-copy mode*/
 #if CONFIG_UART_ISR_IN_IRAM
     void *event_queue_storage;
     void *event_queue_struct;
@@ -146,6 +152,7 @@ typedef struct {
     void *tx_fifo_sem_struct;
     void *tx_done_sem_struct;
     void *tx_brk_sem_struct;
+    void *rx_zc_sem_struct;
 #endif
 } uart_obj_t;
 
@@ -762,6 +769,73 @@ static uint32_t UART_ISR_ATTR uart_enable_tx_write_fifo(uart_port_t uart_num, co
     return sent_len;
 }
 
+//RX FIFO interrupt in zero-copy mode: the FIFO is read straight into the RX buffer
+static void UART_ISR_ATTR uart_rx_intr_zero_copy(uart_obj_t *p_uart, uint32_t uart_intr_status, uart_event_t *uart_event, portBASE_TYPE *HPTaskAwoken)
+{
+    uart_port_t uart_num = p_uart->uart_num;
+    int rx_fifo_len = uart_hal_get_rxfifo_len(&(uart_context[uart_num].hal));
+    if ((p_uart->rx_always_timeout_flg) && !(uart_intr_status & UART_INTR_RXFIFO_TOUT)) {
+        rx_fifo_len--; // leave one byte in the fifo in order to trigger uart_intr_rxfifo_tout
+    }
+    uint32_t start = atomic_load_explicit(&p_uart->rx_zc_ring.head, memory_order_relaxed);
+    int rx_len = rx_fifo_len > 0 ? uart_rx_ring_fill_from_fifo(&p_uart->rx_zc_ring, &(uart_context[uart_num].hal), rx_fifo_len) : 0;
+    uint8_t pat_chr = 0;
+    uint8_t pat_num = 0;
+    int pat_idx = -1;
+    uart_hal_get_at_cmd_char(&(uart_context[uart_num].hal), &pat_chr, &pat_num);
+
+    if (uart_intr_status & UART_INTR_CMD_CHAR_DET) {
+        uart_hal_clr_intsts_mask(&(uart_context[uart_num].hal), UART_INTR_CMD_CHAR_DET);
+        uart_event->type = UART_PATTERN_DET;
+        uart_event->size = rx_len;
+        pat_idx = uart_rx_ring_find_pattern_from_last(&p_uart->rx_zc_ring, start, rx_len - 1, pat_chr, pat_num);
+    } else {
+        uart_hal_clr_intsts_mask(&(uart_context[uart_num].hal), UART_INTR_RXFIFO_TOUT | UART_INTR_RXFIFO_FULL);
+        uart_event->type = UART_DATA;
+        uart_event->size = rx_len;
+        uart_event->timeout_flag = (uart_intr_status & UART_INTR_RXFIFO_TOUT) ? true : false;
+        UART_ENTER_CRITICAL_ISR(&uart_selectlock);
+        if (p_uart->uart_select_notif_callback) {
+            p_uart->uart_select_notif_callback(uart_num, UART_SELECT_READ_NOTIF, HPTaskAwoken);
+        }
+        UART_EXIT_CRITICAL_ISR(&uart_selectlock);
+    }
+
+    bool buffer_full = rx_len < rx_fifo_len;
+    UART_ENTER_CRITICAL_ISR(&(uart_context[uart_num].spinlock));
+    if (uart_intr_status & UART_INTR_CMD_CHAR_DET) {
+        if (rx_len < pat_num) {
+            //some of the characters are read out in last interrupt
+            uart_pattern_enqueue(uart_num, p_uart->rx_buffered_len - (pat_num - rx_len));
+        } else if (pat_idx >= 0) {
+            uart_pattern_enqueue(uart_num, p_uart->rx_buffered_len + pat_idx);
+        } else if (buffer_full) {
+            //the pattern is still in the FIFO
+            uart_pattern_enqueue(uart_num, p_uart->rx_buffered_len + rx_len);
+        }
+    }
+    p_uart->rx_buffered_len += rx_len;
+    if (buffer_full) {
+        //The rest of the data waits in the FIFO until the reader makes room in the RX buffer
+        p_uart->rx_buffer_full_flg = true;
+        uart_hal_disable_intr_mask(&(uart_context[uart_num].hal), UART_INTR_RXFIFO_TOUT | UART_INTR_RXFIFO_FULL);
+    }
+    UART_EXIT_CRITICAL_ISR(&(uart_context[uart_num].spinlock));
+
+    if (rx_len > 0) {
+        xSemaphoreGiveFromISR(p_uart->rx_zc_sem, HPTaskAwoken);
+    }
+    if (buffer_full) {
+        if ((uart_event->type == UART_PATTERN_DET) && (p_uart->event_queue != NULL) &&
+                (pdFALSE == xQueueSendFromISR(p_uart->event_queue, (void * )uart_event, HPTaskAwoken))) {
+#ifndef CONFIG_UART_ISR_IN_IRAM     //Only log if ISR is not in IRAM
+            ESP_EARLY_LOGV(UART_TAG, "UART event queue full");
+#endif
+        }
+        uart_event->type = UART_BUFFER_FULL;
+    }
+}
+
 //internal isr handler for default driver code.
 static void UART_ISR_ATTR uart_rx_intr_handler_default(void *param)
 {
@@ -879,7 +953,9 @@ static void UART_ISR_ATTR uart_rx_intr_handler_default(void *param)
                 uart_intr_status |= UART_INTR_CMD_CHAR_DET;
                 pat_flg = 0;
             }
-            if (p_uart->rx_buffer_full_flg == false) {
+            if (p_uart->rx_buffer_full_flg == false && p_uart->rx_zero_copy) {
+                uart_rx_intr_zero_copy(p_uart, uart_intr_status, &uart_event, &HPTaskAwoken);
+            } else if (p_uart->rx_buffer_full_flg == false) {
                 rx_fifo_len = uart_hal_get_rxfifo_len(&(uart_context[uart_num].hal));
                 if ((p_uart_obj[uart_num]->rx_always_timeout_flg) && !(uart_intr_status & UART_INTR_RXFIFO_TOUT)) {
                     rx_fifo_len--; // leave one byte in the fifo in order to trigger uart_intr_rxfifo_tout
@@ -1239,6 +1315,60 @@ static bool uart_check_buf_full(uart_port_t uart_num)
     return false;
 }
 
+//Give back the space of consumed data to the ISR, the caller holds rx_mux
+static void uart_rx_zero_copy_consume(uart_port_t uart_num, uint32_t len)
+{
+    uart_obj_t *p_uart = p_uart_obj[uart_num];
+    bool resume;
+    uart_rx_ring_consume(&p_uart->rx_zc_ring, len);
+    UART_ENTER_CRITICAL(&(uart_context[uart_num].spinlock));
+    p_uart->rx_buffered_len -= len;
+    uart_pattern_queue_update(uart_num, len);
+    resume = p_uart->rx_buffer_full_flg;
+    p_uart->rx_buffer_full_flg = false;
+    UART_EXIT_CRITICAL(&(uart_context[uart_num].spinlock));
+    if (resume) {
+        /* The data left in the FIFO is read by the next interrupt. Only re-activate the interrupts
+         * if they were NOT explicitly disabled by the user. */
+        uart_reenable_intr_mask(uart_num, UART_INTR_RXFIFO_TOUT | UART_INTR_RXFIFO_FULL);
+    }
+}
+
+//Wait for data in the RX buffer of the zero-copy mode, the caller holds rx_mux
+static uint32_t uart_rx_zero_copy_wait(uart_port_t uart_num, const uint8_t **data, TickType_t ticks_to_wait)
+{
+    uart_obj_t *p_uart = p_uart_obj[uart_num];
+    uint32_t len;
+    //The ISR gives the semaphore after adding data, a stale one only costs another check
+    while ((len = uart_rx_ring_read_span(&p_uart->rx_zc_ring, data)) == 0) {
+        //When using dual cores, the ISR may find the RX buffer full right before the last read empties it.
+        //Resume the RX interrupts here too, as uart_check_buf_full() does in the default mode.
+        uart_rx_zero_copy_consume(uart_num, 0);
+        if (xSemaphoreTake(p_uart->rx_zc_sem, ticks_to_wait) != pdTRUE) {
+            return 0;
+        }
+    }
+    return len;
+}
+
+static int uart_read_bytes_zero_copy(uart_port_t uart_num, uint8_t *buf, uint32_t length, TickType_t ticks_to_wait)
+{
+    const uint8_t *data = NULL;
+    size_t copy_len = 0;
+    while (length) {
+        uint32_t len_tmp = uart_rx_zero_copy_wait(uart_num, &data, ticks_to_wait);
+        if (len_tmp == 0) {
+            break;
+        }
+        len_tmp = MIN(len_tmp, length);
+        memcpy(buf + copy_len, data, len_tmp);
+        uart_rx_zero_copy_consume(uart_num, len_tmp);
+        copy_len += len_tmp;
+        length -= len_tmp;
+    }
+    return copy_len;
+}
+
 int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t ticks_to_wait)
 {
     ESP_RETURN_ON_FALSE((uart_num < UART_NUM_MAX), (-1), UART_TAG, "uart_num error");
@@ -1251,6 +1381,11 @@ int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t
     if (xSemaphoreTake(p_uart_obj[uart_num]->rx_mux, (TickType_t)ticks_to_wait) != pdTRUE) {
         return -1;
     }
+    if (p_uart_obj[uart_num]->rx_zero_copy) {
+        copy_len = uart_read_bytes_zero_copy(uart_num, buf, length, ticks_to_wait);
+        xSemaphoreGive(p_uart_obj[uart_num]->rx_mux);
+        return copy_len;
+    }
     while (length) {
         if (p_uart_obj[uart_num]->rx_cur_remain == 0) {
             data = (uint8_t *) xRingbufferReceive(p_uart_obj[uart_num]->rx_ring_buf, &size, (TickType_t) ticks_to_wait);
@@ -1298,6 +1433,37 @@ int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t
     return copy_len;
 }
 
+int uart_read_borrow(uart_port_t uart_num, const uint8_t **data, TickType_t ticks_to_wait)
+{
+    ESP_RETURN_ON_FALSE((uart_num < UART_NUM_MAX), (-1), UART_TAG, "uart_num error");
+    ESP_RETURN_ON_FALSE((data), (-1), UART_TAG, "uart data null");
+    ESP_RETURN_ON_FALSE((p_uart_obj[uart_num]), (-1), UART_TAG, "uart driver error");
+    ESP_RETURN_ON_FALSE((p_uart_obj[uart_num]->rx_zero_copy), (-1), UART_TAG, "uart not in zero-copy mode");
+    if (xSemaphoreTake(p_uart_obj[uart_num]->rx_mux, (TickType_t)ticks_to_wait) != pdTRUE) {
+        return -1;
+    }
+    uint32_t len = uart_rx_zero_copy_wait(uart_num, data, ticks_to_wait);
+    if (len == 0) {
+        xSemaphoreGive(p_uart_obj[uart_num]->rx_mux);
+        return 0;
+    }
+    //rx_mux is held until the data is given back
+    p_uart_obj[uart_num]->rx_zc_borrowed = len;
+    return len;
+}
+
+esp_err_t uart_read_return(uart_port_t uart_num, size_t length)
+{
+    ESP_RETURN_ON_FALSE((uart_num < UART_NUM_MAX), ESP_ERR_INVALID_ARG, UART_TAG, "uart_num error");
+    ESP_RETURN_ON_FALSE((p_uart_obj[uart_num]), ESP_ERR_INVALID_STATE, UART_TAG, "uart driver error");
+    ESP_RETURN_ON_FALSE((p_uart_obj[uart_num]->rx_zc_borrowed), ESP_ERR_INVALID_STATE, UART_TAG, "no data borrowed");
+    ESP_RETURN_ON_FALSE((length <= p_uart_obj[uart_num]->rx_zc_borrowed), ESP_ERR_INVALID_ARG, UART_TAG, "length larger than the borrowed data");
+    p_uart_obj[uart_num]->rx_zc_borrowed = 0;
+    uart_rx_zero_copy_consume(uart_num, length);
+    xSemaphoreGive(p_uart_obj[uart_num]->rx_mux);
+    return ESP_OK;
+}
+
 esp_err_t uart_get_buffered_data_len(uart_port_t uart_num, size_t *size)
 {
     ESP_RETURN_ON_FALSE((uart_num < UART_NUM_MAX), ESP_FAIL, UART_TAG, "uart_num error");
@@ -1332,46 +1498,56 @@ esp_err_t uart_flush_input(uart_port_t uart_num)
     UART_ENTER_CRITICAL(&(uart_context[uart_num].spinlock));
     uart_hal_disable_intr_mask(&(uart_context[uart_num].hal), UART_INTR_RXFIFO_FULL | UART_INTR_RXFIFO_TOUT);
     UART_EXIT_CRITICAL(&(uart_context[uart_num].spinlock));
-    while (true) {
-        if (p_uart->rx_head_ptr) {
-            vRingbufferReturnItem(p_uart->rx_ring_buf, p_uart->rx_head_ptr);
-            UART_ENTER_CRITICAL(&(uart_context[uart_num].spinlock));
-            p_uart_obj[uart_num]->rx_buffered_len -= p_uart->rx_cur_remain;
-            uart_pattern_queue_update(uart_num, p_uart->rx_cur_remain);
-            UART_EXIT_CRITICAL(&(uart_context[uart_num].spinlock));
-            p_uart->rx_ptr = NULL;
-            p_uart->rx_cur_remain = 0;
-            p_uart->rx_head_ptr = NULL;
-        }
-        data = (uint8_t*) xRingbufferReceive(p_uart->rx_ring_buf, &size, (TickType_t) 0);
-        if(data == NULL) {
-            bool error = false;
-            UART_ENTER_CRITICAL(&(uart_context[uart_num].spinlock));
-            if( p_uart_obj[uart_num]->rx_buffered_len != 0 ) {
-                p_uart_obj[uart_num]->rx_buffered_len = 0;
-                error = true;
-            }
-            //We also need to clear the `rx_buffer_full_flg` here.
-            p_uart_obj[uart_num]->rx_buffer_full_flg = false;
-            UART_EXIT_CRITICAL(&(uart_context[uart_num].spinlock));
-            if (error) {
-                // this must be called outside the critical section
-                ESP_LOGE(UART_TAG, "rx_buffered_len error");
-            }
-            break;
-        }
+    if (p_uart->rx_zero_copy) {
+        uint32_t len = uart_rx_ring_data_len(&p_uart->rx_zc_ring);
+        uart_rx_ring_consume(&p_uart->rx_zc_ring, len);
         UART_ENTER_CRITICAL(&(uart_context[uart_num].spinlock));
-        p_uart_obj[uart_num]->rx_buffered_len -= size;
-        uart_pattern_queue_update(uart_num, size);
+        p_uart->rx_buffered_len -= len;
+        uart_pattern_queue_update(uart_num, len);
+        p_uart->rx_buffer_full_flg = false;
         UART_EXIT_CRITICAL(&(uart_context[uart_num].spinlock));
-        vRingbufferReturnItem(p_uart->rx_ring_buf, data);
-        if (p_uart_obj[uart_num]->rx_buffer_full_flg) {
-            BaseType_t res = xRingbufferSend(p_uart_obj[uart_num]->rx_ring_buf, p_uart_obj[uart_num]->rx_data_buf, p_uart_obj[uart_num]->rx_stash_len, 1);
-            if (res == pdTRUE) {
+    } else {
+        while (true) {
+            if (p_uart->rx_head_ptr) {
+                vRingbufferReturnItem(p_uart->rx_ring_buf, p_uart->rx_head_ptr);
                 UART_ENTER_CRITICAL(&(uart_context[uart_num].spinlock));
-                p_uart_obj[uart_num]->rx_buffered_len += p_uart_obj[uart_num]->rx_stash_len;
+                p_uart_obj[uart_num]->rx_buffered_len -= p_uart->rx_cur_remain;
+                uart_pattern_queue_update(uart_num, p_uart->rx_cur_remain);
+                UART_EXIT_CRITICAL(&(uart_context[uart_num].spinlock));
+                p_uart->rx_ptr = NULL;
+                p_uart->rx_cur_remain = 0;
+                p_uart->rx_head_ptr = NULL;
+            }
+            data = (uint8_t*) xRingbufferReceive(p_uart->rx_ring_buf, &size, (TickType_t) 0);
+            if(data == NULL) {
+                bool error = false;
+                UART_ENTER_CRITICAL(&(uart_context[uart_num].spinlock));
+                if( p_uart_obj[uart_num]->rx_buffered_len != 0 ) {
+                    p_uart_obj[uart_num]->rx_buffered_len = 0;
+                    error = true;
+                }
+                //We also need to clear the `rx_buffer_full_flg` here.
                 p_uart_obj[uart_num]->rx_buffer_full_flg = false;
                 UART_EXIT_CRITICAL(&(uart_context[uart_num].spinlock));
+                if (error) {
+                    // this must be called outside the critical section
+                    ESP_LOGE(UART_TAG, "rx_buffered_len error");
+                }
+                break;
+            }
+            UART_ENTER_CRITICAL(&(uart_context[uart_num].spinlock));
+            p_uart_obj[uart_num]->rx_buffered_len -= size;
+            uart_pattern_queue_update(uart_num, size);
+            UART_EXIT_CRITICAL(&(uart_context[uart_num].spinlock));
+            vRingbufferReturnItem(p_uart->rx_ring_buf, data);
+            if (p_uart_obj[uart_num]->rx_buffer_full_flg) {
+                BaseType_t res = xRingbufferSend(p_uart_obj[uart_num]->rx_ring_buf, p_uart_obj[uart_num]->rx_data_buf, p_uart_obj[uart_num]->rx_stash_len, 1);
+                if (res == pdTRUE) {
+                    UART_ENTER_CRITICAL(&(uart_context[uart_num].spinlock));
+                    p_uart_obj[uart_num]->rx_buffered_len += p_uart_obj[uart_num]->rx_stash_len;
+                    p_uart_obj[uart_num]->rx_buffer_full_flg = false;
+                    UART_EXIT_CRITICAL(&(uart_context[uart_num].spinlock));
+                }
             }
         }
     }
@@ -1386,6 +1562,54 @@ esp_err_t uart_flush_input(uart_port_t uart_num)
     return ESP_OK;
 }
 
+esp_err_t uart_set_rx_zero_copy(uart_port_t uart_num, bool enable)
+{
+    ESP_RETURN_ON_FALSE((uart_num < UART_NUM_MAX), ESP_ERR_INVALID_ARG, UART_TAG, "uart_num error");
+    ESP_RETURN_ON_FALSE((p_uart_obj[uart_num]), ESP_ERR_INVALID_STATE, UART_TAG, "uart driver error");
+    ESP_RETURN_ON_FALSE((p_uart_obj[uart_num]->rx_zc_borrowed == 0), ESP_ERR_INVALID_STATE, UART_TAG, "rx data borrowed");
+    uart_obj_t *p_uart = p_uart_obj[uart_num];
+    esp_err_t ret = ESP_OK;
+
+    if (p_uart->rx_zero_copy == enable) {
+        return ESP_OK;
+    }
+    uart_flush_input(uart_num);
+    xSemaphoreTake(p_uart->rx_mux, (TickType_t)portMAX_DELAY);
+    UART_ENTER_CRITICAL(&(uart_context[uart_num].spinlock));
+    uart_hal_disable_intr_mask(&(uart_context[uart_num].hal), UART_INTR_RXFIFO_FULL | UART_INTR_RXFIFO_TOUT);
+    UART_EXIT_CRITICAL(&(uart_context[uart_num].spinlock));
+    //The RX buffer changes hands: the storage of the ring buffer is reused when it is static
+    if (enable) {
+#if CONFIG_UART_ISR_IN_IRAM
+        uint8_t *storage = p_uart->rx_ring_buf_storage;
+#else
+        uint8_t *storage = heap_caps_malloc(p_uart->rx_buf_size, UART_MALLOC_CAPS);
+#endif
+        ESP_GOTO_ON_FALSE(storage, ESP_ERR_NO_MEM, out, UART_TAG, "no mem for the zero-copy rx buffer");
+        vRingbufferDelete(p_uart->rx_ring_buf);
+        p_uart->rx_ring_buf = NULL;
+        uart_rx_ring_init(&p_uart->rx_zc_ring, storage, p_uart->rx_buf_size);
+    } else {
+#if CONFIG_UART_ISR_IN_IRAM
+        RingbufHandle_t ring_buf = xRingbufferCreateStatic(p_uart->rx_buf_size, RINGBUF_TYPE_BYTEBUF,
+                                   p_uart->rx_ring_buf_storage, p_uart->rx_ring_buf_struct);
+#else
+        RingbufHandle_t ring_buf = xRingbufferCreate(p_uart->rx_buf_size, RINGBUF_TYPE_BYTEBUF);
+#endif
+        ESP_GOTO_ON_FALSE(ring_buf, ESP_ERR_NO_MEM, out, UART_TAG, "no mem for the rx ring buffer");
+#if !CONFIG_UART_ISR_IN_IRAM
+        free(p_uart->rx_zc_ring.buf);
+#endif
+        p_uart->rx_zc_ring.buf = NULL;
+        p_uart->rx_ring_buf = ring_buf;
+    }
+    p_uart->rx_zero_copy = enable;
+out:
+    uart_reenable_intr_mask(uart_num, UART_INTR_RXFIFO_TOUT | UART_INTR_RXFIFO_FULL);
+    xSemaphoreGive(p_uart->rx_mux);
+    return ret;
+}
+
 static void uart_free_driver_obj(uart_obj_t *uart_obj)
 {
     if (uart_obj->tx_fifo_sem) {
@@ -1403,6 +1627,9 @@ static void uart_free_driver_obj(uart_obj_t *uart_obj)
     if (uart_obj->rx_mux) {
         vSemaphoreDelete(uart_obj->rx_mux);
     }
+    if (uart_obj->rx_zc_sem) {
+        vSemaphoreDelete(uart_obj->rx_zc_sem);
+    }
     if (uart_obj->event_queue) {
         vQueueDelete(uart_obj->event_queue);
     }
@@ -1424,6 +1651,10 @@ static void uart_free_driver_obj(uart_obj_t *uart_obj)
     free(uart_obj->tx_brk_sem_struct);
     free(uart_obj->tx_done_sem_struct);
     free(uart_obj->tx_fifo_sem_struct);
+    free(uart_obj->rx_zc_sem_struct);
+#else
+    //In zero-copy mode, the RX buffer is not owned by a ring buffer
+    free(uart_obj->rx_zc_ring.buf);
 #endif
     free(uart_obj);
 }
@@ -1456,9 +1687,10 @@ static uart_obj_t *uart_alloc_driver_obj(int event_queue_size, int tx_buffer_siz
     uart_obj->tx_brk_sem_struct = heap_caps_calloc(1, sizeof(StaticSemaphore_t), UART_MALLOC_CAPS);
     uart_obj->tx_done_sem_struct = heap_caps_calloc(1, sizeof(StaticSemaphore_t), UART_MALLOC_CAPS);
     uart_obj->tx_fifo_sem_struct = heap_caps_calloc(1, sizeof(StaticSemaphore_t), UART_MALLOC_CAPS);
+    uart_obj->rx_zc_sem_struct = heap_caps_calloc(1, sizeof(StaticSemaphore_t), UART_MALLOC_CAPS);
     if (!uart_obj->rx_ring_buf_storage || !uart_obj->rx_ring_buf_struct || !uart_obj->rx_mux_struct ||
             !uart_obj->tx_mux_struct || !uart_obj->tx_brk_sem_struct || !uart_obj->tx_done_sem_struct ||
-            !uart_obj->tx_fifo_sem_struct) {
+            !uart_obj->tx_fifo_sem_struct || !uart_obj->rx_zc_sem_struct) {
         goto err;
     }
     if (event_queue_size > 0) {
@@ -1482,8 +1714,9 @@ static uart_obj_t *uart_alloc_driver_obj(int event_queue_size, int tx_buffer_siz
     uart_obj->tx_brk_sem = xSemaphoreCreateBinaryStatic(uart_obj->tx_brk_sem_struct);
     uart_obj->tx_done_sem = xSemaphoreCreateBinaryStatic(uart_obj->tx_done_sem_struct);
     uart_obj->tx_fifo_sem = xSemaphoreCreateBinaryStatic(uart_obj->tx_fifo_sem_struct);
+    uart_obj->rx_zc_sem = xSemaphoreCreateBinaryStatic(uart_obj->rx_zc_sem_struct);
     if (!uart_obj->rx_ring_buf || !uart_obj->rx_mux || !uart_obj->tx_mux || !uart_obj->tx_brk_sem ||
-            !uart_obj->tx_done_sem || !uart_obj->tx_fifo_sem) {
+            !uart_obj->tx_done_sem || !uart_obj->tx_fifo_sem || !uart_obj->rx_zc_sem) {
         goto err;
     }
 #else
@@ -1505,8 +1738,9 @@ static uart_obj_t *uart_alloc_driver_obj(int event_queue_size, int tx_buffer_siz
     uart_obj->tx_brk_sem = xSemaphoreCreateBinary();
     uart_obj->tx_done_sem = xSemaphoreCreateBinary();
     uart_obj->tx_fifo_sem = xSemaphoreCreateBinary();
+    uart_obj->rx_zc_sem = xSemaphoreCreateBinary();
     if (!uart_obj->rx_ring_buf || !uart_obj->rx_mux || !uart_obj->tx_mux || !uart_obj->tx_brk_sem ||
-            !uart_obj->tx_done_sem || !uart_obj->tx_fifo_sem) {
+            !uart_obj->tx_done_sem || !uart_obj->tx_fifo_sem || !uart_obj->rx_zc_sem) {
         goto err;
     }
 #endif
@@ -1562,6 +1796,9 @@ esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_b
         p_uart_obj[uart_num]->rx_cur_remain = 0;
         p_uart_obj[uart_num]->rx_int_usr_mask = UART_INTR_RXFIFO_FULL | UART_INTR_RXFIFO_TOUT;
         p_uart_obj[uart_num]->rx_head_ptr = NULL;
+        p_uart_obj[uart_num]->rx_buf_size = rx_buffer_size;
+        p_uart_obj[uart_num]->rx_zero_copy = false;
+        p_uart_obj[uart_num]->rx_zc_borrowed = 0;
         p_uart_obj[uart_num]->tx_buf_size = tx_buffer_size;
         p_uart_obj[uart_num]->uart_select_notif_callback = NULL;
         xSemaphoreGive(p_uart_obj[uart_num]->tx_fifo_sem);
@@ -0,0 +1,127 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <sys/param.h>
+#include "sdkconfig.h"
+#include "esp_attr.h"
+#include "esp_private/uart_rx_ring.h"
+
+// The producer side runs in the UART ISR
+#ifdef CONFIG_UART_ISR_IN_IRAM
+#define UART_RX_RING_ATTR IRAM_ATTR
+#else
+#define UART_RX_RING_ATTR
+#endif
+
+/*
+ * The counters run over twice the size of the ring, which tells a full ring from an empty one without giving up a
+ * byte of storage, for any size.
+ */
+static inline uint32_t UART_RX_RING_ATTR ring_advance(const uart_rx_ring_t *ring, uint32_t counter, uint32_t len)
+{
+    counter += len;
+    return counter >= 2 * ring->size ? counter - 2 * ring->size : counter;
+}
+
+static inline uint32_t UART_RX_RING_ATTR ring_pos(const uart_rx_ring_t *ring, uint32_t counter)
+{
+    return counter >= ring->size ? counter - ring->size : counter;
+}
+
+static inline uint32_t UART_RX_RING_ATTR ring_used(const uart_rx_ring_t *ring, uint32_t head, uint32_t tail)
+{
+    return head >= tail ? head - tail : head + 2 * ring->size - tail;
+}
+
+void uart_rx_ring_init(uart_rx_ring_t *ring, uint8_t *buf, uint32_t size)
+{
+    ring->buf = buf;
+    ring->size = size;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+}
+
+uint32_t UART_RX_RING_ATTR uart_rx_ring_data_len(uart_rx_ring_t *ring)
+{
+    return ring_used(ring, atomic_load_explicit(&ring->head, memory_order_acquire),
+                     atomic_load_explicit(&ring->tail, memory_order_acquire));
+}
+
+uint32_t UART_RX_RING_ATTR uart_rx_ring_write_span(uart_rx_ring_t *ring, uint8_t **span)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    // the consumer must be done with the bytes before their space is written again
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    uint32_t pos = ring_pos(ring, head);
+    uint32_t free_len = ring->size - ring_used(ring, head, tail);
+
+    *span = ring->buf + pos;
+    return MIN(free_len, ring->size - pos);
+}
+
+void UART_RX_RING_ATTR uart_rx_ring_commit(uart_rx_ring_t *ring, uint32_t len)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    // publish the data before the new head
+    atomic_store_explicit(&ring->head, ring_advance(ring, head, len), memory_order_release);
+}
+
+int UART_RX_RING_ATTR uart_rx_ring_fill_from_fifo(uart_rx_ring_t *ring, uart_hal_context_t *hal, int len)
+{
+    int read_len = 0;
+    uint8_t *span = NULL;
+
+    // the free space is split in two spans at most
+    for (int i = 0; i < 2 && read_len < len; i++) {
+        int span_len = MIN(len - read_len, (int)uart_rx_ring_write_span(ring, &span));
+        if (span_len == 0) {
+            // ring full
+            break;
+        }
+        uart_hal_read_rxfifo(hal, span, &span_len);
+        uart_rx_ring_commit(ring, span_len);
+        read_len += span_len;
+    }
+    return read_len;
+}
+
+uint32_t uart_rx_ring_read_span(uart_rx_ring_t *ring, const uint8_t **span)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    // the data must be visible before it is read
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t pos = ring_pos(ring, tail);
+
+    *span = ring->buf + pos;
+    return MIN(ring_used(ring, head, tail), ring->size - pos);
+}
+
+void uart_rx_ring_consume(uart_rx_ring_t *ring, uint32_t len)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    // the data must be read before its space is given back
+    atomic_store_explicit(&ring->tail, ring_advance(ring, tail, len), memory_order_release);
+}
+
+int UART_RX_RING_ATTR uart_rx_ring_find_pattern_from_last(uart_rx_ring_t *ring, uint32_t start, int length, uint8_t pat_chr, uint8_t pat_num)
+{
+    int cnt = 0;
+    int len = length;
+    while (len >= 0) {
+        if (ring->buf[ring_pos(ring, ring_advance(ring, start, len))] == pat_chr) {
+            cnt++;
+        } else {
+            cnt = 0;
+        }
+        if (cnt >= pat_num) {
+            break;
+        }
+        len --;
+    }
+    return len;
+}
@@ -139,7 +139,8 @@ esp_err_t async_memcpy_impl_new_etm_event(async_memcpy_impl_t *impl, async_memcp
 
 bool async_memcpy_impl_is_buffer_address_valid(async_memcpy_impl_t *impl, void *src, void *dst)
 {
-    bool valid = true;
+    // GDMA can only access SRAM and PSRAM
+    bool valid = (esp_ptr_internal(src) || esp_ptr_external_ram(src)) && (esp_ptr_internal(dst) || esp_ptr_external_ram(dst));
     if (esp_ptr_external_ram(dst)) {
         if (impl->psram_trans_align) {
             valid = valid && (((intptr_t)dst & (impl->psram_trans_align - 1)) == 0);
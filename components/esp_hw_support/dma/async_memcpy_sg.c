@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <sys/param.h>
+#include "esp_private/async_memcpy_sg.h"
+
+void async_memcpy_sg_iter_init(async_memcpy_sg_iter_t *iter, const async_memcpy_iovec_t *iov, size_t iov_num, size_t max_buffer_size)
+{
+    iter->iov = iov;
+    iter->iov_num = iov_num;
+    iter->index = 0;
+    iter->offset = 0;
+    iter->max_buffer_size = max_buffer_size;
+}
+
+size_t async_memcpy_sg_iter_next(async_memcpy_sg_iter_t *iter, uint8_t **buffer)
+{
+    uint8_t *start = NULL;
+    size_t size = 0;
+
+    while (iter->index < iter->iov_num && size < iter->max_buffer_size) {
+        const async_memcpy_iovec_t *iov = &iter->iov[iter->index];
+        uint8_t *ptr = (uint8_t *)iov->buffer + iter->offset;
+        size_t left = iov->length - iter->offset;
+        if (left) {
+            if (size == 0) {
+                start = ptr;
+            } else if (ptr != start + size) {
+                // not contiguous to the buffer, starts the next one
+                break;
+            }
+            size_t take = MIN(left, iter->max_buffer_size - size);
+            size += take;
+            iter->offset += take;
+            left -= take;
+        }
+        if (left == 0) {
+            iter->index++;
+            iter->offset = 0;
+        }
+    }
+    *buffer = start;
+    return size;
+}
+
+size_t async_memcpy_sg_total_length(const async_memcpy_iovec_t *iov, size_t iov_num)
+{
+    size_t length = 0;
+    for (size_t i = 0; i < iov_num; i++) {
+        length += iov[i].length;
+    }
+    return length;
+}
+
+size_t async_memcpy_sg_count_buffers(const async_memcpy_iovec_t *iov, size_t iov_num, size_t max_buffer_size)
+{
+    async_memcpy_sg_iter_t iter;
+    uint8_t *buffer;
+    size_t count = 0;
+
+    async_memcpy_sg_iter_init(&iter, iov, iov_num, max_buffer_size);
+    while (async_memcpy_sg_iter_next(&iter, &buffer)) {
+        count++;
+    }
+    return count;
+}
+
+size_t async_memcpy_sg_emulate(const async_memcpy_iovec_t *dst, size_t dst_num,
+                               const async_memcpy_iovec_t *src, size_t src_num, size_t max_buffer_size)
+{
+    async_memcpy_sg_iter_t rx;
+    async_memcpy_sg_iter_t tx;
+    uint8_t *rx_buf = NULL;
+    uint8_t *tx_buf = NULL;
+    size_t rx_left = 0;
+    size_t tx_left = 0;
+    size_t copied = 0;
+
+    async_memcpy_sg_iter_init(&rx, dst, dst_num, max_buffer_size);
+    async_memcpy_sg_iter_init(&tx, src, src_num, max_buffer_size);
+    while (true) {
+        // fetch the next descriptor of the channel which has drained its own
+        if (rx_left == 0 && (rx_left = async_memcpy_sg_iter_next(&rx, &rx_buf)) == 0) {
+            break;
+        }
+        if (tx_left == 0 && (tx_left = async_memcpy_sg_iter_next(&tx, &tx_buf)) == 0) {
+            break;
+        }
+        size_t n = MIN(rx_left, tx_left);
+        memcpy(rx_buf, tx_buf, n);
+        rx_buf += n;
+        tx_buf += n;
+        rx_left -= n;
+        tx_left -= n;
+        copied += n;
+    }
+    return copied;
+}
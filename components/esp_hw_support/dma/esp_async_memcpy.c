@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2020-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2020-2024 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -13,6 +13,7 @@
 #include "esp_log.h"
 #include "esp_async_memcpy.h"
 #include "esp_async_memcpy_impl.h"
+#include "esp_private/async_memcpy_sg.h"
 
 static const char *TAG = "async_memcpy";
 
@@ -123,87 +124,61 @@ esp_err_t esp_async_memcpy_new_etm_event(async_memcpy_t asmcp, async_memcpy_etm_
     return async_memcpy_impl_new_etm_event(&asmcp->mcp_impl, event_type, out_event);
 }
 
-static int async_memcpy_prepare_receive(async_memcpy_t asmcp, void *buffer, size_t size, dma_descriptor_t **start_desc, dma_descriptor_t **end_desc)
+static int async_memcpy_prepare_receive(async_memcpy_t asmcp, async_memcpy_sg_iter_t *iter, dma_descriptor_t **start_desc, dma_descriptor_t **end_desc)
 {
     uint32_t prepared_length = 0;
-    uint8_t *buf = (uint8_t *)buffer;
+    uint8_t *buf = NULL;
+    size_t size = 0;
     dma_descriptor_t *desc = asmcp->rx_desc; // descriptor iterator
     dma_descriptor_t *start = desc;
     dma_descriptor_t *end = desc;
 
-    while (size > asmcp->max_dma_buffer_size) {
-        if (desc->dw0.owner != DMA_DESCRIPTOR_BUFFER_OWNER_DMA) {
-            desc->dw0.suc_eof = 0;
-            desc->dw0.size = asmcp->max_dma_buffer_size;
-            desc->buffer = &buf[prepared_length];
-            desc = desc->next; // move to next descriptor
-            prepared_length += asmcp->max_dma_buffer_size;
-            size -= asmcp->max_dma_buffer_size;
-        } else {
+    while ((size = async_memcpy_sg_iter_next(iter, &buf)) != 0) {
+        if (desc->dw0.owner == DMA_DESCRIPTOR_BUFFER_OWNER_DMA) {
             // out of RX descriptors
-            goto _exit;
-        }
-    }
-    if (size) {
-        if (desc->dw0.owner != DMA_DESCRIPTOR_BUFFER_OWNER_DMA) {
-            end = desc; // the last descriptor used
-            desc->dw0.suc_eof = 0;
-            desc->dw0.size = size;
-            desc->buffer = &buf[prepared_length];
-            desc = desc->next; // move to next descriptor
-            prepared_length += size;
-        } else {
-            // out of RX descriptors
-            goto _exit;
+            break;
         }
+        end = desc; // the last descriptor used
+        desc->dw0.suc_eof = 0;
+        desc->dw0.size = size;
+        desc->buffer = buf;
+        desc = desc->next; // move to next descriptor
+        prepared_length += size;
     }
 
-_exit:
     *start_desc = start;
     *end_desc = end;
     return prepared_length;
 }
 
-static int async_memcpy_prepare_transmit(async_memcpy_t asmcp, void *buffer, size_t len, dma_descriptor_t **start_desc, dma_descriptor_t **end_desc)
+static int async_memcpy_prepare_transmit(async_memcpy_t asmcp, async_memcpy_sg_iter_t *iter, dma_descriptor_t **start_desc, dma_descriptor_t **end_desc)
 {
     uint32_t prepared_length = 0;
-    uint8_t *buf = (uint8_t *)buffer;
+    uint8_t *buf = NULL;
+    size_t len = 0;
     dma_descriptor_t *desc = asmcp->tx_desc; // descriptor iterator
     dma_descriptor_t *start = desc;
     dma_descriptor_t *end = desc;
 
-    while (len > asmcp->max_dma_buffer_size) {
-        if (desc->dw0.owner != DMA_DESCRIPTOR_BUFFER_OWNER_DMA) {
-            desc->dw0.suc_eof = 0; // not the end of the transaction
-            desc->dw0.size = asmcp->max_dma_buffer_size;
-            desc->dw0.length = asmcp->max_dma_buffer_size;
-            desc->buffer = &buf[prepared_length];
-            desc = desc->next; // move to next descriptor
-            prepared_length += asmcp->max_dma_buffer_size;
-            len -= asmcp->max_dma_buffer_size;
-        } else {
+    while ((len = async_memcpy_sg_iter_next(iter, &buf)) != 0) {
+        if (desc->dw0.owner == DMA_DESCRIPTOR_BUFFER_OWNER_DMA) {
             // out of TX descriptors
-            goto _exit;
+            return prepared_length;
         }
+        end = desc;            // the last descriptor used
+        desc->dw0.suc_eof = 0; // not the end of the transaction
+        desc->dw0.size = len;
+        desc->dw0.length = len;
+        desc->buffer = buf;
+        desc = desc->next; // move to next descriptor
+        prepared_length += len;
     }
-    if (len) {
-        if (desc->dw0.owner != DMA_DESCRIPTOR_BUFFER_OWNER_DMA) {
-            end = desc;            // the last descriptor used
-            desc->dw0.suc_eof = 1; // end of the transaction
-            desc->dw0.size = len;
-            desc->dw0.length = len;
-            desc->buffer = &buf[prepared_length];
-            desc = desc->next; // move to next descriptor
-            prepared_length += len;
-        } else {
-            // out of TX descriptors
-            goto _exit;
-        }
+    if (prepared_length) {
+        end->dw0.suc_eof = 1; // end of the transaction
     }
 
     *start_desc = start;
     *end_desc = end;
-_exit:
     return prepared_length;
 }
 
@@ -222,7 +197,7 @@ static bool async_memcpy_get_next_rx_descriptor(async_memcpy_t asmcp, dma_descri
     return false;
 }
 
-esp_err_t esp_async_memcpy(async_memcpy_t asmcp, void *dst, void *src, size_t n, async_memcpy_isr_cb_t cb_isr, void *cb_args)
+static esp_err_t async_memcpy_submit(async_memcpy_t asmcp, async_memcpy_sg_iter_t *rx_iter, async_memcpy_sg_iter_t *tx_iter, size_t n, async_memcpy_isr_cb_t cb_isr, void *cb_args)
 {
     esp_err_t ret = ESP_OK;
     dma_descriptor_t *rx_start_desc = NULL;
@@ -231,20 +206,11 @@ esp_err_t esp_async_memcpy(async_memcpy_t asmcp, void *dst, void *src, size_t n,
     dma_descriptor_t *tx_end_desc = NULL;
     size_t rx_prepared_size = 0;
     size_t tx_prepared_size = 0;
-    ESP_GOTO_ON_FALSE(asmcp, ESP_ERR_INVALID_ARG, err, TAG, "mcp handle can't be null");
-    ESP_GOTO_ON_FALSE(async_memcpy_impl_is_buffer_address_valid(&asmcp->mcp_impl, src, dst), ESP_ERR_INVALID_ARG, err, TAG, "buffer address not valid: %p -> %p", src, dst);
-    ESP_GOTO_ON_FALSE(n <= asmcp->max_dma_buffer_size * asmcp->max_stream_num, ESP_ERR_INVALID_ARG, err, TAG, "buffer size too large");
-    if (asmcp->mcp_impl.sram_trans_align) {
-        ESP_GOTO_ON_FALSE(((n & (asmcp->mcp_impl.sram_trans_align - 1)) == 0), ESP_ERR_INVALID_ARG, err, TAG, "copy size should align to %d bytes", asmcp->mcp_impl.sram_trans_align);
-    }
-    if (asmcp->mcp_impl.psram_trans_align) {
-        ESP_GOTO_ON_FALSE(((n & (asmcp->mcp_impl.psram_trans_align - 1)) == 0), ESP_ERR_INVALID_ARG, err, TAG, "copy size should align to %d bytes", asmcp->mcp_impl.psram_trans_align);
-    }
 
     // Prepare TX and RX descriptor
     portENTER_CRITICAL_SAFE(&asmcp->spinlock);
-    rx_prepared_size = async_memcpy_prepare_receive(asmcp, dst, n, &rx_start_desc, &rx_end_desc);
-    tx_prepared_size = async_memcpy_prepare_transmit(asmcp, src, n, &tx_start_desc, &tx_end_desc);
+    rx_prepared_size = async_memcpy_prepare_receive(asmcp, rx_iter, &rx_start_desc, &rx_end_desc);
+    tx_prepared_size = async_memcpy_prepare_transmit(asmcp, tx_iter, &tx_start_desc, &tx_end_desc);
     if (rx_start_desc && tx_start_desc && (rx_prepared_size == n) && (tx_prepared_size == n)) {
         // register user callback to the last descriptor
         async_memcpy_stream_t *mcp_stream = __containerof(rx_end_desc, async_memcpy_stream_t, desc);
@@ -279,6 +245,76 @@ err:
     return ret;
 }
 
+static bool async_memcpy_is_size_aligned(async_memcpy_t asmcp, size_t n)
+{
+    if (asmcp->mcp_impl.sram_trans_align && (n & (asmcp->mcp_impl.sram_trans_align - 1))) {
+        return false;
+    }
+    if (asmcp->mcp_impl.psram_trans_align && (n & (asmcp->mcp_impl.psram_trans_align - 1))) {
+        return false;
+    }
+    return true;
+}
+
+esp_err_t esp_async_memcpy(async_memcpy_t asmcp, void *dst, void *src, size_t n, async_memcpy_isr_cb_t cb_isr, void *cb_args)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_GOTO_ON_FALSE(asmcp, ESP_ERR_INVALID_ARG, err, TAG, "mcp handle can't be null");
+    ESP_GOTO_ON_FALSE(async_memcpy_impl_is_buffer_address_valid(&asmcp->mcp_impl, src, dst), ESP_ERR_INVALID_ARG, err, TAG, "buffer address not valid: %p -> %p", src, dst);
+    ESP_GOTO_ON_FALSE(n <= asmcp->max_dma_buffer_size * asmcp->max_stream_num, ESP_ERR_INVALID_ARG, err, TAG, "buffer size too large");
+    if (asmcp->mcp_impl.sram_trans_align) {
+        ESP_GOTO_ON_FALSE(((n & (asmcp->mcp_impl.sram_trans_align - 1)) == 0), ESP_ERR_INVALID_ARG, err, TAG, "copy size should align to %d bytes", asmcp->mcp_impl.sram_trans_align);
+    }
+    if (asmcp->mcp_impl.psram_trans_align) {
+        ESP_GOTO_ON_FALSE(((n & (asmcp->mcp_impl.psram_trans_align - 1)) == 0), ESP_ERR_INVALID_ARG, err, TAG, "copy size should align to %d bytes", asmcp->mcp_impl.psram_trans_align);
+    }
+
+    async_memcpy_iovec_t rx_iov = {.buffer = dst, .length = n};
+    async_memcpy_iovec_t tx_iov = {.buffer = src, .length = n};
+    async_memcpy_sg_iter_t rx_iter;
+    async_memcpy_sg_iter_t tx_iter;
+    async_memcpy_sg_iter_init(&rx_iter, &rx_iov, 1, asmcp->max_dma_buffer_size);
+    async_memcpy_sg_iter_init(&tx_iter, &tx_iov, 1, asmcp->max_dma_buffer_size);
+    ret = async_memcpy_submit(asmcp, &rx_iter, &tx_iter, n, cb_isr, cb_args);
+
+err:
+    return ret;
+}
+
+esp_err_t esp_async_memcpy_sg(async_memcpy_t asmcp, const async_memcpy_iovec_t *dst, size_t dst_num,
+                              const async_memcpy_iovec_t *src, size_t src_num, async_memcpy_isr_cb_t cb_isr, void *cb_args)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_GOTO_ON_FALSE(asmcp, ESP_ERR_INVALID_ARG, err, TAG, "mcp handle can't be null");
+    ESP_GOTO_ON_FALSE(dst && src && dst_num && src_num, ESP_ERR_INVALID_ARG, err, TAG, "fragment list can't be empty");
+    // each fragment is checked against the first one of the other side, which is checked in the other loop
+    for (size_t i = 0; i < dst_num; i++) {
+        ESP_GOTO_ON_FALSE(async_memcpy_impl_is_buffer_address_valid(&asmcp->mcp_impl, src[0].buffer, dst[i].buffer), ESP_ERR_INVALID_ARG, err, TAG,
+                          "buffer address not valid: %p", dst[i].buffer);
+        ESP_GOTO_ON_FALSE(async_memcpy_is_size_aligned(asmcp, dst[i].length), ESP_ERR_INVALID_ARG, err, TAG, "fragment %d size not aligned", (int)i);
+    }
+    for (size_t i = 0; i < src_num; i++) {
+        ESP_GOTO_ON_FALSE(async_memcpy_impl_is_buffer_address_valid(&asmcp->mcp_impl, src[i].buffer, dst[0].buffer), ESP_ERR_INVALID_ARG, err, TAG,
+                          "buffer address not valid: %p", src[i].buffer);
+        ESP_GOTO_ON_FALSE(async_memcpy_is_size_aligned(asmcp, src[i].length), ESP_ERR_INVALID_ARG, err, TAG, "fragment %d size not aligned", (int)i);
+    }
+    size_t n = async_memcpy_sg_total_length(src, src_num);
+    ESP_GOTO_ON_FALSE(n && n == async_memcpy_sg_total_length(dst, dst_num), ESP_ERR_INVALID_ARG, err, TAG, "source and destination lengths differ");
+    // the descriptors are used in a ring, a chain longer than the ring would overwrite itself
+    ESP_GOTO_ON_FALSE(async_memcpy_sg_count_buffers(dst, dst_num, asmcp->max_dma_buffer_size) <= asmcp->max_stream_num &&
+                      async_memcpy_sg_count_buffers(src, src_num, asmcp->max_dma_buffer_size) <= asmcp->max_stream_num,
+                      ESP_ERR_INVALID_ARG, err, TAG, "too many fragments");
+
+    async_memcpy_sg_iter_t rx_iter;
+    async_memcpy_sg_iter_t tx_iter;
+    async_memcpy_sg_iter_init(&rx_iter, dst, dst_num, asmcp->max_dma_buffer_size);
+    async_memcpy_sg_iter_init(&tx_iter, src, src_num, asmcp->max_dma_buffer_size);
+    ret = async_memcpy_submit(asmcp, &rx_iter, &tx_iter, n, cb_isr, cb_args);
+
+err:
+    return ret;
+}
+
 IRAM_ATTR void async_memcpy_isr_on_rx_done_event(async_memcpy_impl_t *impl)
 {
     bool to_continue = false;
@@ -11,6 +11,7 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include <stddef.h>
 #include <stdbool.h>
 #include "esp_err.h"
 #include "esp_etm.h"
@@ -42,6 +43,15 @@ typedef struct {
  */
 typedef bool (*async_memcpy_isr_cb_t)(async_memcpy_t mcp_hdl, async_memcpy_event_t *event, void *cb_args);
 
+/**
+ * @brief Fragment of a scatter-gather memory copy
+ *
+ */
+typedef struct {
+    void *buffer;  /*!< Start address of the fragment */
+    size_t length; /*!< Length of the fragment, in bytes */
+} async_memcpy_iovec_t;
+
 /**
  * @brief Type of async memcpy configuration
  *
@@ -107,6 +117,34 @@ esp_err_t esp_async_memcpy_uninstall(async_memcpy_t asmcp);
  */
 esp_err_t esp_async_memcpy(async_memcpy_t asmcp, void *dst, void *src, size_t n, async_memcpy_isr_cb_t cb_isr, void *cb_args);
 
+/**
+ * @brief Send an asynchronous scatter-gather memory copy request
+ *
+ * The source fragments are copied, in order, into the destination fragments as if both lists were contiguous buffers:
+ * the fragments of the two lists don't need to have the same lengths. Fragments which follow each other in memory are
+ * merged, and large fragments are split, so that the copy takes as few DMA descriptors as possible.
+ *
+ * Like esp_async_memcpy, several requests can be in flight at the same time, as long as the descriptors (the backlog)
+ * are not exhausted. The requests complete in order, each one invoking its own callback.
+ *
+ * @note The callback function is invoked in interrupt context, never do blocking jobs in the callback.
+ * @note The length of every fragment must be aligned like the copy size of esp_async_memcpy.
+ *
+ * @param[in] asmcp Handle of async memcpy driver that returned from esp_async_memcpy_install
+ * @param[in] dst Destination fragments (copy to)
+ * @param[in] dst_num Number of destination fragments
+ * @param[in] src Source fragments (copy from)
+ * @param[in] src_num Number of source fragments
+ * @param[in] cb_isr Callback function, which got invoked in interrupt context once all the fragments are copied. Set to NULL can bypass the callback.
+ * @param[in] cb_args User defined argument to be passed to the callback function
+ * @return
+ *      - ESP_OK: Send memory copy request successfully
+ *      - ESP_ERR_INVALID_ARG: Send memory copy request failed because of invalid argument, e.g. the total lengths of the source and destination fragments differ
+ *      - ESP_FAIL: Send memory copy request failed because of other error, e.g. out of descriptors
+ */
+esp_err_t esp_async_memcpy_sg(async_memcpy_t asmcp, const async_memcpy_iovec_t *dst, size_t dst_num,
+                              const async_memcpy_iovec_t *src, size_t src_num, async_memcpy_isr_cb_t cb_isr, void *cb_args);
+
 /**
  * @brief Async memory copy specific events that supported by the ETM module
  */
@@ -0,0 +1,76 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// DO NOT USE THESE APIS IN ANY APPLICATIONS
+// Descriptor planning of the async memcpy driver, exposed for testing it on the host.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_async_memcpy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Iterator over the DMA buffers of a list of fragments
+ *
+ * Each DMA buffer becomes one descriptor of the chain: fragments which follow each other in memory are merged into the
+ * same buffer, and no buffer is larger than max_buffer_size.
+ */
+typedef struct {
+    const async_memcpy_iovec_t *iov; /*!< Fragments */
+    size_t iov_num;                  /*!< Number of fragments */
+    size_t index;                    /*!< Fragment the next buffer starts in */
+    size_t offset;                   /*!< Offset in this fragment of the next buffer */
+    size_t max_buffer_size;          /*!< Maximum size of a buffer */
+} async_memcpy_sg_iter_t;
+
+/**
+ * @brief Start iterating over the DMA buffers of a list of fragments
+ *
+ * @param[out] iter Iterator
+ * @param[in] iov Fragments, must stay valid while iterating
+ * @param[in] iov_num Number of fragments
+ * @param[in] max_buffer_size Maximum size of a buffer, not 0
+ */
+void async_memcpy_sg_iter_init(async_memcpy_sg_iter_t *iter, const async_memcpy_iovec_t *iov, size_t iov_num, size_t max_buffer_size);
+
+/**
+ * @brief Get the next DMA buffer
+ *
+ * @param[in] iter Iterator
+ * @param[out] buffer Start address of the buffer
+ * @return Size of the buffer, 0 when all the fragments have been walked through
+ */
+size_t async_memcpy_sg_iter_next(async_memcpy_sg_iter_t *iter, uint8_t **buffer);
+
+/**
+ * @brief Get the total length of a list of fragments
+ */
+size_t async_memcpy_sg_total_length(const async_memcpy_iovec_t *iov, size_t iov_num);
+
+/**
+ * @brief Get the number of descriptors needed by a list of fragments
+ */
+size_t async_memcpy_sg_count_buffers(const async_memcpy_iovec_t *iov, size_t iov_num, size_t max_buffer_size);
+
+/**
+ * @brief Copy fragments like the M2M DMA would do with the descriptor chains of the planner
+ *
+ * The TX buffers are streamed into the RX buffers, regardless of where each buffer ends.
+ * Software emulation, used to check and benchmark the planner where no DMA is available.
+ *
+ * @return Number of bytes copied
+ */
+size_t async_memcpy_sg_emulate(const async_memcpy_iovec_t *dst, size_t dst_num,
+                               const async_memcpy_iovec_t *src, size_t src_num, size_t max_buffer_size);
+
+#ifdef __cplusplus
+}
+#endif
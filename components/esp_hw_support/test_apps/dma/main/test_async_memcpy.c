@@ -193,6 +193,68 @@ TEST_CASE("memory copy by DMA on the fly", "[async mcp]")
     TEST_ESP_OK(esp_async_memcpy_uninstall(driver));
 }
 
+static IRAM_ATTR bool test_async_memcpy_sg_cb(async_memcpy_t mcp_hdl, async_memcpy_event_t *event, void *cb_args)
+{
+    SemaphoreHandle_t sem = (SemaphoreHandle_t)cb_args;
+    BaseType_t high_task_wakeup = pdFALSE;
+    xSemaphoreGiveFromISR(sem, &high_task_wakeup);
+    return high_task_wakeup == pdTRUE;
+}
+
+static const uint8_t test_async_memcpy_flash_data[3000] = {1, 2, 3};
+
+TEST_CASE("memory copy scatter-gather fragments", "[async mcp]")
+{
+    async_memcpy_config_t config = ASYNC_MEMCPY_DEFAULT_CONFIG();
+    config.backlog = 16;
+    async_memcpy_t driver = NULL;
+    TEST_ESP_OK(esp_async_memcpy_install(&config, &driver));
+    SemaphoreHandle_t sem = xSemaphoreCreateCounting(2, 0);
+    TEST_ASSERT_NOT_NULL(sem);
+
+    uint8_t *src_buf = heap_caps_malloc(8192, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    uint8_t *dst_buf = heap_caps_calloc(1, 8192, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    TEST_ASSERT_NOT_NULL(src_buf);
+    TEST_ASSERT_NOT_NULL(dst_buf);
+    for (int i = 0; i < 8192; i++) {
+        src_buf[i] = i % 251;
+    }
+
+    // fragments of different lengths on both sides, the first two source fragments are merged
+    async_memcpy_iovec_t src[] = {
+        {src_buf, 100}, {src_buf + 100, 5000}, {src_buf + 6000, 900},
+    };
+    async_memcpy_iovec_t dst[] = {
+        {dst_buf + 4000, 3000}, {dst_buf, 3000},
+    };
+    // a second request in flight, with its own callback
+    async_memcpy_iovec_t src2[] = {{src_buf + 7000, 1000}};
+    async_memcpy_iovec_t dst2[] = {{dst_buf + 7000, 600}, {dst_buf + 7600, 400}};
+    TEST_ESP_OK(esp_async_memcpy_sg(driver, dst, 2, src, 3, test_async_memcpy_sg_cb, sem));
+    TEST_ESP_OK(esp_async_memcpy_sg(driver, dst2, 2, src2, 1, test_async_memcpy_sg_cb, sem));
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(sem, pdMS_TO_TICKS(1000)));
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(sem, pdMS_TO_TICKS(1000)));
+
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(src_buf, dst_buf + 4000, 3000);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(src_buf + 3000, dst_buf, 2100);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(src_buf + 6000, dst_buf + 2100, 900);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(src_buf + 7000, dst_buf + 7000, 1000);
+
+    // the lengths of both sides must match
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_async_memcpy_sg(driver, dst, 1, src, 3, NULL, NULL));
+    // every fragment is checked, not only the first one: the DMA can't access the flash
+    src[2].buffer = (void *)test_async_memcpy_flash_data;
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_async_memcpy_sg(driver, dst, 2, src, 3, NULL, NULL));
+    src[2].buffer = src_buf + 6000;
+    dst[1].buffer = (void *)test_async_memcpy_flash_data;
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_async_memcpy_sg(driver, dst, 2, src, 3, NULL, NULL));
+
+    vSemaphoreDelete(sem);
+    free(src_buf);
+    free(dst_buf);
+    TEST_ESP_OK(esp_async_memcpy_uninstall(driver));
+}
+
 #define TEST_ASYNC_MEMCPY_BENCH_COUNTS   (16)
 static int s_count = 0;
 
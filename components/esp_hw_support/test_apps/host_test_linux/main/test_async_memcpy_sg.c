@@ -0,0 +1,157 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/param.h>
+#include "unity.h"
+#include "esp_private/async_memcpy_sg.h"
+
+/* The M2M DMA is emulated: these tests check the descriptor chains planned by the async memcpy driver
+*/
+
+#define TEST_MAX_BUFFER_SIZE 4092
+
+TEST_CASE("scatter-gather buffers are merged and split", "[async mcp]")
+{
+    static uint8_t mem[3 * TEST_MAX_BUFFER_SIZE];
+    async_memcpy_sg_iter_t iter;
+    uint8_t *buffer = NULL;
+
+    // contiguous fragments and empty ones take a single descriptor
+    async_memcpy_iovec_t contiguous[] = {
+        {mem, 16}, {mem + 16, 0}, {mem + 16, 100}, {mem + 116, 4},
+    };
+    async_memcpy_sg_iter_init(&iter, contiguous, 4, TEST_MAX_BUFFER_SIZE);
+    TEST_ASSERT_EQUAL(120, async_memcpy_sg_iter_next(&iter, &buffer));
+    TEST_ASSERT_EQUAL_PTR(mem, buffer);
+    TEST_ASSERT_EQUAL(0, async_memcpy_sg_iter_next(&iter, &buffer));
+
+    // a gap starts a new descriptor
+    async_memcpy_iovec_t gap[] = {
+        {mem, 16}, {mem + 32, 16}, {mem + 48, 8},
+    };
+    async_memcpy_sg_iter_init(&iter, gap, 3, TEST_MAX_BUFFER_SIZE);
+    TEST_ASSERT_EQUAL(16, async_memcpy_sg_iter_next(&iter, &buffer));
+    TEST_ASSERT_EQUAL_PTR(mem, buffer);
+    TEST_ASSERT_EQUAL(24, async_memcpy_sg_iter_next(&iter, &buffer));
+    TEST_ASSERT_EQUAL_PTR(mem + 32, buffer);
+    TEST_ASSERT_EQUAL(0, async_memcpy_sg_iter_next(&iter, &buffer));
+
+    // large fragments are split, the merge goes on after a split
+    async_memcpy_iovec_t large[] = {
+        {mem, TEST_MAX_BUFFER_SIZE + 8}, {mem + TEST_MAX_BUFFER_SIZE + 8, TEST_MAX_BUFFER_SIZE},
+    };
+    async_memcpy_sg_iter_init(&iter, large, 2, TEST_MAX_BUFFER_SIZE);
+    TEST_ASSERT_EQUAL(TEST_MAX_BUFFER_SIZE, async_memcpy_sg_iter_next(&iter, &buffer));
+    TEST_ASSERT_EQUAL_PTR(mem, buffer);
+    TEST_ASSERT_EQUAL(TEST_MAX_BUFFER_SIZE, async_memcpy_sg_iter_next(&iter, &buffer));
+    TEST_ASSERT_EQUAL_PTR(mem + TEST_MAX_BUFFER_SIZE, buffer);
+    TEST_ASSERT_EQUAL(8, async_memcpy_sg_iter_next(&iter, &buffer));
+    TEST_ASSERT_EQUAL(0, async_memcpy_sg_iter_next(&iter, &buffer));
+
+    TEST_ASSERT_EQUAL(1, async_memcpy_sg_count_buffers(contiguous, 4, TEST_MAX_BUFFER_SIZE));
+    TEST_ASSERT_EQUAL(2, async_memcpy_sg_count_buffers(gap, 3, TEST_MAX_BUFFER_SIZE));
+    TEST_ASSERT_EQUAL(3, async_memcpy_sg_count_buffers(large, 2, TEST_MAX_BUFFER_SIZE));
+    TEST_ASSERT_EQUAL(2 * TEST_MAX_BUFFER_SIZE + 8, async_memcpy_sg_total_length(large, 2));
+    TEST_ASSERT_EQUAL(0, async_memcpy_sg_count_buffers(NULL, 0, TEST_MAX_BUFFER_SIZE));
+}
+
+static size_t test_random_fragments(uint8_t *mem, size_t mem_size, size_t total, async_memcpy_iovec_t *iov, size_t max_iov)
+{
+    size_t num = 0;
+    size_t offset = 0;
+    while (total && num < max_iov) {
+        size_t len = 4 * (1 + rand() % 600);
+        len = (num == max_iov - 1) ? total : MIN(total, len);
+        // every other fragment follows the previous one, to be merged
+        if (rand() % 2) {
+            offset += 4 * (rand() % 8);
+        }
+        TEST_ASSERT(offset + len <= mem_size);
+        iov[num].buffer = mem + offset;
+        iov[num].length = len;
+        offset += len;
+        total -= len;
+        num++;
+    }
+    return num;
+}
+
+TEST_CASE("scatter-gather copy through emulated DMA", "[async mcp]")
+{
+    const size_t mem_size = 64 * 1024;
+    uint8_t *src_mem = malloc(mem_size);
+    uint8_t *dst_mem = malloc(mem_size);
+    uint8_t *expected = malloc(mem_size);
+    async_memcpy_iovec_t src[32];
+    async_memcpy_iovec_t dst[32];
+    TEST_ASSERT_NOT_NULL(src_mem);
+    TEST_ASSERT_NOT_NULL(dst_mem);
+    TEST_ASSERT_NOT_NULL(expected);
+    srand(42);
+
+    for (int round = 0; round < 200; round++) {
+        size_t total = 4 * (1 + rand() % 4096);
+        for (size_t i = 0; i < mem_size; i++) {
+            src_mem[i] = rand();
+        }
+        memset(dst_mem, 0, mem_size);
+        size_t src_num = test_random_fragments(src_mem, mem_size, total, src, 32);
+        size_t dst_num = test_random_fragments(dst_mem, mem_size, total, dst, 32);
+
+        TEST_ASSERT_EQUAL(total, async_memcpy_sg_emulate(dst, dst_num, src, src_num, TEST_MAX_BUFFER_SIZE));
+
+        // gather the source, then scatter it: the destination must match
+        size_t offset = 0;
+        for (size_t i = 0; i < src_num; i++) {
+            memcpy(expected + offset, src[i].buffer, src[i].length);
+            offset += src[i].length;
+        }
+        offset = 0;
+        for (size_t i = 0; i < dst_num; i++) {
+            TEST_ASSERT_EQUAL_HEX8_ARRAY(expected + offset, dst[i].buffer, dst[i].length);
+            offset += dst[i].length;
+        }
+    }
+
+    free(src_mem);
+    free(dst_mem);
+    free(expected);
+}
+
+TEST_CASE("scatter-gather planning performance", "[async mcp]")
+{
+    const int rounds = 20000;
+    static uint8_t src_mem[64 * 1024];
+    static uint8_t dst_mem[64 * 1024];
+    async_memcpy_iovec_t src[32];
+    async_memcpy_iovec_t dst[32];
+    size_t descriptors = 0;
+    size_t bytes = 0;
+    srand(1);
+    size_t src_num = test_random_fragments(src_mem, sizeof(src_mem), 32 * 1024, src, 32);
+    size_t dst_num = test_random_fragments(dst_mem, sizeof(dst_mem), 32 * 1024, dst, 32);
+
+    clock_t start = clock();
+    for (int i = 0; i < rounds; i++) {
+        descriptors += async_memcpy_sg_count_buffers(src, src_num, TEST_MAX_BUFFER_SIZE);
+        descriptors += async_memcpy_sg_count_buffers(dst, dst_num, TEST_MAX_BUFFER_SIZE);
+    }
+    double plan_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (int i = 0; i < rounds / 10; i++) {
+        bytes += async_memcpy_sg_emulate(dst, dst_num, src, src_num, TEST_MAX_BUFFER_SIZE);
+    }
+    double copy_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("planned %zu descriptors from %zu + %zu fragments: %.1f ns per descriptor\n",
+           descriptors / rounds, src_num, dst_num, plan_s * 1e9 / descriptors);
+    printf("emulated copy: %.1f MB/s\n", copy_s > 0 ? bytes / copy_s / 1e6 : 0.0);
+    TEST_ASSERT_EQUAL(rounds / 10 * 32 * 1024, bytes);
+}
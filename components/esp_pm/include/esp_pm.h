@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2016-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2016-2024 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -192,6 +192,57 @@ esp_err_t esp_pm_lock_delete(esp_pm_lock_handle_t handle);
  */
 esp_err_t esp_pm_dump_locks(FILE* stream);
 
+/**
+ * @brief Start recording power management lock events
+ *
+ * Once started, every call to esp_pm_lock_acquire and esp_pm_lock_release is
+ * recorded with a timestamp, the CPU, the task calling it (or ISR) and the
+ * lock count after the call. The locks held when tracing starts are recorded
+ * as well. Events are kept in a ring buffer of CONFIG_PM_LOCK_TRACE_BUF_SIZE
+ * entries, allocated on the first start; the oldest events are overwritten
+ * when it is full.
+ *
+ * Previously recorded events are discarded.
+ *
+ * This function must not be called from an ISR.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_NO_MEM if the buffer can not be allocated
+ *      - ESP_ERR_NOT_SUPPORTED if CONFIG_PM_LOCK_TRACE is not enabled in sdkconfig
+ */
+esp_err_t esp_pm_lock_trace_start(void);
+
+/**
+ * @brief Stop recording power management lock events
+ *
+ * The recorded events are kept until the next esp_pm_lock_trace_start.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_NOT_SUPPORTED if CONFIG_PM_LOCK_TRACE is not enabled in sdkconfig
+ */
+esp_err_t esp_pm_lock_trace_stop(void);
+
+/**
+ * @brief Dump the recorded power management lock events
+ *
+ * Prints the configuration, the existing locks, the existing tasks (with
+ * CONFIG_FREERTOS_USE_TRACE_FACILITY) and the recorded events, oldest first.
+ * The output is meant to be processed on the host by
+ * components/esp_pm/pm_lock_trace.py. Tracing may go on while dumping, events
+ * overwritten in the meantime are counted as lost.
+ *
+ * This function must not be called from an ISR.
+ *
+ * @param stream stream to print information to
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_STATE if tracing was never started
+ *      - ESP_ERR_NOT_SUPPORTED if CONFIG_PM_LOCK_TRACE is not enabled in sdkconfig
+ */
+esp_err_t esp_pm_lock_trace_dump(FILE* stream);
+
 #ifdef __cplusplus
 }
 #endif
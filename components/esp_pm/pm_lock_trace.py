@@ -0,0 +1,313 @@
+#!/usr/bin/env python
+#
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+#
+# This script analyzes the output of esp_pm_lock_trace_dump() (CONFIG_PM_LOCK_TRACE). It reports, for each PM lock:
+# how long it was held and by which tasks, how long it kept the chip out of light sleep or at the maximum CPU
+# frequency, and the energy it cost: the energy the chip would have saved over the trace if this lock alone had not
+# been held, given the current drawn in each power management mode.
+#
+# The currents are rough defaults, measure them on the board for meaningful energy figures.
+#
+# The input is a serial log, only the last dump it contains is analyzed.
+#
+# Usage:
+#   pm_lock_trace.py serial.log
+#   pm_lock_trace.py --current CPU_MAX=32 --current SLEEP=0.13 --voltage 3.3 serial.log
+
+import argparse
+import re
+import sys
+import typing
+
+HEADER_REGEX = re.compile(r'esp_pm: lock_trace start_us=(-?\d+) end_us=(-?\d+) max_freq_mhz=(-?\d+) '
+                          r'min_freq_mhz=(-?\d+) light_sleep=(\d+)')
+LOCK_REGEX = re.compile(r'esp_pm: lock (0x[0-9a-fA-F]+) (\w+) (-?\d+) (\S+)')
+TASK_REGEX = re.compile(r'esp_pm: task (0x[0-9a-fA-F]+) (.*?)\s*$')
+END_REGEX = re.compile(r'esp_pm: end events=(\d+) lost=(\d+)')
+EVENT_REGEX = re.compile(r'^(-?\d+) (0x[0-9a-fA-F]+) (\d+) ([ARH]) (\d+) (\d+) (0x[0-9a-fA-F]+|\(nil\))\s*$')
+
+# esp_pm_lock_type_t, in the order of the enum
+LOCK_TYPES = ('CPU_FREQ_MAX', 'APB_FREQ_MAX', 'NO_LIGHT_SLEEP')
+# Power management modes, from the lowest to the highest power
+MODES = ('SLEEP', 'APB_MIN', 'APB_MAX', 'CPU_MAX')
+# Mode each type of lock keeps the chip in, at least
+LOCK_MODES = {'CPU_FREQ_MAX': 'CPU_MAX', 'APB_FREQ_MAX': 'APB_MAX', 'NO_LIGHT_SLEEP': 'APB_MIN'}
+# Current drawn in each mode, in mA
+DEFAULT_CURRENTS = {'CPU_MAX': 40.0, 'APB_MAX': 25.0, 'APB_MIN': 15.0, 'SLEEP': 0.3}
+
+ISR = 0
+
+
+class Event(object):
+    def __init__(self, time: int, lock: int, lock_type: str, kind: str, count: int, core_id: int, task: int) -> None:
+        self.time = time
+        self.lock = lock
+        self.lock_type = lock_type
+        self.kind = kind  # A: acquired, R: released, H: held when the trace started
+        self.count = count  # Lock count after the event
+        self.core_id = core_id
+        self.task = task
+
+
+class Dump(object):
+    def __init__(self, start_us: int, end_us: int, light_sleep: bool) -> None:
+        self.start_us = start_us
+        self.end_us = end_us
+        self.light_sleep = light_sleep
+        self.locks = {}  # type: typing.Dict[int, typing.Tuple[str, str]]  # lock: type, name
+        self.tasks = {}  # type: typing.Dict[int, str]
+        self.events = []  # type: typing.List[Event]
+        self.lost = 0
+
+
+def parse_address(text: str) -> int:
+    return 0 if text == '(nil)' else int(text, 16)
+
+
+def parse_dump(lines: typing.Iterable[str]) -> Dump:
+    dump = None  # type: typing.Optional[Dump]
+    current = None  # type: typing.Optional[Dump]
+
+    for line in lines:
+        header = HEADER_REGEX.search(line)
+        if header:
+            current = Dump(int(header.group(1)), int(header.group(2)), header.group(5) != '0')
+            continue
+        if current is None:
+            continue
+        end = END_REGEX.search(line)
+        if end:
+            current.lost = int(end.group(2))
+            dump = current
+            current = None
+            continue
+        lock = LOCK_REGEX.search(line)
+        if lock:
+            current.locks[int(lock.group(1), 16)] = (lock.group(2), lock.group(4))
+            continue
+        task = TASK_REGEX.search(line)
+        if task:
+            current.tasks[int(task.group(1), 16)] = task.group(2)
+            continue
+        event = EVENT_REGEX.search(line.strip())
+        if event:
+            lock_type = int(event.group(3))
+            current.events.append(Event(int(event.group(1)), int(event.group(2), 16),
+                                        LOCK_TYPES[lock_type] if lock_type < len(LOCK_TYPES) else 'UNKNOWN',
+                                        event.group(4), int(event.group(5)), int(event.group(6)),
+                                        parse_address(event.group(7))))
+
+    if dump is None:
+        raise ValueError('no complete esp_pm lock trace dump found')
+    return dump
+
+
+class LockStats(object):
+    def __init__(self, lock_type: str) -> None:
+        self.lock_type = lock_type
+        self.mode = LOCK_MODES.get(lock_type, 'APB_MIN')
+        self.held_since = None  # type: typing.Optional[int]
+        self.holder = None  # type: typing.Optional[int]  # Task which took the lock, None if unknown
+        self.acquisitions = 0
+        self.held_us = 0
+        self.holds = []  # type: typing.List[int]  # Durations of the completed holds
+        self.task_held_us = {}  # type: typing.Dict[typing.Optional[int], int]
+        self.task_calls = {}  # type: typing.Dict[typing.Optional[int], int]
+        self.sleep_blocked_us = 0  # Light sleep blocked by this lock alone
+        self.sleep_share_us = 0.0  # Light sleep blocked, shared evenly with the other locks held
+        self.cpu_max_us = 0  # Maximum CPU frequency caused by this lock alone
+        self.cpu_max_share_us = 0.0
+        self.energy_uj = 0.0
+
+
+class Analysis(object):
+    def __init__(self, dump: Dump, currents: typing.Dict[str, float], voltage: float) -> None:
+        self.dump = dump
+        self.currents = currents
+        self.voltage = voltage
+        self.locks = {}  # type: typing.Dict[int, LockStats]
+        # Without events lost, the trace starts with the held locks, otherwise with the oldest event kept
+        self.start_us = dump.events[0].time if dump.lost and dump.events else dump.start_us
+        self.end_us = max([dump.end_us] + [e.time for e in dump.events])
+        self.baseline = 'SLEEP' if dump.light_sleep else 'APB_MIN'
+        self.mode_us = {mode: 0 for mode in MODES}  # type: typing.Dict[str, int]
+        self.energy_uj = 0.0
+        self.sleep_blocked_us = 0
+        self.cpu_max_us = 0
+
+    def _mode(self, held: typing.Iterable[LockStats]) -> str:
+        return max([self.baseline] + [s.mode for s in held], key=MODES.index)
+
+    def _power_mw(self, mode: str) -> float:
+        return self.currents[mode] * self.voltage
+
+    def _account(self, duration: int) -> None:
+        """Charge a period without events to the locks held during it"""
+        if duration <= 0:
+            return
+        held = [s for s in self.locks.values() if s.held_since is not None]
+        mode = self._mode(held)
+        self.mode_us[mode] += duration
+        self.energy_uj += duration * self._power_mw(mode) / 1000
+        for s in held:
+            s.held_us += duration
+            s.task_held_us[s.holder] = s.task_held_us.get(s.holder, 0) + duration
+            without = self._mode(other for other in held if other is not s)
+            s.energy_uj += duration * (self._power_mw(mode) - self._power_mw(without)) / 1000
+
+        if self.dump.light_sleep and held:
+            self.sleep_blocked_us += duration
+            for s in held:
+                s.sleep_share_us += duration / len(held)
+            if len(held) == 1:
+                held[0].sleep_blocked_us += duration
+        cpu_max = [s for s in held if s.mode == 'CPU_MAX']
+        if cpu_max:
+            self.cpu_max_us += duration
+            for s in cpu_max:
+                s.cpu_max_share_us += duration / len(cpu_max)
+            if len(cpu_max) == 1:
+                cpu_max[0].cpu_max_us += duration
+
+    def run(self) -> None:
+        events = self.dump.events
+        # The first event of each lock tells whether it was held at the start of the trace
+        for e in events:
+            if e.lock in self.locks:
+                continue
+            lock_type = self.dump.locks.get(e.lock, (e.lock_type, ''))[0]
+            s = self.locks[e.lock] = LockStats(lock_type)
+            if e.kind in ('H', 'R') or (e.kind == 'A' and e.count > 1):
+                s.held_since = self.start_us
+
+        now = self.start_us
+        for e in events:
+            self._account(e.time - now)
+            now = max(now, e.time)
+            s = self.locks[e.lock]
+            if e.kind == 'H':
+                continue
+            s.task_calls[e.task] = s.task_calls.get(e.task, 0) + 1
+            if e.kind == 'A' and e.count == 1 and s.held_since is None:
+                s.held_since = e.time
+                s.holder = e.task
+                s.acquisitions += 1
+            elif e.kind == 'R' and e.count == 0 and s.held_since is not None:
+                s.holds.append(e.time - s.held_since)
+                s.held_since = None
+                s.holder = None
+        self._account(self.end_us - now)
+
+    def lock_name(self, lock: int) -> str:
+        if lock in self.dump.locks and self.dump.locks[lock][1] != '-':
+            return self.dump.locks[lock][1]
+        return 'lock@0x{:08x}'.format(lock)
+
+    def task_name(self, task: typing.Optional[int]) -> str:
+        if task is None:
+            return '(held before)'
+        if task == ISR:
+            return '(ISR)'
+        return self.dump.tasks.get(task, 'task@0x{:08x}'.format(task))
+
+
+def _ms(us: float) -> str:
+    return '{:.3f}'.format(us / 1000)
+
+
+def _percent(part: float, whole: int) -> str:
+    return '{:.1f}%'.format(100.0 * part / whole) if whole > 0 else '-'
+
+
+def write_report(analysis: Analysis, out: typing.TextIO) -> None:
+    duration = analysis.end_us - analysis.start_us
+    out.write('Trace: {} ms, {} events, {} lost\n'.format(_ms(duration), len(analysis.dump.events), analysis.dump.lost))
+    out.write('Time in each mode:')
+    for mode in reversed(MODES):
+        out.write(' {} {}'.format(mode, _percent(analysis.mode_us[mode], duration)))
+    out.write('\n')
+    out.write('Energy: {:.1f} uJ ({:.3f} mW average at {} V)\n\n'.format(
+        analysis.energy_uj, analysis.energy_uj * 1000 / duration if duration > 0 else 0, analysis.voltage))
+
+    locks = sorted(analysis.locks.items(), key=lambda item: (-item[1].energy_uj, -item[1].held_us))
+    out.write('{:<20} {:<14} {:>6} {:>12} {:>7} {:>10} {:>10} {:>11}\n'.format(
+        'Lock', 'Type', 'Taken', 'Held (ms)', 'Held', 'Max (ms)', 'Mean (ms)', 'Energy (uJ)'))
+    for lock, s in locks:
+        out.write('{:<20} {:<14} {:>6} {:>12} {:>7} {:>10} {:>10} {:>11.1f}\n'.format(
+            analysis.lock_name(lock), s.lock_type, s.acquisitions, _ms(s.held_us), _percent(s.held_us, duration),
+            _ms(max(s.holds)) if s.holds else '-', _ms(sum(s.holds) / len(s.holds)) if s.holds else '-',
+            s.energy_uj))
+
+    if analysis.dump.light_sleep:
+        out.write('\nLight sleep blocked: {} ms ({})\n'.format(_ms(analysis.sleep_blocked_us),
+                                                              _percent(analysis.sleep_blocked_us, duration)))
+        out.write('{:<20} {:>12} {:>12}\n'.format('Lock', 'Alone (ms)', 'Share (ms)'))
+        for lock, s in sorted(locks, key=lambda item: -item[1].sleep_share_us):
+            if s.sleep_share_us > 0:
+                out.write('{:<20} {:>12} {:>12}\n'.format(analysis.lock_name(lock), _ms(s.sleep_blocked_us),
+                                                          _ms(s.sleep_share_us)))
+
+    if analysis.cpu_max_us:
+        out.write('\nMaximum CPU frequency: {} ms ({})\n'.format(_ms(analysis.cpu_max_us),
+                                                                _percent(analysis.cpu_max_us, duration)))
+        out.write('{:<20} {:>12} {:>12}\n'.format('Lock', 'Alone (ms)', 'Share (ms)'))
+        for lock, s in sorted(locks, key=lambda item: -item[1].cpu_max_share_us):
+            if s.cpu_max_share_us > 0:
+                out.write('{:<20} {:>12} {:>12}\n'.format(analysis.lock_name(lock), _ms(s.cpu_max_us),
+                                                          _ms(s.cpu_max_share_us)))
+
+    out.write('\nHolders\n')
+    out.write('{:<20} {:<20} {:>6} {:>12}\n'.format('Lock', 'Task', 'Calls', 'Held (ms)'))
+    for lock, s in locks:
+        for task in sorted(set(s.task_held_us) | set(s.task_calls), key=lambda t: -s.task_held_us.get(t, 0)):
+            out.write('{:<20} {:<20} {:>6} {:>12}\n'.format(analysis.lock_name(lock), analysis.task_name(task),
+                                                            s.task_calls.get(task, 0),
+                                                            _ms(s.task_held_us.get(task, 0))))
+
+
+def parse_current(text: str) -> typing.Tuple[str, float]:
+    mode, _, value = text.partition('=')
+    if mode not in MODES:
+        raise argparse.ArgumentTypeError('unknown mode {}, expected one of {}'.format(mode, ', '.join(MODES)))
+    try:
+        return mode, float(value)
+    except ValueError:
+        raise argparse.ArgumentTypeError('invalid current {}'.format(value))
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description='Analyze esp_pm_lock_trace_dump() output')
+    parser.add_argument('input', nargs='?', help='Serial log containing the dump, stdin if omitted')
+    parser.add_argument('--current', type=parse_current, action='append', default=[], metavar='MODE=mA',
+                        help='Current drawn in a mode ({}), defaults: {}'.format(
+                            ', '.join(MODES), ', '.join('{}={}'.format(m, c) for m, c in DEFAULT_CURRENTS.items())))
+    parser.add_argument('--voltage', type=float, default=3.3, help='Supply voltage, in V')
+    parser.add_argument('-o', '--output', help='Output file, stdout if omitted')
+    args = parser.parse_args()
+
+    if args.input:
+        with open(args.input, 'r', errors='replace') as f:
+            dump = parse_dump(f)
+    else:
+        dump = parse_dump(sys.stdin)
+
+    if dump.lost:
+        sys.stderr.write('Warning: {} events lost, increase CONFIG_PM_LOCK_TRACE_BUF_SIZE\n'.format(dump.lost))
+
+    currents = dict(DEFAULT_CURRENTS)
+    currents.update(args.current)
+    analysis = Analysis(dump, currents, args.voltage)
+    analysis.run()
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            write_report(analysis, f)
+    else:
+        write_report(analysis, sys.stdout)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -1,16 +1,20 @@
 /*
- * SPDX-FileCopyrightText: 2016-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2016-2024 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
 
 #include <stdlib.h>
 #include <string.h>
+#include <inttypes.h>
 #include <sys/lock.h>
 #include "esp_pm.h"
 #include "esp_system.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
 #include "sys/queue.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "esp_private/pm_impl.h"
 #include "esp_timer.h"
 #include "sdkconfig.h"
@@ -45,6 +49,63 @@ static SLIST_HEAD(esp_pm_locks_head, esp_pm_lock) s_list =
 /* Protects the above list */
 static _lock_t s_list_lock;
 
+#ifdef CONFIG_PM_LOCK_TRACE
+typedef enum {
+    PM_LOCK_TRACE_ACQUIRE,          /*!< esp_pm_lock_acquire was called */
+    PM_LOCK_TRACE_RELEASE,          /*!< esp_pm_lock_release was called */
+    PM_LOCK_TRACE_HELD,             /*!< the lock was held when tracing started */
+} pm_lock_trace_event_type_t;
+
+typedef struct {
+    pm_time_t time;                 /*!< esp_timer time of the event */
+    esp_pm_lock_t* lock;            /*!< lock the event is about */
+    TaskHandle_t task;              /*!< calling task, NULL for an ISR */
+    uint16_t count;                 /*!< lock count after the event */
+    uint8_t type;                   /*!< pm_lock_trace_event_type_t */
+    uint8_t core_id: 4;             /*!< CPU the event happened on */
+    uint8_t lock_type: 4;           /*!< esp_pm_lock_type_t of the lock, which may be deleted when dumping */
+} pm_lock_trace_event_t;
+
+static const char s_trace_event_names[] = { 'A', 'R', 'H' };
+
+/* Ring buffer of events, allocated by the first esp_pm_lock_trace_start */
+static pm_lock_trace_event_t* s_trace_buf;
+/* Number of events ever recorded since tracing started, the next one goes to
+ * s_trace_buf[s_trace_head % CONFIG_PM_LOCK_TRACE_BUF_SIZE] */
+static uint32_t s_trace_head;
+static volatile bool s_trace_active;
+/* esp_timer time of the last esp_pm_lock_trace_start and esp_pm_lock_trace_stop */
+static pm_time_t s_trace_start_time;
+static pm_time_t s_trace_stop_time;
+/* Protects the above ring buffer */
+static portMUX_TYPE s_trace_spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+static void IRAM_ATTR pm_lock_trace_record(esp_pm_lock_t* lock, pm_lock_trace_event_type_t type)
+{
+    TaskHandle_t task = xPortInIsrContext() ? NULL : xTaskGetCurrentTaskHandle();
+
+    portENTER_CRITICAL_SAFE(&s_trace_spinlock);
+    /* The time is taken in the critical section, so that events are recorded in time order */
+    pm_lock_trace_event_t* event = &s_trace_buf[s_trace_head++ % CONFIG_PM_LOCK_TRACE_BUF_SIZE];
+    event->time = esp_timer_get_time();
+    event->lock = lock;
+    event->task = task;
+    event->count = lock->count;
+    event->type = type;
+    event->core_id = esp_cpu_get_core_id();
+    event->lock_type = lock->type;
+    portEXIT_CRITICAL_SAFE(&s_trace_spinlock);
+}
+
+#define PM_LOCK_TRACE(lock, type) do { \
+        if (s_trace_active) { \
+            pm_lock_trace_record(lock, type); \
+        } \
+    } while (0)
+#else
+#define PM_LOCK_TRACE(lock, type) do { } while (0)
+#endif // CONFIG_PM_LOCK_TRACE
+
 
 esp_err_t esp_pm_lock_create(esp_pm_lock_type_t lock_type, int arg,
         const char* name, esp_pm_lock_handle_t* out_handle)
@@ -115,6 +176,7 @@ esp_err_t IRAM_ATTR esp_pm_lock_acquire(esp_pm_lock_handle_t handle)
         handle->times_taken++;
 #endif
     }
+    PM_LOCK_TRACE(handle, PM_LOCK_TRACE_ACQUIRE);
     portEXIT_CRITICAL_SAFE(&handle->spinlock);
     return ESP_OK;
 }
@@ -142,6 +204,7 @@ esp_err_t IRAM_ATTR esp_pm_lock_release(esp_pm_lock_handle_t handle)
 #endif
         esp_pm_impl_switch_mode(handle->mode, MODE_UNLOCK, now);
     }
+    PM_LOCK_TRACE(handle, PM_LOCK_TRACE_RELEASE);
 out:
     portEXIT_CRITICAL_SAFE(&handle->spinlock);
     return ret;
@@ -207,3 +270,124 @@ esp_err_t esp_pm_dump_locks(FILE* stream)
 #endif
     return ESP_OK;
 }
+
+esp_err_t esp_pm_lock_trace_start(void)
+{
+#ifndef CONFIG_PM_LOCK_TRACE
+    return ESP_ERR_NOT_SUPPORTED;
+#else
+    if (s_trace_buf == NULL) {
+        /* Written to from esp_pm_lock_acquire/release, which may run with the cache disabled */
+        pm_lock_trace_event_t* buf = heap_caps_calloc(CONFIG_PM_LOCK_TRACE_BUF_SIZE, sizeof(*buf),
+                                                      MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (buf == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        s_trace_buf = buf;
+    }
+
+    _lock_acquire(&s_list_lock);
+    portENTER_CRITICAL(&s_trace_spinlock);
+    s_trace_head = 0;
+    s_trace_start_time = esp_timer_get_time();
+    s_trace_stop_time = 0;
+    portEXIT_CRITICAL(&s_trace_spinlock);
+    /* Enabled before the held locks are recorded, so that no event is missed in between.
+     * Each event records the lock count, which tells the state of the lock anyway. */
+    s_trace_active = true;
+    esp_pm_lock_t* it;
+    SLIST_FOREACH(it, &s_list, next) {
+        portENTER_CRITICAL(&it->spinlock);
+        if (it->count > 0) {
+            pm_lock_trace_record(it, PM_LOCK_TRACE_HELD);
+        }
+        portEXIT_CRITICAL(&it->spinlock);
+    }
+    _lock_release(&s_list_lock);
+    return ESP_OK;
+#endif
+}
+
+esp_err_t esp_pm_lock_trace_stop(void)
+{
+#ifndef CONFIG_PM_LOCK_TRACE
+    return ESP_ERR_NOT_SUPPORTED;
+#else
+    if (s_trace_active) {
+        s_trace_active = false;
+        s_trace_stop_time = esp_timer_get_time();
+    }
+    return ESP_OK;
+#endif
+}
+
+#ifdef CONFIG_PM_LOCK_TRACE
+static void pm_lock_trace_dump_tasks(FILE* stream)
+{
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+    UBaseType_t task_count = uxTaskGetNumberOfTasks();
+    /* A few more, in case tasks are created meanwhile */
+    TaskStatus_t* tasks = calloc(task_count + 4, sizeof(TaskStatus_t));
+    if (tasks == NULL) {
+        return;
+    }
+    task_count = uxTaskGetSystemState(tasks, task_count + 4, NULL);
+    for (UBaseType_t i = 0; i < task_count; ++i) {
+        fprintf(stream, "esp_pm: task %p %s\n", tasks[i].xHandle, tasks[i].pcTaskName);
+    }
+    free(tasks);
+#endif
+}
+#endif // CONFIG_PM_LOCK_TRACE
+
+esp_err_t esp_pm_lock_trace_dump(FILE* stream)
+{
+#ifndef CONFIG_PM_LOCK_TRACE
+    return ESP_ERR_NOT_SUPPORTED;
+#else
+    if (s_trace_buf == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_pm_config_t config = { 0 };
+    esp_pm_get_configuration(&config);
+
+    portENTER_CRITICAL(&s_trace_spinlock);
+    uint32_t end = s_trace_head;
+    pm_time_t start_time = s_trace_start_time;
+    pm_time_t end_time = s_trace_stop_time ? s_trace_stop_time : esp_timer_get_time();
+    portEXIT_CRITICAL(&s_trace_spinlock);
+    uint32_t first = end > CONFIG_PM_LOCK_TRACE_BUF_SIZE ? end - CONFIG_PM_LOCK_TRACE_BUF_SIZE : 0;
+    uint32_t lost = first;
+
+    fprintf(stream, "esp_pm: lock_trace start_us=%lld end_us=%lld max_freq_mhz=%d min_freq_mhz=%d light_sleep=%d\n",
+            start_time, end_time, config.max_freq_mhz, config.min_freq_mhz, config.light_sleep_enable);
+    _lock_acquire(&s_list_lock);
+    esp_pm_lock_t* it;
+    SLIST_FOREACH(it, &s_list, next) {
+        fprintf(stream, "esp_pm: lock %p %s %d %s\n", it, s_lock_type_names[it->type], it->arg,
+                it->name ? it->name : "-");
+    }
+    _lock_release(&s_list_lock);
+    pm_lock_trace_dump_tasks(stream);
+
+    for (uint32_t i = first; i < end; ++i) {
+        pm_lock_trace_event_t event;
+        bool valid;
+        portENTER_CRITICAL(&s_trace_spinlock);
+        /* Tracing goes on: the event may have been overwritten, or discarded by a restart */
+        valid = s_trace_head >= end && s_trace_head - i <= CONFIG_PM_LOCK_TRACE_BUF_SIZE;
+        if (valid) {
+            event = s_trace_buf[i % CONFIG_PM_LOCK_TRACE_BUF_SIZE];
+        }
+        portEXIT_CRITICAL(&s_trace_spinlock);
+        if (!valid) {
+            lost++;
+            continue;
+        }
+        fprintf(stream, "%lld %p %d %c %d %d %p\n", event.time, event.lock, event.lock_type,
+                s_trace_event_names[event.type], event.count, event.core_id, event.task);
+    }
+    fprintf(stream, "esp_pm: end events=%"PRIu32" lost=%"PRIu32"\n", end - lost, lost);
+    return ESP_OK;
+#endif
+}
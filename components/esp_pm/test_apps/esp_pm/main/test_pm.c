@@ -7,6 +7,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <time.h>
 #include <sys/time.h>
 #include <sys/param.h>
@@ -85,6 +86,56 @@ TEST_CASE("Can switch frequency using esp_pm_configure", "[pm]")
     switch_freq(orig_freq_mhz);
 }
 
+#if CONFIG_PM_LOCK_TRACE
+TEST_CASE("PM lock events are traced", "[pm]")
+{
+    esp_pm_lock_handle_t held_lock;
+    esp_pm_lock_handle_t lock;
+    char *buf = NULL;
+    size_t size = 0;
+    char line[64];
+
+    TEST_ESP_OK(esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "trace_held", &held_lock));
+    TEST_ESP_OK(esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "trace_test", &lock));
+    TEST_ESP_OK(esp_pm_lock_acquire(held_lock));
+
+    TEST_ESP_OK(esp_pm_lock_trace_start());
+    TEST_ESP_OK(esp_pm_lock_acquire(lock));
+    TEST_ESP_OK(esp_pm_lock_acquire(lock));
+    TEST_ESP_OK(esp_pm_lock_release(lock));
+    TEST_ESP_OK(esp_pm_lock_release(lock));
+    TEST_ESP_OK(esp_pm_lock_release(held_lock));
+    TEST_ESP_OK(esp_pm_lock_trace_stop());
+    /* Not traced */
+    TEST_ESP_OK(esp_pm_lock_acquire(lock));
+    TEST_ESP_OK(esp_pm_lock_release(lock));
+
+    FILE *stream = open_memstream(&buf, &size);
+    TEST_ASSERT_NOT_NULL(stream);
+    TEST_ESP_OK(esp_pm_lock_trace_dump(stream));
+    fclose(stream);
+    printf("%s", buf);
+
+    TEST_ASSERT_NOT_NULL(strstr(buf, "esp_pm: lock_trace start_us="));
+    snprintf(line, sizeof(line), "esp_pm: lock %p CPU_FREQ_MAX 0 trace_test\n", lock);
+    TEST_ASSERT_NOT_NULL(strstr(buf, line));
+    /* The held lock is recorded first, then each call with the lock count after it */
+    const char *expected[] = { "2 H 1 ", "0 A 1 ", "0 A 2 ", "0 R 1 ", "0 R 0 ", "2 R 0 " };
+    const char *pos = buf;
+    for (int i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        snprintf(line, sizeof(line), " %p %s", i == 0 || i == 5 ? held_lock : lock, expected[i]);
+        pos = strstr(pos, line);
+        TEST_ASSERT_NOT_NULL_MESSAGE(pos, line);
+    }
+    /* Other locks, e.g. the ones of the FreeRTOS idle hooks, may be traced meanwhile */
+    TEST_ASSERT_NOT_NULL(strstr(pos, " lost=0\n"));
+    free(buf);
+
+    TEST_ESP_OK(esp_pm_lock_delete(lock));
+    TEST_ESP_OK(esp_pm_lock_delete(held_lock));
+}
+#endif // CONFIG_PM_LOCK_TRACE
+
 #if CONFIG_FREERTOS_USE_TICKLESS_IDLE
 
 static void light_sleep_enable(void)
@@ -12,8 +12,19 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <string.h>
+#include <pthread.h>
 #include "esp_rom_crc.h"
 
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CRC_HAS_PCLMUL 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
 static const uint32_t crc32_le_table[256] = {
     0x00000000L, 0x77073096L, 0xee0e612cL, 0x990951baL, 0x076dc419L, 0x706af48fL, 0xe963a535L, 0x9e6495a3L,
     0x0edb8832L, 0x79dcb8a4L, 0xe0d5e91eL, 0x97d2d988L, 0x09b64c2bL, 0x7eb17cbdL, 0xe7b82d07L, 0x90bf1d91L,
@@ -163,10 +174,179 @@ static uint8_t crc8_be_table[256] = {
     0xde, 0xd9, 0xd0, 0xd7, 0xc2, 0xc5, 0xcc, 0xcb, 0xe6, 0xe1, 0xe8, 0xef, 0xfa, 0xfd, 0xf4, 0xf3
 };
 
+/*
+ * Slicing-by-8: slice[k][i] is the CRC contribution of byte i followed by k zero bytes,
+ * so eight input bytes are folded into the CRC with eight independent table lookups.
+ * slice[0] is the byte-wise table above, the others are derived from it at first use.
+ */
+#define CRC_SLICES 8
+
+static uint32_t crc32_le_slice[CRC_SLICES][256];
+static uint32_t crc32_be_slice[CRC_SLICES][256];
+static uint16_t crc16_le_slice[CRC_SLICES][256];
+static uint16_t crc16_be_slice[CRC_SLICES][256];
+static uint8_t crc8_le_slice[CRC_SLICES][256];
+static uint8_t crc8_be_slice[CRC_SLICES][256];
+static pthread_once_t s_crc_slice_once = PTHREAD_ONCE_INIT;
+#if CRC_HAS_PCLMUL
+static int s_crc_has_pclmul;
+#endif
+
+static void crc_slice_init(void)
+{
+    memcpy(crc32_le_slice[0], crc32_le_table, sizeof(crc32_le_table));
+    memcpy(crc32_be_slice[0], crc32_be_table, sizeof(crc32_be_table));
+    memcpy(crc16_le_slice[0], crc16_le_table, sizeof(crc16_le_table));
+    memcpy(crc16_be_slice[0], crc16_be_table, sizeof(crc16_be_table));
+    memcpy(crc8_le_slice[0], crc8_le_table, sizeof(crc8_le_table));
+    memcpy(crc8_be_slice[0], crc8_be_table, sizeof(crc8_be_table));
+
+    for (int k = 1; k < CRC_SLICES; k++) {
+        for (int i = 0; i < 256; i++) {
+            uint32_t c32_le = crc32_le_slice[k - 1][i];
+            uint32_t c32_be = crc32_be_slice[k - 1][i];
+            uint16_t c16_le = crc16_le_slice[k - 1][i];
+            uint16_t c16_be = crc16_be_slice[k - 1][i];
+
+            crc32_le_slice[k][i] = crc32_le_table[c32_le & 0xff] ^ (c32_le >> 8);
+            crc32_be_slice[k][i] = crc32_be_table[c32_be >> 24] ^ (c32_be << 8);
+            crc16_le_slice[k][i] = crc16_le_table[c16_le & 0xff] ^ (c16_le >> 8);
+            crc16_be_slice[k][i] = crc16_be_table[c16_be >> 8] ^ (uint16_t)(c16_be << 8);
+            crc8_le_slice[k][i] = crc8_le_table[crc8_le_slice[k - 1][i]];
+            crc8_be_slice[k][i] = crc8_be_table[crc8_be_slice[k - 1][i]];
+        }
+    }
+
+#if CRC_HAS_PCLMUL
+    s_crc_has_pclmul = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+static inline uint32_t load_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint32_t load_be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+#if CRC_HAS_PCLMUL
+/*
+ * Reflected CRC32 by folding 64-byte blocks with carry-less multiplication, followed by a
+ * Barrett reduction ("Fast CRC Computation for Generic Polynomials Using PCLMULQDQ
+ * Instruction", Intel). Takes and returns the non-inverted CRC; len >= 64, multiple of 16.
+ */
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t crc32_le_pclmul(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+    static const uint64_t __attribute__((aligned(16))) k1k2[] = { 0x0154442bd4, 0x01c6e41596 };
+    static const uint64_t __attribute__((aligned(16))) k3k4[] = { 0x01751997d0, 0x00ccaa009e };
+    static const uint64_t __attribute__((aligned(16))) k5k0[] = { 0x0163cd6124, 0x0000000000 };
+    static const uint64_t __attribute__((aligned(16))) poly[] = { 0x01db710641, 0x01f7011641 };
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+    x1 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+    x2 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+    x3 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+    x4 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(crc));
+    x0 = _mm_load_si128((const __m128i *)k1k2);
+    buf += 64;
+    len -= 64;
+
+    /* Fold 4 x 128 bits in parallel */
+    while (len >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i *)(buf + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i *)(buf + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i *)(buf + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i *)(buf + 0x30)));
+        buf += 64;
+        len -= 64;
+    }
+
+    /* Fold into 128 bits */
+    x0 = _mm_load_si128((const __m128i *)k3k4);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    while (len >= 16) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128((const __m128i *)buf)), x5);
+        buf += 16;
+        len -= 16;
+    }
+
+    /* Fold 128 to 64 bits */
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x0 = _mm_loadl_epi64((const __m128i *)k5k0);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    /* Barrett reduction to 32 bits */
+    x0 = _mm_load_si128((const __m128i *)poly);
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return _mm_extract_epi32(x1, 1);
+}
+#endif /* CRC_HAS_PCLMUL */
+
 uint32_t esp_rom_crc32_le(uint32_t crc, uint8_t const * buf,uint32_t len)
 {
     uint32_t i;
     crc = ~crc;
+#if defined(__ARM_FEATURE_CRC32)
+    for (; len >= 8; buf += 8, len -= 8) {
+        uint64_t data;
+        memcpy(&data, buf, sizeof(data));
+        crc = __crc32d(crc, data);
+    }
+#else
+    if (len >= 8) {
+        pthread_once(&s_crc_slice_once, crc_slice_init);
+#if CRC_HAS_PCLMUL
+        if (s_crc_has_pclmul && len >= 64) {
+            uint32_t chunk = len & ~15U;
+            crc = crc32_le_pclmul(crc, buf, chunk);
+            buf += chunk;
+            len -= chunk;
+        }
+#endif
+        for (; len >= 8; buf += 8, len -= 8) {
+            uint32_t lo = crc ^ load_le32(buf);
+            uint32_t hi = load_le32(buf + 4);
+            crc = crc32_le_slice[7][lo & 0xff] ^ crc32_le_slice[6][(lo >> 8) & 0xff] ^
+                  crc32_le_slice[5][(lo >> 16) & 0xff] ^ crc32_le_slice[4][lo >> 24] ^
+                  crc32_le_slice[3][hi & 0xff] ^ crc32_le_slice[2][(hi >> 8) & 0xff] ^
+                  crc32_le_slice[1][(hi >> 16) & 0xff] ^ crc32_le_slice[0][hi >> 24];
+        }
+    }
+#endif
     for(i=0;i<len;i++){
         crc = crc32_le_table[(crc^buf[i])&0xff]^(crc>>8);
     }
@@ -177,6 +357,16 @@ uint32_t esp_rom_crc32_be(uint32_t crc, uint8_t const * buf,uint32_t len)
 {
     uint32_t i;
     crc = ~crc;
+    if (len >= 8) {
+        pthread_once(&s_crc_slice_once, crc_slice_init);
+        for (; len >= 8; buf += 8, len -= 8) {
+            uint32_t hi = crc ^ load_be32(buf);
+            crc = crc32_be_slice[7][hi >> 24] ^ crc32_be_slice[6][(hi >> 16) & 0xff] ^
+                  crc32_be_slice[5][(hi >> 8) & 0xff] ^ crc32_be_slice[4][hi & 0xff] ^
+                  crc32_be_slice[3][buf[4]] ^ crc32_be_slice[2][buf[5]] ^
+                  crc32_be_slice[1][buf[6]] ^ crc32_be_slice[0][buf[7]];
+        }
+    }
     for(i=0;i<len;i++){
         crc = crc32_be_table[(crc>>24)^buf[i]]^(crc<<8);
     }
@@ -187,6 +377,16 @@ uint16_t esp_rom_crc16_le(uint16_t crc, uint8_t const * buf, uint32_t len)
 {
     uint32_t i;
     crc = ~crc;
+    if (len >= 8) {
+        pthread_once(&s_crc_slice_once, crc_slice_init);
+        for (; len >= 8; buf += 8, len -= 8) {
+            uint16_t x = crc ^ (buf[0] | (buf[1] << 8));
+            crc = crc16_le_slice[7][x & 0xff] ^ crc16_le_slice[6][x >> 8] ^
+                  crc16_le_slice[5][buf[2]] ^ crc16_le_slice[4][buf[3]] ^
+                  crc16_le_slice[3][buf[4]] ^ crc16_le_slice[2][buf[5]] ^
+                  crc16_le_slice[1][buf[6]] ^ crc16_le_slice[0][buf[7]];
+        }
+    }
     for(i = 0; i < len; i++)
     {
         crc = crc16_le_table[(crc^buf[i])&0xff]^(crc>>8);
@@ -198,6 +398,16 @@ uint16_t esp_rom_crc16_be(uint16_t crc, uint8_t const * buf,uint32_t len)
 {
     uint32_t i;
     crc = ~crc;
+    if (len >= 8) {
+        pthread_once(&s_crc_slice_once, crc_slice_init);
+        for (; len >= 8; buf += 8, len -= 8) {
+            uint16_t x = crc ^ ((buf[0] << 8) | buf[1]);
+            crc = crc16_be_slice[7][x >> 8] ^ crc16_be_slice[6][x & 0xff] ^
+                  crc16_be_slice[5][buf[2]] ^ crc16_be_slice[4][buf[3]] ^
+                  crc16_be_slice[3][buf[4]] ^ crc16_be_slice[2][buf[5]] ^
+                  crc16_be_slice[1][buf[6]] ^ crc16_be_slice[0][buf[7]];
+        }
+    }
     for(i=0;i<len;i++){
         crc = crc16_be_table[(crc>>8)^buf[i]]^(crc<<8);
     }
@@ -208,6 +418,15 @@ uint8_t esp_rom_crc8_le(uint8_t crc, uint8_t const * buf, uint32_t len)
 {
     uint32_t i;
     crc = ~crc;
+    if (len >= 8) {
+        pthread_once(&s_crc_slice_once, crc_slice_init);
+        for (; len >= 8; buf += 8, len -= 8) {
+            crc = crc8_le_slice[7][crc ^ buf[0]] ^ crc8_le_slice[6][buf[1]] ^
+                  crc8_le_slice[5][buf[2]] ^ crc8_le_slice[4][buf[3]] ^
+                  crc8_le_slice[3][buf[4]] ^ crc8_le_slice[2][buf[5]] ^
+                  crc8_le_slice[1][buf[6]] ^ crc8_le_slice[0][buf[7]];
+        }
+    }
     for(i = 0; i < len; i++)
     {
         crc = crc8_le_table[crc^buf[i]];
@@ -219,6 +438,15 @@ uint8_t esp_rom_crc8_be(uint8_t crc, uint8_t const * buf,uint32_t len)
 {
     uint32_t i;
     crc = ~crc;
+    if (len >= 8) {
+        pthread_once(&s_crc_slice_once, crc_slice_init);
+        for (; len >= 8; buf += 8, len -= 8) {
+            crc = crc8_be_slice[7][crc ^ buf[0]] ^ crc8_be_slice[6][buf[1]] ^
+                  crc8_be_slice[5][buf[2]] ^ crc8_be_slice[4][buf[3]] ^
+                  crc8_be_slice[3][buf[4]] ^ crc8_be_slice[2][buf[5]] ^
+                  crc8_be_slice[1][buf[6]] ^ crc8_be_slice[0][buf[7]];
+        }
+    }
     for(i=0;i<len;i++){
         crc = crc8_be_table[crc^buf[i]];
     }
@@ -1,12 +1,15 @@
 #!/usr/bin/env python
 #
-# SPDX-FileCopyrightText: 2022 Espressif Systems (Shanghai) CO LTD
+# SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
 # SPDX-License-Identifier: Apache-2.0
 #
 # This file is used to check the order of execution of ESP_SYSTEM_INIT_FN functions.
 # It compares the priorities found in .c source files to the contents of system_init_fn.txt
 # In case of an inconsistency, the script prints the differences found and returns with a
 # non-zero exit code.
+# It also checks the dependency graph of the functions defined with ESP_SYSTEM_INIT_FN_DEPS:
+# such a function runs on a single core, dependencies must exist, have a lower priority, which also
+# rules out cycles, and run on the same core.
 
 import difflib
 import glob
@@ -18,19 +21,69 @@ import typing
 
 ESP_SYSTEM_INIT_FN_STR = r'ESP_SYSTEM_INIT_FN'
 ESP_SYSTEM_INIT_FN_REGEX_SIMPLE = re.compile(r'ESP_SYSTEM_INIT_FN')
-ESP_SYSTEM_INIT_FN_REGEX = re.compile(r'ESP_SYSTEM_INIT_FN\(([a-zA-Z0-9_]+)\s*,\s*([a-zA-Z\ _0-9\(\)|]+)\s*,\s*([0-9]+)\)')
+ESP_SYSTEM_INIT_FN_REGEX = re.compile(r'ESP_SYSTEM_INIT_FN(_DEPS)?\(([a-zA-Z0-9_]+)\s*,\s*([a-zA-Z\ _0-9\(\)|]+)\s*,\s*([0-9]+)'
+                                      r'(?:\s*,\s*("[a-zA-Z0-9_ ]*"))?\s*[,)]')
+ESP_SYSTEM_INIT_SINGLE_CORE_REGEX = re.compile(r'BIT\([0-9]+\)')
+ESP_SYSTEM_INIT_ALL_CORES_STR = 'ESP_SYSTEM_INIT_ALL_CORES'
 STARTUP_ENTRIES_FILE = 'components/esp_system/system_init_fn.txt'
 
 
 class StartupEntry:
-    def __init__(self, filename: str, func: str, affinity: str, priority: int) -> None:
+    def __init__(self, filename: str, func: str, affinity: str, priority: int,
+                 deps: typing.Optional[typing.List[str]] = None) -> None:
         self.filename = filename
         self.func = func
         self.affinity = affinity
         self.priority = priority
+        self.deps = deps
 
     def __str__(self) -> str:
-        return f'{self.priority:3d}: {self.func} in {self.filename} on {self.affinity}'
+        line = f'{self.priority:3d}: {self.func} in {self.filename} on {self.affinity}'
+        if self.deps is not None:
+            line += f' after [{" ".join(self.deps)}]'
+        return line
+
+
+def check_dependencies(startup_entries: typing.List[StartupEntry]) -> bool:
+    """
+    Check the dependency graph, return True if it is valid.
+    Dependencies are named by function, so names must be unique.
+    """
+    valid = True
+    entries_by_name = {}  # type: typing.Dict[str, StartupEntry]
+    for entry in startup_entries:
+        if entry.func in entries_by_name:
+            print(f'error: {entry.func} is defined in both {entries_by_name[entry.func].filename} and {entry.filename}',
+                  file=sys.stderr)
+            valid = False
+        entries_by_name[entry.func] = entry
+
+    for entry in startup_entries:
+        single_core = bool(ESP_SYSTEM_INIT_SINGLE_CORE_REGEX.fullmatch(entry.affinity))
+        if entry.deps is not None and not single_core:
+            # Other cores must not wait in flash code while the main core does flash operations
+            print(f'error: {entry.func} in {entry.filename} has dependencies, it must run on a single core (BIT(n))',
+                  file=sys.stderr)
+            valid = False
+        for dep in entry.deps or []:
+            dep_entry = entries_by_name.get(dep)
+            if dep_entry is None:
+                print(f'error: {entry.func} in {entry.filename} depends on {dep}, which is not an init function',
+                      file=sys.stderr)
+                valid = False
+            elif dep_entry.priority >= entry.priority:
+                # Dependencies are looked up before the function in the array sorted by priority
+                print((f'error: {entry.func} in {entry.filename} (priority {entry.priority}) depends on {dep} '
+                       f'(priority {dep_entry.priority}), dependencies must have a lower priority'), file=sys.stderr)
+                valid = False
+            elif single_core and dep_entry.affinity not in (entry.affinity, ESP_SYSTEM_INIT_ALL_CORES_STR):
+                print((f'error: {entry.func} in {entry.filename} (on {entry.affinity}) depends on {dep} '
+                       f'(on {dep_entry.affinity}), dependencies must run on the same core'), file=sys.stderr)
+                valid = False
+        if entry.deps is not None and len(set(entry.deps)) != len(entry.deps):
+            print(f'error: {entry.func} in {entry.filename} lists a dependency more than once', file=sys.stderr)
+            valid = False
+    return valid
 
 
 def main() -> None:
@@ -55,7 +108,9 @@ def main() -> None:
         if ESP_SYSTEM_INIT_FN_STR not in file_contents:
             continue
         count_expected = len(ESP_SYSTEM_INIT_FN_REGEX_SIMPLE.findall(file_contents))
-        found = ESP_SYSTEM_INIT_FN_REGEX.findall(file_contents)
+        found = [match for match in ESP_SYSTEM_INIT_FN_REGEX.findall(file_contents)
+                 # ESP_SYSTEM_INIT_FN_DEPS takes the dependencies, ESP_SYSTEM_INIT_FN doesn't
+                 if bool(match[0]) == bool(match[4])]
         if len(found) != count_expected:
             print((f'error: In {filename}, found ESP_SYSTEM_INIT_FN {count_expected} time(s), '
                    f'but regular expression matched {len(found)} time(s)'), file=sys.stderr)
@@ -64,16 +119,19 @@ def main() -> None:
         for match in found:
             entry = StartupEntry(
                 filename=os.path.relpath(filename, idf_path),
-                func=match[0],
-                affinity=match[1],
-                priority=int(match[2])
+                func=match[1],
+                affinity=match[2],
+                priority=int(match[3]),
+                deps=match[4].strip('"').split() if match[0] else None
             )
             startup_entries.append(entry)
 
     #
-    # 2. Sort the ESP_SYSTEM_INIT_FN functions in C source files by priority
+    # 2. Sort the ESP_SYSTEM_INIT_FN functions in C source files by priority and check their dependencies
     #
     startup_entries = list(sorted(startup_entries, key=lambda e: e.priority))
+    if not check_dependencies(startup_entries):
+        has_errors = True
     startup_entries_lines = [str(entry) for entry in startup_entries]
 
     #
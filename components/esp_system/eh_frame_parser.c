@@ -24,6 +24,11 @@
 
 #include "eh_frame_parser_impl.h"
 
+#if CONFIG_ESP_SYSTEM_EH_FRAME_INDEX
+#include <stdlib.h>
+#include "esp_private/startup_internal.h"
+#endif
+
 /**
  * @brief Dimension of an array (number of elements)
  */
@@ -402,11 +407,17 @@ static const table_entry* esp_eh_frame_find_entry(const table_entry* sorted_tabl
     uint32_t is_signed = (encoding & 0xf) >= 0x9;
     uint32_t pc_relative = true;
 
-    /* The following local variables are used for dichotomic search. */
+    /* The following local variables are used for dichotomic search.
+     * The last entry has no next entry to be compared to, it is not part of the
+     * search: it is the one to return if return_address is above all the others. */
     uint32_t found = false;
     uint32_t begin = 0;
-    uint32_t end = length;
-    uint32_t middle = (end + begin) / 2;
+    uint32_t end = length - 1;
+    uint32_t middle = 0;
+
+    if (length == 0) {
+        return NULL;
+    }
 
     /* If the addresses in the table are offsets relative to the eh_frame section,
     * instead of decoding each of them, we can simply encode the return_address
@@ -419,7 +430,9 @@ static const table_entry* esp_eh_frame_find_entry(const table_entry* sorted_tabl
     }
 
     /* Perform dichotomic search. */
-    while (end != 0 && middle != (length - 1) && !found) {
+    while (begin < end && !found) {
+        middle = (end + begin) / 2;
+
         const uint32_t fun_addr = sorted_table[middle].fun_addr;
         const uint32_t nxt_addr = sorted_table[middle + 1].fun_addr;
 
@@ -448,14 +461,16 @@ static const table_entry* esp_eh_frame_find_entry(const table_entry* sorted_tabl
             else
                 end = middle;
         }
+    }
 
-        middle = (end + begin) / 2;
+    if (found) {
+        return sorted_table + middle;
     }
 
-    /* If 'end' reached the beginning of the array, it means the return_address
+    /* If 'begin' remained at the beginning of the array, it means the return_address
      * passed was below the first address of the array, thus, it was wrong.
-     * Else, return the address found. */
-    return (end == 0) ? 0 : sorted_table + middle;
+     * Else, return_address is part of the last function. */
+    return (begin == 0 && length > 1) ? NULL : sorted_table + begin;
 }
 
 /**
@@ -642,15 +657,16 @@ static bool esp_eh_frame_execute(const uint8_t* instructions, const uint32_t ins
 }
 
 /**
- * @brief Initialize the DWARF registers state by parsing and executing CIE instructions.
+ * @brief Parse the CIE fields preceding its instructions.
  *
  * @param cie Pointer to the CIE data.
- * @param frame Pointer to the execution frame.
- * @param state DWARF machine state (DWARF registers).
+ * @param ra_reg Filled with the index of the DWARF register containing the return address.
+ * @param instructions_length Filled with the length, in bytes, of the CIE instructions.
  *
- * @return index of the DWARF register containing the return address.
+ * @return Pointer to the CIE instructions.
  */
-static uint32_t esp_eh_frame_initialize_state(const uint8_t* cie, ExecutionFrame* frame, dwarf_regs* state)
+static const uint8_t* esp_eh_frame_cie_instructions(const uint8_t* cie, uint32_t* ra_reg,
+                                                    uint32_t* instructions_length)
 {
     char c = 0;
     uint32_t size = 0;
@@ -685,7 +701,7 @@ static uint32_t esp_eh_frame_initialize_state(const uint8_t* cie, ExecutionFrame
 
     /* Field describing the index of the DWARF register which will contain
      * the return address. */
-    const uint32_t ra_reg = decode_leb128(cie_data, false, &size);
+    *ra_reg = decode_leb128(cie_data, false, &size);
     cie_data += size;
 
     /* Augmentation data length is encoded in ULEB128. It represents the,
@@ -698,7 +714,25 @@ static uint32_t esp_eh_frame_initialize_state(const uint8_t* cie, ExecutionFrame
      * bug. Subtract the offset of this field (minus sizeof(uint32_t) because
      * `length` field is not part of the structure length) to the total length
      * of the structure. */
-    const uint32_t instructions_length = length - (cie_data - sizeof(uint32_t) - cie);
+    *instructions_length = length - (cie_data - sizeof(uint32_t) - cie);
+
+    return cie_data;
+}
+
+/**
+ * @brief Initialize the DWARF registers state by parsing and executing CIE instructions.
+ *
+ * @param cie Pointer to the CIE data.
+ * @param frame Pointer to the execution frame.
+ * @param state DWARF machine state (DWARF registers).
+ *
+ * @return index of the DWARF register containing the return address.
+ */
+static uint32_t esp_eh_frame_initialize_state(const uint8_t* cie, ExecutionFrame* frame, dwarf_regs* state)
+{
+    uint32_t ra_reg = 0;
+    uint32_t instructions_length = 0;
+    const uint8_t* instructions = esp_eh_frame_cie_instructions(cie, &ra_reg, &instructions_length);
 
     /* Execute the instructions contained in CIE structure. Their goal is to
      * initialize the DWARF registers. Usually it binds the CFA (virtual stack
@@ -708,24 +742,23 @@ static uint32_t esp_eh_frame_initialize_state(const uint8_t* cie, ExecutionFrame
      * it stored on the stack when `call` instruction is used. DWARF will
      * use `eip` (instruction pointer, a.k.a. program counter) as a
      * register containing the return address register. */
-    esp_eh_frame_execute(cie_data, instructions_length, frame, state);
+    esp_eh_frame_execute(instructions, instructions_length, frame, state);
 
     return ra_reg;
 }
 
 /**
- * @brief Modify the execution frame and DWARF VM state for restoring caller's context.
+ * @brief Execute the CIE and FDE instructions to get the rules restoring the caller's context.
  *
  * @param fde Pointer to the Frame Description Entry for the current program counter (defined by frame's MEPC register)
- * @param frame Snapshot of the CPU registers when the CPU stopped its normal execution.
- * @param state DWARF VM registers.
+ * @param frame Snapshot of the CPU registers. Only its program counter is used.
+ * @param state DWARF VM registers, filled with the rules for the program counter.
+ * @param ra_reg Filled with the index of the DWARF register containing the return address.
  *
- * @return Return Address of the current context. Frame has been restored to the previous context
- * (before calling the function program counter is currently going throught).
+ * @return true if the execution went fine, false if an unsupported instruction was met.
  */
-static uint32_t esp_eh_frame_restore_caller_state(const uint32_t* fde,
-                                                  ExecutionFrame* frame,
-                                                  dwarf_regs* state)
+static bool esp_eh_frame_execute_fde(const uint32_t* fde, ExecutionFrame* frame,
+                                     dwarf_regs* state, uint32_t* ra_reg)
 {
     /* Length of the whole Frame Description Entry (FDE), excluding this field. */
     const uint32_t length = fde[ESP_FDE_LENGTH_IDX];
@@ -753,14 +786,33 @@ static uint32_t esp_eh_frame_restore_caller_state(const uint32_t* fde,
     assert(augmentation == 0);
 
     /* Initialize the DWARF state by executing the CIE's instructions. */
-    const uint32_t ra_reg = esp_eh_frame_initialize_state(cie, frame, state);
+    *ra_reg = esp_eh_frame_initialize_state(cie, frame, state);
     state->location = initial_location;
 
     /**
      * Execute the DWARf instructions is order to create rules that will be executed later to retrieve
      * the registers former value.
      */
-    bool success = esp_eh_frame_execute(instructions, instructions_length, frame, state);
+    return esp_eh_frame_execute(instructions, instructions_length, frame, state);
+}
+
+/**
+ * @brief Modify the execution frame and DWARF VM state for restoring caller's context.
+ *
+ * @param fde Pointer to the Frame Description Entry for the current program counter (defined by frame's MEPC register)
+ * @param frame Snapshot of the CPU registers when the CPU stopped its normal execution.
+ * @param state DWARF VM registers.
+ *
+ * @return Return Address of the current context. Frame has been restored to the previous context
+ * (before calling the function program counter is currently going throught).
+ */
+static uint32_t esp_eh_frame_restore_caller_state(const uint32_t* fde,
+                                                  ExecutionFrame* frame,
+                                                  dwarf_regs* state)
+{
+    uint32_t ra_reg = 0;
+
+    bool success = esp_eh_frame_execute_fde(fde, frame, state, &ra_reg);
     if (!success) {
         /* An error occured (unsupported opcode), return PC as the return address.
          * This will be tested by the caller, and the backtrace will be finished. */
@@ -831,6 +883,678 @@ static bool esp_eh_frame_missing_info(const uint32_t* fde, uint32_t pc) {
     return (initial_location + range_length) <= pc;
 }
 
+/**
+ * @brief Parse the .eh_frame_hdr section header.
+ *
+ * @param fde_count Filled with the number of entries in the sorted table.
+ * @param table_enc Filled with the encoding of the sorted table entries.
+ *
+ * @return Pointer to the sorted table of entries.
+ */
+static const table_entry* esp_eh_frame_get_sorted_table(uint32_t* fde_count, uint32_t* table_enc)
+{
+    uint32_t size = 0;
+    uint8_t* enc_values = NULL;
+
+    /* Start parsing the .eh_frame_hdr section. */
+    fde_header* header = (fde_header*) EH_FRAME_HDR_ADDR;
+    assert(header->version == 1);
+
+    /* Make enc_values point to the end of the structure, where the encoded
+     * values start. */
+    enc_values = (uint8_t*) (header + 1);
+
+    /* Retrieve the encoded value eh_frame_ptr. Get the size of the data also. */
+    const uint32_t eh_frame_ptr = esp_eh_frame_get_encoded(enc_values, header->eh_frame_ptr_enc, &size);
+    assert(eh_frame_ptr == (uint32_t) EH_FRAME_ADDR);
+    enc_values += size;
+
+    /* Same for the number of entries in the sorted table. */
+    *fde_count = esp_eh_frame_get_encoded(enc_values, header->fde_count_enc, &size);
+    enc_values += size;
+
+    /* enc_values points now at the beginning of the sorted table. */
+    /* Only support 4-byte entries. */
+    *table_enc = header->table_enc;
+    assert(((*table_enc >> 4) == 0x3) || ((*table_enc >> 4) == 0xB));
+
+    return (const table_entry*) enc_values;
+}
+
+#if CONFIG_ESP_SYSTEM_EH_FRAME_INDEX
+
+/**
+ * @brief Index of the .eh_frame_hdr sorted table and pre-decoded unwinding rules.
+ *
+ * The sorted table is split into regions of contiguous code (IRAM, flash...). Each region is
+ * divided into buckets of 2^CONFIG_ESP_SYSTEM_EH_FRAME_INDEX_BUCKET_SHIFT bytes of code, and each
+ * bucket holds the index of the last function starting at or before the bucket. Finding the entry
+ * of a PC is then a bucket lookup followed by a scan of the few functions starting in the bucket.
+ *
+ * For each FDE, the rules of its widest row, which is the body of the function after the prologue
+ * for the common prologue patterns, are computed once by the DWARF interpreter and kept in a
+ * compact form. The rules are shared between the functions having the same frame layout. PCs
+ * outside of that row, or functions which rules cannot be pre-decoded, are left to the interpreter.
+ */
+#define ESP_EH_FRAME_INDEX_MAX_REGIONS  (8)
+#define ESP_EH_FRAME_INDEX_REGION_GAP   (64 << CONFIG_ESP_SYSTEM_EH_FRAME_INDEX_BUCKET_SHIFT)
+#define ESP_EH_FRAME_INDEX_MAX_SAVED    (12)
+#define ESP_EH_FRAME_INDEX_NO_RULE      (0xffff)
+
+/**
+ * @brief Pre-decoded rules restoring the caller's context.
+ */
+typedef struct {
+    uint16_t cfa_off;   /*!< Offset, in bytes, to add to cfa_reg to get the CFA. */
+    uint8_t cfa_reg;    /*!< Register the CFA is relative to. */
+    uint8_t ra_reg;     /*!< Register containing the return address, once restored. */
+    uint8_t saved_count; /*!< Number of registers saved on the stack. */
+    uint8_t saved_reg[ESP_EH_FRAME_INDEX_MAX_SAVED]; /*!< Registers saved on the stack. */
+    uint8_t saved_off[ESP_EH_FRAME_INDEX_MAX_SAVED]; /*!< Offset, in words, of each saved register below the CFA. */
+} eh_frame_rule;
+
+/**
+ * @brief Index entry of a sorted table entry.
+ */
+typedef struct {
+    uint16_t start;     /*!< The rule applies to PCs in (function + start, function + end]. */
+    uint16_t end;
+    uint16_t rule;      /*!< Index of the rule, ESP_EH_FRAME_INDEX_NO_RULE if the FDE must be interpreted. */
+} eh_frame_index_entry;
+
+/**
+ * @brief Region of contiguous code.
+ */
+typedef struct {
+    uint32_t start;         /*!< Address of the first function of the region. */
+    uint32_t bucket_count;  /*!< Number of buckets covering the region. */
+    uint32_t first_bucket;  /*!< Index of the region's first bucket. */
+} eh_frame_index_region;
+
+typedef struct {
+    const table_entry* table;
+    uint32_t table_enc;
+    uint32_t fde_count;
+    eh_frame_index_entry* entries;  /*!< One entry per sorted table entry, NULL if the index was not built. */
+    eh_frame_rule* rules;
+    uint32_t rule_count;
+    uint16_t* buckets;
+    uint32_t region_count;
+    eh_frame_index_region regions[ESP_EH_FRAME_INDEX_MAX_REGIONS];
+} eh_frame_index;
+
+static eh_frame_index s_index = { 0 };
+
+/**
+ * @brief Get the absolute address of the function described by an entry of the sorted table.
+ */
+static inline uint32_t esp_eh_frame_index_fun_addr(const eh_frame_index* index, uint32_t i)
+{
+    return (uint32_t) esp_eh_frame_decode_address(&index->table[i].fun_addr, index->table_enc);
+}
+
+/**
+ * @brief Check that a DWARF instruction can be pre-decoded and get its length.
+ *
+ * Only the instructions generated for the common prologues and epilogues are accepted:
+ * location advances, CFA definitions, registers save and restore, and state save and restore.
+ * The operands are checked the same way the interpreter asserts them.
+ *
+ * @param instr Instruction to check.
+ * @param remaining Number of bytes left in the instructions array, including the instruction.
+ * @param depth Number of states saved by DW_CFA_REMEMBER_STATE, updated.
+ * @param delta Filled with the location delta of the instruction, 0 if it doesn't advance the location.
+ *
+ * @return Length of the instruction in bytes, 0 if it is not supported.
+ */
+static uint32_t esp_eh_frame_index_check_instruction(const uint8_t* instr, const uint32_t remaining,
+                                                     uint8_t* depth, uint32_t* delta)
+{
+    const uint8_t param = DW_GET_PARAM(instr[0]);
+    uint32_t length = 1;
+    uint32_t size = 0;
+    uint32_t operand1 = 0;
+    uint32_t operand2 = 0;
+
+    *delta = 0;
+
+    switch (DW_GET_OPCODE(instr[0])) {
+        case DW_CFA_ADVANCE_LOC:
+            *delta = param;
+            break;
+        case DW_CFA_OFFSET:
+            operand1 = decode_leb128(&instr[1], false, &size);
+            length += size;
+            if (param >= EXECUTION_FRAME_MAX_REGS || param == ESP_ESH_FRAME_CFA_IDX ||
+                !ESP_EH_FRAME_CFA_OFFSET_VALID(operand1)) {
+                return 0;
+            }
+            break;
+        case DW_CFA_RESTORE:
+            if (param >= EXECUTION_FRAME_MAX_REGS || param == ESP_ESH_FRAME_CFA_IDX) {
+                return 0;
+            }
+            break;
+        default:
+            switch (param) {
+                case DW_CFA_NOP:
+                    break;
+                case DW_CFA_ADVANCE_LOC1:
+                case DW_CFA_ADVANCE_LOC2:
+                case DW_CFA_ADVANCE_LOC4:
+                    /* Little endian delta of 1, 2 or 4 bytes. */
+                    length += (param == DW_CFA_ADVANCE_LOC4) ? 4 : param - 1;
+                    if (length > remaining) {
+                        return 0;
+                    }
+                    for (uint32_t i = length - 1; i > 0; i--) {
+                        *delta = (*delta << 8) | instr[i];
+                    }
+                    break;
+                case DW_CFA_REMEMBER_STATE:
+                    if (*depth != 0) {
+                        return 0;
+                    }
+                    *depth = 1;
+                    break;
+                case DW_CFA_RESTORE_STATE:
+                    if (*depth != 1) {
+                        return 0;
+                    }
+                    *depth = 0;
+                    break;
+                case DW_CFA_DEF_CFA:
+                    operand1 = decode_leb128(&instr[1], false, &size);
+                    length += size;
+                    operand2 = decode_leb128(&instr[length], false, &size);
+                    length += size;
+                    if (!ESP_EH_FRAME_CFA_REG_VALID(operand1) || !ESP_EH_FRAME_CFA_OFF_VALID(operand2)) {
+                        return 0;
+                    }
+                    break;
+                case DW_CFA_DEF_CFA_REGISTER:
+                    operand1 = decode_leb128(&instr[1], false, &size);
+                    length += size;
+                    if (!ESP_EH_FRAME_CFA_REG_VALID(operand1)) {
+                        return 0;
+                    }
+                    break;
+                case DW_CFA_DEF_CFA_OFFSET:
+                    operand1 = decode_leb128(&instr[1], false, &size);
+                    length += size;
+                    if (!ESP_EH_FRAME_CFA_OFF_VALID(operand1)) {
+                        return 0;
+                    }
+                    break;
+                default:
+                    return 0;
+            }
+            break;
+    }
+
+    return (length <= remaining) ? length : 0;
+}
+
+/**
+ * @brief Find the widest row of an FDE that can be pre-decoded.
+ *
+ * The interpreter stops right after the location advance reaching the PC. Thus, all the PCs
+ * between two location advances, (previous location, new location], execute the same instructions
+ * and get the same rules. Such a range is a row. The rows following an unsupported instruction
+ * are left to the interpreter.
+ *
+ * @param instructions FDE instructions.
+ * @param length Length, in bytes, of the FDE instructions.
+ * @param range Size, in bytes, of the function described by the FDE.
+ * @param depth Number of states saved by the CIE instructions.
+ * @param row_start Filled with the start offset of the row, excluded.
+ * @param row_end Filled with the end offset of the row, included.
+ *
+ * @return true if a row was found, false else.
+ */
+static bool esp_eh_frame_index_find_row(const uint8_t* instructions, const uint32_t length,
+                                        const uint32_t range, uint8_t depth,
+                                        uint16_t* row_start, uint16_t* row_end)
+{
+    uint32_t location = 0;
+    uint32_t start = 0;
+    uint32_t best_width = 0;
+    uint32_t delta = 0;
+    uint32_t i = 0;
+    bool complete = false;
+
+    if (range == 0) {
+        return false;
+    }
+
+    while (!complete) {
+        uint32_t end = 0;
+
+        if (i >= length) {
+            /* Past the last location advance, all the instructions are executed. */
+            end = range - 1;
+            complete = true;
+        } else {
+            const uint32_t size = esp_eh_frame_index_check_instruction(&instructions[i], length - i,
+                                                                       &depth, &delta);
+            if (size == 0) {
+                break;
+            }
+            i += size;
+            if (delta == 0) {
+                continue;
+            }
+            location += delta;
+            end = location;
+        }
+
+        /* Only keep the part of the row inside the function that fits in the index entry. */
+        if (end > range - 1) {
+            end = range - 1;
+        }
+        if (end > UINT16_MAX) {
+            end = UINT16_MAX;
+        }
+        if (end > start && end - start > best_width) {
+            best_width = end - start;
+            *row_start = start;
+            *row_end = end;
+        }
+        start = location;
+    }
+
+    return best_width != 0;
+}
+
+/**
+ * @brief Pre-decode the rules of an FDE widest row.
+ *
+ * @param fde Pointer to the Frame Description Entry.
+ * @param entry Index entry, filled with the row.
+ * @param rule Filled with the rules of the row.
+ *
+ * @return true if the FDE has a row which rules could be pre-decoded, false else.
+ */
+static bool esp_eh_frame_index_decode_fde(const uint32_t* fde, eh_frame_index_entry* entry, eh_frame_rule* rule)
+{
+    dwarf_regs state = { 0 };
+    ExecutionFrame frame = { 0 };
+    uint32_t ra_reg = 0;
+    uint32_t cie_length = 0;
+    uint32_t delta = 0;
+    uint8_t depth = 0;
+
+    const uint32_t length = fde[ESP_FDE_LENGTH_IDX];
+    const uint8_t* cie = (uint8_t*) ((uint32_t) &fde[ESP_FDE_CIE_IDX] - fde[ESP_FDE_CIE_IDX]);
+    const uint32_t initial_location = ((uint32_t) &fde[ESP_FDE_INITLOC_IDX] + fde[ESP_FDE_INITLOC_IDX]);
+    const uint32_t range_length = fde[ESP_FDE_RANGELEN_IDX];
+    const uint8_t augmentation = *((uint8_t*) (fde + ESP_FDE_AUGMENTATION_IDX));
+    const uint32_t instructions_length = length - 3 * sizeof(uint32_t) - sizeof(uint8_t);
+    const uint8_t* instructions = ((uint8_t*) (fde + ESP_FDE_AUGMENTATION_IDX)) + 1;
+
+    if (augmentation != 0) {
+        return false;
+    }
+
+    /* The CIE instructions are executed for every PC, they must all be supported. */
+    const uint8_t* cie_instructions = esp_eh_frame_cie_instructions(cie, &ra_reg, &cie_length);
+    for (uint32_t i = 0, size = 0; i < cie_length; i += size) {
+        size = esp_eh_frame_index_check_instruction(&cie_instructions[i], cie_length - i, &depth, &delta);
+        if (size == 0 || delta != 0) {
+            return false;
+        }
+    }
+
+    if (!esp_eh_frame_index_find_row(instructions, instructions_length, range_length, depth,
+                                     &entry->start, &entry->end)) {
+        return false;
+    }
+
+    /* Let the interpreter compute the rules of the row, for any of its PCs. */
+    EXECUTION_FRAME_PC(frame) = initial_location + entry->end;
+    if (!esp_eh_frame_execute_fde(fde, &frame, &state, &ra_reg)) {
+        return false;
+    }
+
+    const uint32_t cfa_val = ESP_EH_FRAME_CFA(&state);
+    if (!ESP_EH_FRAME_CFA_REG_VALID(ESP_EH_FRAME_GET_CFA_REG(cfa_val)) ||
+        ESP_EH_FRAME_GET_CFA_OFF(cfa_val) > UINT16_MAX || ra_reg >= EXECUTION_FRAME_MAX_REGS) {
+        return false;
+    }
+
+    /* Clear the whole structure, rules are compared byte by byte. */
+    memset(rule, 0, sizeof(eh_frame_rule));
+    rule->cfa_reg = ESP_EH_FRAME_GET_CFA_REG(cfa_val);
+    rule->cfa_off = ESP_EH_FRAME_GET_CFA_OFF(cfa_val);
+    rule->ra_reg = ra_reg;
+    for (uint32_t i = 0; i < DIM(state.regs_offset[0]); i++) {
+        const uint32_t value = state.regs_offset[state.offset_idx][i];
+        if (i == ESP_ESH_FRAME_CFA_IDX || value == ESP_EH_FRAME_REG_SAME) {
+            continue;
+        }
+        if (rule->saved_count == ESP_EH_FRAME_INDEX_MAX_SAVED ||
+            ESP_EH_FRAME_GET_REG_OFFSET(value) > UINT8_MAX) {
+            return false;
+        }
+        rule->saved_reg[rule->saved_count] = i;
+        rule->saved_off[rule->saved_count] = ESP_EH_FRAME_GET_REG_OFFSET(value);
+        rule->saved_count++;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get the index of a rule in the index, adding it if it is not part of it yet.
+ *
+ * @param index Index being built.
+ * @param rule Rule to look for.
+ * @param slots Hash table of the rules indexes, slot_mask + 1 entries.
+ * @param slot_mask Mask to apply to the hashes.
+ * @param capacity Number of rules the index can hold, updated when the rules array grows.
+ *
+ * @return Index of the rule, ESP_EH_FRAME_INDEX_NO_RULE if it could not be added.
+ */
+static uint16_t esp_eh_frame_index_add_rule(eh_frame_index* index, const eh_frame_rule* rule,
+                                            uint16_t* slots, const uint32_t slot_mask, uint32_t* capacity)
+{
+    const uint8_t* bytes = (const uint8_t*) rule;
+    uint32_t hash = 2166136261;
+
+    /* FNV-1a hash of the rule. */
+    for (uint32_t i = 0; i < sizeof(eh_frame_rule); i++) {
+        hash = (hash ^ bytes[i]) * 16777619;
+    }
+
+    /* Open addressing: there are at least twice as many slots as FDEs, an empty slot is always met. */
+    for (hash &= slot_mask; slots[hash] != ESP_EH_FRAME_INDEX_NO_RULE; hash = (hash + 1) & slot_mask) {
+        if (memcmp(&index->rules[slots[hash]], rule, sizeof(eh_frame_rule)) == 0) {
+            return slots[hash];
+        }
+    }
+
+    if (index->rule_count == *capacity) {
+        const uint32_t new_capacity = (*capacity == 0) ? 16 : *capacity * 2;
+        eh_frame_rule* rules = realloc(index->rules, new_capacity * sizeof(eh_frame_rule));
+        if (rules == NULL) {
+            return ESP_EH_FRAME_INDEX_NO_RULE;
+        }
+        index->rules = rules;
+        *capacity = new_capacity;
+    }
+
+    index->rules[index->rule_count] = *rule;
+    slots[hash] = index->rule_count;
+    return index->rule_count++;
+}
+
+bool esp_eh_frame_index_init(void)
+{
+    eh_frame_index index = { 0 };
+    eh_frame_index_region* region = NULL;
+    eh_frame_rule rule;
+    uint32_t bucket_count = 0;
+    uint32_t capacity = 0;
+    uint32_t slot_mask = 0;
+    uint32_t prev_addr = 0;
+
+    if (s_index.entries != NULL) {
+        return true;
+    }
+
+    index.table = esp_eh_frame_get_sorted_table(&index.fde_count, &index.table_enc);
+
+    /* Table and rules indexes are stored on 16 bits. */
+    if (index.fde_count < 2 || index.fde_count >= ESP_EH_FRAME_INDEX_NO_RULE) {
+        return false;
+    }
+
+    /* Split the table into regions of contiguous code. The functions beyond the last
+     * region are left to the binary search. */
+    for (uint32_t i = 0; i < index.fde_count; i++) {
+        const uint32_t fun_addr = esp_eh_frame_index_fun_addr(&index, i);
+        if (region == NULL || fun_addr - prev_addr > ESP_EH_FRAME_INDEX_REGION_GAP) {
+            if (index.region_count == ESP_EH_FRAME_INDEX_MAX_REGIONS) {
+                break;
+            }
+            region = &index.regions[index.region_count++];
+            region->start = fun_addr;
+        }
+        region->bucket_count = ((fun_addr - region->start) >> CONFIG_ESP_SYSTEM_EH_FRAME_INDEX_BUCKET_SHIFT) + 1;
+        prev_addr = fun_addr;
+    }
+    for (uint32_t r = 0; r < index.region_count; r++) {
+        index.regions[r].first_bucket = bucket_count;
+        bucket_count += index.regions[r].bucket_count;
+    }
+
+    /* Twice as many slots as FDEs, rounded up to a power of 2. */
+    for (slot_mask = 1; slot_mask < 2 * index.fde_count; slot_mask <<= 1);
+    uint16_t* slots = malloc(slot_mask * sizeof(uint16_t));
+    slot_mask--;
+
+    index.buckets = malloc(bucket_count * sizeof(uint16_t));
+    index.entries = malloc(index.fde_count * sizeof(eh_frame_index_entry));
+    if (slots == NULL || index.buckets == NULL || index.entries == NULL) {
+        free(slots);
+        free(index.buckets);
+        free(index.entries);
+        return false;
+    }
+    memset(slots, 0xff, (slot_mask + 1) * sizeof(uint16_t));
+
+    /* Each bucket holds the last function starting at or before it. */
+    uint32_t fun_idx = 0;
+    for (uint32_t r = 0; r < index.region_count; r++) {
+        region = &index.regions[r];
+        for (uint32_t b = 0; b < region->bucket_count; b++) {
+            const uint32_t bucket_addr = region->start + (b << CONFIG_ESP_SYSTEM_EH_FRAME_INDEX_BUCKET_SHIFT);
+            while (fun_idx + 1 < index.fde_count &&
+                   esp_eh_frame_index_fun_addr(&index, fun_idx + 1) <= bucket_addr) {
+                fun_idx++;
+            }
+            index.buckets[region->first_bucket + b] = fun_idx;
+        }
+    }
+
+    /* Pre-decode the rules of each FDE. If memory runs out, the remaining FDEs are interpreted. */
+    for (uint32_t i = 0; i < index.fde_count; i++) {
+        eh_frame_index_entry* entry = &index.entries[i];
+        const uint32_t* fde = esp_eh_frame_decode_address(&index.table[i].fde_addr, index.table_enc);
+
+        entry->rule = ESP_EH_FRAME_INDEX_NO_RULE;
+        if (esp_eh_frame_index_decode_fde(fde, entry, &rule)) {
+            entry->rule = esp_eh_frame_index_add_rule(&index, &rule, slots, slot_mask, &capacity);
+        }
+    }
+    free(slots);
+
+    /* Release the unused rules. */
+    if (index.rule_count != 0 && index.rule_count < capacity) {
+        eh_frame_rule* rules = realloc(index.rules, index.rule_count * sizeof(eh_frame_rule));
+        if (rules != NULL) {
+            index.rules = rules;
+        }
+    }
+
+    s_index = index;
+    return true;
+}
+
+/**
+ * @brief Find the sorted table entry for the given PC thanks to the buckets.
+ *
+ * @param pc Program counter to look for.
+ *
+ * @return Pointer to the entry found, NULL if the PC is not covered by the index.
+ */
+static const table_entry* esp_eh_frame_index_find_entry(const uint32_t pc)
+{
+    for (uint32_t r = 0; r < s_index.region_count; r++) {
+        const eh_frame_index_region* region = &s_index.regions[r];
+        const uint32_t bucket = (pc - region->start) >> CONFIG_ESP_SYSTEM_EH_FRAME_INDEX_BUCKET_SHIFT;
+
+        if (pc >= region->start && bucket < region->bucket_count) {
+            uint32_t i = s_index.buckets[region->first_bucket + bucket];
+            while (i + 1 < s_index.fde_count && esp_eh_frame_index_fun_addr(&s_index, i + 1) <= pc) {
+                i++;
+            }
+            return &s_index.table[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Get the pre-decoded rules for the given PC.
+ *
+ * @param from_fun Sorted table entry of the function the PC is part of.
+ * @param pc Program counter.
+ *
+ * @return Rules to apply, NULL if the DWARF instructions must be interpreted.
+ */
+static const eh_frame_rule* esp_eh_frame_index_get_rule(const table_entry* from_fun, const uint32_t pc)
+{
+    if (s_index.entries == NULL) {
+        return NULL;
+    }
+
+    const uint32_t i = from_fun - s_index.table;
+    const eh_frame_index_entry* entry = &s_index.entries[i];
+    const uint32_t offset = pc - esp_eh_frame_index_fun_addr(&s_index, i);
+
+    if (entry->rule == ESP_EH_FRAME_INDEX_NO_RULE || offset <= entry->start || offset > entry->end) {
+        return NULL;
+    }
+
+    return &s_index.rules[entry->rule];
+}
+
+/**
+ * @brief Modify the execution frame for restoring caller's context thanks to pre-decoded rules.
+ *
+ * This is equivalent to esp_eh_frame_restore_caller_state() for the PCs the rules apply to.
+ *
+ * @param rule Rules to apply.
+ * @param frame Snapshot of the CPU registers when the CPU stopped its normal execution.
+ *
+ * @return Return Address of the current context.
+ */
+static uint32_t esp_eh_frame_index_restore_caller_state(const eh_frame_rule* rule, ExecutionFrame* frame)
+{
+    const uint32_t cfa_addr = EXECUTION_FRAME_REG(frame, rule->cfa_reg) + rule->cfa_off;
+
+    for (uint32_t i = 0; i < rule->saved_count; i++) {
+        const uint32_t value_addr = cfa_addr - rule->saved_off[i] * sizeof(uint32_t);
+        EXECUTION_FRAME_REG(frame, rule->saved_reg[i]) = *((uint32_t*) value_addr);
+    }
+
+    EXECUTION_FRAME_SP(*frame) = cfa_addr;
+
+    /* See esp_eh_frame_restore_caller_state() for the return address adjustment. */
+    return EXECUTION_FRAME_REG(frame, rule->ra_reg) - 2;
+}
+
+ESP_SYSTEM_INIT_FN_DEPS(esp_eh_frame_index_startup_init, BIT(0), 240, "init_components0")
+{
+    /* Without the index, which only happens when running out of memory,
+     * backtraces are still generated by the interpreter. */
+    esp_eh_frame_index_init();
+    return ESP_OK;
+}
+
+#endif // CONFIG_ESP_SYSTEM_EH_FRAME_INDEX
+
+/**
+ * @brief Find the FDE describing the function the given PC is part of.
+ *
+ * @param sorted_table Sorted table of the .eh_frame_hdr section.
+ * @param fde_count Number of entries in the sorted table.
+ * @param table_enc Encoding of the sorted table entries.
+ * @param pc Program counter to look for.
+ * @param from_fun Filled with the sorted table entry of the function, if found.
+ *
+ * @return Pointer to the FDE, NULL if DWARF information for the PC are missing.
+ */
+static uint32_t* esp_eh_frame_find_fde(const table_entry* sorted_table, const uint32_t fde_count,
+                                       const uint32_t table_enc, const uint32_t pc,
+                                       const table_entry** from_fun)
+{
+    const table_entry* entry = NULL;
+    uint32_t* fde = NULL;
+
+#if CONFIG_ESP_SYSTEM_EH_FRAME_INDEX
+    entry = esp_eh_frame_index_find_entry(pc);
+#endif
+    if (entry == NULL) {
+        entry = esp_eh_frame_find_entry(sorted_table, fde_count, table_enc, pc);
+    }
+
+    /* Get absolute address of FDE entry describing the function where PC left of. */
+    if (entry != NULL) {
+        fde = esp_eh_frame_decode_address(&entry->fde_addr, table_enc);
+    }
+
+    if (esp_eh_frame_missing_info(fde, pc)) {
+        return NULL;
+    }
+
+    *from_fun = entry;
+    return fde;
+}
+
+/**
+ * @brief Go back to the caller of the function the frame's program counter is part of.
+ *
+ * @param sorted_table Sorted table of the .eh_frame_hdr section.
+ * @param fde_count Number of entries in the sorted table.
+ * @param table_enc Encoding of the sorted table entries.
+ * @param frame Snapshot of the CPU registers, modified to be the caller's one.
+ * @param state DWARF VM registers, used if the DWARF instructions need to be executed.
+ * @param end_of_backtrace Set to true if the frame is the last one of the backtrace.
+ *
+ * @return false if the DWARF information for the frame's program counter are missing,
+ *         the frame is not modified in that case. true else.
+ */
+static bool esp_eh_frame_unwind_step(const table_entry* sorted_table, const uint32_t fde_count,
+                                     const uint32_t table_enc, ExecutionFrame* frame,
+                                     dwarf_regs* state, bool* end_of_backtrace)
+{
+    const table_entry* from_fun = NULL;
+    const uint32_t* fde = esp_eh_frame_find_fde(sorted_table, fde_count, table_enc,
+                                                EXECUTION_FRAME_PC(*frame), &from_fun);
+
+    if (fde == NULL) {
+        return false;
+    }
+
+    const uint32_t prev_sp = EXECUTION_FRAME_SP(*frame);
+    uint32_t ra = 0;
+
+    /* Retrieve the return address of the frame. The frame's registers will be modified.
+     * The frame we get then is the caller's one. */
+#if CONFIG_ESP_SYSTEM_EH_FRAME_INDEX
+    const eh_frame_rule* rule = esp_eh_frame_index_get_rule(from_fun, EXECUTION_FRAME_PC(*frame));
+    if (rule != NULL) {
+        ra = esp_eh_frame_index_restore_caller_state(rule, frame);
+    } else
+#endif
+    {
+        /* Clean and set the DWARF register structure. */
+        memset(state, 0, sizeof(dwarf_regs));
+        ra = esp_eh_frame_restore_caller_state(fde, frame, state);
+    }
+
+    /* End of backtrace is reached if the stack and the PC don't change anymore. */
+    *end_of_backtrace = (EXECUTION_FRAME_SP(*frame) == prev_sp) && (EXECUTION_FRAME_PC(*frame) == ra);
+
+    /* Go back to the caller: update stack pointer and program counter. */
+    EXECUTION_FRAME_PC(*frame) = ra;
+
+    return true;
+}
+
 /**
  * @brief When one step of the backtrace is generated, output it to the serial.
  * This function can be overriden as it is defined as weak.
@@ -857,33 +1581,11 @@ void esp_eh_frame_print_backtrace(const void *frame_or)
 
     static dwarf_regs state = { 0 };
     ExecutionFrame frame = *((ExecutionFrame*) frame_or);
-    uint32_t size = 0;
-    uint8_t* enc_values = NULL;
+    uint32_t fde_count = 0;
+    uint32_t table_enc = 0;
     bool end_of_backtrace = false;
 
-    /* Start parsing the .eh_frame_hdr section. */
-    fde_header* header = (fde_header*) EH_FRAME_HDR_ADDR;
-    assert(header->version == 1);
-
-    /* Make enc_values point to the end of the structure, where the encoded
-     * values start. */
-    enc_values = (uint8_t*) (header + 1);
-
-    /* Retrieve the encoded value eh_frame_ptr. Get the size of the data also. */
-    const uint32_t eh_frame_ptr = esp_eh_frame_get_encoded(enc_values, header->eh_frame_ptr_enc, &size);
-    assert(eh_frame_ptr == (uint32_t) EH_FRAME_ADDR);
-    enc_values += size;
-
-    /* Same for the number of entries in the sorted table. */
-    const uint32_t fde_count = esp_eh_frame_get_encoded(enc_values, header->fde_count_enc, &size);
-    enc_values += size;
-
-    /* enc_values points now at the beginning of the sorted table. */
-    /* Only support 4-byte entries. */
-    const uint32_t table_enc = header->table_enc;
-    assert(((table_enc >> 4) == 0x3) || ((table_enc >> 4) == 0xB));
-
-    const table_entry* sorted_table = (const table_entry*) enc_values;
+    const table_entry* sorted_table = esp_eh_frame_get_sorted_table(&fde_count, &table_enc);
 
     panic_print_str("Backtrace:");
     while (!end_of_backtrace) {
@@ -891,17 +1593,7 @@ void esp_eh_frame_print_backtrace(const void *frame_or)
         /* Output one step of the backtrace. */
         esp_eh_frame_generated_step(EXECUTION_FRAME_PC(frame), EXECUTION_FRAME_SP(frame));
 
-        const table_entry* from_fun = esp_eh_frame_find_entry(sorted_table, fde_count,
-                                                              table_enc, EXECUTION_FRAME_PC(frame));
-
-        /* Get absolute address of FDE entry describing the function where PC left of. */
-        uint32_t* fde = NULL;
-
-        if (from_fun != NULL) {
-            fde = esp_eh_frame_decode_address(&from_fun->fde_addr, table_enc);
-        }
-
-        if (esp_eh_frame_missing_info(fde, EXECUTION_FRAME_PC(frame))) {
+        if (!esp_eh_frame_unwind_step(sorted_table, fde_count, table_enc, &frame, &state, &end_of_backtrace)) {
             /* Address was not found in the list. */
             panic_print_str("\r\nBacktrace ended abruptly: cannot find DWARF information for"
                             " instruction at address 0x");
@@ -909,23 +1601,50 @@ void esp_eh_frame_print_backtrace(const void *frame_or)
             panic_print_str("\r\n");
             break;
         }
+    }
 
-        /* Clean and set the DWARF register structure. */
-        memset(&state, 0, sizeof(dwarf_regs));
+    panic_print_str("\r\n");
+}
 
-        const uint32_t prev_sp = EXECUTION_FRAME_SP(frame);
+uint32_t esp_eh_frame_get_backtrace(const void *frame_or, uint32_t *pcs, uint32_t depth)
+{
+    assert(frame_or != NULL);
 
-        /* Retrieve the return address of the frame. The frame's registers will be modified.
-         * The frame we get then is the caller's one. */
-        uint32_t ra = esp_eh_frame_restore_caller_state(fde, &frame, &state);
+    /* Unlike esp_eh_frame_print_backtrace(), this function can be called from several
+     * contexts at once, keep the DWARF registers on the stack. */
+    dwarf_regs state;
+    ExecutionFrame frame = *((ExecutionFrame*) frame_or);
+    uint32_t fde_count = 0;
+    uint32_t table_enc = 0;
+    uint32_t count = 0;
+    bool end_of_backtrace = false;
 
-        /* End of backtrace is reached if the stack and the PC don't change anymore. */
-        end_of_backtrace = (EXECUTION_FRAME_SP(frame) == prev_sp) && (EXECUTION_FRAME_PC(frame) == ra);
+    const table_entry* sorted_table = esp_eh_frame_get_sorted_table(&fde_count, &table_enc);
 
-        /* Go back to the caller: update stack pointer and program counter. */
-        EXECUTION_FRAME_PC(frame) = ra;
+    while (!end_of_backtrace && count < depth) {
+        pcs[count++] = EXECUTION_FRAME_PC(frame);
+
+        if (!esp_eh_frame_unwind_step(sorted_table, fde_count, table_enc, &frame, &state, &end_of_backtrace)) {
+            break;
+        }
     }
 
-    panic_print_str("\r\n");
+    return count;
+}
+
+uint32_t esp_eh_frame_get_function(uint32_t pc)
+{
+    uint32_t fde_count = 0;
+    uint32_t table_enc = 0;
+    const table_entry* from_fun = NULL;
+
+    const table_entry* sorted_table = esp_eh_frame_get_sorted_table(&fde_count, &table_enc);
+    const uint32_t* fde = esp_eh_frame_find_fde(sorted_table, fde_count, table_enc, pc, &from_fun);
+
+    if (fde == NULL) {
+        return 0;
+    }
+
+    return (uint32_t) &fde[ESP_FDE_INITLOC_IDX] + fde[ESP_FDE_INITLOC_IDX];
 }
 #endif //ESP_SYSTEM_USE_EH_FRAME
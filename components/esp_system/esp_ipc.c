@@ -13,6 +13,9 @@
 #include "esp_private/esp_ipc_isr.h"
 #include "esp_attr.h"
 #include "esp_cpu.h"
+#if CONFIG_ESP_IPC_ASYNC
+#include "esp_timer.h"
+#endif
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -48,6 +51,85 @@ static volatile esp_ipc_func_t s_no_block_func[portNUM_PROCESSORS] = { 0 };
 static volatile bool s_no_block_func_and_arg_are_ready[portNUM_PROCESSORS] = { 0 };
 static void * volatile s_no_block_func_arg[portNUM_PROCESSORS];
 
+#if CONFIG_ESP_IPC_ASYNC
+#define IPC_ASYNC_RING_MASK (CONFIG_ESP_IPC_ASYNC_RING_SIZE - 1)
+_Static_assert((CONFIG_ESP_IPC_ASYNC_RING_SIZE & IPC_ASYNC_RING_MASK) == 0, "CONFIG_ESP_IPC_ASYNC_RING_SIZE must be a power of 2");
+
+/*
+ * Asynchronous calls are queued in a bounded multi-producer ring per CPU. Each slot has a sequence number telling
+ * whether it is free for the producer of position seq, or filled for the IPC task at position seq - 1. Producers
+ * claim a position with a compare-and-set on s_async_head, fill the slot, then publish it through its sequence
+ * number. The IPC task is the only consumer, it gives the slot back by advancing its sequence number by the ring size.
+ */
+typedef struct {
+    volatile uint32_t seq;
+    esp_ipc_func_t func;
+    void *arg;
+    esp_ipc_future_t *future;
+    uint32_t submit_us;                 // Low 32 bits of esp_timer_get_time() at submission
+} ipc_async_slot_t;
+
+static DRAM_ATTR ipc_async_slot_t s_async_ring[portNUM_PROCESSORS][CONFIG_ESP_IPC_ASYNC_RING_SIZE];
+static volatile uint32_t s_async_head[portNUM_PROCESSORS];   // Next position claimed by a producer
+static uint32_t s_async_tail[portNUM_PROCESSORS];            // Next position executed by the IPC task
+static esp_ipc_async_stats_t s_async_stats[portNUM_PROCESSORS];
+static portMUX_TYPE s_async_stats_lock = portMUX_INITIALIZER_UNLOCKED;  // Stats are updated and read from both CPUs
+
+static void IRAM_ATTR ipc_async_run_batch(int cpuid)
+{
+    ipc_async_slot_t *ring = s_async_ring[cpuid];
+    esp_ipc_async_stats_t *stats = &s_async_stats[cpuid];
+    uint32_t tail = s_async_tail[cpuid];
+    uint32_t batch = 0;
+    uint64_t total_latency_us = 0;
+    uint32_t max_latency_us = 0;
+
+    while (true) {
+        ipc_async_slot_t *slot = &ring[tail & IPC_ASYNC_RING_MASK];
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != tail + 1) {
+            break; // empty, or the producer of this position has not published it yet
+        }
+        esp_ipc_func_t func = slot->func;
+        void *arg = slot->arg;
+        esp_ipc_future_t *future = slot->future;
+        uint32_t submit_us = slot->submit_us;
+        // Give the slot back before running the callback, so that it can queue another call
+        __atomic_store_n(&slot->seq, tail + CONFIG_ESP_IPC_ASYNC_RING_SIZE, __ATOMIC_RELEASE);
+        tail++;
+
+        (*func)(arg);
+
+        uint32_t latency_us = (uint32_t)esp_timer_get_time() - submit_us;
+        total_latency_us += latency_us;
+        if (latency_us > max_latency_us) {
+            max_latency_us = latency_us;
+        }
+        batch++;
+
+        if (future != NULL) {
+            __atomic_store_n(&future->completed, true, __ATOMIC_RELEASE);
+            // Give last: the caller may reuse or free the future as soon as it takes the semaphore
+            xSemaphoreGive(future->done);
+        }
+    }
+
+    s_async_tail[cpuid] = tail;
+    if (batch != 0) {
+        portENTER_CRITICAL(&s_async_stats_lock);
+        stats->calls += batch;
+        stats->batches++;
+        if (batch > stats->max_batch) {
+            stats->max_batch = batch;
+        }
+        stats->total_latency_us += total_latency_us;
+        if (max_latency_us > stats->max_latency_us) {
+            stats->max_latency_us = max_latency_us;
+        }
+        portEXIT_CRITICAL(&s_async_stats_lock);
+    }
+}
+#endif // CONFIG_ESP_IPC_ASYNC
+
 static void IRAM_ATTR ipc_task(void* arg)
 {
     const int cpuid = (int) arg;
@@ -87,6 +169,10 @@ static void IRAM_ATTR ipc_task(void* arg)
             }
         }
 #endif // !CONFIG_FREERTOS_UNICORE
+
+#if CONFIG_ESP_IPC_ASYNC
+        ipc_async_run_batch(cpuid);
+#endif
     }
     // TODO: currently this is unreachable code. Introduce esp_ipc_uninit
     // function which will signal to both tasks that they can shut down.
@@ -114,6 +200,11 @@ static void esp_ipc_init(void)
 
     for (int i = 0; i < portNUM_PROCESSORS; ++i) {
         task_name[3] = i + (char)'0';
+#if CONFIG_ESP_IPC_ASYNC
+        for (uint32_t pos = 0; pos < CONFIG_ESP_IPC_ASYNC_RING_SIZE; pos++) {
+            s_async_ring[i][pos].seq = pos;
+        }
+#endif
         s_ipc_mutex[i] = xSemaphoreCreateMutexStatic(&s_ipc_mutex_buffer[i]);
         s_ipc_ack[i] = xSemaphoreCreateBinaryStatic(&s_ipc_ack_buffer[i]);
         portBASE_TYPE res = xTaskCreatePinnedToCore(ipc_task, task_name, IPC_STACK_SIZE, (void*) i,
@@ -203,4 +294,91 @@ esp_err_t esp_ipc_call_nonblocking(uint32_t cpu_id, esp_ipc_func_t func, void* a
     return ESP_FAIL;
 }
 
+#if CONFIG_ESP_IPC_ASYNC
+esp_err_t IRAM_ATTR esp_ipc_call_async(uint32_t cpu_id, esp_ipc_func_t func, void* arg, esp_ipc_future_t* future)
+{
+    const bool in_isr = xPortInIsrContext();
+
+    if (cpu_id >= portNUM_PROCESSORS || func == NULL || (in_isr && future != NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_ipc_task_handle[cpu_id] == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    ipc_async_slot_t *ring = s_async_ring[cpu_id];
+    ipc_async_slot_t *slot;
+    uint32_t pos = s_async_head[cpu_id];
+    while (true) {
+        slot = &ring[pos & IPC_ASYNC_RING_MASK];
+        int32_t diff = (int32_t)(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - pos);
+        if (diff == 0) {
+            if (esp_cpu_compare_and_set(&s_async_head[cpu_id], pos, pos + 1)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The IPC task has not executed the call queued one ring size ago yet
+            portENTER_CRITICAL_SAFE(&s_async_stats_lock);
+            s_async_stats[cpu_id].rejected++;
+            portEXIT_CRITICAL_SAFE(&s_async_stats_lock);
+            return ESP_ERR_NO_MEM;
+        }
+        // Another producer claimed this position
+        pos = s_async_head[cpu_id];
+    }
+
+    if (future != NULL) {
+        future->completed = false;
+        future->done = xSemaphoreCreateBinaryStatic(&future->done_buffer);
+    }
+    slot->func = func;
+    slot->arg = arg;
+    slot->future = future;
+    slot->submit_us = (uint32_t)esp_timer_get_time();
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
+    if (in_isr) {
+        vTaskNotifyGiveFromISR(s_ipc_task_handle[cpu_id], NULL);
+    } else {
+#ifdef CONFIG_ESP_IPC_USES_CALLERS_PRIORITY
+        // A synchronous call may have left the IPC task at its caller's priority. As in esp_ipc_call_nonblocking(),
+        // restore the maximum one without the IPC mutex, so that a pending synchronous call does not block this one.
+        vTaskPrioritySet(s_ipc_task_handle[cpu_id], IPC_MAX_PRIORITY);
+#endif
+        xTaskNotifyGive(s_ipc_task_handle[cpu_id]);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_ipc_future_wait(esp_ipc_future_t* future, TickType_t ticks_to_wait)
+{
+    if (xSemaphoreTake(future->done, ticks_to_wait) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_ipc_get_async_stats(uint32_t cpu_id, esp_ipc_async_stats_t* stats)
+{
+    if (cpu_id >= portNUM_PROCESSORS || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&s_async_stats_lock);
+    *stats = s_async_stats[cpu_id];
+    portEXIT_CRITICAL(&s_async_stats_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_ipc_reset_async_stats(uint32_t cpu_id)
+{
+    if (cpu_id >= portNUM_PROCESSORS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&s_async_stats_lock);
+    memset(&s_async_stats[cpu_id], 0, sizeof(esp_ipc_async_stats_t));
+    portEXIT_CRITICAL(&s_async_stats_lock);
+    return ESP_OK;
+}
+#endif // CONFIG_ESP_IPC_ASYNC
+
 #endif // !defined(CONFIG_FREERTOS_UNICORE) || defined(CONFIG_APPTRACE_GCOV_ENABLE)
@@ -6,7 +6,13 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <esp_err.h>
+#include "sdkconfig.h"
+#if CONFIG_ESP_IPC_ASYNC
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -72,6 +78,107 @@ esp_err_t esp_ipc_call(uint32_t cpu_id, esp_ipc_func_t func, void* arg);
  */
 esp_err_t esp_ipc_call_blocking(uint32_t cpu_id, esp_ipc_func_t func, void* arg);
 
+#if CONFIG_ESP_IPC_ASYNC
+
+/**
+ * @brief Completion of an asynchronous IPC call
+ *
+ * The structure is allocated by the caller of esp_ipc_call_async() and must stay valid until the call completes.
+ * Its fields are private.
+ */
+typedef struct {
+    StaticSemaphore_t done_buffer;
+    SemaphoreHandle_t done;
+    volatile bool completed;
+} esp_ipc_future_t;
+
+/**
+ * @brief Statistics of the asynchronous IPC calls of a CPU
+ */
+typedef struct {
+    uint32_t calls;                 /*!< Asynchronous calls executed */
+    uint32_t rejected;              /*!< Calls rejected because the command ring was full */
+    uint32_t batches;               /*!< Wake-ups of the IPC task which executed asynchronous calls */
+    uint32_t max_batch;             /*!< Largest number of calls executed in one wake-up */
+    uint64_t total_latency_us;      /*!< Sum of the times from the submission to the end of the execution of the calls */
+    uint32_t max_latency_us;        /*!< Longest time from the submission to the end of the execution of a call */
+} esp_ipc_async_stats_t;
+
+/**
+ * @brief Queue a callback to be executed on a given CPU
+ *
+ * The call is added to the command ring of the target CPU without taking the IPC mutex, then the IPC task of this
+ * CPU is woken up. The IPC task executes the queued calls in order, after any pending call of the other esp_ipc_*
+ * functions. The IPC task priority is not changed to the caller's one. With CONFIG_ESP_IPC_USES_CALLERS_PRIORITY,
+ * a call from a task sets the IPC task back to its maximum priority, as esp_ipc_call_nonblocking() does. The function
+ * never waits for the IPC mutex, nor for a pending esp_ipc_call() or esp_ipc_call_blocking() to this CPU.
+ *
+ * This function can be called from an interrupt, with a NULL future only.
+ *
+ * @param[in]   cpu_id  CPU where the given function should be executed (0 or 1)
+ * @param[in]   func    Pointer to a function of type void func(void* arg) to be executed
+ * @param[in]   arg     Arbitrary argument of type void* to be passed into the function
+ * @param[out]  future  Completion of the call, to be passed to esp_ipc_future_wait(). Can be NULL.
+ *
+ * @return
+ *      - ESP_ERR_INVALID_ARG if cpu_id or func is invalid, or future is not NULL in an interrupt
+ *      - ESP_ERR_INVALID_STATE if the IPC tasks have not been initialized yet
+ *      - ESP_ERR_NO_MEM if the command ring of the CPU is full
+ *      - ESP_OK otherwise
+ */
+esp_err_t esp_ipc_call_async(uint32_t cpu_id, esp_ipc_func_t func, void* arg, esp_ipc_future_t* future);
+
+/**
+ * @brief Wait for the completion of an asynchronous IPC call
+ *
+ * Must not be called from the IPC task of the CPU the call is queued to.
+ *
+ * @param[in]   future          Future given to esp_ipc_call_async()
+ * @param[in]   ticks_to_wait   Maximum time to wait, in ticks
+ *
+ * @return
+ *      - ESP_ERR_TIMEOUT if the call did not complete in time, the future must then stay valid until it completes
+ *      - ESP_OK if the call completed, the future can be reused
+ */
+esp_err_t esp_ipc_future_wait(esp_ipc_future_t* future, TickType_t ticks_to_wait);
+
+/**
+ * @brief Check whether an asynchronous IPC call has completed, without blocking
+ *
+ * @param[in]   future  Future given to esp_ipc_call_async()
+ *
+ * @return true if the callback has returned. The future can be reused only after esp_ipc_future_wait() returned ESP_OK.
+ */
+static inline bool esp_ipc_future_is_done(const esp_ipc_future_t* future)
+{
+    return __atomic_load_n(&future->completed, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Get the statistics of the asynchronous IPC calls of a CPU
+ *
+ * @param[in]   cpu_id  CPU
+ * @param[out]  stats   Statistics
+ *
+ * @return
+ *      - ESP_ERR_INVALID_ARG if cpu_id or stats is invalid
+ *      - ESP_OK otherwise
+ */
+esp_err_t esp_ipc_get_async_stats(uint32_t cpu_id, esp_ipc_async_stats_t* stats);
+
+/**
+ * @brief Reset the statistics of the asynchronous IPC calls of a CPU
+ *
+ * @param[in]   cpu_id  CPU
+ *
+ * @return
+ *      - ESP_ERR_INVALID_ARG if cpu_id is invalid
+ *      - ESP_OK otherwise
+ */
+esp_err_t esp_ipc_reset_async_stats(uint32_t cpu_id);
+
+#endif // CONFIG_ESP_IPC_ASYNC
+
 #endif // !defined(CONFIG_FREERTOS_UNICORE) || defined(CONFIG_APPTRACE_GCOV_ENABLE)
 
 #ifdef __cplusplus
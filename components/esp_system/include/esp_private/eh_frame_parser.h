@@ -7,6 +7,9 @@
 #ifndef EH_FRAME_PARSER_H
 #define EH_FRAME_PARSER_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -20,6 +23,45 @@ extern "C" {
  */
 void esp_eh_frame_print_backtrace(const void *frame_or);
 
+/**
+ * @brief Get the program counters of the backtrace for the given execution frame.
+ *
+ * Unlike esp_eh_frame_print_backtrace(), nothing is printed, which makes this function
+ * usable from an interrupt handler. It takes about 300 bytes of stack.
+ *
+ * @param frame_or Snapshot of the CPU registers.
+ * @param pcs Array filled with the program counters, starting with the frame's one.
+ * @param depth Size of the pcs array.
+ *
+ * @return Number of program counters written to pcs. The backtrace is truncated if it
+ *         reaches depth or a program counter without DWARF information.
+ */
+uint32_t esp_eh_frame_get_backtrace(const void *frame_or, uint32_t *pcs, uint32_t depth);
+
+/**
+ * @brief Get the start address of the function the given program counter is part of.
+ *
+ * @param pc Program counter.
+ *
+ * @return Address of the function, 0 if there is no DWARF information for the program counter.
+ */
+uint32_t esp_eh_frame_get_function(uint32_t pc);
+
+/**
+ * @brief Build the index used to speed up backtraces.
+ *
+ * The index maps code addresses to `.eh_frame_hdr` entries through fixed size
+ * buckets and holds the pre-decoded unwinding rules of each function body.
+ * Backtrace steps it covers neither search the table nor execute DWARF
+ * instructions. Other steps are done as without the index.
+ *
+ * Only available with CONFIG_ESP_SYSTEM_EH_FRAME_INDEX, which calls this function
+ * at startup. It must not be called from a panic handler as it allocates memory.
+ *
+ * @return true if the index is built, false if there was not enough memory.
+ */
+bool esp_eh_frame_index_init(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,109 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Sampling profiler core: samples buffer and call stacks aggregation.
+ *
+ * Samples are unwound from an interrupt handler into a single producer, single consumer
+ * ring, without locks. A task drains the ring and aggregates the samples by call stack,
+ * each program counter being replaced by the address of the function it is part of.
+ */
+typedef struct {
+    uint32_t *samples;              /*!< Ring of samples, each one is a depth word followed by max_depth program counters */
+    uint32_t sample_slots;          /*!< Number of samples the ring holds, power of 2 */
+    uint32_t head;                  /*!< Samples written, only modified by esp_profiler_core_sample() */
+    uint32_t tail;                  /*!< Samples aggregated, only modified by esp_profiler_core_aggregate() */
+    uint32_t dropped;               /*!< Samples lost because the ring was full */
+    uint32_t max_depth;             /*!< Maximum number of functions of a call stack */
+    uint32_t *stacks;               /*!< Hash table, each slot is a count word, a depth word and max_depth functions */
+    uint32_t stack_slots;           /*!< Number of slots of the hash table, power of 2 */
+    uint32_t max_stacks;            /*!< Maximum number of call stacks in the hash table */
+    uint32_t stack_count;           /*!< Call stacks in the hash table */
+    uint32_t aggregated;            /*!< Samples aggregated in the hash table */
+    uint32_t lost;                  /*!< Samples not aggregated because the hash table was full */
+} esp_profiler_core_t;
+
+/**
+ * @brief Callback called for each aggregated call stack.
+ *
+ * @param arg User argument.
+ * @param count Number of samples of the call stack.
+ * @param funs Functions of the call stack, starting with the sampled one.
+ * @param depth Number of functions in funs.
+ */
+typedef void (*esp_profiler_core_stack_cb_t)(void *arg, uint32_t count, const uint32_t *funs, uint32_t depth);
+
+/**
+ * @brief Allocate the ring and the hash table.
+ *
+ * @param core Core to initialize.
+ * @param ring_samples Number of samples the ring holds, rounded up to a power of 2.
+ * @param max_stacks Maximum number of distinct call stacks aggregated.
+ * @param max_depth Maximum number of functions of a call stack.
+ *
+ * @return true on success, false if the arguments are invalid or there is not enough memory.
+ */
+bool esp_profiler_core_init(esp_profiler_core_t *core, uint32_t ring_samples, uint32_t max_stacks, uint32_t max_depth);
+
+/**
+ * @brief Free the ring and the hash table.
+ *
+ * @param core Core to deinitialize.
+ */
+void esp_profiler_core_deinit(esp_profiler_core_t *core);
+
+/**
+ * @brief Unwind the given frame into the ring.
+ *
+ * Meant to be called from an interrupt handler. It must not be called from several
+ * contexts at once.
+ *
+ * @param core Core.
+ * @param frame Snapshot of the CPU registers of the sampled context.
+ *
+ * @return false if the sample was dropped because the ring is full, true else.
+ */
+bool esp_profiler_core_sample(esp_profiler_core_t *core, const void *frame);
+
+/**
+ * @brief Get the number of samples in the ring.
+ *
+ * @param core Core.
+ *
+ * @return Number of samples waiting to be aggregated.
+ */
+uint32_t esp_profiler_core_pending(const esp_profiler_core_t *core);
+
+/**
+ * @brief Aggregate the samples of the ring in the hash table.
+ *
+ * It must not be called from several contexts at once.
+ *
+ * @param core Core.
+ */
+void esp_profiler_core_aggregate(esp_profiler_core_t *core);
+
+/**
+ * @brief Call the given callback for each aggregated call stack.
+ *
+ * @param core Core.
+ * @param cb Callback.
+ * @param arg Argument passed to the callback.
+ */
+void esp_profiler_core_foreach(const esp_profiler_core_t *core, esp_profiler_core_stack_cb_t cb, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
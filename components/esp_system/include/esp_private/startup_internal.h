@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -44,6 +44,7 @@ void startup_resume_other_cores(void);
 typedef struct {
     esp_err_t (*fn)(void);   /*!< Pointer to the startup function */
     uint32_t cores;     /*!< Bit map of cores where the function has to be called */
+    const char *name;   /*!< Name of the startup function */
 } esp_system_init_fn_t;
 
 /**
@@ -68,7 +69,33 @@ typedef struct {
 #define ESP_SYSTEM_INIT_FN(f, c, priority, ...) \
     static esp_err_t __VA_ARGS__ __esp_system_init_fn_##f(void); \
     static __attribute__((used)) _SECTION_ATTR_IMPL(".esp_system_init_fn", priority) \
-        esp_system_init_fn_t esp_system_init_fn_##f = { .fn = ( __esp_system_init_fn_##f), .cores = (c) }; \
+        esp_system_init_fn_t esp_system_init_fn_##f = { .fn = ( __esp_system_init_fn_##f), .cores = (c), .name = #f }; \
+    static esp_err_t __esp_system_init_fn_##f(void)
+
+/**
+ * @brief Define a system initialization function which declares the functions it depends on
+ *
+ * @param f  function name (identifier)
+ * @param c  core the function is executed on, as a single bit (e.g. BIT(0))
+ * @param priority  integer, priority of the initialization function. It must be higher than the
+ *                  priorities of the dependencies.
+ * @param deps  string literal, space separated names of the initialization functions to wait for.
+ *              They must run on core c too.
+ * @param (varargs)  optional, additional attributes for the function declaration (such as IRAM_ATTR)
+ *
+ * Before the scheduler starts, a core must not run flash code while another core does flash
+ * operations, so no core waits for the functions of another one: the dependencies are on the same
+ * core, and the function runs on this core in priority order. Declaring them lets the startup order
+ * be checked, instead of relying on the priorities alone.
+ *
+ * The dependencies are only checked at build time, by check_system_init_priorities.py: the function
+ * still runs in priority order on its core, there is no dependency-driven scheduling of the init
+ * functions, so dependent functions cannot run in parallel on different cores.
+ */
+#define ESP_SYSTEM_INIT_FN_DEPS(f, c, priority, deps, ...) \
+    static esp_err_t __VA_ARGS__ __esp_system_init_fn_##f(void); \
+    static __attribute__((used)) _SECTION_ATTR_IMPL(".esp_system_init_fn", priority) \
+        esp_system_init_fn_t esp_system_init_fn_##f = { .fn = ( __esp_system_init_fn_##f), .cores = (c), .name = #f }; \
     static esp_err_t __esp_system_init_fn_##f(void)
 
 #ifdef CONFIG_ESP_SYSTEM_SINGLE_CORE_MODE
@@ -0,0 +1,95 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Sampling profiler configuration
+ */
+typedef struct {
+    uint32_t period_us;         /*!< Sampling period, in microseconds */
+    uint32_t max_depth;         /*!< Maximum number of functions recorded per sample, 1 only records the sampled function */
+    uint32_t ring_samples;      /*!< Samples buffered between the sampling interrupt and the aggregation task */
+    uint32_t max_stacks;        /*!< Maximum number of distinct call stacks, samples of other call stacks are counted as lost */
+    uint32_t task_priority;     /*!< Priority of the aggregation task */
+} esp_profiler_config_t;
+
+#define ESP_PROFILER_DEFAULT_CONFIG() { \
+    .period_us = 1000, \
+    .max_depth = 16, \
+    .ring_samples = 64, \
+    .max_stacks = 256, \
+    .task_priority = 1, \
+}
+
+/**
+ * @brief Start sampling the CPU
+ *
+ * The program counter interrupted by a periodic esp_timer interrupt is sampled and the call
+ * stack is unwound thanks to the DWARF information (CONFIG_ESP_SYSTEM_USE_EH_FRAME). Samples are
+ * aggregated by call stack of functions in a low priority task.
+ *
+ * Code running with interrupts disabled, or while the flash cache is disabled, is not sampled.
+ * The results of a previous profiling session are discarded.
+ *
+ * @param config Profiler configuration
+ *
+ * @return
+ *      - ESP_OK: Profiler started
+ *      - ESP_ERR_INVALID_ARG: Invalid configuration
+ *      - ESP_ERR_INVALID_STATE: Profiler already started
+ *      - ESP_ERR_NO_MEM: Not enough memory
+ */
+esp_err_t esp_profiler_start(const esp_profiler_config_t *config);
+
+/**
+ * @brief Stop sampling the CPU
+ *
+ * The results are kept until the profiler is started again or deinitialized.
+ *
+ * @return
+ *      - ESP_OK: Profiler stopped
+ *      - ESP_ERR_INVALID_STATE: Profiler not started
+ */
+esp_err_t esp_profiler_stop(void);
+
+/**
+ * @brief Print the aggregated call stacks
+ *
+ * The profiler may be running or stopped. The output is meant to be parsed by
+ * components/esp_system/profparse.py, which symbolizes it and converts it to the
+ * flamegraph or pprof formats. Each call stack is printed on a line, from the outermost
+ * function to the sampled one, followed by its number of samples:
+ *
+ *     esp_profiler: period_us=1000 samples=1520 dropped=0 lost=0 skipped=3
+ *     0x42001a2c;0x420035f0;0x42004d18 1204
+ *     ...
+ *     esp_profiler: end
+ *
+ * @param stream Stream to print to, stdout if NULL
+ *
+ * @return
+ *      - ESP_OK: Results printed
+ *      - ESP_ERR_INVALID_STATE: Profiler never started
+ */
+esp_err_t esp_profiler_dump(FILE *stream);
+
+/**
+ * @brief Stop the profiler if needed and free its results
+ */
+void esp_profiler_deinit(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,169 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdbool.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+#include "esp_err.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "esp_profiler.h"
+#include "esp_private/profiler_core.h"
+#include "esp_private/cache_utils.h"
+#include "riscv/interrupt.h"
+
+/* Samples are aggregated at least this often, or as soon as the ring is half full */
+#define PROFILER_AGGREGATE_PERIOD_MS    100
+#define PROFILER_TASK_STACK_SIZE        2048
+
+static const char *TAG = "esp_profiler";
+
+static esp_profiler_core_t s_core;
+static bool s_core_initialized;
+static uint32_t s_period_us;
+/* Samples not taken because the flash cache was disabled or no frame was available */
+static volatile uint32_t s_skipped;
+static esp_timer_handle_t s_timer;
+static TaskHandle_t s_task;
+/* Protects the aggregation, run by the task, esp_profiler_stop() and esp_profiler_dump() */
+static SemaphoreHandle_t s_lock;
+
+static void IRAM_ATTR profiler_sample(void *arg)
+{
+    const void *frame = intr_handler_get_frame();
+
+    /* The unwinder and the DWARF information are in flash */
+    if (frame == NULL || !spi_flash_cache_enabled()) {
+        s_skipped++;
+        return;
+    }
+
+    esp_profiler_core_sample(&s_core, frame);
+
+    if (esp_profiler_core_pending(&s_core) == s_core.sample_slots / 2) {
+        BaseType_t yield = pdFALSE;
+        vTaskNotifyGiveFromISR(s_task, &yield);
+        if (yield == pdTRUE) {
+            esp_timer_isr_dispatch_need_yield();
+        }
+    }
+}
+
+static void profiler_task(void *arg)
+{
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(PROFILER_AGGREGATE_PERIOD_MS));
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        esp_profiler_core_aggregate(&s_core);
+        xSemaphoreGive(s_lock);
+    }
+}
+
+esp_err_t esp_profiler_start(const esp_profiler_config_t *config)
+{
+    esp_err_t ret = ESP_OK;
+
+    ESP_RETURN_ON_FALSE(config != NULL && config->period_us != 0 && config->max_depth != 0 &&
+                        config->ring_samples != 0 && config->max_stacks != 0,
+                        ESP_ERR_INVALID_ARG, TAG, "invalid configuration");
+    ESP_RETURN_ON_FALSE(s_timer == NULL, ESP_ERR_INVALID_STATE, TAG, "profiler already started");
+
+    if (s_lock == NULL) {
+        s_lock = xSemaphoreCreateMutex();
+        ESP_RETURN_ON_FALSE(s_lock != NULL, ESP_ERR_NO_MEM, TAG, "no memory for the lock");
+    }
+
+    esp_profiler_deinit();
+    ESP_RETURN_ON_FALSE(esp_profiler_core_init(&s_core, config->ring_samples, config->max_stacks, config->max_depth),
+                        ESP_ERR_NO_MEM, TAG, "no memory for the samples");
+    s_core_initialized = true;
+    s_period_us = config->period_us;
+    s_skipped = 0;
+
+    ESP_GOTO_ON_FALSE(xTaskCreate(profiler_task, "profiler", PROFILER_TASK_STACK_SIZE, NULL,
+                                  config->task_priority, &s_task) == pdPASS,
+                      ESP_ERR_NO_MEM, err, TAG, "no memory for the task");
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = profiler_sample,
+        .dispatch_method = ESP_TIMER_ISR,
+        .name = "profiler",
+    };
+    ESP_GOTO_ON_ERROR(esp_timer_create(&timer_args, &s_timer), err, TAG, "cannot create the timer");
+    ESP_GOTO_ON_ERROR(esp_timer_start_periodic(s_timer, config->period_us), err, TAG, "cannot start the timer");
+    return ESP_OK;
+
+err:
+    esp_profiler_deinit();
+    return ret;
+}
+
+static void stop_sampling(void)
+{
+    if (s_timer != NULL) {
+        esp_timer_stop(s_timer);
+        esp_timer_delete(s_timer);
+        s_timer = NULL;
+    }
+
+    if (s_task != NULL) {
+        /* The task is not aggregating while the lock is held */
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        vTaskDelete(s_task);
+        s_task = NULL;
+        esp_profiler_core_aggregate(&s_core);
+        xSemaphoreGive(s_lock);
+    }
+}
+
+esp_err_t esp_profiler_stop(void)
+{
+    ESP_RETURN_ON_FALSE(s_timer != NULL, ESP_ERR_INVALID_STATE, TAG, "profiler not started");
+
+    stop_sampling();
+    return ESP_OK;
+}
+
+static void print_stack(void *arg, uint32_t count, const uint32_t *funs, uint32_t depth)
+{
+    FILE *stream = (FILE *) arg;
+
+    for (uint32_t i = depth; i > 0; i--) {
+        fprintf(stream, "0x%08"PRIx32"%s", funs[i - 1], i > 1 ? ";" : " ");
+    }
+    fprintf(stream, "%"PRIu32"\n", count);
+}
+
+esp_err_t esp_profiler_dump(FILE *stream)
+{
+    ESP_RETURN_ON_FALSE(s_core_initialized, ESP_ERR_INVALID_STATE, TAG, "profiler never started");
+
+    if (stream == NULL) {
+        stream = stdout;
+    }
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    esp_profiler_core_aggregate(&s_core);
+    fprintf(stream, "esp_profiler: period_us=%"PRIu32" samples=%"PRIu32" dropped=%"PRIu32" lost=%"PRIu32" skipped=%"PRIu32"\n",
+            s_period_us, s_core.aggregated, s_core.dropped, s_core.lost, s_skipped);
+    esp_profiler_core_foreach(&s_core, print_stack, stream);
+    fprintf(stream, "esp_profiler: end\n");
+    xSemaphoreGive(s_lock);
+    return ESP_OK;
+}
+
+void esp_profiler_deinit(void)
+{
+    stop_sampling();
+
+    if (s_core_initialized) {
+        esp_profiler_core_deinit(&s_core);
+        s_core_initialized = false;
+    }
+}
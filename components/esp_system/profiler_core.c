@@ -0,0 +1,148 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_private/profiler_core.h"
+#include "esp_private/eh_frame_parser.h"
+
+/* Words of a sample in the ring: depth, then the program counters */
+#define SAMPLE_WORDS(core)  (1 + (core)->max_depth)
+/* Words of a slot of the hash table: count, depth, then the functions */
+#define STACK_WORDS(core)   (2 + (core)->max_depth)
+
+static uint32_t round_up_pow2(uint32_t n)
+{
+    uint32_t p = 1;
+
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+static uint32_t hash_stack(const uint32_t *funs, uint32_t depth)
+{
+    /* FNV-1a over the function addresses */
+    uint32_t hash = 2166136261u;
+
+    for (uint32_t i = 0; i < depth; i++) {
+        hash = (hash ^ funs[i]) * 16777619u;
+    }
+    return hash;
+}
+
+bool esp_profiler_core_init(esp_profiler_core_t *core, uint32_t ring_samples, uint32_t max_stacks, uint32_t max_depth)
+{
+    if (ring_samples == 0 || max_stacks == 0 || max_depth == 0) {
+        return false;
+    }
+
+    memset(core, 0, sizeof(esp_profiler_core_t));
+    core->max_depth = max_depth;
+    core->sample_slots = round_up_pow2(ring_samples);
+    core->max_stacks = max_stacks;
+    /* Keep the hash table at most 3/4 full so that probing stays short */
+    core->stack_slots = round_up_pow2(max_stacks + max_stacks / 3 + 1);
+
+    core->samples = calloc(core->sample_slots, SAMPLE_WORDS(core) * sizeof(uint32_t));
+    core->stacks = calloc(core->stack_slots, STACK_WORDS(core) * sizeof(uint32_t));
+    if (core->samples == NULL || core->stacks == NULL) {
+        esp_profiler_core_deinit(core);
+        return false;
+    }
+    return true;
+}
+
+void esp_profiler_core_deinit(esp_profiler_core_t *core)
+{
+    free(core->samples);
+    free(core->stacks);
+    core->samples = NULL;
+    core->stacks = NULL;
+}
+
+bool esp_profiler_core_sample(esp_profiler_core_t *core, const void *frame)
+{
+    const uint32_t head = core->head;
+
+    if (head - __atomic_load_n(&core->tail, __ATOMIC_ACQUIRE) >= core->sample_slots) {
+        core->dropped++;
+        return false;
+    }
+
+    uint32_t *sample = &core->samples[(head & (core->sample_slots - 1)) * SAMPLE_WORDS(core)];
+    sample[0] = esp_eh_frame_get_backtrace(frame, &sample[1], core->max_depth);
+
+    /* Publish the sample once it is completely written */
+    __atomic_store_n(&core->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+uint32_t esp_profiler_core_pending(const esp_profiler_core_t *core)
+{
+    return __atomic_load_n(&core->head, __ATOMIC_ACQUIRE) - core->tail;
+}
+
+static void aggregate_stack(esp_profiler_core_t *core, const uint32_t *funs, uint32_t depth)
+{
+    const uint32_t mask = core->stack_slots - 1;
+
+    for (uint32_t i = hash_stack(funs, depth) & mask; ; i = (i + 1) & mask) {
+        uint32_t *slot = &core->stacks[i * STACK_WORDS(core)];
+
+        if (slot[0] == 0) {
+            if (core->stack_count == core->max_stacks) {
+                core->lost++;
+                return;
+            }
+            slot[1] = depth;
+            memcpy(&slot[2], funs, depth * sizeof(uint32_t));
+            core->stack_count++;
+        } else if (slot[1] != depth || memcmp(&slot[2], funs, depth * sizeof(uint32_t)) != 0) {
+            continue;
+        }
+        slot[0]++;
+        core->aggregated++;
+        return;
+    }
+}
+
+void esp_profiler_core_aggregate(esp_profiler_core_t *core)
+{
+    const uint32_t head = __atomic_load_n(&core->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = core->tail;
+
+    while (tail != head) {
+        uint32_t *sample = &core->samples[(tail & (core->sample_slots - 1)) * SAMPLE_WORDS(core)];
+        const uint32_t depth = sample[0];
+
+        /* Replace each program counter by its function, in place, the slot is not
+         * given back to the producer yet. Program counters without DWARF information
+         * (ROM code for example) are kept as they are. */
+        for (uint32_t i = 0; i < depth; i++) {
+            const uint32_t fun = esp_eh_frame_get_function(sample[1 + i]);
+            if (fun != 0) {
+                sample[1 + i] = fun;
+            }
+        }
+        aggregate_stack(core, &sample[1], depth);
+
+        tail++;
+        __atomic_store_n(&core->tail, tail, __ATOMIC_RELEASE);
+    }
+}
+
+void esp_profiler_core_foreach(const esp_profiler_core_t *core, esp_profiler_core_stack_cb_t cb, void *arg)
+{
+    for (uint32_t i = 0; i < core->stack_slots; i++) {
+        const uint32_t *slot = &core->stacks[i * STACK_WORDS(core)];
+
+        if (slot[0] != 0) {
+            cb(arg, slot[0], &slot[2], slot[1]);
+        }
+    }
+}
@@ -0,0 +1,199 @@
+#!/usr/bin/env python
+#
+# SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+#
+# This script converts the output of esp_profiler_dump() (CONFIG_ESP_SYSTEM_PROFILER) into
+# a flamegraph or pprof profile. Function addresses are symbolized with addr2line.
+#
+# The input is a serial log, only the last dump it contains is converted.
+#
+# Usage:
+#   profparse.py --elf build/app.elf serial.log > app.folded
+#   flamegraph.pl app.folded > app.svg
+#
+#   profparse.py --elf build/app.elf --format pprof -o app.pb.gz serial.log
+#   pprof -http=: app.pb.gz
+
+import argparse
+import gzip
+import re
+import subprocess
+import sys
+import typing
+
+HEADER_REGEX = re.compile(r'esp_profiler: period_us=(\d+) samples=(\d+) dropped=(\d+) lost=(\d+) skipped=(\d+)')
+END_REGEX = re.compile(r'esp_profiler: end')
+STACK_REGEX = re.compile(r'((?:0x[0-9a-fA-F]+;)*0x[0-9a-fA-F]+) (\d+)\s*$')
+
+Stack = typing.Tuple[int, ...]  # Function addresses, from the outermost function to the sampled one
+
+
+class Dump(object):
+    def __init__(self, period_us: int, counters: typing.Dict[str, int]) -> None:
+        self.period_us = period_us
+        self.counters = counters
+        self.stacks = {}  # type: typing.Dict[Stack, int]
+
+
+def parse_dump(lines: typing.Iterable[str]) -> Dump:
+    dump = None  # type: typing.Optional[Dump]
+    current = None  # type: typing.Optional[Dump]
+
+    for line in lines:
+        header = HEADER_REGEX.search(line)
+        if header:
+            current = Dump(int(header.group(1)), {name: int(header.group(i + 2))
+                                                  for i, name in enumerate(('samples', 'dropped', 'lost', 'skipped'))})
+            continue
+        if current is None:
+            continue
+        if END_REGEX.search(line):
+            dump = current
+            current = None
+            continue
+        stack = STACK_REGEX.search(line)
+        if stack:
+            funs = tuple(int(addr, 16) for addr in stack.group(1).split(';'))
+            current.stacks[funs] = current.stacks.get(funs, 0) + int(stack.group(2))
+
+    if dump is None:
+        raise ValueError('no complete esp_profiler dump found')
+    return dump
+
+
+def symbolize(addresses: typing.Iterable[int], elf: typing.Optional[str],
+              addr2line: str) -> typing.Dict[int, typing.Tuple[str, str, int]]:
+    """Return the function name, file and line of each address"""
+    addresses = sorted(set(addresses))
+    symbols = {addr: ('0x{:08x}'.format(addr), '', 0) for addr in addresses}
+    if elf is None or not addresses:
+        return symbols
+
+    output = subprocess.check_output([addr2line, '-f', '-C', '-e', elf] + ['0x{:x}'.format(a) for a in addresses])
+    lines = output.decode('utf-8', 'replace').splitlines()
+    for i, addr in enumerate(addresses):
+        name, location = lines[2 * i], lines[2 * i + 1]
+        filename, _, line = location.rpartition(':')
+        line_number = int(line.split()[0]) if line.split() and line.split()[0].isdigit() else 0
+        if name != '??':
+            symbols[addr] = (name, filename if filename != '??' else '', line_number)
+    return symbols
+
+
+def write_folded(dump: Dump, symbols: typing.Dict[int, typing.Tuple[str, str, int]], out: typing.TextIO) -> None:
+    for stack, count in sorted(dump.stacks.items(), key=lambda item: -item[1]):
+        out.write('{} {}\n'.format(';'.join(symbols[addr][0] for addr in stack), count))
+
+
+def _varint(value: int) -> bytes:
+    out = bytearray()
+    value &= (1 << 64) - 1
+    while True:
+        byte = value & 0x7f
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def _field_varint(number: int, value: int) -> bytes:
+    return _varint(number << 3) + _varint(value)
+
+
+def _field_bytes(number: int, value: bytes) -> bytes:
+    return _varint((number << 3) | 2) + _varint(len(value)) + value
+
+
+def _field_packed(number: int, values: typing.Iterable[int]) -> bytes:
+    return _field_bytes(number, b''.join(_varint(v) for v in values))
+
+
+def write_pprof(dump: Dump, symbols: typing.Dict[int, typing.Tuple[str, str, int]], out: typing.BinaryIO) -> None:
+    """Encode the dump as a gzipped perftools.profiles.Profile protobuf message"""
+    strings = ['']  # type: typing.List[str]
+    string_ids = {'': 0}  # type: typing.Dict[str, int]
+
+    def string_id(s: str) -> int:
+        if s not in string_ids:
+            string_ids[s] = len(strings)
+            strings.append(s)
+        return string_ids[s]
+
+    def value_type(type_name: str, unit: str) -> bytes:
+        return _field_varint(1, string_id(type_name)) + _field_varint(2, string_id(unit))
+
+    profile = bytearray()
+    profile += _field_bytes(1, value_type('samples', 'count'))
+    profile += _field_bytes(1, value_type('cpu', 'nanoseconds'))
+
+    period_ns = dump.period_us * 1000
+    location_ids = {}  # type: typing.Dict[int, int]
+    for stack, count in dump.stacks.items():
+        for addr in stack:
+            location_ids.setdefault(addr, len(location_ids) + 1)
+        # pprof lists the locations from the sampled function to the outermost one
+        sample = _field_packed(1, [location_ids[addr] for addr in reversed(stack)])
+        sample += _field_packed(2, [count, count * period_ns])
+        profile += _field_bytes(2, sample)
+
+    for addr, location_id in location_ids.items():
+        name, filename, line = symbols[addr]
+        # Each location is a distinct function, they share their ID
+        line_msg = _field_varint(1, location_id) + _field_varint(2, line)
+        profile += _field_bytes(4, _field_varint(1, location_id) + _field_varint(3, addr) + _field_bytes(4, line_msg))
+        function = _field_varint(1, location_id) + _field_varint(2, string_id(name)) + \
+            _field_varint(3, string_id(name)) + _field_varint(4, string_id(filename)) + _field_varint(5, line)
+        profile += _field_bytes(5, function)
+
+    period_type = value_type('cpu', 'nanoseconds')
+    for s in strings:
+        profile += _field_bytes(6, s.encode('utf-8'))
+    profile += _field_bytes(11, period_type)
+    profile += _field_varint(12, period_ns)
+
+    with gzip.GzipFile(fileobj=out, mode='wb') as f:
+        f.write(bytes(profile))
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description='Convert esp_profiler_dump() output to flamegraph or pprof format')
+    parser.add_argument('input', nargs='?', help='Serial log containing the dump, stdin if omitted')
+    parser.add_argument('--elf', help='Application ELF file used to symbolize the addresses')
+    parser.add_argument('--toolchain-prefix', default='riscv32-esp-elf-', help='Prefix of the addr2line tool')
+    parser.add_argument('--format', choices=['folded', 'pprof'], default='folded',
+                        help='folded: input of flamegraph.pl, pprof: gzipped profile.proto')
+    parser.add_argument('-o', '--output', help='Output file, stdout if omitted')
+    args = parser.parse_args()
+
+    if args.input:
+        with open(args.input, 'r', errors='replace') as f:
+            dump = parse_dump(f)
+    else:
+        dump = parse_dump(sys.stdin)
+
+    for name, value in dump.counters.items():
+        if name != 'samples' and value != 0:
+            sys.stderr.write('Warning: {} {} samples\n'.format(value, name))
+
+    symbols = symbolize((addr for stack in dump.stacks for addr in stack), args.elf, args.toolchain_prefix + 'addr2line')
+
+    if args.format == 'folded':
+        if args.output:
+            with open(args.output, 'w') as f:
+                write_folded(dump, symbols, f)
+        else:
+            write_folded(dump, symbols, sys.stdout)
+    else:
+        if args.output:
+            with open(args.output, 'wb') as f:
+                write_pprof(dump, symbols, f)
+        else:
+            write_pprof(dump, symbols, sys.stdout.buffer)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
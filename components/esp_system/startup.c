@@ -5,7 +5,9 @@
  */
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/param.h>
 
 #include "esp_attr.h"
 #include "esp_err.h"
@@ -148,6 +150,20 @@ static IRAM_ATTR void _Unwind_SetNoFunctionContextInstall_Default(unsigned char
 
 static const char* TAG = "cpu_start";
 
+#if CONFIG_ESP_SYSTEM_INIT_TIMELINE
+typedef struct {
+    const esp_system_init_fn_t *fn;
+    int core_id;
+    int64_t start_us;
+    int64_t end_us;
+} system_init_trace_t;
+
+// Allocated by the main core before the other cores are resumed, freed once all cores are done
+static system_init_trace_t *s_system_init_trace;
+static size_t s_system_init_trace_size;
+static uint32_t s_system_init_trace_count;
+#endif
+
 /**
  * This function overwrites a the same function of libsupc++ (part of libstdc++).
  * Consequently, libsupc++ will then follow our configured exception emergency pool size.
@@ -224,12 +240,23 @@ static void do_system_init_fn(void)
     int core_id = esp_cpu_get_core_id();
     for (p = &_esp_system_init_fn_array_start; p < &_esp_system_init_fn_array_end; ++p) {
         if (p->cores & BIT(core_id)) {
-            ESP_LOGD(TAG, "calling init function: %p on core: %d", p->fn, core_id);
+            ESP_LOGD(TAG, "calling init function: %s on core: %d", p->name, core_id);
+#if CONFIG_ESP_SYSTEM_INIT_TIMELINE
+            int64_t start_us = esp_timer_get_time();
+#endif
             esp_err_t err = (*(p->fn))();
             if (err != ESP_OK) {
-                ESP_LOGE(TAG, "init function %p has failed (0x%x), aborting", p->fn, err);
+                ESP_LOGE(TAG, "init function %s has failed (0x%x), aborting", p->name, err);
                 abort();
             }
+#if CONFIG_ESP_SYSTEM_INIT_TIMELINE
+            uint32_t idx = __atomic_fetch_add(&s_system_init_trace_count, 1, __ATOMIC_RELAXED);
+            if (idx < s_system_init_trace_size) {
+                s_system_init_trace[idx] = (system_init_trace_t) {
+                    .fn = p, .core_id = core_id, .start_us = start_us, .end_us = esp_timer_get_time(),
+                };
+            }
+#endif
         }
     }
 
@@ -238,6 +265,45 @@ static void do_system_init_fn(void)
 #endif
 }
 
+#if CONFIG_ESP_SYSTEM_INIT_TIMELINE
+static void create_system_init_trace(void)
+{
+    extern esp_system_init_fn_t _esp_system_init_fn_array_start;
+    extern esp_system_init_fn_t _esp_system_init_fn_array_end;
+
+    size_t size = 0;
+    for (esp_system_init_fn_t *p = &_esp_system_init_fn_array_start; p < &_esp_system_init_fn_array_end; ++p) {
+        size += __builtin_popcount(p->cores & ESP_SYSTEM_INIT_ALL_CORES);
+    }
+    // Without memory, the functions still run, only the timeline is not printed
+    s_system_init_trace = calloc(size, sizeof(system_init_trace_t));
+    s_system_init_trace_size = s_system_init_trace ? size : 0;
+}
+
+static void print_system_init_timeline(void)
+{
+    int64_t first_us = INT64_MAX;
+    int64_t last_us = 0;
+    int64_t busy_us = 0;
+
+    ESP_LOGI(TAG, "init functions timeline (us):");
+    for (uint32_t i = 0; i < s_system_init_trace_count && i < s_system_init_trace_size; i++) {
+        const system_init_trace_t *trace = &s_system_init_trace[i];
+        ESP_LOGI(TAG, "  core %d: %8lld - %8lld %s", trace->core_id, trace->start_us, trace->end_us,
+                 trace->fn->name);
+        first_us = MIN(first_us, trace->start_us);
+        last_us = MAX(last_us, trace->end_us);
+        busy_us += trace->end_us - trace->start_us;
+    }
+    if (last_us > first_us) {
+        ESP_LOGI(TAG, "init functions took %lld us, %lld us of function time", last_us - first_us, busy_us);
+    }
+    free(s_system_init_trace);
+    s_system_init_trace = NULL;
+    s_system_init_trace_size = 0;
+}
+#endif
+
 #if !CONFIG_ESP_SYSTEM_SINGLE_CORE_MODE
 static void  esp_startup_start_app_other_cores_default(void)
 {
@@ -417,6 +483,10 @@ static void do_core_init(void)
 
 static void do_secondary_init(void)
 {
+#if CONFIG_ESP_SYSTEM_INIT_TIMELINE
+    create_system_init_trace();
+#endif
+
 #if !CONFIG_ESP_SYSTEM_SINGLE_CORE_MODE
     // The port layer transferred control to this function with other cores 'paused',
     // resume execution so that cores might execute component initialization functions.
@@ -440,6 +510,10 @@ static void do_secondary_init(void)
         esp_rom_delay_us(100);
     }
 #endif
+
+#if CONFIG_ESP_SYSTEM_INIT_TIMELINE
+    print_system_init_timeline();
+#endif
 }
 
 static void start_cpu0_default(void)
@@ -209,4 +209,116 @@ TEST_CASE("Test ipc call nonblocking when FreeRTOS Scheduler is suspended", "[ip
         xTaskResumeAll();
     #endif
 }
+
+#if CONFIG_ESP_IPC_ASYNC
+static volatile bool async_blocker_started;
+
+static void test_func_ipc_async_block(void *sema)
+{
+    async_blocker_started = true;
+    xSemaphoreTake((SemaphoreHandle_t)sema, portMAX_DELAY);
+}
+
+TEST_CASE("Test ipc call async with many calls in flight", "[ipc]")
+{
+    static esp_ipc_future_t futures[CONFIG_ESP_IPC_ASYNC_RING_SIZE];
+    volatile int value = 0;
+
+    for (int i = 0; i < CONFIG_ESP_IPC_ASYNC_RING_SIZE; i++) {
+        TEST_ESP_OK(esp_ipc_call_async(1, test_func_ipc_cb4, (void*)&value, &futures[i]));
+    }
+    for (int i = 0; i < CONFIG_ESP_IPC_ASYNC_RING_SIZE; i++) {
+        TEST_ESP_OK(esp_ipc_future_wait(&futures[i], pdMS_TO_TICKS(1000)));
+        TEST_ASSERT_TRUE(esp_ipc_future_is_done(&futures[i]));
+    }
+    TEST_ASSERT_EQUAL(CONFIG_ESP_IPC_ASYNC_RING_SIZE, value);
+}
+
+TEST_CASE("Test ipc call async when the command ring is full", "[ipc]")
+{
+    static esp_ipc_future_t futures[CONFIG_ESP_IPC_ASYNC_RING_SIZE];
+    SemaphoreHandle_t sema = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(sema);
+    volatile int value = 0;
+    esp_ipc_async_stats_t stats;
+
+    TEST_ESP_OK(esp_ipc_reset_async_stats(1));
+    async_blocker_started = false;
+    TEST_ESP_OK(esp_ipc_call_async(1, test_func_ipc_async_block, sema, NULL));
+    while (!async_blocker_started) {
+        vTaskDelay(1);
+    }
+
+    // The IPC task is blocked, the blocking call does not take a slot anymore
+    for (int i = 0; i < CONFIG_ESP_IPC_ASYNC_RING_SIZE; i++) {
+        TEST_ESP_OK(esp_ipc_call_async(1, test_func_ipc_cb4, (void*)&value, &futures[i]));
+    }
+    TEST_ESP_ERR(ESP_ERR_NO_MEM, esp_ipc_call_async(1, test_func_ipc_cb4, (void*)&value, NULL));
+    TEST_ASSERT_FALSE(esp_ipc_future_is_done(&futures[0]));
+    TEST_ESP_ERR(ESP_ERR_TIMEOUT, esp_ipc_future_wait(&futures[0], pdMS_TO_TICKS(10)));
+    vTaskDelay(pdMS_TO_TICKS(50));
+    TEST_ASSERT_EQUAL(0, value);
+
+    xSemaphoreGive(sema);
+    for (int i = 0; i < CONFIG_ESP_IPC_ASYNC_RING_SIZE; i++) {
+        TEST_ESP_OK(esp_ipc_future_wait(&futures[i], pdMS_TO_TICKS(1000)));
+    }
+    TEST_ASSERT_EQUAL(CONFIG_ESP_IPC_ASYNC_RING_SIZE, value);
+
+    TEST_ESP_OK(esp_ipc_get_async_stats(1, &stats));
+    TEST_ASSERT_EQUAL(CONFIG_ESP_IPC_ASYNC_RING_SIZE + 1, stats.calls);
+    TEST_ASSERT_EQUAL(1, stats.rejected);
+    // The calls queued while the IPC task was blocked are executed in one batch
+    TEST_ASSERT_EQUAL(CONFIG_ESP_IPC_ASYNC_RING_SIZE + 1, stats.max_batch);
+    TEST_ASSERT_GREATER_OR_EQUAL(50 * 1000, stats.max_latency_us);
+    TEST_ASSERT_GREATER_OR_EQUAL(stats.max_latency_us, stats.total_latency_us);
+    vSemaphoreDelete(sema);
+}
+
+static SemaphoreHandle_t blocking_caller_done;
+
+static void test_ipc_blocking_caller(void *sema)
+{
+    TEST_ESP_OK(esp_ipc_call_blocking(1, test_func_ipc_async_block, sema));
+    xSemaphoreGive(blocking_caller_done);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("Test ipc call async does not wait for a pending blocking call", "[ipc]")
+{
+    esp_ipc_future_t future;
+    SemaphoreHandle_t sema = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(sema);
+    blocking_caller_done = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(blocking_caller_done);
+    volatile int value = 0;
+
+    // The blocking call holds the IPC mutex until sema is given
+    async_blocker_started = false;
+    xTaskCreatePinnedToCore(test_ipc_blocking_caller, "ipc_caller", 4096, sema, CONFIG_UNITY_FREERTOS_PRIORITY + 1, NULL, 0);
+    while (!async_blocker_started) {
+        vTaskDelay(1);
+    }
+
+    TEST_ESP_OK(esp_ipc_call_async(1, test_func_ipc_cb4, (void*)&value, &future));
+    TEST_ESP_ERR(ESP_ERR_TIMEOUT, esp_ipc_future_wait(&future, pdMS_TO_TICKS(10)));
+    TEST_ASSERT_EQUAL(0, value);
+
+    xSemaphoreGive(sema);
+    TEST_ASSERT_TRUE(xSemaphoreTake(blocking_caller_done, pdMS_TO_TICKS(1000)));
+    TEST_ESP_OK(esp_ipc_future_wait(&future, pdMS_TO_TICKS(1000)));
+    TEST_ASSERT_EQUAL(1, value);
+    vSemaphoreDelete(blocking_caller_done);
+    vSemaphoreDelete(sema);
+}
+
+TEST_CASE("Test ipc call async invalid arguments", "[ipc]")
+{
+    esp_ipc_future_t future;
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_ipc_call_async(portNUM_PROCESSORS, test_func_ipc_cb4, NULL, &future));
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_ipc_call_async(1, NULL, NULL, &future));
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_ipc_get_async_stats(1, NULL));
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_ipc_reset_async_stats(portNUM_PROCESSORS));
+}
+#endif /* CONFIG_ESP_IPC_ASYNC */
 #endif /* !CONFIG_FREERTOS_UNICORE */
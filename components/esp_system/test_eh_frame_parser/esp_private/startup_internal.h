@@ -0,0 +1,26 @@
+// Copyright 2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK      0
+#define BIT(nr)     (1UL << (nr))
+
+/* There is no startup sequence on the host, the test calls the functions itself. */
+#define ESP_SYSTEM_INIT_FN(f, c, priority, ...) \
+    static __attribute__((unused)) esp_err_t f(void)
+#define ESP_SYSTEM_INIT_FN_DEPS(f, c, priority, deps, ...) \
+    static __attribute__((unused)) esp_err_t f(void)
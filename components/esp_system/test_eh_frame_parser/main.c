@@ -21,8 +21,10 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <assert.h>
+#include <time.h>
 #include <ucontext.h>
 #include "../include/esp_private/eh_frame_parser.h"
+#include "../include/esp_private/profiler_core.h"
 #include "eh_frame_parser_impl.h"
 
 /**
@@ -54,6 +56,31 @@
  */
 #define NUMBER_OF_ITERATION     (2 * NUMBER_TO_TEST + 2 + 1)
 
+/**
+ * @brief Maximum number of backtrace steps a trace can record.
+ */
+#define MAX_TRACE_STEPS         (4096)
+
+/**
+ * @brief Number of backtraces generated to measure the time of one.
+ */
+#define BENCHMARK_ITERATIONS    (100000)
+
+/**
+ * @brief Value filling the fake stack. Used as a return address, it ends the backtrace.
+ */
+#define FAKE_STACK_VALUE        (0x10)
+
+/**
+ * @brief Size of the profiler ring, rounded up by the profiler to 4 samples.
+ */
+#define PROFILER_RING_SAMPLES   (3)
+
+/**
+ * @brief Maximum number of call stacks aggregated by the profiler.
+ */
+#define PROFILER_MAX_STACKS     (2)
+
 /**
  * @brief Define a simple linked list type and initialize one.
  */
@@ -63,6 +90,32 @@ struct list_t {
 };
 
 static struct list_t head = { 0 };
+
+/**
+ * @brief Steps of one or several backtraces, used to compare the backtraces
+ * generated with and without the eh_frame index.
+ */
+struct trace_t {
+    uint32_t count;
+    uint32_t steps[MAX_TRACE_STEPS][2];
+};
+
+static struct trace_t bt_reference, bt_indexed, pcs_reference, pcs_indexed;
+
+/**
+ * @brief Trace the steps are recorded in, if not NULL.
+ */
+static struct trace_t* trace = NULL;
+
+/**
+ * @brief Whether the steps shall be checked against the expected call stack.
+ */
+static bool check_steps = true;
+
+/**
+ * @brief Used by panic_print_str and panic_print_hex.
+ */
+bool g_panic_print_mute = false;
 /**
  * Few recursive functions to make the the call stack a bit more complex than a
  * single function call would give.
@@ -135,6 +188,15 @@ static uint32_t iteration = 1;
  * generated.
  */
 void esp_eh_frame_generated_step(uint32_t pc, uint32_t sp) {
+    if (trace != NULL && trace->count < MAX_TRACE_STEPS) {
+        trace->steps[trace->count][0] = pc;
+        trace->steps[trace->count][1] = sp;
+        trace->count++;
+    }
+
+    if (!check_steps)
+        return;
+
     /* The first PCs in the backtrace are calls to `browse_list()` + 2.
      * This is due to the fact that the list contains all the numbers
      * between NUMBER_TO_TEST to 0 included. Moreover, another call
@@ -164,6 +226,139 @@ void esp_eh_frame_generated_step(uint32_t pc, uint32_t sp) {
 }
 
 
+/**
+ * @brief Create a frame which registers point to a fake stack.
+ *
+ * @param pc Program counter of the frame.
+ *
+ * @return Frame whose backtrace ends after the caller's step.
+ */
+static x86ExcFrame fake_frame(uint32_t pc)
+{
+    static uint32_t fake_stack[64];
+
+    for (uint32_t i = 0; i < sizeof(fake_stack)/sizeof(*fake_stack); i++)
+        fake_stack[i] = FAKE_STACK_VALUE;
+
+    x86ExcFrame frame = {
+        .esp = (uint32_t) &fake_stack[32],
+        .ebp = (uint32_t) &fake_stack[32],
+        .eip = pc
+    };
+    return frame;
+}
+
+/**
+ * @brief Generate a backtrace from every address of the functions in `funs`.
+ * The registers point to a fake stack, thus each backtrace ends after the caller's
+ * step, which only depends on the DWARF rules for the address.
+ */
+static void backtrace_all_pcs(void)
+{
+    for (uint32_t i = 0; i < FUNCTIONS_COUNT; i++) {
+        for (uintptr_t pc = funs[i].start; pc <= funs[i].end; pc++) {
+            const x86ExcFrame frame = fake_frame(pc);
+            esp_eh_frame_print_backtrace(&frame);
+        }
+    }
+}
+
+/**
+ * @brief Measure the time taken to generate the backtrace of a frame.
+ *
+ * @param frame Frame to generate the backtrace of.
+ *
+ * @return Average time of one backtrace, in nanoseconds.
+ */
+static double benchmark_backtrace(const x86ExcFrame* frame)
+{
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t i = 0; i < BENCHMARK_ITERATIONS; i++)
+        esp_eh_frame_print_backtrace(frame);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / BENCHMARK_ITERATIONS;
+}
+
+/**
+ * @brief Compare two traces.
+ *
+ * @return true if both traces contain the same steps, false else.
+ */
+static bool same_traces(const struct trace_t* a, const struct trace_t* b)
+{
+    return a->count == b->count &&
+           memcmp(a->steps, b->steps, a->count * sizeof(a->steps[0])) == 0;
+}
+
+/**
+ * @brief Callback checking the call stack aggregated by the profiler from the frame
+ * of the SIGSEV, the most sampled one.
+ */
+static void check_profiler_stack(void *arg, uint32_t count, const uint32_t *stack, uint32_t depth)
+{
+    uint32_t *stacks = (uint32_t *) arg;
+
+    (*stacks)++;
+    if (count == PROFILER_RING_SAMPLES + 1) {
+        assert(depth == bt_reference.count);
+        for (uint32_t i = 0; i < depth; i++) {
+            const uint32_t fun = esp_eh_frame_get_function(bt_reference.steps[i][0]);
+            assert(stack[i] == (fun != 0 ? fun : bt_reference.steps[i][0]));
+        }
+        assert(stack[0] == funs[0].start);
+    }
+}
+
+/**
+ * @brief Check the backtraces returned by esp_eh_frame_get_backtrace() and the
+ * aggregation of samples by the profiler.
+ *
+ * @param frame Frame of the SIGSEV, which backtrace is in `bt_reference`.
+ */
+static void check_profiler(const x86ExcFrame* frame)
+{
+    static uint32_t pcs[MAX_TRACE_STEPS];
+    esp_profiler_core_t core;
+    uint32_t stacks = 0;
+
+    /* Same program counters as the printed backtrace. */
+    const uint32_t depth = esp_eh_frame_get_backtrace(frame, pcs, MAX_TRACE_STEPS);
+    assert(depth == bt_reference.count);
+    for (uint32_t i = 0; i < depth; i++)
+        assert(pcs[i] == bt_reference.steps[i][0]);
+    assert(esp_eh_frame_get_backtrace(frame, pcs, 2) == 2);
+    assert(esp_eh_frame_get_function(funs[1].start + 1) == funs[1].start);
+
+    assert(esp_profiler_core_init(&core, PROFILER_RING_SAMPLES, PROFILER_MAX_STACKS, MAX_TRACE_STEPS));
+
+    /* Fill the ring, the last sample is dropped. */
+    for (uint32_t i = 0; i < PROFILER_RING_SAMPLES + 2; i++)
+        assert(esp_profiler_core_sample(&core, frame) == (i <= PROFILER_RING_SAMPLES));
+    assert(core.dropped == 1);
+    assert(esp_profiler_core_pending(&core) == PROFILER_RING_SAMPLES + 1);
+    esp_profiler_core_aggregate(&core);
+    assert(esp_profiler_core_pending(&core) == 0);
+
+    /* Samples at different addresses of a function share the same call stack. The
+     * third call stack is lost as the table only holds two of them. */
+    x86ExcFrame other = fake_frame(funs[1].start + 1);
+    assert(esp_profiler_core_sample(&core, &other));
+    other = fake_frame(funs[1].end);
+    assert(esp_profiler_core_sample(&core, &other));
+    other = fake_frame(funs[2].start + 1);
+    assert(esp_profiler_core_sample(&core, &other));
+    esp_profiler_core_aggregate(&core);
+    assert(core.stack_count == 2 && core.lost == 1);
+    assert(core.aggregated == PROFILER_RING_SAMPLES + 3);
+
+    esp_profiler_core_foreach(&core, check_profiler_stack, &stacks);
+    assert(stacks == 2);
+    esp_profiler_core_deinit(&core);
+}
+
 /**
  * @brief Handler called when SIGSEV signal is sent to the program.
  *
@@ -195,18 +390,50 @@ void signal_handler(int signal, siginfo_t *info, void *ucontext) {
      * Instead of replacing stdout file descriptor with a pipe, we can simply
      * replace these functions to store the data instead of printing them.
      */
+    trace = &bt_reference;
     esp_eh_frame_print_backtrace(&frame);
 
     /* No assert has been triggered, the backtrace succeeded if the number of
      * iterations of function `esp_eh_frame_generated_step` is correct. */
-    if (iteration == NUMBER_OF_ITERATION) {
-        printf("\e[32m\e[1mAll tests passed \e[0m\r\n");
-    } else {
+    if (iteration != NUMBER_OF_ITERATION) {
         printf("\e[31m\e[1mWrong length of backtrace (%d iteration, expected %d) \e[0m\r\n",
         iteration, NUMBER_OF_ITERATION);
         exit(1);
     }
 
+    /* The backtraces generated with the index must be the same as the ones
+     * generated by the DWARF interpreter only, for every address. */
+    check_steps = false;
+    g_panic_print_mute = true;
+    trace = &pcs_reference;
+    backtrace_all_pcs();
+    trace = NULL;
+    const double interpreter_ns = benchmark_backtrace(&frame);
+
+    if (!esp_eh_frame_index_init()) {
+        printf("\e[31m\e[1mCould not build the eh_frame index \e[0m\r\n");
+        exit(1);
+    }
+
+    trace = &bt_indexed;
+    esp_eh_frame_print_backtrace(&frame);
+    trace = &pcs_indexed;
+    backtrace_all_pcs();
+    trace = NULL;
+    const double index_ns = benchmark_backtrace(&frame);
+    g_panic_print_mute = false;
+
+    if (!same_traces(&bt_reference, &bt_indexed) || !same_traces(&pcs_reference, &pcs_indexed)) {
+        printf("\e[31m\e[1mBacktraces differ with the eh_frame index \e[0m\r\n");
+        exit(1);
+    }
+
+    check_profiler(&frame);
+
+    printf("Backtrace of %u steps: %.0f ns without index, %.0f ns with index\r\n",
+           bt_reference.count, interpreter_ns, index_ns);
+    printf("\e[32m\e[1mAll tests passed \e[0m\r\n");
+
     /* Everything went fine, exit normally. */
     exit(0);
 }
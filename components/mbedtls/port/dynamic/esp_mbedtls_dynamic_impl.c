@@ -6,6 +6,12 @@
 
 #include <string.h>
 #include "esp_mbedtls_dynamic_impl.h"
+#ifdef CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE
+#include <stdatomic.h>
+#include <sys/param.h>
+#include "esp_system.h"
+#include "esp_mbedtls_dynamic_buffer.h"
+#endif
 
 #define COUNTER_SIZE (8)
 #define CACHE_IV_SIZE (16)
@@ -15,9 +21,70 @@
 
 static const char *TAG = "Dynamic Impl";
 
+#ifdef CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE
+static struct {
+    atomic_uint allocs;
+    atomic_uint reuses;
+    atomic_uint grows;
+    atomic_uint shrinks;
+    atomic_uint pressure_frees;
+    atomic_uint kept_bytes;
+    atomic_uint peak_kept_bytes;
+} s_stats;
+
+#define ADAPTIVE_STAT_INC(_name) atomic_fetch_add_explicit(&s_stats._name, 1, memory_order_relaxed)
+
+static void adaptive_kept_add(unsigned int len)
+{
+    unsigned int kept = atomic_fetch_add_explicit(&s_stats.kept_bytes, len, memory_order_relaxed) + len;
+    unsigned int peak = atomic_load_explicit(&s_stats.peak_kept_bytes, memory_order_relaxed);
+
+    while (kept > peak &&
+           !atomic_compare_exchange_weak_explicit(&s_stats.peak_kept_bytes, &peak, kept,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+static void adaptive_kept_sub(unsigned int len)
+{
+    atomic_fetch_sub_explicit(&s_stats.kept_bytes, len, memory_order_relaxed);
+}
+
+void esp_mbedtls_dynamic_buffer_get_stats(esp_mbedtls_dynamic_buffer_stats_t *stats)
+{
+    stats->allocs = atomic_load(&s_stats.allocs);
+    stats->reuses = atomic_load(&s_stats.reuses);
+    stats->grows = atomic_load(&s_stats.grows);
+    stats->shrinks = atomic_load(&s_stats.shrinks);
+    stats->pressure_frees = atomic_load(&s_stats.pressure_frees);
+    stats->kept_bytes = atomic_load(&s_stats.kept_bytes);
+    stats->peak_kept_bytes = atomic_load(&s_stats.peak_kept_bytes);
+}
+
+void esp_mbedtls_dynamic_buffer_reset_stats(void)
+{
+    atomic_store(&s_stats.allocs, 0);
+    atomic_store(&s_stats.reuses, 0);
+    atomic_store(&s_stats.grows, 0);
+    atomic_store(&s_stats.shrinks, 0);
+    atomic_store(&s_stats.pressure_frees, 0);
+    atomic_store(&s_stats.peak_kept_bytes, atomic_load(&s_stats.kept_bytes));
+}
+#else
+#define ADAPTIVE_STAT_INC(_name)
+#endif /* CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE */
+
 static void esp_mbedtls_set_buf_state(unsigned char *buf, esp_mbedtls_ssl_buf_states state)
 {
     struct esp_mbedtls_ssl_buf *temp = __containerof(buf, struct esp_mbedtls_ssl_buf, buf[0]);
+
+#ifdef CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE
+    if (state == ESP_MBEDTLS_SSL_BUF_KEPT && temp->state != ESP_MBEDTLS_SSL_BUF_KEPT) {
+        adaptive_kept_add(temp->len);
+    } else if (state != ESP_MBEDTLS_SSL_BUF_KEPT && temp->state == ESP_MBEDTLS_SSL_BUF_KEPT) {
+        adaptive_kept_sub(temp->len);
+    }
+#endif
     temp->state = state;
 }
 
@@ -31,6 +98,11 @@ void esp_mbedtls_free_buf(unsigned char *buf)
 {
     struct esp_mbedtls_ssl_buf *temp = __containerof(buf, struct esp_mbedtls_ssl_buf, buf[0]);
     ESP_LOGV(TAG, "free buffer @ %p", temp);
+#ifdef CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE
+    if (temp->state == ESP_MBEDTLS_SSL_BUF_KEPT) {
+        adaptive_kept_sub(temp->len);
+    }
+#endif
     mbedtls_free(temp);
 }
 
@@ -42,6 +114,60 @@ static void esp_mbedtls_init_ssl_buf(struct esp_mbedtls_ssl_buf *buf, unsigned i
     }
 }
 
+#ifdef CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE
+/**
+ * Decide whether the kept buffer takes a record needing "need" bytes. If not, "alloc_len"
+ * is the size of the buffer to allocate instead: the record size when the kept buffer is
+ * too small, or the largest recent record size when the buffer has been mostly unused for
+ * CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE_SHRINK_RECORDS records.
+ */
+static bool adaptive_reuse(unsigned char *buf, unsigned int need, unsigned int *alloc_len)
+{
+    struct esp_mbedtls_ssl_buf *temp = __containerof(buf, struct esp_mbedtls_ssl_buf, buf[0]);
+
+    if (need > temp->len) {
+        ESP_LOGV(TAG, "grow kept buffer %u -> %u bytes", temp->len, need);
+        ADAPTIVE_STAT_INC(grows);
+        *alloc_len = need;
+        return false;
+    }
+
+    if (need <= temp->len / 2) {
+        temp->small_peak = MAX(temp->small_peak, need);
+        if (++temp->small_records >= CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE_SHRINK_RECORDS) {
+            ESP_LOGV(TAG, "shrink kept buffer %u -> %u bytes", temp->len, temp->small_peak);
+            ADAPTIVE_STAT_INC(shrinks);
+            *alloc_len = temp->small_peak;
+            return false;
+        }
+    } else {
+        temp->small_records = 0;
+        temp->small_peak = 0;
+    }
+
+    ADAPTIVE_STAT_INC(reuses);
+    return true;
+}
+
+/**
+ * Keep the record buffer for the next record of an established connection while enough
+ * heap is free, handshake records keep the per-message allocation.
+ */
+static bool adaptive_keep(mbedtls_ssl_context *ssl)
+{
+    if (ssl->MBEDTLS_PRIVATE(state) != MBEDTLS_SSL_HANDSHAKE_OVER) {
+        return false;
+    }
+
+    if (esp_get_free_heap_size() < CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE_MIN_FREE_HEAP) {
+        ADAPTIVE_STAT_INC(pressure_frees);
+        return false;
+    }
+
+    return true;
+}
+#endif /* CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE */
+
 static void esp_mbedtls_parse_record_header(mbedtls_ssl_context *ssl)
 {
     ssl->MBEDTLS_PRIVATE(in_msgtype) =  ssl->MBEDTLS_PRIVATE(in_hdr)[0];
@@ -241,27 +367,47 @@ int esp_mbedtls_add_tx_buffer(mbedtls_ssl_context *ssl, size_t buffer_len)
 
     ESP_LOGV(TAG, "--> add out");
 
+    buffer_len = tx_buffer_len(ssl, buffer_len);
+
     if (ssl->MBEDTLS_PRIVATE(out_buf)) {
-        if (esp_mbedtls_get_buf_state(ssl->MBEDTLS_PRIVATE(out_buf)) == ESP_MBEDTLS_SSL_BUF_CACHED) {
+        esp_mbedtls_ssl_buf_states state = esp_mbedtls_get_buf_state(ssl->MBEDTLS_PRIVATE(out_buf));
+
+        if (state == ESP_MBEDTLS_SSL_BUF_CACHED) {
             ESP_LOGV(TAG, "out buffer is not empty");
             ret = 0;
             goto exit;
-        } else {
+        }
+#ifdef CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE
+        if (state == ESP_MBEDTLS_SSL_BUF_KEPT) {
+            unsigned int alloc_len;
+
+            if (adaptive_reuse(ssl->MBEDTLS_PRIVATE(out_buf), buffer_len, &alloc_len)) {
+                esp_mbedtls_set_buf_state(ssl->MBEDTLS_PRIVATE(out_buf), ESP_MBEDTLS_SSL_BUF_CACHED);
+                ret = 0;
+                goto exit;
+            }
+
+            /* The kept buffer has the full record layout */
+            memcpy(cache_buf, ssl->MBEDTLS_PRIVATE(out_ctr), COUNTER_SIZE);
+            memcpy(cache_buf + COUNTER_SIZE, ssl->MBEDTLS_PRIVATE(out_iv), CACHE_IV_SIZE);
+            buffer_len = alloc_len;
+        } else
+#endif
+        {
             memcpy(cache_buf, ssl->MBEDTLS_PRIVATE(out_buf), CACHE_BUFFER_SIZE);
-            esp_mbedtls_free_buf(ssl->MBEDTLS_PRIVATE(out_buf));
-            init_tx_buffer(ssl, NULL);
-            cached = 1;
         }
+        esp_mbedtls_free_buf(ssl->MBEDTLS_PRIVATE(out_buf));
+        init_tx_buffer(ssl, NULL);
+        cached = 1;
     }
 
-    buffer_len = tx_buffer_len(ssl, buffer_len);
-
     esp_buf = mbedtls_calloc(1, SSL_BUF_HEAD_OFFSET_SIZE + buffer_len);
     if (!esp_buf) {
         ESP_LOGE(TAG, "alloc(%zu bytes) failed", SSL_BUF_HEAD_OFFSET_SIZE + buffer_len);
         ret = MBEDTLS_ERR_SSL_ALLOC_FAILED;
         goto exit;
     }
+    ADAPTIVE_STAT_INC(allocs);
 
     ESP_LOGV(TAG, "add out buffer %zu bytes @ %p", buffer_len, esp_buf->buf);
 
@@ -290,11 +436,23 @@ int esp_mbedtls_free_tx_buffer(mbedtls_ssl_context *ssl)
 
     ESP_LOGV(TAG, "--> free out");
 
-    if (!ssl->MBEDTLS_PRIVATE(out_buf) || (ssl->MBEDTLS_PRIVATE(out_buf) && (esp_mbedtls_get_buf_state(ssl->MBEDTLS_PRIVATE(out_buf)) == ESP_MBEDTLS_SSL_BUF_NO_CACHED))) {
+    if (!ssl->MBEDTLS_PRIVATE(out_buf) || (ssl->MBEDTLS_PRIVATE(out_buf) && (esp_mbedtls_get_buf_state(ssl->MBEDTLS_PRIVATE(out_buf)) != ESP_MBEDTLS_SSL_BUF_CACHED))) {
         ret = 0;
         goto exit;
     }
 
+#ifdef CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE
+    if (adaptive_keep(ssl)) {
+        unsigned char *out_buf = ssl->MBEDTLS_PRIVATE(out_buf);
+
+        /* Counter and IV stay in place, only reset the record state */
+        init_tx_buffer(ssl, NULL);
+        init_tx_buffer(ssl, out_buf);
+        esp_mbedtls_set_buf_state(out_buf, ESP_MBEDTLS_SSL_BUF_KEPT);
+        goto exit;
+    }
+#endif
+
     memcpy(buf, ssl->MBEDTLS_PRIVATE(out_ctr), COUNTER_SIZE);
     memcpy(buf + COUNTER_SIZE, ssl->MBEDTLS_PRIVATE(out_iv), CACHE_IV_SIZE);
 
@@ -363,6 +521,26 @@ int esp_mbedtls_add_rx_buffer(mbedtls_ssl_context *ssl)
     ESP_LOGV(TAG, "message length is %d RX buffer length should be %d left is %d",
                 (int)in_msglen, (int)buffer_len, (int)ssl->MBEDTLS_PRIVATE(in_left));
 
+#ifdef CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE
+    if (cached && esp_mbedtls_get_buf_state(ssl->MBEDTLS_PRIVATE(in_buf)) == ESP_MBEDTLS_SSL_BUF_KEPT) {
+        unsigned char *in_buf = ssl->MBEDTLS_PRIVATE(in_buf);
+        unsigned int alloc_len;
+
+        if (adaptive_reuse(in_buf, buffer_len, &alloc_len)) {
+            esp_mbedtls_set_buf_state(in_buf, ESP_MBEDTLS_SSL_BUF_CACHED);
+            init_rx_buffer(ssl, NULL);
+            init_rx_buffer(ssl, in_buf);
+            goto copy_header;
+        }
+
+        /* The kept buffer has the full record layout */
+        memcpy(cache_buf, ssl->MBEDTLS_PRIVATE(in_ctr), 8);
+        memcpy(cache_buf + 8, ssl->MBEDTLS_PRIVATE(in_iv), 8);
+        esp_mbedtls_free_buf(in_buf);
+        init_rx_buffer(ssl, NULL);
+        buffer_len = alloc_len;
+    } else
+#endif
     if (cached) {
         memcpy(cache_buf, ssl->MBEDTLS_PRIVATE(in_buf), 16);
         esp_mbedtls_free_buf(ssl->MBEDTLS_PRIVATE(in_buf));
@@ -375,6 +553,7 @@ int esp_mbedtls_add_rx_buffer(mbedtls_ssl_context *ssl)
         ret = MBEDTLS_ERR_SSL_ALLOC_FAILED;
         goto exit;
     }
+    ADAPTIVE_STAT_INC(allocs);
 
     ESP_LOGV(TAG, "add in buffer %d bytes @ %p", buffer_len, esp_buf->buf);
 
@@ -386,6 +565,9 @@ int esp_mbedtls_add_rx_buffer(mbedtls_ssl_context *ssl)
         memcpy(ssl->MBEDTLS_PRIVATE(in_iv), cache_buf + 8, 8);
     }
 
+#ifdef CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE
+copy_header:
+#endif
     memcpy(ssl->MBEDTLS_PRIVATE(in_hdr), msg_head, in_left);
     ssl->MBEDTLS_PRIVATE(in_left) = in_left;
     ssl->MBEDTLS_PRIVATE(in_msglen) = 0;
@@ -408,7 +590,7 @@ int esp_mbedtls_free_rx_buffer(mbedtls_ssl_context *ssl)
      * When have read multi messages once, can't free the input buffer directly.
      */
     if (!ssl->MBEDTLS_PRIVATE(in_buf) || (ssl->MBEDTLS_PRIVATE(in_hslen) && (ssl->MBEDTLS_PRIVATE(in_hslen) < ssl->MBEDTLS_PRIVATE(in_msglen))) ||
-        (ssl->MBEDTLS_PRIVATE(in_buf) && (esp_mbedtls_get_buf_state(ssl->MBEDTLS_PRIVATE(in_buf)) == ESP_MBEDTLS_SSL_BUF_NO_CACHED))) {
+        (ssl->MBEDTLS_PRIVATE(in_buf) && (esp_mbedtls_get_buf_state(ssl->MBEDTLS_PRIVATE(in_buf)) != ESP_MBEDTLS_SSL_BUF_CACHED))) {
         ret = 0;
         goto exit;
     }
@@ -429,6 +611,18 @@ int esp_mbedtls_free_rx_buffer(mbedtls_ssl_context *ssl)
         goto exit;
     }
 
+#ifdef CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE
+    if (adaptive_keep(ssl)) {
+        unsigned char *in_buf = ssl->MBEDTLS_PRIVATE(in_buf);
+
+        /* Counter and IV stay in place, only reset the record state */
+        init_rx_buffer(ssl, NULL);
+        init_rx_buffer(ssl, in_buf);
+        esp_mbedtls_set_buf_state(in_buf, ESP_MBEDTLS_SSL_BUF_KEPT);
+        goto exit;
+    }
+#endif
+
     memcpy(buf, ssl->MBEDTLS_PRIVATE(in_ctr), 8);
     memcpy(buf + 8, ssl->MBEDTLS_PRIVATE(in_iv), 8);
 
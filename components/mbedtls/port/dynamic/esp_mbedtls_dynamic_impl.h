@@ -49,11 +49,16 @@
 typedef enum {
     ESP_MBEDTLS_SSL_BUF_CACHED,
     ESP_MBEDTLS_SSL_BUF_NO_CACHED,
+    ESP_MBEDTLS_SSL_BUF_KEPT,       /* full record buffer kept for the next record, no data cached */
 } esp_mbedtls_ssl_buf_states;
 
 struct esp_mbedtls_ssl_buf {
     esp_mbedtls_ssl_buf_states state;
     unsigned int len;
+#ifdef CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE
+    unsigned int small_records;     /* consecutive records using less than half of the buffer */
+    unsigned int small_peak;        /* largest of those records */
+#endif
     unsigned char buf[];
 };
 
@@ -56,6 +56,19 @@ static int manage_resource(mbedtls_ssl_context *ssl, bool add)
                 CHECK_OK(esp_mbedtls_add_rx_buffer(ssl));
             } else {
                 CHECK_OK(esp_mbedtls_free_rx_buffer(ssl));
+
+                /* A resumed session skips the certificate and key exchange
+                 * states, so their data can be released right away */
+                if (ssl->MBEDTLS_PRIVATE(handshake)->resume) {
+#ifdef CONFIG_MBEDTLS_DYNAMIC_FREE_CA_CERT
+                    esp_mbedtls_free_cacert(ssl);
+#endif
+#ifdef CONFIG_MBEDTLS_DYNAMIC_FREE_CONFIG_DATA
+                    esp_mbedtls_free_dhm(ssl);
+                    esp_mbedtls_free_keycert_key(ssl);
+                    esp_mbedtls_free_keycert(ssl);
+#endif
+                }
             }
             break;
         case MBEDTLS_SSL_SERVER_CERTIFICATE:
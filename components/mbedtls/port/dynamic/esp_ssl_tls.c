@@ -301,8 +301,24 @@ int __wrap_mbedtls_ssl_setup(mbedtls_ssl_context *ssl, const mbedtls_ssl_config
 int __wrap_mbedtls_ssl_write(mbedtls_ssl_context *ssl, unsigned char *buf, size_t len)
 {
     int ret;
+    size_t buffer_len = 0;
 
-    CHECK_OK(esp_mbedtls_add_tx_buffer(ssl, 0));
+#ifdef CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE
+    /**
+     * A write on an established connection sends at most one record of "len" bytes,
+     * so size the buffer for it. Otherwise the write may run the handshake, which
+     * needs the full buffer.
+     */
+    if (ssl->MBEDTLS_PRIVATE(state) == MBEDTLS_SSL_HANDSHAKE_OVER
+#if defined(MBEDTLS_SSL_RENEGOTIATION)
+        && ssl->MBEDTLS_PRIVATE(renego_status) != MBEDTLS_SSL_RENEGOTIATION_PENDING
+#endif
+    ) {
+        buffer_len = MIN(len, MBEDTLS_SSL_OUT_CONTENT_LEN);
+    }
+#endif
+
+    CHECK_OK(esp_mbedtls_add_tx_buffer(ssl, buffer_len));
 
     ret = __real_mbedtls_ssl_write(ssl, buf, len);
 
@@ -0,0 +1,409 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "mbedtls/platform.h"
+#include "mbedtls/platform_util.h"
+#include "esp_session_cache.h"
+
+#define SESSION_CACHE_MAGIC         0x45534331  /* "ESC1" */
+#define SESSION_CACHE_HOST_MAX      255
+/* Serialized entry header: host_len(1) port(2) expires(8) session_len(4) */
+#define SESSION_CACHE_ENTRY_HDR     15
+
+typedef struct {
+    char *host;                 /* NULL if the entry is free */
+    uint16_t port;
+    time_t expires;
+    uint32_t last_used;
+    size_t len;
+    unsigned char *session;     /* output of mbedtls_ssl_session_save() */
+} session_cache_entry_t;
+
+typedef struct {
+    uint32_t ttl_sec;
+    uint32_t use_count;
+    size_t max_entries;
+    session_cache_entry_t entries[];
+} session_cache_t;
+
+static const char *TAG = "session_cache";
+
+/* s_cache is only read or changed with s_lock held. The lock is static and
+ * outlives the cache, so deinit cannot free it under a concurrent caller. */
+static session_cache_t *s_cache;
+static SemaphoreHandle_t s_lock;
+static StaticSemaphore_t s_lock_buf;
+static portMUX_TYPE s_lock_init = portMUX_INITIALIZER_UNLOCKED;
+
+static void cache_lock(void)
+{
+    if (!s_lock) {
+        portENTER_CRITICAL(&s_lock_init);
+        if (!s_lock) {
+            s_lock = xSemaphoreCreateMutexStatic(&s_lock_buf);
+        }
+        portEXIT_CRITICAL(&s_lock_init);
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+}
+
+static void cache_unlock(void)
+{
+    xSemaphoreGive(s_lock);
+}
+
+static void entry_free(session_cache_entry_t *entry)
+{
+    mbedtls_free(entry->host);
+    if (entry->session) {
+        mbedtls_platform_zeroize(entry->session, entry->len);
+        mbedtls_free(entry->session);
+    }
+    memset(entry, 0, sizeof(*entry));
+}
+
+static session_cache_entry_t *entry_find(const char *host, uint16_t port)
+{
+    for (size_t i = 0; i < s_cache->max_entries; i++) {
+        session_cache_entry_t *entry = &s_cache->entries[i];
+
+        if (entry->host && entry->port == port && strcmp(entry->host, host) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/* Free entry, else an expired one, else the least recently used one */
+static session_cache_entry_t *entry_alloc(time_t now)
+{
+    session_cache_entry_t *lru = NULL;
+
+    for (size_t i = 0; i < s_cache->max_entries; i++) {
+        session_cache_entry_t *entry = &s_cache->entries[i];
+
+        if (!entry->host || entry->expires <= now) {
+            entry_free(entry);
+            return entry;
+        }
+        if (!lru || (int32_t)(entry->last_used - lru->last_used) < 0) {
+            lru = entry;
+        }
+    }
+    entry_free(lru);
+    return lru;
+}
+
+static esp_err_t entry_store(const char *host, uint16_t port, time_t expires,
+                             const unsigned char *session, size_t len)
+{
+    session_cache_entry_t *entry = entry_find(host, port);
+    size_t host_len = strlen(host);
+    char *host_copy = mbedtls_calloc(1, host_len + 1);
+    unsigned char *session_copy = mbedtls_calloc(1, len);
+
+    if (!host_copy || !session_copy) {
+        mbedtls_free(host_copy);
+        mbedtls_free(session_copy);
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(host_copy, host, host_len);
+    memcpy(session_copy, session, len);
+
+    if (entry) {
+        entry_free(entry);
+    } else {
+        entry = entry_alloc(time(NULL));
+    }
+    entry->host = host_copy;
+    entry->port = port;
+    entry->expires = expires;
+    entry->last_used = ++s_cache->use_count;
+    entry->session = session_copy;
+    entry->len = len;
+    return ESP_OK;
+}
+
+esp_err_t esp_mbedtls_session_cache_init(const esp_mbedtls_session_cache_config_t *config)
+{
+    session_cache_t *cache;
+
+    if (!config || !config->max_entries || !config->ttl_sec) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    cache_lock();
+    if (s_cache) {
+        cache_unlock();
+        return ESP_ERR_INVALID_STATE;
+    }
+    cache = mbedtls_calloc(1, sizeof(*cache) + config->max_entries * sizeof(session_cache_entry_t));
+    if (!cache) {
+        cache_unlock();
+        return ESP_ERR_NO_MEM;
+    }
+    cache->max_entries = config->max_entries;
+    cache->ttl_sec = config->ttl_sec;
+    s_cache = cache;
+    cache_unlock();
+    return ESP_OK;
+}
+
+void esp_mbedtls_session_cache_deinit(void)
+{
+    cache_lock();
+    if (s_cache) {
+        for (size_t i = 0; i < s_cache->max_entries; i++) {
+            entry_free(&s_cache->entries[i]);
+        }
+        mbedtls_free(s_cache);
+        s_cache = NULL;
+    }
+    cache_unlock();
+}
+
+esp_err_t esp_mbedtls_session_cache_set(mbedtls_ssl_context *ssl, const char *host, uint16_t port)
+{
+    session_cache_entry_t *entry;
+    mbedtls_ssl_session session;
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    int ret;
+
+    if (!ssl || !host) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    cache_lock();
+    if (!s_cache) {
+        cache_unlock();
+        return ESP_ERR_INVALID_STATE;
+    }
+    entry = entry_find(host, port);
+    if (entry && entry->expires <= time(NULL)) {
+        entry_free(entry);
+        entry = NULL;
+    }
+    if (entry) {
+        mbedtls_ssl_session_init(&session);
+        ret = mbedtls_ssl_session_load(&session, entry->session, entry->len);
+        if (ret == 0) {
+            ret = mbedtls_ssl_set_session(ssl, &session);
+        }
+        mbedtls_ssl_session_free(&session);
+        if (ret == 0) {
+            entry->last_used = ++s_cache->use_count;
+            err = ESP_OK;
+        } else {
+            ESP_LOGD(TAG, "Failed to set cached session for %s:%u, -0x%x", host, port, -ret);
+            entry_free(entry);
+            err = ESP_FAIL;
+        }
+    }
+    cache_unlock();
+    return err;
+}
+
+esp_err_t esp_mbedtls_session_cache_save(const mbedtls_ssl_context *ssl, const char *host, uint16_t port)
+{
+    mbedtls_ssl_session session;
+    unsigned char *buf = NULL;
+    size_t len = 0;
+    esp_err_t err;
+    int ret;
+
+    if (!ssl || !host || strlen(host) > SESSION_CACHE_HOST_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* Serialize outside of the lock, only the table update is locked */
+    mbedtls_ssl_session_init(&session);
+    ret = mbedtls_ssl_get_session(ssl, &session);
+    if (ret == 0) {
+        ret = mbedtls_ssl_session_save(&session, NULL, 0, &len);
+        if (ret == MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL) {
+            buf = mbedtls_calloc(1, len);
+            ret = buf ? mbedtls_ssl_session_save(&session, buf, len, &len) : MBEDTLS_ERR_SSL_ALLOC_FAILED;
+        }
+    }
+    mbedtls_ssl_session_free(&session);
+
+    if (ret == 0) {
+        cache_lock();
+        if (s_cache) {
+            err = entry_store(host, port, time(NULL) + s_cache->ttl_sec, buf, len);
+        } else {
+            err = ESP_ERR_INVALID_STATE;
+        }
+        cache_unlock();
+    } else {
+        ESP_LOGD(TAG, "Failed to save session for %s:%u, -0x%x", host, port, -ret);
+        err = ret == MBEDTLS_ERR_SSL_ALLOC_FAILED ? ESP_ERR_NO_MEM : ESP_FAIL;
+    }
+
+    if (buf) {
+        mbedtls_platform_zeroize(buf, len);
+        mbedtls_free(buf);
+    }
+    return err;
+}
+
+void esp_mbedtls_session_cache_remove(const char *host, uint16_t port)
+{
+    session_cache_entry_t *entry;
+
+    if (!host) {
+        return;
+    }
+
+    cache_lock();
+    if (s_cache) {
+        entry = entry_find(host, port);
+        if (entry) {
+            entry_free(entry);
+        }
+    }
+    cache_unlock();
+}
+
+static void put_be(uint8_t *p, uint64_t val, int bytes)
+{
+    for (int i = bytes - 1; i >= 0; i--) {
+        p[i] = val & 0xff;
+        val >>= 8;
+    }
+}
+
+static uint64_t get_be(const uint8_t *p, int bytes)
+{
+    uint64_t val = 0;
+
+    for (int i = 0; i < bytes; i++) {
+        val = (val << 8) | p[i];
+    }
+    return val;
+}
+
+esp_err_t esp_mbedtls_session_cache_export(uint8_t *buf, size_t buf_len, size_t *olen)
+{
+    size_t len = 6;
+    uint16_t count = 0;
+    uint8_t *pos;
+
+    if (!olen) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    cache_lock();
+    if (!s_cache) {
+        cache_unlock();
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (size_t i = 0; i < s_cache->max_entries; i++) {
+        session_cache_entry_t *entry = &s_cache->entries[i];
+
+        if (entry->host) {
+            len += SESSION_CACHE_ENTRY_HDR + strlen(entry->host) + entry->len;
+        }
+    }
+    *olen = len;
+    if (!buf || buf_len < len) {
+        cache_unlock();
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    pos = buf + 6;
+    for (size_t i = 0; i < s_cache->max_entries; i++) {
+        session_cache_entry_t *entry = &s_cache->entries[i];
+        size_t host_len;
+
+        if (!entry->host) {
+            continue;
+        }
+        host_len = strlen(entry->host);
+        pos[0] = host_len;
+        put_be(pos + 1, entry->port, 2);
+        put_be(pos + 3, (uint64_t)entry->expires, 8);
+        put_be(pos + 11, entry->len, 4);
+        pos += SESSION_CACHE_ENTRY_HDR;
+        memcpy(pos, entry->host, host_len);
+        pos += host_len;
+        memcpy(pos, entry->session, entry->len);
+        pos += entry->len;
+        count++;
+    }
+    cache_unlock();
+
+    put_be(buf, SESSION_CACHE_MAGIC, 4);
+    put_be(buf + 4, count, 2);
+    return ESP_OK;
+}
+
+esp_err_t esp_mbedtls_session_cache_import(const uint8_t *buf, size_t len)
+{
+    char host[SESSION_CACHE_HOST_MAX + 1];
+    const uint8_t *pos, *end;
+    time_t now = time(NULL);
+    esp_err_t err = ESP_OK;
+    uint16_t count;
+
+    if (!buf || len < 6 || get_be(buf, 4) != SESSION_CACHE_MAGIC) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    count = get_be(buf + 4, 2);
+    pos = buf + 6;
+    end = buf + len;
+
+    cache_lock();
+    if (!s_cache) {
+        cache_unlock();
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (uint16_t i = 0; i < count && err == ESP_OK; i++) {
+        size_t host_len, session_len;
+        uint16_t port;
+        time_t expires;
+        bool has_room = false;
+
+        if (end - pos < SESSION_CACHE_ENTRY_HDR) {
+            err = ESP_ERR_INVALID_ARG;
+            break;
+        }
+        host_len = pos[0];
+        port = get_be(pos + 1, 2);
+        expires = (time_t)get_be(pos + 3, 8);
+        session_len = get_be(pos + 11, 4);
+        pos += SESSION_CACHE_ENTRY_HDR;
+        if ((size_t)(end - pos) < host_len || (size_t)(end - pos) - host_len < session_len) {
+            err = ESP_ERR_INVALID_ARG;
+            break;
+        }
+        memcpy(host, pos, host_len);
+        host[host_len] = '\0';
+        pos += host_len;
+
+        for (size_t j = 0; j < s_cache->max_entries; j++) {
+            if (!s_cache->entries[j].host || s_cache->entries[j].expires <= now) {
+                has_room = true;
+                break;
+            }
+        }
+        if (expires > now && has_room && !entry_find(host, port)) {
+            err = entry_store(host, port, expires, pos, session_len);
+        }
+        pos += session_len;
+    }
+    cache_unlock();
+
+    mbedtls_platform_zeroize(host, sizeof(host));
+    return err;
+}
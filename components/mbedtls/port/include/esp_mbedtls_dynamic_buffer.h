@@ -0,0 +1,44 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Statistics of the adaptive TX/RX record buffers (CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE)
+ */
+typedef struct {
+    uint32_t allocs;                /*!< Record buffers allocated */
+    uint32_t reuses;                /*!< Records that reused a kept buffer */
+    uint32_t grows;                 /*!< Kept buffers reallocated for a larger record */
+    uint32_t shrinks;               /*!< Kept buffers reallocated to the largest recent record size */
+    uint32_t pressure_frees;        /*!< Record buffers freed instead of kept because of low free heap */
+    uint32_t kept_bytes;            /*!< Bytes currently held by kept buffers of idle connections */
+    uint32_t peak_kept_bytes;       /*!< Largest value of kept_bytes since boot or the last reset */
+} esp_mbedtls_dynamic_buffer_stats_t;
+
+/**
+ * @brief Get the statistics of the adaptive TX/RX record buffers of all TLS connections
+ *
+ * @param[out] stats Statistics
+ */
+void esp_mbedtls_dynamic_buffer_get_stats(esp_mbedtls_dynamic_buffer_stats_t *stats);
+
+/**
+ * @brief Reset the counters of the adaptive record buffer statistics
+ *
+ * kept_bytes is not a counter and is left as is; peak_kept_bytes restarts from it.
+ */
+void esp_mbedtls_dynamic_buffer_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,137 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "mbedtls/ssl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Configuration of the TLS client session cache
+ */
+typedef struct {
+    size_t max_entries;     /*!< Maximum number of cached sessions; the least recently used one is evicted when full */
+    uint32_t ttl_sec;       /*!< Time in seconds a cached session is offered for resumption */
+} esp_mbedtls_session_cache_config_t;
+
+#define ESP_MBEDTLS_SESSION_CACHE_DEFAULT_CONFIG() {                    \
+    .max_entries = CONFIG_MBEDTLS_CLIENT_SESSION_CACHE_SIZE,            \
+    .ttl_sec = CONFIG_MBEDTLS_CLIENT_SESSION_CACHE_TTL,                 \
+}
+
+/**
+ * @brief Create the TLS client session cache
+ *
+ * The cache keeps the sessions of completed handshakes keyed by server host and port
+ * so that the next connection to the same server can resume the session instead of
+ * performing a full handshake (certificate chain verification and key exchange).
+ * Sessions are kept serialized, so an entry only holds the session secrets, the
+ * session ticket (if any) and, with MBEDTLS_SSL_KEEP_PEER_CERTIFICATE, the peer certificate.
+ *
+ * All functions of the cache are thread safe.
+ *
+ * @param[in] config Cache configuration
+ *
+ * @return
+ *      - ESP_OK: Success
+ *      - ESP_ERR_INVALID_ARG: Invalid configuration
+ *      - ESP_ERR_INVALID_STATE: The cache already exists
+ *      - ESP_ERR_NO_MEM: Out of memory
+ */
+esp_err_t esp_mbedtls_session_cache_init(const esp_mbedtls_session_cache_config_t *config);
+
+/**
+ * @brief Free the TLS client session cache and all cached sessions
+ */
+void esp_mbedtls_session_cache_deinit(void);
+
+/**
+ * @brief Offer the cached session for a server for resumption
+ *
+ * Call after mbedtls_ssl_setup() and before the handshake.
+ *
+ * @param[in] ssl  SSL context of the new connection
+ * @param[in] host Server host name
+ * @param[in] port Server port
+ *
+ * @return
+ *      - ESP_OK: A cached session was set on the SSL context
+ *      - ESP_ERR_NOT_FOUND: No valid session is cached for the server; a full handshake will be done
+ *      - ESP_ERR_INVALID_ARG: Invalid arguments
+ *      - ESP_ERR_INVALID_STATE: The cache was not created
+ *      - ESP_FAIL: The cached session could not be set
+ */
+esp_err_t esp_mbedtls_session_cache_set(mbedtls_ssl_context *ssl, const char *host, uint16_t port);
+
+/**
+ * @brief Store the session of a connection in the cache
+ *
+ * Call after a successful handshake. An existing entry for the server is replaced.
+ *
+ * @param[in] ssl  SSL context of the connection
+ * @param[in] host Server host name
+ * @param[in] port Server port
+ *
+ * @return
+ *      - ESP_OK: Success
+ *      - ESP_ERR_INVALID_ARG: Invalid arguments
+ *      - ESP_ERR_INVALID_STATE: The cache was not created
+ *      - ESP_ERR_NO_MEM: Out of memory
+ *      - ESP_FAIL: The session could not be read from the SSL context
+ */
+esp_err_t esp_mbedtls_session_cache_save(const mbedtls_ssl_context *ssl, const char *host, uint16_t port);
+
+/**
+ * @brief Remove the cached session of a server, e.g. after resumption was refused
+ *
+ * @param[in] host Server host name
+ * @param[in] port Server port
+ */
+void esp_mbedtls_session_cache_remove(const char *host, uint16_t port);
+
+/**
+ * @brief Serialize the cached sessions, e.g. to keep them in NVS across reboots
+ *
+ * @note The output contains the session secrets. Only store it in encrypted storage.
+ *
+ * @param[out] buf     Output buffer, or NULL to query the required length
+ * @param[in]  buf_len Length of the output buffer
+ * @param[out] olen    Number of bytes written, or required if buf is too small
+ *
+ * @return
+ *      - ESP_OK: Success
+ *      - ESP_ERR_INVALID_SIZE: buf is NULL or too small, olen holds the required length
+ *      - ESP_ERR_INVALID_ARG: Invalid arguments
+ *      - ESP_ERR_INVALID_STATE: The cache was not created
+ */
+esp_err_t esp_mbedtls_session_cache_export(uint8_t *buf, size_t buf_len, size_t *olen);
+
+/**
+ * @brief Load sessions serialized by esp_mbedtls_session_cache_export()
+ *
+ * Expired sessions are skipped and cached sessions are kept. Entries are added while
+ * the cache has free space.
+ *
+ * @param[in] buf Serialized sessions
+ * @param[in] len Length of buf
+ *
+ * @return
+ *      - ESP_OK: Success
+ *      - ESP_ERR_INVALID_ARG: Invalid arguments or malformed data
+ *      - ESP_ERR_INVALID_STATE: The cache was not created
+ *      - ESP_ERR_NO_MEM: Out of memory
+ */
+esp_err_t esp_mbedtls_session_cache_import(const uint8_t *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
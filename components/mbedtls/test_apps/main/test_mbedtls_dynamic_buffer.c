@@ -0,0 +1,228 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdlib.h>
+#include <sys/param.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "sdkconfig.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/net_sockets.h"
+#include "mbedtls/ssl.h"
+
+#include "unity.h"
+#include "test_utils.h"
+#include "unity_test_utils.h"
+
+#if CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE
+#include "esp_mbedtls_dynamic_buffer.h"
+#endif
+
+#define SERVER_ADDRESS "localhost"
+#define SERVER_PORT "4435"
+#define SEM_TIMEOUT 10000
+#define STREAM_BYTES (64 * 1024)
+
+extern const uint8_t server_cert_chain_pem_start[] asm("_binary_server_cert_chain_pem_start");
+extern const uint8_t server_cert_chain_pem_end[]   asm("_binary_server_cert_chain_pem_end");
+
+extern const uint8_t server_pk_start[] asm("_binary_prvtkey_pem_start");
+extern const uint8_t server_pk_end[]   asm("_binary_prvtkey_pem_end");
+
+static const char *TAG = "dynamic_buffer_test";
+
+typedef struct {
+    SemaphoreHandle_t sema;
+    size_t chunk;
+} stream_server_t;
+
+static volatile size_t s_min_free;
+
+static void sample_heap(void)
+{
+    size_t free_size = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+
+    if (free_size < s_min_free) {
+        s_min_free = free_size;
+    }
+}
+
+static void stream_server_task(void *pvParameters)
+{
+    stream_server_t *server = (stream_server_t *) pvParameters;
+    mbedtls_ssl_context ssl;
+    mbedtls_ssl_config conf;
+    mbedtls_net_context listen_fd, fd;
+    mbedtls_entropy_context entropy;
+    mbedtls_ctr_drbg_context ctr_drbg;
+    mbedtls_x509_crt cert;
+    mbedtls_pk_context pkey;
+    unsigned char *data;
+    size_t sent = 0;
+    int ret;
+
+    mbedtls_ssl_init(&ssl);
+    mbedtls_ssl_config_init(&conf);
+    mbedtls_net_init(&listen_fd);
+    mbedtls_net_init(&fd);
+    mbedtls_entropy_init(&entropy);
+    mbedtls_ctr_drbg_init(&ctr_drbg);
+    mbedtls_x509_crt_init(&cert);
+    mbedtls_pk_init(&pkey);
+
+    data = calloc(1, server->chunk);
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL(0, mbedtls_ctr_drbg_seed(&ctr_drbg, mbedtls_entropy_func, &entropy, NULL, 0));
+    TEST_ASSERT_EQUAL(0, mbedtls_x509_crt_parse(&cert, server_cert_chain_pem_start,
+                                                server_cert_chain_pem_end - server_cert_chain_pem_start));
+    TEST_ASSERT_EQUAL(0, mbedtls_pk_parse_key(&pkey, server_pk_start, server_pk_end - server_pk_start,
+                                              NULL, 0, mbedtls_ctr_drbg_random, &ctr_drbg));
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_config_defaults(&conf, MBEDTLS_SSL_IS_SERVER, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                                     MBEDTLS_SSL_PRESET_DEFAULT));
+    mbedtls_ssl_conf_rng(&conf, mbedtls_ctr_drbg_random, &ctr_drbg);
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_conf_own_cert(&conf, &cert, &pkey));
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_setup(&ssl, &conf));
+    TEST_ASSERT_EQUAL(0, mbedtls_net_bind(&listen_fd, NULL, SERVER_PORT, MBEDTLS_NET_PROTO_TCP));
+
+    xSemaphoreGive(server->sema);
+
+    TEST_ASSERT_EQUAL(0, mbedtls_net_accept(&listen_fd, &fd, NULL, 0, NULL));
+    mbedtls_ssl_set_bio(&ssl, &fd, mbedtls_net_send, mbedtls_net_recv, NULL);
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_handshake(&ssl));
+
+    while (sent < STREAM_BYTES) {
+        ret = mbedtls_ssl_write(&ssl, data, MIN(server->chunk, STREAM_BYTES - sent));
+        if (ret < 0) {
+            TEST_ASSERT_TRUE(ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE);
+            continue;
+        }
+        sent += ret;
+        sample_heap();
+    }
+    mbedtls_ssl_close_notify(&ssl);
+
+    free(data);
+    mbedtls_net_free(&fd);
+    mbedtls_net_free(&listen_fd);
+    mbedtls_ssl_free(&ssl);
+    mbedtls_ssl_config_free(&conf);
+    mbedtls_x509_crt_free(&cert);
+    mbedtls_pk_free(&pkey);
+    mbedtls_ctr_drbg_free(&ctr_drbg);
+    mbedtls_entropy_free(&entropy);
+
+    xSemaphoreGive(server->sema);
+    vTaskSuspend(NULL);
+}
+
+/* Stream STREAM_BYTES from the server in writes of "chunk" bytes, log throughput and peak heap use */
+static void stream_once(size_t chunk)
+{
+    stream_server_t server = { .chunk = chunk };
+    mbedtls_ssl_context ssl;
+    mbedtls_ssl_config conf;
+    mbedtls_net_context fd;
+    mbedtls_entropy_context entropy;
+    mbedtls_ctr_drbg_context ctr_drbg;
+    TaskHandle_t server_task_handle;
+    unsigned char buf[1024];
+    size_t received = 0, free_before;
+    int64_t start, elapsed;
+    int ret;
+
+    server.sema = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(server.sema);
+
+    free_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    s_min_free = free_before;
+
+    xTaskCreate(stream_server_task, "stream server", 8192, &server, 10, &server_task_handle);
+    if (!xSemaphoreTake(server.sema, SEM_TIMEOUT / portTICK_PERIOD_MS)) {
+        TEST_FAIL_MESSAGE("server start failed");
+    }
+
+    mbedtls_ssl_init(&ssl);
+    mbedtls_ssl_config_init(&conf);
+    mbedtls_net_init(&fd);
+    mbedtls_entropy_init(&entropy);
+    mbedtls_ctr_drbg_init(&ctr_drbg);
+
+    TEST_ASSERT_EQUAL(0, mbedtls_ctr_drbg_seed(&ctr_drbg, mbedtls_entropy_func, &entropy, NULL, 0));
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_config_defaults(&conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                                     MBEDTLS_SSL_PRESET_DEFAULT));
+    mbedtls_ssl_conf_rng(&conf, mbedtls_ctr_drbg_random, &ctr_drbg);
+    mbedtls_ssl_conf_authmode(&conf, MBEDTLS_SSL_VERIFY_NONE);
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_setup(&ssl, &conf));
+    TEST_ASSERT_EQUAL(0, mbedtls_net_connect(&fd, SERVER_ADDRESS, SERVER_PORT, MBEDTLS_NET_PROTO_TCP));
+    mbedtls_ssl_set_bio(&ssl, &fd, mbedtls_net_send, mbedtls_net_recv, NULL);
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_handshake(&ssl));
+
+    start = esp_timer_get_time();
+    while (received < STREAM_BYTES) {
+        ret = mbedtls_ssl_read(&ssl, buf, sizeof(buf));
+        if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+            continue;
+        }
+        TEST_ASSERT_GREATER_THAN(0, ret);
+        received += ret;
+        sample_heap();
+    }
+    elapsed = esp_timer_get_time() - start;
+
+    mbedtls_net_free(&fd);
+    mbedtls_ssl_free(&ssl);
+    mbedtls_ssl_config_free(&conf);
+    mbedtls_ctr_drbg_free(&ctr_drbg);
+    mbedtls_entropy_free(&entropy);
+
+    if (!xSemaphoreTake(server.sema, SEM_TIMEOUT / portTICK_PERIOD_MS)) {
+        TEST_FAIL_MESSAGE("server exit failed");
+    }
+    unity_utils_task_delete(server_task_handle);
+    vSemaphoreDelete(server.sema);
+
+    ESP_LOGI(TAG, "%s buffers, %u byte writes: %lld KB/s, peak heap use %u bytes",
+#if CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE
+             "adaptive",
+#elif CONFIG_MBEDTLS_DYNAMIC_BUFFER
+             "dynamic",
+#else
+             "static",
+#endif
+             (unsigned)chunk, (long long)STREAM_BYTES * 1000000 / 1024 / MAX(elapsed, 1),
+             (unsigned)(free_before - s_min_free));
+}
+
+TEST_CASE("mbedtls record buffer streaming throughput and heap", "[mbedtls]")
+{
+    test_case_uses_tcpip();
+
+#if CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE
+    esp_mbedtls_dynamic_buffer_stats_t stats;
+
+    esp_mbedtls_dynamic_buffer_reset_stats();
+#endif
+
+    /* Full size records, then small records */
+    stream_once(16 * 1024);
+    stream_once(256);
+
+#if CONFIG_MBEDTLS_DYNAMIC_BUFFER_ADAPTIVE
+    esp_mbedtls_dynamic_buffer_get_stats(&stats);
+    ESP_LOGI(TAG, "allocs %u reuses %u grows %u shrinks %u pressure frees %u peak kept %u bytes",
+             (unsigned)stats.allocs, (unsigned)stats.reuses, (unsigned)stats.grows, (unsigned)stats.shrinks,
+             (unsigned)stats.pressure_frees, (unsigned)stats.peak_kept_bytes);
+    TEST_ASSERT_GREATER_THAN(stats.allocs, stats.reuses);
+    /* Buffers kept by the closed connections are released with them */
+    TEST_ASSERT_EQUAL(0, stats.kept_bytes);
+#endif
+}
@@ -0,0 +1,250 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/net_sockets.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/ssl_cache.h"
+
+#include "unity.h"
+#include "test_utils.h"
+#include "unity_test_utils.h"
+
+#if CONFIG_MBEDTLS_CLIENT_SESSION_CACHE
+
+#include "esp_session_cache.h"
+
+#define SERVER_ADDRESS "localhost"
+#define SERVER_PORT "4434"
+#define SERVER_PORT_NUM 4434
+#define SEM_TIMEOUT 10000
+
+extern const uint8_t server_cert_chain_pem_start[] asm("_binary_server_cert_chain_pem_start");
+extern const uint8_t server_cert_chain_pem_end[]   asm("_binary_server_cert_chain_pem_end");
+
+extern const uint8_t server_pk_start[] asm("_binary_prvtkey_pem_start");
+extern const uint8_t server_pk_end[]   asm("_binary_prvtkey_pem_end");
+
+static const char *TAG = "session_cache_test";
+
+static volatile bool s_exit_flag;
+static int s_verify_calls;
+
+typedef struct {
+    mbedtls_ssl_context ssl;
+    mbedtls_ssl_config conf;
+    mbedtls_net_context listen_fd;
+    mbedtls_net_context fd;
+    mbedtls_entropy_context entropy;
+    mbedtls_ctr_drbg_context ctr_drbg;
+    mbedtls_x509_crt cert;
+    mbedtls_pk_context pkey;
+    mbedtls_ssl_cache_context cache;
+} tls_endpoint_t;
+
+static void endpoint_init(tls_endpoint_t *ep, int endpoint)
+{
+    mbedtls_ssl_init(&ep->ssl);
+    mbedtls_ssl_config_init(&ep->conf);
+    mbedtls_net_init(&ep->listen_fd);
+    mbedtls_net_init(&ep->fd);
+    mbedtls_entropy_init(&ep->entropy);
+    mbedtls_ctr_drbg_init(&ep->ctr_drbg);
+    mbedtls_x509_crt_init(&ep->cert);
+    mbedtls_pk_init(&ep->pkey);
+    mbedtls_ssl_cache_init(&ep->cache);
+
+    TEST_ASSERT_EQUAL(0, mbedtls_ctr_drbg_seed(&ep->ctr_drbg, mbedtls_entropy_func, &ep->entropy, NULL, 0));
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_config_defaults(&ep->conf, endpoint, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                                     MBEDTLS_SSL_PRESET_DEFAULT));
+    mbedtls_ssl_conf_rng(&ep->conf, mbedtls_ctr_drbg_random, &ep->ctr_drbg);
+    mbedtls_ssl_conf_max_tls_version(&ep->conf, MBEDTLS_SSL_VERSION_TLS1_2);
+}
+
+static void endpoint_free(tls_endpoint_t *ep)
+{
+    mbedtls_net_free(&ep->fd);
+    mbedtls_net_free(&ep->listen_fd);
+    mbedtls_ssl_free(&ep->ssl);
+    mbedtls_ssl_config_free(&ep->conf);
+    mbedtls_ssl_cache_free(&ep->cache);
+    mbedtls_x509_crt_free(&ep->cert);
+    mbedtls_pk_free(&ep->pkey);
+    mbedtls_ctr_drbg_free(&ep->ctr_drbg);
+    mbedtls_entropy_free(&ep->entropy);
+}
+
+static void server_task(void *pvParameters)
+{
+    SemaphoreHandle_t *sema = (SemaphoreHandle_t *) pvParameters;
+    tls_endpoint_t server;
+
+    endpoint_init(&server, MBEDTLS_SSL_IS_SERVER);
+    TEST_ASSERT_EQUAL(0, mbedtls_x509_crt_parse(&server.cert, server_cert_chain_pem_start,
+                                                server_cert_chain_pem_end - server_cert_chain_pem_start));
+    TEST_ASSERT_EQUAL(0, mbedtls_pk_parse_key(&server.pkey, server_pk_start, server_pk_end - server_pk_start,
+                                              NULL, 0, mbedtls_ctr_drbg_random, &server.ctr_drbg));
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_conf_own_cert(&server.conf, &server.cert, &server.pkey));
+    /* Session ID based resumption */
+    mbedtls_ssl_conf_session_cache(&server.conf, &server.cache, mbedtls_ssl_cache_get, mbedtls_ssl_cache_set);
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_setup(&server.ssl, &server.conf));
+    TEST_ASSERT_EQUAL(0, mbedtls_net_bind(&server.listen_fd, NULL, SERVER_PORT, MBEDTLS_NET_PROTO_TCP));
+    mbedtls_net_set_nonblock(&server.listen_fd);
+
+    xSemaphoreGive(*sema);
+
+    while (!s_exit_flag) {
+        if (mbedtls_net_accept(&server.listen_fd, &server.fd, NULL, 0, NULL) == 0) {
+            mbedtls_net_set_block(&server.fd);
+            mbedtls_ssl_set_bio(&server.ssl, &server.fd, mbedtls_net_send, mbedtls_net_recv, NULL);
+            mbedtls_ssl_handshake(&server.ssl);
+            mbedtls_ssl_close_notify(&server.ssl);
+            mbedtls_ssl_session_reset(&server.ssl);
+            mbedtls_net_free(&server.fd);
+        }
+        vTaskDelay(10 / portTICK_PERIOD_MS);
+    }
+
+    endpoint_free(&server);
+    xSemaphoreGive(*sema);
+    vTaskSuspend(NULL);
+}
+
+static int count_verify(void *ctx, mbedtls_x509_crt *crt, int depth, uint32_t *flags)
+{
+    s_verify_calls++;
+    return 0;
+}
+
+/* One client connection, returns the handshake time in us and the ID of the negotiated session */
+static int64_t client_connect(bool resume, esp_err_t *set_err, unsigned char id[32], size_t *id_len)
+{
+    tls_endpoint_t client;
+    mbedtls_ssl_session session;
+    int64_t start, elapsed;
+    int ret;
+
+    endpoint_init(&client, MBEDTLS_SSL_IS_CLIENT);
+    mbedtls_ssl_conf_authmode(&client.conf, MBEDTLS_SSL_VERIFY_OPTIONAL);
+    mbedtls_ssl_conf_verify(&client.conf, count_verify, NULL);
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_setup(&client.ssl, &client.conf));
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_set_hostname(&client.ssl, SERVER_ADDRESS));
+
+    if (resume) {
+        *set_err = esp_mbedtls_session_cache_set(&client.ssl, SERVER_ADDRESS, SERVER_PORT_NUM);
+    }
+
+    TEST_ASSERT_EQUAL(0, mbedtls_net_connect(&client.fd, SERVER_ADDRESS, SERVER_PORT, MBEDTLS_NET_PROTO_TCP));
+    mbedtls_ssl_set_bio(&client.ssl, &client.fd, mbedtls_net_send, mbedtls_net_recv, NULL);
+
+    start = esp_timer_get_time();
+    while ((ret = mbedtls_ssl_handshake(&client.ssl)) != 0) {
+        if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+            break;
+        }
+    }
+    elapsed = esp_timer_get_time() - start;
+    TEST_ASSERT_EQUAL(0, ret);
+
+    mbedtls_ssl_session_init(&session);
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_get_session(&client.ssl, &session));
+    *id_len = mbedtls_ssl_session_get_id_len(&session);
+    TEST_ASSERT_NOT_EQUAL(0, *id_len);
+    memcpy(id, *mbedtls_ssl_session_get_id(&session), *id_len);
+    mbedtls_ssl_session_free(&session);
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_mbedtls_session_cache_save(&client.ssl, SERVER_ADDRESS, SERVER_PORT_NUM));
+
+    mbedtls_ssl_close_notify(&client.ssl);
+    endpoint_free(&client);
+    return elapsed;
+}
+
+TEST_CASE("client session cache resumes handshakes", "[mbedtls]")
+{
+    esp_mbedtls_session_cache_config_t cfg = ESP_MBEDTLS_SESSION_CACHE_DEFAULT_CONFIG();
+    unsigned char full_id[32], id[32];
+    size_t full_id_len, id_len;
+    esp_err_t set_err = ESP_FAIL;
+    uint8_t *blob;
+    size_t len;
+    int verify_calls;
+    int64_t full_us, resumed_us;
+
+    test_case_uses_tcpip();
+
+    SemaphoreHandle_t signal_sem = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(signal_sem);
+
+    s_exit_flag = false;
+    TaskHandle_t server_task_handle;
+    xTaskCreate(server_task, "server task", 8192, &signal_sem, 10, &server_task_handle);
+    if (!xSemaphoreTake(signal_sem, SEM_TIMEOUT / portTICK_PERIOD_MS)) {
+        TEST_FAIL_MESSAGE("signal_sem not released, server start failed");
+    }
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_mbedtls_session_cache_init(&cfg));
+
+    /* Full handshake, nothing cached yet */
+    s_verify_calls = 0;
+    full_us = client_connect(false, NULL, full_id, &full_id_len);
+    verify_calls = s_verify_calls;
+    TEST_ASSERT_NOT_EQUAL(0, verify_calls);
+
+    /* The server resumed the cached session: same session ID, and the
+     * certificate chain is not verified again */
+    resumed_us = client_connect(true, &set_err, id, &id_len);
+    TEST_ASSERT_EQUAL(ESP_OK, set_err);
+    TEST_ASSERT_EQUAL(full_id_len, id_len);
+    TEST_ASSERT_EQUAL_MEMORY(full_id, id, id_len);
+    TEST_ASSERT_EQUAL(verify_calls, s_verify_calls);
+    ESP_LOGI(TAG, "handshake: full %lld us, resumed %lld us", full_us, resumed_us);
+
+    /* Persisted sessions survive re-creating the cache */
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, esp_mbedtls_session_cache_export(NULL, 0, &len));
+    blob = malloc(len);
+    TEST_ASSERT_NOT_NULL(blob);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_mbedtls_session_cache_export(blob, len, &len));
+    esp_mbedtls_session_cache_deinit();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_mbedtls_session_cache_init(&cfg));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_mbedtls_session_cache_import(blob, len));
+    free(blob);
+
+    set_err = ESP_FAIL;
+    client_connect(true, &set_err, id, &id_len);
+    TEST_ASSERT_EQUAL(ESP_OK, set_err);
+    TEST_ASSERT_EQUAL(full_id_len, id_len);
+    TEST_ASSERT_EQUAL_MEMORY(full_id, id, id_len);
+    TEST_ASSERT_EQUAL(verify_calls, s_verify_calls);
+
+    /* Removed sessions fall back to a full handshake with a new session */
+    esp_mbedtls_session_cache_remove(SERVER_ADDRESS, SERVER_PORT_NUM);
+    client_connect(true, &set_err, id, &id_len);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, set_err);
+    TEST_ASSERT(id_len != full_id_len || memcmp(full_id, id, id_len) != 0);
+    TEST_ASSERT_EQUAL(2 * verify_calls, s_verify_calls);
+
+    esp_mbedtls_session_cache_deinit();
+
+    s_exit_flag = true;
+    if (!xSemaphoreTake(signal_sem, SEM_TIMEOUT / portTICK_PERIOD_MS)) {
+        TEST_FAIL_MESSAGE("signal_sem not released, server exit failed");
+    }
+    unity_utils_task_delete(server_task_handle);
+    vSemaphoreDelete(signal_sem);
+}
+
+#endif /* CONFIG_MBEDTLS_CLIENT_SESSION_CACHE */
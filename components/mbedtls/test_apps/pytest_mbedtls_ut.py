@@ -87,3 +87,18 @@ def test_mbedtls_ecdsa_sign(dut: Dut) -> None:
 )
 def test_mbedtls_rom_impl_esp32c2(dut: Dut) -> None:
     dut.run_all_single_board_cases()
+
+
+@pytest.mark.esp32
+@pytest.mark.esp32c3
+@pytest.mark.generic
+@pytest.mark.parametrize(
+    'config',
+    [
+        'dynamic_buffer',
+        'dynamic_buffer_adaptive',
+    ],
+    indirect=True,
+)
+def test_mbedtls_dynamic_buffer(dut: Dut) -> None:
+    dut.run_all_single_board_cases()
@@ -38,6 +38,14 @@ intr_handler_t intr_handler_get(int rv_int_num);
  */
 void *intr_handler_get_arg(int rv_int_num);
 
+/** Get the frame of the context interrupted by the handler being run
+ *
+ * The frame is laid out as RvExcFrame, up to the t6 register.
+ *
+ *@return registers saved when the interrupt was taken, or NULL if called outside of an interrupt handler
+ */
+const void *intr_handler_get_frame(void);
+
 /*************************** Interrupt matrix ***************************/
 
 /**
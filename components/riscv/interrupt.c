@@ -29,6 +29,9 @@ typedef struct {
 
 static intr_handler_item_t s_intr_handlers[32];
 
+/* Frame of the context interrupted by the handler being run */
+static const void *s_intr_frame;
+
 void intr_handler_set(int int_no, intr_handler_t fn, void *arg)
 {
     assert_valid_rv_int_num(int_no);
@@ -49,12 +52,21 @@ void *intr_handler_get_arg(int rv_int_num)
     return s_intr_handlers[rv_int_num].arg;
 }
 
+const void *intr_handler_get_frame(void)
+{
+    return s_intr_frame;
+}
+
 /* called from vectors.S */
-void _global_interrupt_handler(intptr_t sp, int mcause)
+void _global_interrupt_handler(intptr_t frame, int mcause)
 {
     intr_handler_item_t it = s_intr_handlers[mcause];
     if (it.handler) {
+        /* Nested interrupts restore it before this handler resumes */
+        const void *prev_frame = s_intr_frame;
+        s_intr_frame = (const void *) frame;
         (*it.handler)(it.arg);
+        s_intr_frame = prev_frame;
     }
 }
 
@@ -73,6 +73,46 @@ esp_err_t esp_supplicant_deinit(void);
  */
 esp_err_t esp_supplicant_disable_pmk_caching(bool disable);
 
+/**
+ * @brief Save the station PMKSA cache in encrypted form.
+ *
+ * The cached PMKSAs are encrypted and authenticated with AES-GCM under the given key so that the
+ * application can keep them in NVS or RTC memory and hand them back to esp_supplicant_pmksa_cache_restore()
+ * after a reboot or deep sleep. Reconnecting with a restored PMKSA skips the SAE or 802.1X exchange.
+ * Expired entries are not saved. The cache is read on the Wi-Fi task, so this call blocks until it is done.
+ *
+ * @param key AES key (16 or 32 bytes) protecting the saved entries. It should be device unique,
+ *            e.g. derived from a key kept in eFuse or encrypted NVS.
+ * @param key_len Length of the key
+ * @param buf Buffer for the saved entries, or NULL to query the required length
+ * @param[inout] len Length of buf on input, number of bytes written (or required) on output
+ * @return
+ *     - ESP_OK: Success
+ *     - ESP_ERR_INVALID_ARG: Invalid key or len
+ *     - ESP_ERR_INVALID_SIZE: buf is too small, len holds the required length
+ *     - ESP_ERR_INVALID_STATE: Wi-Fi or the supplicant not initialized
+ *     - ESP_FAIL: Encryption failed
+ */
+esp_err_t esp_supplicant_pmksa_cache_save(const uint8_t *key, size_t key_len, uint8_t *buf, size_t *len);
+
+/**
+ * @brief Restore station PMKSA cache entries saved by esp_supplicant_pmksa_cache_save().
+ *
+ * Entries are aged by the wall-clock time elapsed since they were saved and expired ones are dropped.
+ * Call this after esp_wifi_start() and before connecting.
+ *
+ * @param key AES key used when the entries were saved
+ * @param key_len Length of the key
+ * @param buf Saved entries
+ * @param len Length of the saved entries
+ * @return
+ *     - ESP_OK: Success (zero or more entries restored)
+ *     - ESP_ERR_INVALID_ARG: Invalid arguments
+ *     - ESP_ERR_INVALID_STATE: Wi-Fi or the supplicant not initialized
+ *     - ESP_FAIL: The saved entries could not be authenticated with the key
+ */
+esp_err_t esp_supplicant_pmksa_cache_restore(const uint8_t *key, size_t key_len, const uint8_t *buf, size_t len);
+
 /**
   * @}
   */
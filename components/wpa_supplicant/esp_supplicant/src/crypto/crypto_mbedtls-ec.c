@@ -45,10 +45,115 @@ static int crypto_rng_wrapper(void *ctx, unsigned char *buf, size_t len)
 	return random_get_bytes(buf, len);
 }
 
-struct crypto_ec *crypto_ec_init(int group)
+/*
+ * Groups for the NIST curves used by SAE, OWE and DPP are loaded once and
+ * shared process-wide. Before a group is published its generator is
+ * multiplied once, which makes mbedtls keep the fixed-base comb table in the
+ * group (unless a static table is already in flash). After that, mbedtls only
+ * reads the shared group, so it can be used from several tasks at once.
+ * Cached groups are never freed.
+ */
+static const mbedtls_ecp_group_id crypto_ec_cache_ids[] = {
+	MBEDTLS_ECP_DP_SECP256R1,
+	MBEDTLS_ECP_DP_SECP384R1,
+	MBEDTLS_ECP_DP_SECP521R1,
+};
+static struct crypto_ec *crypto_ec_cache[ARRAY_SIZE(crypto_ec_cache_ids)];
+
+static struct crypto_ec *crypto_ec_load(mbedtls_ecp_group_id grp_id)
 {
 	struct crypto_ec *e;
 
+	e = os_zalloc(sizeof(*e));
+	if (e == NULL) {
+		return NULL;
+	}
+
+	mbedtls_ecp_group_init(&e->group);
+
+	if (mbedtls_ecp_group_load(&e->group, grp_id)) {
+		mbedtls_ecp_group_free(&e->group);
+		os_free(e);
+		return NULL;
+	}
+
+	return e;
+}
+
+static int crypto_ec_precompute(struct crypto_ec *e)
+{
+	mbedtls_ecp_point R;
+	mbedtls_mpi one;
+	int ret;
+
+	mbedtls_ecp_point_init(&R);
+	mbedtls_mpi_init(&one);
+
+	MBEDTLS_MPI_CHK(mbedtls_mpi_lset(&one, 1));
+	MBEDTLS_MPI_CHK(mbedtls_ecp_mul(&e->group, &R, &one, &e->group.G,
+					crypto_rng_wrapper, NULL));
+
+cleanup:
+	mbedtls_mpi_free(&one);
+	mbedtls_ecp_point_free(&R);
+	return ret ? -1 : 0;
+}
+
+static struct crypto_ec *crypto_ec_get_cached(mbedtls_ecp_group_id grp_id)
+{
+	struct crypto_ec *e, *cached;
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(crypto_ec_cache_ids); i++) {
+		if (crypto_ec_cache_ids[i] == grp_id) {
+			break;
+		}
+	}
+	if (i == ARRAY_SIZE(crypto_ec_cache_ids)) {
+		return crypto_ec_load(grp_id);
+	}
+
+	e = __atomic_load_n(&crypto_ec_cache[i], __ATOMIC_ACQUIRE);
+	if (e) {
+		return e;
+	}
+
+	e = crypto_ec_load(grp_id);
+	if (e == NULL) {
+		return NULL;
+	}
+	if (crypto_ec_precompute(e) < 0) {
+		mbedtls_ecp_group_free(&e->group);
+		os_free(e);
+		return NULL;
+	}
+
+	/* Another task may have published the group meanwhile */
+	cached = NULL;
+	if (!__atomic_compare_exchange_n(&crypto_ec_cache[i], &cached, e, false,
+					 __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+		mbedtls_ecp_group_free(&e->group);
+		os_free(e);
+		e = cached;
+	}
+
+	return e;
+}
+
+static bool crypto_ec_is_cached(const struct crypto_ec *e)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(crypto_ec_cache); i++) {
+		if (e == __atomic_load_n(&crypto_ec_cache[i], __ATOMIC_RELAXED)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+struct crypto_ec *crypto_ec_init(int group)
+{
 	mbedtls_ecp_group_id  grp_id;
 
 	/* IANA registry to mbedtls internal mapping*/
@@ -63,25 +168,14 @@ struct crypto_ec *crypto_ec_init(int group)
 			return NULL;
 
 	}
-	e = os_zalloc(sizeof(*e));
-	if (e == NULL) {
-		return NULL;
-	}
 
-	mbedtls_ecp_group_init(&e->group);
-
-	if (mbedtls_ecp_group_load(&e->group, grp_id)) {
-		crypto_ec_deinit(e);
-		e = NULL;
-	}
-
-	return e;
+	return crypto_ec_get_cached(grp_id);
 }
 
 
 void crypto_ec_deinit(struct crypto_ec *e)
 {
-	if (e == NULL) {
+	if (e == NULL || crypto_ec_is_cached(e)) {
 		return;
 	}
 
@@ -129,16 +223,13 @@ struct crypto_ec_group *crypto_ec_get_group_byname(const char *name)
 	struct crypto_ec *e;
 	const mbedtls_ecp_curve_info *curve = mbedtls_ecp_curve_info_from_name(name);
 
-	e = os_zalloc(sizeof(*e));
-	if (e == NULL) {
+	if (curve == NULL) {
 		return NULL;
 	}
 
-	mbedtls_ecp_group_init( &e->group );
-
-	if (mbedtls_ecp_group_load(&e->group, curve->grp_id)) {
-		crypto_ec_deinit(e);
-		e = NULL;
+	e = crypto_ec_get_cached(curve->grp_id);
+	if (e == NULL) {
+		return NULL;
 	}
 
 	return (struct crypto_ec_group *) &e->group;
@@ -268,24 +359,16 @@ int crypto_ec_point_mul(struct crypto_ec *e, const struct crypto_ec_point *p,
 		struct crypto_ec_point *res)
 {
 	int ret;
-	mbedtls_entropy_context entropy;
-	mbedtls_ctr_drbg_context ctr_drbg;
-
-	mbedtls_entropy_init(&entropy);
-	mbedtls_ctr_drbg_init(&ctr_drbg);
-
-	MBEDTLS_MPI_CHK(mbedtls_ctr_drbg_seed(&ctr_drbg, mbedtls_entropy_func, &entropy,
-				NULL, 0));
 
+	/* The RNG is only used for blinding; seeding a DRBG for every
+	 * multiplication cost more than the generator multiplication itself */
 	MBEDTLS_MPI_CHK(mbedtls_ecp_mul(&e->group,
 				(mbedtls_ecp_point *) res,
 				(const mbedtls_mpi *)b,
 				(const mbedtls_ecp_point *)p,
-				mbedtls_ctr_drbg_random,
-				&ctr_drbg));
+				crypto_rng_wrapper,
+				NULL));
 cleanup:
-	mbedtls_ctr_drbg_free(&ctr_drbg);
-	mbedtls_entropy_free(&entropy);
 	return ret ? -1 : 0;
 }
 
@@ -379,10 +379,204 @@ DECL_PBKDF2(sha1,                           // _name
             sha1_extract,                   // _xtract
             sha1_xor)                       // _xxor
 
+/* --- Multi-lane PBKDF2-HMAC-SHA1 ---
+ *
+ * Every PBKDF2 output block is an independent chain of SHA-1 compressions,
+ * so several chains (both blocks of a PSK, blocks of other passphrases) are
+ * run side by side in lanes. Lane state is stored word-major so each step of
+ * the compression is a loop over lanes the compiler can interleave.
+ *
+ * After the first iteration both the inner and the outer hash of each
+ * iteration compress a single block holding a 20-byte digest and fixed
+ * padding for a 64 + 20 byte message, so only those five words vary.
+ */
+#define SHA1_LANES 2
+
+#define ROL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+typedef uint32_t sha1_lanes_t[5][SHA1_LANES];
+
+static void sha1_lanes_xform(sha1_lanes_t out, const sha1_lanes_t start,
+                             const sha1_lanes_t msg)
+{
+  uint32_t w[16][SHA1_LANES];
+  uint32_t a[SHA1_LANES], b[SHA1_LANES], c[SHA1_LANES], d[SHA1_LANES], e[SHA1_LANES];
+  int t, l;
+
+  for (l = 0; l < SHA1_LANES; l++)
+  {
+    w[0][l] = msg[0][l];
+    w[1][l] = msg[1][l];
+    w[2][l] = msg[2][l];
+    w[3][l] = msg[3][l];
+    w[4][l] = msg[4][l];
+    w[5][l] = 0x80000000;
+    for (t = 6; t < 15; t++)
+      w[t][l] = 0;
+    w[15][l] = (64 + 20) * 8;
+
+    a[l] = start[0][l];
+    b[l] = start[1][l];
+    c[l] = start[2][l];
+    d[l] = start[3][l];
+    e[l] = start[4][l];
+  }
+
+#define SHA1_LANES_ROUND(_t, _f, _k)                                          \
+  for (l = 0; l < SHA1_LANES; l++)                                            \
+  {                                                                           \
+    uint32_t wt = w[(_t) & 15][l];                                            \
+    if ((_t) >= 16)                                                           \
+    {                                                                         \
+      wt = ROL32(w[((_t) - 3) & 15][l] ^ w[((_t) - 8) & 15][l] ^              \
+                 w[((_t) - 14) & 15][l] ^ wt, 1);                             \
+      w[(_t) & 15][l] = wt;                                                   \
+    }                                                                         \
+    uint32_t tmp = ROL32(a[l], 5) + (_f) + e[l] + (_k) + wt;                  \
+    e[l] = d[l];                                                              \
+    d[l] = c[l];                                                              \
+    c[l] = ROL32(b[l], 30);                                                   \
+    b[l] = a[l];                                                              \
+    a[l] = tmp;                                                               \
+  }
+
+  for (t = 0; t < 20; t++)
+    SHA1_LANES_ROUND(t, (b[l] & c[l]) | (~b[l] & d[l]), 0x5a827999)
+  for (; t < 40; t++)
+    SHA1_LANES_ROUND(t, b[l] ^ c[l] ^ d[l], 0x6ed9eba1)
+  for (; t < 60; t++)
+    SHA1_LANES_ROUND(t, (b[l] & c[l]) | (b[l] & d[l]) | (c[l] & d[l]), 0x8f1bbcdc)
+  for (; t < 80; t++)
+    SHA1_LANES_ROUND(t, b[l] ^ c[l] ^ d[l], 0xca62c1d6)
+#undef SHA1_LANES_ROUND
+
+  for (l = 0; l < SHA1_LANES; l++)
+  {
+    out[0][l] = start[0][l] + a[l];
+    out[1][l] = start[1][l] + b[l];
+    out[2][l] = start[2][l] + c[l];
+    out[3][l] = start[3][l] + d[l];
+    out[4][l] = start[4][l] + e[l];
+  }
+}
+
+typedef struct {
+  sha1_lanes_t inner; /* hash state after the ipad block */
+  sha1_lanes_t outer; /* hash state after the opad block */
+  sha1_lanes_t u;     /* U_c */
+  sha1_lanes_t result;
+  uint8_t *out[SHA1_LANES];
+  size_t nout[SHA1_LANES];
+} sha1_lanes_batch;
+
+static inline void sha1_lanes_load(sha1_lanes_t dst, int lane, const uint8_t in[20])
+{
+  for (int i = 0; i < 5; i++)
+    dst[i][lane] = ((uint32_t) in[4 * i] << 24) | ((uint32_t) in[4 * i + 1] << 16) |
+                   ((uint32_t) in[4 * i + 2] << 8) | in[4 * i + 3];
+}
+
+/* Load output block counter of pw/salt into a lane: key the HMAC and compute
+ * U_1 with the regular implementation, then leave U_2..U_c to the lanes. */
+static void sha1_lanes_start(sha1_lanes_batch *batch, int lane,
+                             const uint8_t *pw, size_t npw,
+                             const uint8_t *salt, size_t nsalt,
+                             uint32_t counter, uint8_t *out, size_t nout)
+{
+  HMAC_CTX(sha1) ctx;
+  uint8_t buf[20];
+  uint8_t countbuf[4];
+
+  HMAC_INIT(sha1)(&ctx, pw, npw);
+  sha1_extract(&ctx.inner, buf);
+  sha1_lanes_load(batch->inner, lane, buf);
+  sha1_extract(&ctx.outer, buf);
+  sha1_lanes_load(batch->outer, lane, buf);
+
+  write32_be(counter, countbuf);
+  HMAC_UPDATE(sha1)(&ctx, salt, nsalt);
+  HMAC_UPDATE(sha1)(&ctx, countbuf, sizeof countbuf);
+  HMAC_FINAL(sha1)(&ctx, buf);
+  sha1_lanes_load(batch->u, lane, buf);
+  sha1_lanes_load(batch->result, lane, buf);
+
+  batch->out[lane] = out;
+  batch->nout[lane] = nout;
+  forced_memzero(&ctx, sizeof(ctx));
+  forced_memzero(buf, sizeof(buf));
+}
+
+static void sha1_lanes_run(sha1_lanes_batch *batch, int lanes, uint32_t iterations)
+{
+  sha1_lanes_t inner_out;
+  uint8_t block[20];
+
+  for (uint32_t i = 1; i < iterations; i++)
+  {
+    sha1_lanes_xform(inner_out, batch->inner, batch->u);
+    sha1_lanes_xform(batch->u, batch->outer, inner_out);
+    for (int w = 0; w < 5; w++)
+      for (int l = 0; l < SHA1_LANES; l++)
+        batch->result[w][l] ^= batch->u[w][l];
+  }
+
+  for (int l = 0; l < lanes; l++)
+  {
+    for (int w = 0; w < 5; w++)
+      write32_be(batch->result[w][l], block + 4 * w);
+    memcpy(batch->out[l], block, batch->nout[l]);
+  }
+  forced_memzero(batch, sizeof(*batch));
+  forced_memzero(inner_out, sizeof(inner_out));
+  forced_memzero(block, sizeof(block));
+}
+
+void fastpbkdf2_hmac_sha1_multi(const fastpbkdf2_sha1_job *jobs, size_t njobs,
+                                uint32_t iterations)
+{
+  sha1_lanes_batch batch;
+  int lanes = 0;
+
+  assert(iterations);
+  memset(&batch, 0, sizeof(batch));
+
+  for (size_t j = 0; j < njobs; j++)
+  {
+    const fastpbkdf2_sha1_job *job = &jobs[j];
+    uint32_t blocks_needed = (uint32_t)(job->nout + 20 - 1) / 20;
+
+    assert(job->out && job->nout);
+    for (uint32_t counter = 1; counter <= blocks_needed; counter++)
+    {
+      size_t offset = (counter - 1) * 20;
+
+      sha1_lanes_start(&batch, lanes, job->pw, job->npw, job->salt, job->nsalt,
+                       counter, job->out + offset, MIN(job->nout - offset, 20));
+      if (++lanes == SHA1_LANES)
+      {
+        sha1_lanes_run(&batch, lanes, iterations);
+        lanes = 0;
+      }
+    }
+  }
+
+  if (lanes)
+    sha1_lanes_run(&batch, lanes, iterations);
+}
+
 void fastpbkdf2_hmac_sha1(const uint8_t *pw, size_t npw,
                           const uint8_t *salt, size_t nsalt,
                           uint32_t iterations,
                           uint8_t *out, size_t nout)
 {
+#if !CONFIG_ESP_WIFI_FAST_PBKDF2_LANES || (defined(MBEDTLS_SHA1_ALT) && !CONFIG_IDF_TARGET_ESP32)
+  /* Targets with a SHA accelerator run the chains one block at a time */
   PBKDF2(sha1)(pw, npw, salt, nsalt, iterations, out, nout);
+#else
+  fastpbkdf2_sha1_job job = {
+    .pw = pw, .npw = npw, .salt = salt, .nsalt = nsalt, .out = out, .nout = nout,
+  };
+
+  fastpbkdf2_hmac_sha1_multi(&job, 1, iterations);
+#endif
 }
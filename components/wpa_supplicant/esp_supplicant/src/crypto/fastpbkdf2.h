@@ -41,6 +41,27 @@ void fastpbkdf2_hmac_sha1(const uint8_t *pw, size_t npw,
                           const uint8_t *salt, size_t nsalt,
                           uint32_t iterations,
                           uint8_t *out, size_t nout);
+
+/** One PBKDF2-HMAC-SHA1 derivation for fastpbkdf2_hmac_sha1_multi(). */
+typedef struct {
+  const uint8_t *pw;
+  size_t npw;
+  const uint8_t *salt;
+  size_t nsalt;
+  uint8_t *out;
+  size_t nout;
+} fastpbkdf2_sha1_job;
+
+/** Calculates PBKDF2-HMAC-SHA1 for @p njobs derivations at once.
+ *
+ *  All derivations use @p iterations iterations. The output blocks of all
+ *  jobs are computed in parallel lanes, which is faster than calling
+ *  fastpbkdf2_hmac_sha1() for each job, e.g., when deriving many PSKs.
+ *
+ *  This function cannot fail; it does not report errors.
+ */
+void fastpbkdf2_hmac_sha1_multi(const fastpbkdf2_sha1_job *jobs, size_t njobs,
+                                uint32_t iterations);
 #ifdef __cplusplus
 }
 #endif
@@ -67,6 +67,8 @@ uint32_t tls_instance_count;
 struct tls_data {
 	/* Data for mbedlts */
 	struct wpabuf *in_data;
+	/* Part of in_data not yet read by mbedtls */
+	struct wpabuf in_view;
 	/* Data from mbedtls */
 	struct wpabuf *out_data;
 };
@@ -131,23 +133,16 @@ static int tls_mbedtls_read(void *ctx, unsigned char *buf, size_t len)
 {
 	struct tls_connection *conn = (struct tls_connection *)ctx;
 	struct tls_data *data = &conn->tls_io_data;
-	struct wpabuf *local_buf;
 
-	if (data->in_data == NULL || len > wpabuf_len(data->in_data)) {
+	if (data->in_data == NULL || len > wpabuf_len(&data->in_view)) {
 		/* We don't have suffient buffer available for read */
 		wpa_printf(MSG_INFO, "len=%zu not available in input", len);
 		return MBEDTLS_ERR_SSL_WANT_READ;
 	}
 
-	os_memcpy(buf, wpabuf_head(data->in_data), len);
-	/* adjust buffer */
-	if (len < wpabuf_len(data->in_data)) {
-		/* TODO optimize this operation */
-		local_buf = wpabuf_alloc_copy(wpabuf_mhead_u8(data->in_data) + len,
-					      wpabuf_len(data->in_data) - len);
-		wpabuf_free(data->in_data);
-		data->in_data = local_buf;
-	} else {
+	/* Advance the view rather than copying the rest of the input */
+	os_memcpy(buf, wpabuf_pull(&data->in_view, len), len);
+	if (wpabuf_len(&data->in_view) == 0) {
 		wpabuf_free(data->in_data);
 		data->in_data = NULL;
 	}
@@ -155,6 +150,17 @@ static int tls_mbedtls_read(void *ctx, unsigned char *buf, size_t len)
 	return len;
 }
 
+static int tls_mbedtls_set_input(struct tls_data *data, const struct wpabuf *in_data)
+{
+	wpabuf_free(data->in_data);
+	data->in_data = wpabuf_dup(in_data);
+	if (!data->in_data) {
+		return -1;
+	}
+	wpabuf_slice(&data->in_view, data->in_data, 0, wpabuf_len(data->in_data));
+	return 0;
+}
+
 static int set_pki_context(tls_context_t *tls, const struct tls_connection_params *cfg)
 {
 	int ret;
@@ -749,7 +755,7 @@ struct wpabuf * tls_connection_handshake(void *tls_ctx,
 	/* data freed by sender */
 	conn->tls_io_data.out_data = NULL;
 	if (wpabuf_len(in_data)) {
-		conn->tls_io_data.in_data = wpabuf_dup(in_data);
+		tls_mbedtls_set_input(&conn->tls_io_data, in_data);
 	}
 
 	/* Multiple reads */
@@ -845,9 +851,7 @@ struct wpabuf *tls_connection_decrypt(void *tls_ctx,
 	/* Reset dangling output buffer before setting data, data was freed by caller */
 	conn->tls_io_data.out_data = NULL;
 
-	conn->tls_io_data.in_data = wpabuf_dup(in_data);
-
-	if (!conn->tls_io_data.in_data) {
+	if (tls_mbedtls_set_input(&conn->tls_io_data, in_data) < 0) {
 		goto cleanup;
 	}
 	ret = mbedtls_ssl_read(&conn->tls->ssl, buf, MAX_PHASE2_BUFFER);
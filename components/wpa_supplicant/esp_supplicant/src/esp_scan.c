@@ -115,54 +115,43 @@ int esp_handle_beacon_probe(u8 type, u8 *frame, size_t len, u8 *sender,
 {
 	struct wpa_supplicant *wpa_s = &g_wpa_supp;
 	struct os_reltime now;
-	struct wpa_scan_res *res;
-	u8 *ptr;
+	struct wpa_scan_res res;
 
 	if (len < 12) {
 		wpa_printf(MSG_ERROR, "beacon/probe is having short len=%d", len);
 		return -1;
 	}
 
-	res = os_zalloc(sizeof(struct wpa_scan_res) + len - 12);
-	if (!res) {
-		wpa_printf(MSG_ERROR, "failed to allocate memory");
-		return -1;
-	}
-
-	ptr = (u8 *)res;
+	/* The IEs are copied straight from the frame into the BSS entry */
+	os_memset(&res, 0, sizeof(res));
 	os_get_time(&now);
-	os_memcpy(res->bssid, sender, ETH_ALEN);
-	res->tsf = WPA_GET_LE64(frame);
+	os_memcpy(res.bssid, sender, ETH_ALEN);
+	res.tsf = WPA_GET_LE64(frame);
 	frame += 8;
 	len -= 8;
 
 	if ((wpa_s->scan_start_tsf == 0) &&
 	    wpa_s->current_bss &&
 	    (os_memcmp(wpa_s->current_bss, sender, ETH_ALEN) == 0)) {
-		wpa_s->scan_start_tsf = res->tsf;
+		wpa_s->scan_start_tsf = res.tsf;
 		os_memcpy(wpa_s->tsf_bssid, sender, ETH_ALEN);
 	}
-	res->beacon_int = WPA_GET_LE16(frame);
+	res.beacon_int = WPA_GET_LE16(frame);
 
 	frame += 2;
 	len -= 2;
-	res->caps = WPA_GET_LE16(frame);
+	res.caps = WPA_GET_LE16(frame);
 	frame += 2;
 	len -= 2;
 
-	res->chan = channel;
-	res->noise = 0;
-	res->level = rssi;
-	os_memcpy(res->tsf_bssid, wpa_s->tsf_bssid, ETH_ALEN);
-	res->parent_tsf = current_tsf - wpa_s->scan_start_tsf;
-	res->ie_len = len;
+	res.chan = channel;
+	res.noise = 0;
+	res.level = rssi;
+	os_memcpy(res.tsf_bssid, wpa_s->tsf_bssid, ETH_ALEN);
+	res.parent_tsf = current_tsf - wpa_s->scan_start_tsf;
+	res.ie_len = len;
 
-	ptr += sizeof(struct wpa_scan_res);
-
-	/* update rest of the frame */
-	os_memcpy(ptr, frame, len);
-	wpa_bss_update_scan_res(wpa_s, res, &now);
-	os_free(res);
+	wpa_bss_update_scan_res_ies(wpa_s, &res, frame, &now);
 
 	return 0;
 }
@@ -17,6 +17,10 @@
 #include "esp_hostap.h"
 #include <inttypes.h>
 #include <zephyr/kernel.h>
+#include "crypto/crypto.h"
+#include "crypto/sha256.h"
+#include "esp_attr.h"
+#include "soc/soc_caps.h"
 static struct sae_pt *g_sae_pt;
 static struct sae_data g_sae_data;
 static struct wpabuf *g_sae_token = NULL;
@@ -24,6 +28,261 @@ static struct wpabuf *g_sae_commit = NULL;
 static struct wpabuf *g_sae_confirm = NULL;
 int g_allowed_groups[] = { IANA_SECP256R1, 0 };
 
+/*
+ * Cache of H2E password elements. The hash-to-curve derivation is by far the
+ * most expensive part of building an H2E commit, and its result only depends
+ * on the SSID, the password, the password identifier and the group, so it is
+ * kept across disconnects (and, optionally, deep sleep) instead of being
+ * re-derived on every connection attempt. Only the serialized point and a
+ * digest of the credentials are stored; the password itself never is. The
+ * cache outlives a station or Wi-Fi deinit: entries are only invalidated when
+ * a new station config drops every element that was not derived from it, and
+ * the storage is only wiped by esp_wpa3_sae_pt_cache_clear().
+ */
+#define SAE_PT_CACHE_SIZE 2
+#define SAE_PT_CACHE_SSID_ID_LEN 8
+
+struct sae_pt_cache_entry {
+    int group;
+    size_t pt_len;
+    u8 ssid_id[SAE_PT_CACHE_SSID_ID_LEN];
+    u8 key[SHA256_MAC_LEN];
+    u8 pt[2 * SAE_MAX_ECC_PRIME_LEN];
+};
+
+#ifdef CONFIG_ESP_WIFI_SAE_PT_CACHE_RTC
+static RTC_DATA_ATTR struct sae_pt_cache_entry g_sae_pt_cache[SAE_PT_CACHE_SIZE];
+static RTC_DATA_ATTR unsigned int g_sae_pt_cache_next;
+#else
+static struct sae_pt_cache_entry g_sae_pt_cache[SAE_PT_CACHE_SIZE];
+static unsigned int g_sae_pt_cache_next;
+#endif
+static unsigned int g_sae_pt_cache_hits;
+static unsigned int g_sae_pt_cache_misses;
+
+static int sae_pt_cache_digest(int group, const u8 *ssid, size_t ssid_len,
+                               const u8 *password, size_t password_len,
+                               const char *identifier, u8 *ssid_id, u8 *key)
+{
+    static const char label[] = "ESP SAE PT cache";
+    u8 hdr[4];
+    u8 hash[SHA256_MAC_LEN];
+    const u8 *addr[5];
+    size_t len[5];
+
+    WPA_PUT_BE16(hdr, group);
+    WPA_PUT_BE16(hdr + 2, ssid_len);
+
+    addr[0] = (const u8 *) label;
+    len[0] = sizeof(label) - 1;
+    addr[1] = hdr;
+    len[1] = sizeof(hdr);
+    addr[2] = ssid;
+    len[2] = ssid_len;
+    if (sha256_vector(3, addr, len, hash) < 0) {
+        return -1;
+    }
+    os_memcpy(ssid_id, hash, SAE_PT_CACHE_SSID_ID_LEN);
+
+    /* The NUL terminator separates the password from the identifier */
+    addr[3] = password;
+    len[3] = password_len + 1;
+    addr[4] = (const u8 *) identifier;
+    len[4] = identifier ? os_strlen(identifier) : 0;
+    if (sha256_vector(5, addr, len, key) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static void sae_pt_cache_store(const u8 *ssid_id, const u8 *key,
+                               const struct sae_pt *pt)
+{
+    struct sae_pt_cache_entry *entry = NULL;
+    size_t prime_len;
+    int i;
+
+    if (!pt->ec) {
+        return;
+    }
+    prime_len = crypto_ec_prime_len(pt->ec);
+    if (2 * prime_len > sizeof(entry->pt)) {
+        return;
+    }
+
+    /* Credentials changed for a network we already know: replace its entry */
+    for (i = 0; i < SAE_PT_CACHE_SIZE; i++) {
+        if (g_sae_pt_cache[i].group == pt->group &&
+            os_memcmp(g_sae_pt_cache[i].ssid_id, ssid_id,
+                      SAE_PT_CACHE_SSID_ID_LEN) == 0) {
+            entry = &g_sae_pt_cache[i];
+            break;
+        }
+    }
+    if (!entry) {
+        entry = &g_sae_pt_cache[g_sae_pt_cache_next % SAE_PT_CACHE_SIZE];
+        g_sae_pt_cache_next++;
+    }
+
+    forced_memzero(entry, sizeof(*entry));
+    if (crypto_ec_point_to_bin(pt->ec, pt->ecc_pt, entry->pt,
+                               entry->pt + prime_len) < 0) {
+        forced_memzero(entry, sizeof(*entry));
+        return;
+    }
+    entry->pt_len = 2 * prime_len;
+    os_memcpy(entry->ssid_id, ssid_id, SAE_PT_CACHE_SSID_ID_LEN);
+    os_memcpy(entry->key, key, SHA256_MAC_LEN);
+    entry->group = pt->group;
+}
+
+static struct sae_pt *sae_pt_cache_load(int group, const u8 *ssid_id,
+                                        const u8 *key)
+{
+    struct sae_pt_cache_entry *entry = NULL;
+    struct sae_pt *pt;
+    int i;
+
+    for (i = 0; i < SAE_PT_CACHE_SIZE; i++) {
+        if (g_sae_pt_cache[i].group == group &&
+            os_memcmp(g_sae_pt_cache[i].ssid_id, ssid_id,
+                      SAE_PT_CACHE_SSID_ID_LEN) == 0 &&
+            os_memcmp_const(g_sae_pt_cache[i].key, key, SHA256_MAC_LEN) == 0) {
+            entry = &g_sae_pt_cache[i];
+            break;
+        }
+    }
+    if (!entry) {
+        return NULL;
+    }
+
+    pt = os_zalloc(sizeof(*pt));
+    if (!pt) {
+        return NULL;
+    }
+    pt->group = group;
+    pt->ec = crypto_ec_init(group);
+    if (!pt->ec || crypto_ec_prime_len(pt->ec) * 2 != entry->pt_len) {
+        goto fail;
+    }
+    pt->ecc_pt = crypto_ec_point_from_bin(pt->ec, entry->pt);
+    if (!pt->ecc_pt || !crypto_ec_point_is_on_curve(pt->ec, pt->ecc_pt)) {
+        goto fail;
+    }
+    return pt;
+
+fail:
+    /* Never hand out a corrupted element; drop it and derive again */
+    forced_memzero(entry, sizeof(*entry));
+    sae_deinit_pt(pt);
+    return NULL;
+}
+
+struct sae_pt *esp_wpa3_sae_pt_get(int *groups, const u8 *ssid, size_t ssid_len,
+                                   const u8 *password, size_t password_len,
+                                   const char *identifier)
+{
+    struct sae_pt *pt = NULL, *last = NULL, *tmp;
+    u8 ssid_id[SAE_PT_CACHE_SSID_ID_LEN];
+    u8 key[SHA256_MAC_LEN];
+    int group_list[2] = { 0, 0 };
+    int i;
+
+    if (ssid_len > SSID_MAX_LEN) {
+        return NULL;
+    }
+
+    for (i = 0; groups[i] > 0; i++) {
+        if (sae_pt_cache_digest(groups[i], ssid, ssid_len, password,
+                                password_len, identifier, ssid_id, key) < 0) {
+            goto fail;
+        }
+
+        tmp = sae_pt_cache_load(groups[i], ssid_id, key);
+        if (tmp) {
+            g_sae_pt_cache_hits++;
+            wpa_printf(MSG_DEBUG, "SAE: Using cached PT for group %d",
+                       groups[i]);
+        } else {
+            g_sae_pt_cache_misses++;
+            group_list[0] = groups[i];
+            tmp = sae_derive_pt(group_list, ssid, ssid_len, password,
+                                password_len, identifier);
+            if (!tmp) {
+                continue;
+            }
+            sae_pt_cache_store(ssid_id, key, tmp);
+        }
+#ifdef CONFIG_SAE_PK
+        os_memcpy(tmp->ssid, ssid, ssid_len);
+        tmp->ssid_len = ssid_len;
+#endif /* CONFIG_SAE_PK */
+
+        if (last) {
+            last->next = tmp;
+        } else {
+            pt = tmp;
+        }
+        last = tmp;
+    }
+
+    forced_memzero(key, sizeof(key));
+    return pt;
+
+fail:
+    forced_memzero(key, sizeof(key));
+    sae_deinit_pt(pt);
+    return NULL;
+}
+
+void esp_wpa3_sae_pt_cache_clear(void)
+{
+    forced_memzero(g_sae_pt_cache, sizeof(g_sae_pt_cache));
+    g_sae_pt_cache_next = 0;
+    g_sae_pt_cache_hits = 0;
+    g_sae_pt_cache_misses = 0;
+}
+
+void esp_wpa3_sae_pt_cache_sync_config(void)
+{
+    struct wifi_ssid *ssid = esp_wifi_sta_get_prof_ssid_internal();
+    const u8 *pw = (const u8 *)esp_wifi_sta_get_prof_password_internal();
+    char sae_pwd_id[SAE_H2E_IDENTIFIER_LEN+1] = {0};
+    u8 ssid_id[SAE_PT_CACHE_SSID_ID_LEN];
+    u8 key[SHA256_MAC_LEN];
+    int i;
+
+    if (!ssid || !pw || ssid->len > SSID_MAX_LEN) {
+        esp_wpa3_sae_pt_cache_clear();
+        return;
+    }
+    memcpy(sae_pwd_id, esp_wifi_sta_get_sae_identifier_internal(), SAE_H2E_IDENTIFIER_LEN);
+
+    /* Only the elements of the network now configured may outlive a config change */
+    for (i = 0; i < SAE_PT_CACHE_SIZE; i++) {
+        struct sae_pt_cache_entry *entry = &g_sae_pt_cache[i];
+
+        if (!entry->group) {
+            continue;
+        }
+        if (sae_pt_cache_digest(entry->group, ssid->ssid, ssid->len, pw,
+                                os_strlen((const char *)pw),
+                                os_strlen(sae_pwd_id) ? sae_pwd_id : NULL,
+                                ssid_id, key) < 0 ||
+            os_memcmp(entry->ssid_id, ssid_id, SAE_PT_CACHE_SSID_ID_LEN) != 0 ||
+            os_memcmp_const(entry->key, key, SHA256_MAC_LEN) != 0) {
+            forced_memzero(entry, sizeof(*entry));
+        }
+    }
+    forced_memzero(key, sizeof(key));
+}
+
+void esp_wpa3_sae_pt_cache_get_stats(unsigned int *hits, unsigned int *misses)
+{
+    *hits = g_sae_pt_cache_hits;
+    *misses = g_sae_pt_cache_misses;
+}
+
 static esp_err_t wpa3_build_sae_commit(u8 *bssid, size_t *sae_msg_len)
 {
     int default_group = IANA_SECP256R1;
@@ -84,7 +343,7 @@ static esp_err_t wpa3_build_sae_commit(u8 *bssid, size_t *sae_msg_len)
     }
 
     if (use_pt && !g_sae_pt) {
-        g_sae_pt = sae_derive_pt(g_allowed_groups, ssid->ssid, ssid->len, pw, strlen((const char *)pw), valid_pwd_id ? sae_pwd_id : NULL);
+        g_sae_pt = esp_wpa3_sae_pt_get(g_allowed_groups, ssid->ssid, ssid->len, pw, strlen((const char *)pw), valid_pwd_id ? sae_pwd_id : NULL);
     }
 
     if (wpa_sta_cur_pmksa_matches_akm()) {
@@ -343,9 +602,103 @@ void esp_wifi_unregister_wpa3_cb(void)
 static void *g_wpa3_hostap_task_hdl = NULL;
 static void *g_wpa3_hostap_evt_queue = NULL;
 struct k_sem * g_wpa3_hostap_auth_api_lock = NULL;
+static void *g_wpa3_hostap_state_lock = NULL;
+static struct wpa3_hostap_sae_stats g_wpa3_hostap_sae_stats;
+
+#if WPA3_HOSTAP_SAE_WORKERS > 1
+#define WPA3_SAE_WORK_COMMIT 1
+#define WPA3_SAE_WORK_STOP   0
+
+static void *g_wpa3_sae_worker_hdl[WPA3_HOSTAP_SAE_WORKERS];
+static void *g_wpa3_sae_work_queue = NULL;
+static void *g_wpa3_sae_worker_exit_sem = NULL;
+static int g_wpa3_sae_worker_num;
+#endif /* WPA3_HOSTAP_SAE_WORKERS > 1 */
+
+void wpa3_hostap_state_lock(void)
+{
+    if (g_wpa3_hostap_state_lock) {
+        os_mutex_lock(g_wpa3_hostap_state_lock);
+    }
+}
+
+void wpa3_hostap_state_unlock(void)
+{
+    if (g_wpa3_hostap_state_lock) {
+        os_mutex_unlock(g_wpa3_hostap_state_lock);
+    }
+}
+
+/* Called with the state lock held, from the task processing a commit */
+unsigned int wpa3_hostap_sae_commits_in_flight(void)
+{
+    return g_wpa3_hostap_sae_stats.in_flight ? g_wpa3_hostap_sae_stats.in_flight - 1 : 0;
+}
+
+/* Called with the state lock held, by auth_sae_queue() */
+void wpa3_hostap_sae_stats_commit_queued(u32 queue_depth)
+{
+    g_wpa3_hostap_sae_stats.queued++;
+    g_wpa3_hostap_sae_stats.queue_depth = queue_depth;
+    if (queue_depth > g_wpa3_hostap_sae_stats.queue_depth_max) {
+        g_wpa3_hostap_sae_stats.queue_depth_max = queue_depth;
+    }
+}
+
+/* Called with the state lock held, by auth_sae_queue() */
+void wpa3_hostap_sae_stats_commit_dropped(void)
+{
+    g_wpa3_hostap_sae_stats.dropped++;
+}
+
+void wpa3_hostap_sae_stats_get(struct wpa3_hostap_sae_stats *stats)
+{
+    wpa3_hostap_state_lock();
+    os_memcpy(stats, &g_wpa3_hostap_sae_stats, sizeof(*stats));
+    wpa3_hostap_state_unlock();
+}
+
+void wpa3_hostap_sae_stats_reset(void)
+{
+    u32 queue_depth, in_flight;
+
+    wpa3_hostap_state_lock();
+    queue_depth = g_wpa3_hostap_sae_stats.queue_depth;
+    in_flight = g_wpa3_hostap_sae_stats.in_flight;
+    os_memset(&g_wpa3_hostap_sae_stats, 0, sizeof(g_wpa3_hostap_sae_stats));
+    g_wpa3_hostap_sae_stats.queue_depth = queue_depth;
+    g_wpa3_hostap_sae_stats.queue_depth_max = queue_depth;
+    g_wpa3_hostap_sae_stats.in_flight = in_flight;
+    wpa3_hostap_state_unlock();
+}
+
+#if WPA3_HOSTAP_SAE_WORKERS > 1
+static int wpa3_hostap_post_commit_work(void)
+{
+    u32 work = WPA3_SAE_WORK_COMMIT;
+    int ret = ESP_OK;
+
+    if (!g_wpa3_hostap_auth_api_lock) {
+        return ESP_FAIL;
+    }
+    WPA3_HOSTAP_AUTH_API_LOCK();
+    if (!g_wpa3_sae_work_queue ||
+        os_queue_send(g_wpa3_sae_work_queue, &work, 0) != pdPASS) {
+        ret = ESP_FAIL;
+    }
+    WPA3_HOSTAP_AUTH_API_UNLOCK();
+    return ret;
+}
+#endif /* WPA3_HOSTAP_SAE_WORKERS > 1 */
 
 int wpa3_hostap_post_evt(uint32_t evt_id, uint32_t data)
 {
+#if WPA3_HOSTAP_SAE_WORKERS > 1
+    if (evt_id == SIG_WPA3_RX_COMMIT) {
+        return wpa3_hostap_post_commit_work();
+    }
+#endif /* WPA3_HOSTAP_SAE_WORKERS > 1 */
+
     wpa3_hostap_auth_event_t *evt = os_zalloc(sizeof(wpa3_hostap_auth_event_t));
     if (evt == NULL) {
         return ESP_FAIL;
@@ -385,25 +738,55 @@ int wpa3_hostap_post_evt(uint32_t evt_id, uint32_t data)
     return ESP_OK;
 }
 
-static void wpa3_process_rx_commit(wpa3_hostap_auth_event_t *evt)
+static void wpa3_sae_commit_done(struct hostapd_sae_commit_queue *frm, bool processed)
+{
+    struct os_reltime now, age;
+    u32 latency_us;
+
+    os_get_reltime(&now);
+    os_reltime_sub(&now, &frm->rx_time, &age);
+    latency_us = age.sec * 1000000 + age.usec;
+
+    wpa3_hostap_state_lock();
+    g_wpa3_hostap_sae_stats.in_flight--;
+    if (processed) {
+        g_wpa3_hostap_sae_stats.processed++;
+        g_wpa3_hostap_sae_stats.latency_total_us += latency_us;
+        if (latency_us > g_wpa3_hostap_sae_stats.latency_max_us) {
+            g_wpa3_hostap_sae_stats.latency_max_us = latency_us;
+        }
+    } else {
+        g_wpa3_hostap_sae_stats.dropped++;
+    }
+    wpa3_hostap_state_unlock();
+}
+
+static void wpa3_process_rx_commit(void)
 {
     struct hostapd_sae_commit_queue *frm;
     struct hostapd_data *hapd = (struct hostapd_data *)esp_wifi_get_hostap_private_internal();
     struct sta_info *sta = NULL;
+    bool processed = false;
     int ret;
+
+    wpa3_hostap_state_lock();
     frm = dl_list_first(&hapd->sae_commit_queue,
                         struct hostapd_sae_commit_queue, list);
     if (!frm) {
+        wpa3_hostap_state_unlock();
         return;
     }
 
     dl_list_del(&frm->list);
+    g_wpa3_hostap_sae_stats.queue_depth = dl_list_len(&hapd->sae_commit_queue);
+    g_wpa3_hostap_sae_stats.in_flight++;
     wpa_printf(MSG_DEBUG, "SAE: Process next available message from queue");
 
     sta = ap_get_sta(hapd, frm->bssid);
     if (!sta) {
         sta = ap_sta_add(hapd, frm->bssid);
         if (!sta) {
+            wpa3_hostap_state_unlock();
             wpa_printf(MSG_DEBUG, "ap_sta_add() failed");
             ret = WLAN_STATUS_AP_UNABLE_TO_HANDLE_NEW_STA;
             if (esp_send_sae_auth_reply(hapd, frm->bssid, frm->bssid, WLAN_AUTH_SAE,
@@ -415,27 +798,39 @@ static void wpa3_process_rx_commit(wpa3_hostap_auth_event_t *evt)
         }
     }
 
-    if (sta->lock && os_semphr_take(sta->lock, 0)) {
-        sta->sae_commit_processing = true;
-        ret = handle_auth_sae(hapd, sta, frm->msg, frm->len, frm->bssid, frm->auth_transaction, frm->status);
+    /* Taking sta->lock under the state lock keeps the station from being
+     * freed under us; the expensive part then runs without the state lock */
+    if (!sta->lock || !os_semphr_take(sta->lock, 0)) {
+        wpa3_hostap_state_unlock();
+        goto free;
+    }
+    sta->sae_commit_processing = true;
+    wpa3_hostap_state_unlock();
 
-        if (sta->remove_pending) {
-            ap_free_sta(hapd, sta);
-            goto free;
-        }
-        sta->sae_commit_processing = false;
-        os_semphr_give(sta->lock);
-        uint16_t aid = 0;
-        if (ret != WLAN_STATUS_SUCCESS &&
-            ret != WLAN_STATUS_ANTI_CLOGGING_TOKEN_REQ) {
-            esp_wifi_ap_get_sta_aid(frm->bssid, &aid);
-            if (aid == 0) {
-                esp_wifi_ap_deauth_internal(frm->bssid, ret);
-            }
+    ret = handle_auth_sae(hapd, sta, frm->msg, frm->len, frm->bssid, frm->auth_transaction, frm->status);
+    processed = true;
+
+    wpa3_hostap_state_lock();
+    if (sta->remove_pending) {
+        ap_free_sta(hapd, sta);
+        wpa3_hostap_state_unlock();
+        goto free;
+    }
+    sta->sae_commit_processing = false;
+    os_semphr_give(sta->lock);
+    wpa3_hostap_state_unlock();
+
+    uint16_t aid = 0;
+    if (ret != WLAN_STATUS_SUCCESS &&
+        ret != WLAN_STATUS_ANTI_CLOGGING_TOKEN_REQ) {
+        esp_wifi_ap_get_sta_aid(frm->bssid, &aid);
+        if (aid == 0) {
+            esp_wifi_ap_deauth_internal(frm->bssid, ret);
         }
     }
 
 free:
+    wpa3_sae_commit_done(frm, processed);
     os_free(frm);
 }
 
@@ -448,25 +843,26 @@ static void wpa3_process_rx_confirm(wpa3_hostap_auth_event_t *evt)
     if (!frm) {
         return;
     }
+    wpa3_hostap_state_lock();
     sta = ap_get_sta(hapd, frm->bssid);
     if (!sta) {
+        wpa3_hostap_state_unlock();
         os_free(frm);
         return;
     }
 
     if (sta->lock && os_semphr_take(sta->lock, 0)) {
+        wpa3_hostap_state_unlock();
         ret = handle_auth_sae(hapd, sta, frm->msg, frm->len, frm->bssid, frm->auth_transaction, frm->status);
 
-        if (sta->remove_pending) {
+        if (sta->remove_pending ||
+            (ret == WLAN_STATUS_SUCCESS &&
+             esp_wifi_ap_notify_node_sae_auth_done(frm->bssid) != true)) {
+            wpa3_hostap_state_lock();
             ap_free_sta(hapd, sta);
+            wpa3_hostap_state_unlock();
             goto done;
         }
-        if (ret == WLAN_STATUS_SUCCESS) {
-            if (esp_wifi_ap_notify_node_sae_auth_done(frm->bssid) != true) {
-                ap_free_sta(hapd, sta);
-                goto done;
-            }
-        }
         os_semphr_give(sta->lock);
         if (ret != WLAN_STATUS_SUCCESS) {
             uint16_t aid = 0;
@@ -475,11 +871,92 @@ static void wpa3_process_rx_confirm(wpa3_hostap_auth_event_t *evt)
                 esp_wifi_ap_deauth_internal(frm->bssid, ret);
             }
         }
+    } else {
+        wpa3_hostap_state_unlock();
     }
 done:
     os_free(frm);
 }
 
+#if WPA3_HOSTAP_SAE_WORKERS > 1
+static void esp_wpa3_sae_worker_task(void *pvParameters)
+{
+    u32 work;
+
+    while (1) {
+        if (os_queue_recv(g_wpa3_sae_work_queue, &work, portMAX_DELAY) == 1) {
+            if (work == WPA3_SAE_WORK_STOP) {
+                break;
+            }
+            wpa3_process_rx_commit();
+        }
+    }
+    os_semphr_give(g_wpa3_sae_worker_exit_sem);
+    os_task_delete(NULL);
+}
+
+static void wpa3_hostap_sae_workers_stop(void)
+{
+    u32 work = WPA3_SAE_WORK_STOP;
+    int i;
+
+    for (i = 0; i < g_wpa3_sae_worker_num; i++) {
+        os_queue_send(g_wpa3_sae_work_queue, &work, portMAX_DELAY);
+    }
+    for (i = 0; i < g_wpa3_sae_worker_num; i++) {
+        os_semphr_take(g_wpa3_sae_worker_exit_sem, OS_BLOCK);
+    }
+    g_wpa3_sae_worker_num = 0;
+
+    os_queue_delete(g_wpa3_sae_work_queue);
+    g_wpa3_sae_work_queue = NULL;
+    os_semphr_delete(g_wpa3_sae_worker_exit_sem);
+    g_wpa3_sae_worker_exit_sem = NULL;
+}
+
+static int wpa3_hostap_sae_workers_start(void)
+{
+    char name[16];
+    int i;
+
+    g_wpa3_sae_work_queue = os_queue_create(10, sizeof(u32));
+    g_wpa3_sae_worker_exit_sem = os_semphr_create(WPA3_HOSTAP_SAE_WORKERS, 0);
+    if (!g_wpa3_sae_work_queue || !g_wpa3_sae_worker_exit_sem) {
+        goto fail;
+    }
+
+    for (i = 0; i < WPA3_HOSTAP_SAE_WORKERS; i++) {
+        os_snprintf(name, sizeof(name), "esp_wpa3_sae%d", i);
+        /* Spread the workers over the cores, starting with core 1 */
+        if (os_task_create_pinned_to_core(esp_wpa3_sae_worker_task, name,
+                                          WPA3_HOSTAP_HANDLE_AUTH_TASK_STACK_SIZE, NULL,
+                                          WPA3_HOSTAP_HANDLE_AUTH_TASK_PRIORITY,
+                                          &g_wpa3_sae_worker_hdl[i],
+                                          (i + 1) % SOC_CPU_CORES_NUM) != pdPASS) {
+            goto fail;
+        }
+        g_wpa3_sae_worker_num++;
+    }
+    return ESP_OK;
+
+fail:
+    wpa_printf(MSG_ERROR, "wpa3_hostap_auth_init: failed to start SAE workers");
+    if (g_wpa3_sae_work_queue && g_wpa3_sae_worker_exit_sem) {
+        wpa3_hostap_sae_workers_stop();
+        return ESP_FAIL;
+    }
+    if (g_wpa3_sae_work_queue) {
+        os_queue_delete(g_wpa3_sae_work_queue);
+        g_wpa3_sae_work_queue = NULL;
+    }
+    if (g_wpa3_sae_worker_exit_sem) {
+        os_semphr_delete(g_wpa3_sae_worker_exit_sem);
+        g_wpa3_sae_worker_exit_sem = NULL;
+    }
+    return ESP_FAIL;
+}
+#endif /* WPA3_HOSTAP_SAE_WORKERS > 1 */
+
 static void esp_wpa3_hostap_task(void *pvParameters)
 {
     wpa3_hostap_auth_event_t *evt;
@@ -489,7 +966,7 @@ static void esp_wpa3_hostap_task(void *pvParameters)
         if (os_queue_recv(g_wpa3_hostap_evt_queue, &evt, portMAX_DELAY) == 1) {
             switch (evt->id) {
             case SIG_WPA3_RX_COMMIT: {
-                wpa3_process_rx_commit(evt);
+                wpa3_process_rx_commit();
                 break;
             }
             case SIG_WPA3_RX_CONFIRM: {
@@ -509,6 +986,9 @@ static void esp_wpa3_hostap_task(void *pvParameters)
             }
         }
     }
+#if WPA3_HOSTAP_SAE_WORKERS > 1
+    wpa3_hostap_sae_workers_stop();
+#endif /* WPA3_HOSTAP_SAE_WORKERS > 1 */
     uint32_t items_in_queue = os_queue_msg_waiting(g_wpa3_hostap_evt_queue);
     while(items_in_queue--) {
         /* Free events posted to queue */
@@ -543,17 +1023,39 @@ int wpa3_hostap_auth_init(void *data)
         }
     }
 
+    if (g_wpa3_hostap_state_lock == NULL) {
+        /* Recursive: station add/lookup/free take it on their own and are
+         * also called by code that already holds it */
+        g_wpa3_hostap_state_lock = os_recursive_mutex_create();
+        if (!g_wpa3_hostap_state_lock) {
+            wpa_printf(MSG_ERROR, "wpa3_hostap_auth_init: failed to create WPA3 hostap state lock");
+            return ESP_FAIL;
+        }
+    }
+    os_memset(&g_wpa3_hostap_sae_stats, 0, sizeof(g_wpa3_hostap_sae_stats));
+
     g_wpa3_hostap_evt_queue =  os_queue_create(10, sizeof(wpa3_hostap_auth_event_t));
     if (!g_wpa3_hostap_evt_queue) {
         wpa_printf(MSG_ERROR, "wpa3_hostap_auth_init: failed to create queue");
         return ESP_FAIL;
     }
 
+#if WPA3_HOSTAP_SAE_WORKERS > 1
+    if (wpa3_hostap_sae_workers_start() != ESP_OK) {
+        os_queue_delete(g_wpa3_hostap_evt_queue);
+        g_wpa3_hostap_evt_queue = NULL;
+        return ESP_FAIL;
+    }
+#endif /* WPA3_HOSTAP_SAE_WORKERS > 1 */
+
     if (os_task_create(esp_wpa3_hostap_task, "esp_wpa3_hostap_task",
                     WPA3_HOSTAP_HANDLE_AUTH_TASK_STACK_SIZE, NULL,
                     WPA3_HOSTAP_HANDLE_AUTH_TASK_PRIORITY,
                     &g_wpa3_hostap_task_hdl) != pdPASS) {
         wpa_printf(MSG_ERROR, "wpa3_hostap_auth_init: failed to create task");
+#if WPA3_HOSTAP_SAE_WORKERS > 1
+        wpa3_hostap_sae_workers_stop();
+#endif /* WPA3_HOSTAP_SAE_WORKERS > 1 */
         os_queue_delete(g_wpa3_hostap_evt_queue);
         g_wpa3_hostap_evt_queue = NULL;
         return ESP_FAIL;
@@ -577,9 +1079,16 @@ bool wpa3_hostap_auth_deinit(void)
 static int wpa3_hostap_handle_auth(u8 *buf, size_t len, u32 auth_transaction, u16 status, u8 *bssid)
 {
     struct hostapd_data *hapd = (struct hostapd_data *)esp_wifi_get_hostap_private_internal();
-    struct sta_info *sta = ap_get_sta(hapd, bssid);
+    struct sta_info *sta;
+    bool commit_processing;
+
+    wpa3_hostap_state_lock();
+    sta = ap_get_sta(hapd, bssid);
+    commit_processing = sta && sta->sae_commit_processing;
+    wpa3_hostap_state_unlock();
+
     if (auth_transaction == SAE_MSG_COMMIT) {
-        if (sta && sta->sae_commit_processing) {
+        if (commit_processing) {
             /* Ignore commit msg as we are already processing commit msg for this station */
             return ESP_OK;
         }
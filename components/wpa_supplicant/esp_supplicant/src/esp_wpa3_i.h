@@ -12,6 +12,12 @@
 
 void esp_wifi_register_wpa3_cb(struct wpa_funcs *wpa_cb);
 void esp_wpa3_free_sae_data(void);
+struct sae_pt *esp_wpa3_sae_pt_get(int *groups, const u8 *ssid, size_t ssid_len,
+                                   const u8 *password, size_t password_len,
+                                   const char *identifier);
+void esp_wpa3_sae_pt_cache_clear(void);
+void esp_wpa3_sae_pt_cache_sync_config(void);
+void esp_wpa3_sae_pt_cache_get_stats(unsigned int *hits, unsigned int *misses);
 
 #else /* CONFIG_WPA3_SAE */
 
@@ -25,6 +31,14 @@ static inline void esp_wpa3_free_sae_data(void)
 {
 }
 
+static inline void esp_wpa3_sae_pt_cache_clear(void)
+{
+}
+
+static inline void esp_wpa3_sae_pt_cache_sync_config(void)
+{
+}
+
 #endif /* CONFIG_WPA3_SAE */
 
 #ifdef CONFIG_SAE
@@ -53,6 +67,26 @@ struct sae_hostap_confirm_data {
 #define WPA3_HOSTAP_AUTH_API_LOCK() os_semphr_take(g_wpa3_hostap_auth_api_lock, OS_BLOCK)
 #define WPA3_HOSTAP_AUTH_API_UNLOCK() os_semphr_give(g_wpa3_hostap_auth_api_lock)
 
+/* With more than one worker, SAE commits are computed on a pool of worker
+ * tasks instead of the hostap task, so different stations proceed in
+ * parallel. Commits from the same station are still serialized by sta->lock. */
+#ifdef CONFIG_ESP_WIFI_SOFTAP_SAE_WORKERS
+#define WPA3_HOSTAP_SAE_WORKERS CONFIG_ESP_WIFI_SOFTAP_SAE_WORKERS
+#else
+#define WPA3_HOSTAP_SAE_WORKERS 1
+#endif
+
+struct wpa3_hostap_sae_stats {
+    u32 queued;             /* commits added to hapd->sae_commit_queue */
+    u32 processed;          /* commits handed to handle_auth_sae() */
+    u32 dropped;            /* commits dropped on a full queue or busy station */
+    u32 queue_depth;        /* current length of hapd->sae_commit_queue */
+    u32 queue_depth_max;
+    u32 in_flight;          /* commits taken off the queue and not yet done */
+    u32 latency_max_us;     /* reception to end of processing */
+    u64 latency_total_us;
+};
+
 int wpa3_hostap_post_evt(uint32_t evt_id, uint32_t data);
 void esp_wifi_register_wpa3_ap_cb(struct wpa_funcs *wpa_cb);
 int wpa3_hostap_auth_init(void *data);
@@ -61,6 +95,13 @@ int esp_send_sae_auth_reply(struct hostapd_data *hapd,
                const u8 *dst, const u8 *bssid,
                u16 auth_alg, u16 auth_transaction, u16 resp,
                const u8 *ies, size_t ies_len);
+void wpa3_hostap_state_lock(void);
+void wpa3_hostap_state_unlock(void);
+unsigned int wpa3_hostap_sae_commits_in_flight(void);
+void wpa3_hostap_sae_stats_commit_queued(u32 queue_depth);
+void wpa3_hostap_sae_stats_commit_dropped(void);
+void wpa3_hostap_sae_stats_get(struct wpa3_hostap_sae_stats *stats);
+void wpa3_hostap_sae_stats_reset(void);
 
 #else /* CONFIG_SAE */
 
@@ -69,5 +110,13 @@ static inline void esp_wifi_register_wpa3_ap_cb(struct wpa_funcs *wpa_cb)
 	wpa_cb->wpa3_hostap_handle_auth = NULL;
 }
 
+static inline void wpa3_hostap_state_lock(void)
+{
+}
+
+static inline void wpa3_hostap_state_unlock(void)
+{
+}
+
 #endif /* CONFIG_SAE */
 #endif /* ESP_WPA3_H */
@@ -17,6 +17,7 @@
 #include "ap/wpa_auth_i.h"
 #include "ap/ap_config.h"
 #include "ap/hostapd.h"
+#include "rsn_supp/pmksa_cache.h"
 #include "esp_wpas_glue.h"
 #include "esp_hostap.h"
 
@@ -223,6 +224,7 @@ int wpa_sta_connect(uint8_t *bssid)
 
 void wpa_config_done(void)
 {
+    esp_wpa3_sae_pt_cache_sync_config();
     esp_set_scan_ie();
 }
 
@@ -328,10 +330,14 @@ static bool hostap_sta_join(void **sta, u8 *bssid, u8 *wpa_ie, u8 wpa_ie_len, u8
         goto fail;
     }
 
+    /* Station lookup, add and free race with the SAE commit workers; the
+     * state lock is held until this task owns sta_info->lock */
+    wpa3_hostap_state_lock();
     if (*sta) {
         struct sta_info *old_sta = *sta;
 #ifdef CONFIG_SAE
         if (old_sta->lock && os_semphr_take(old_sta->lock, 0) != TRUE) {
+            wpa3_hostap_state_unlock();
             wpa_printf(MSG_INFO, "Ignore assoc request as softap is busy with sae calculation for station "MACSTR, MAC2STR(bssid));
             if (esp_send_assoc_resp(hapd, bssid, WLAN_STATUS_ASSOC_REJECTED_TEMPORARILY, rsnxe ? false : true, subtype) != WLAN_STATUS_SUCCESS) {
                 goto fail;
@@ -345,6 +351,7 @@ static bool hostap_sta_join(void **sta, u8 *bssid, u8 *wpa_ie, u8 wpa_ie_len, u8
         }
 #ifdef CONFIG_SAE
           else if (old_sta && old_sta->lock) {
+            wpa3_hostap_state_unlock();
             sta_info = old_sta;
             goto process_old_sta;
         }
@@ -355,19 +362,24 @@ static bool hostap_sta_join(void **sta, u8 *bssid, u8 *wpa_ie, u8 wpa_ie_len, u8
     if (!sta_info) {
         sta_info = ap_sta_add(hapd,bssid);
         if (!sta_info) {
+            wpa3_hostap_state_unlock();
             wpa_printf(MSG_ERROR, "failed to add station " MACSTR, MAC2STR(bssid));
             goto fail;
         }
     }
 #ifdef CONFIG_SAE
     if (sta_info->lock && os_semphr_take(sta_info->lock, 0) != TRUE) {
+        wpa3_hostap_state_unlock();
         wpa_printf(MSG_INFO, "Ignore assoc request as softap is busy with sae calculation for station "MACSTR, MAC2STR(bssid));
         if (esp_send_assoc_resp(hapd, bssid, WLAN_STATUS_ASSOC_REJECTED_TEMPORARILY, rsnxe ? false : true, subtype) != WLAN_STATUS_SUCCESS) {
             goto fail;
         }
         return false;
     }
+#endif /* CONFIG_SAE */
+    wpa3_hostap_state_unlock();
 
+#ifdef CONFIG_SAE
 process_old_sta:
 #endif /* CONFIG_SAE */
 
@@ -479,3 +491,102 @@ esp_err_t esp_supplicant_disable_pmk_caching(bool disable)
     g_wpa_pmk_caching_disabled = disable;
     return ESP_OK;
 }
+
+struct pmksa_cache_blob {
+    const uint8_t *key;
+    size_t key_len;
+    uint8_t *buf;
+    size_t len;
+    esp_err_t ret;
+};
+
+/* The PMKSA cache is updated and aged by the supplicant on the Wi-Fi task;
+ * save and restore run there too instead of walking it from the caller */
+static int pmksa_cache_save_process(void *data)
+{
+    struct pmksa_cache_blob *blob = (struct pmksa_cache_blob *)data;
+    size_t need;
+    int ret;
+
+    if (!gWpaSm.pmksa) {
+        blob->ret = ESP_ERR_INVALID_STATE;
+        return 0;
+    }
+    need = pmksa_cache_save_len(gWpaSm.pmksa);
+    if (!blob->buf || blob->len < need) {
+        blob->len = need;
+        blob->ret = blob->buf ? ESP_ERR_INVALID_SIZE : ESP_OK;
+        return 0;
+    }
+    ret = pmksa_cache_save(gWpaSm.pmksa, blob->key, blob->key_len, blob->buf, blob->len);
+    if (ret < 0) {
+        blob->ret = ESP_FAIL;
+        return 0;
+    }
+    blob->len = ret;
+    blob->ret = ESP_OK;
+    return 0;
+}
+
+static int pmksa_cache_restore_process(void *data)
+{
+    struct pmksa_cache_blob *blob = (struct pmksa_cache_blob *)data;
+
+    if (!gWpaSm.pmksa) {
+        blob->ret = ESP_ERR_INVALID_STATE;
+        return 0;
+    }
+    if (pmksa_cache_restore(gWpaSm.pmksa, blob->key, blob->key_len, blob->buf, blob->len) < 0) {
+        blob->ret = ESP_FAIL;
+        return 0;
+    }
+    blob->ret = ESP_OK;
+    return 0;
+}
+
+static esp_err_t pmksa_cache_blob_call(wifi_ipc_fn_t fn, struct pmksa_cache_blob *blob)
+{
+    wifi_ipc_config_t cfg;
+
+    cfg.fn = fn;
+    cfg.arg = blob;
+    cfg.arg_size = 0;
+    blob->ret = ESP_ERR_INVALID_STATE;
+    if (esp_wifi_ipc_internal(&cfg, true) != ESP_OK) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return blob->ret;
+}
+
+esp_err_t esp_supplicant_pmksa_cache_save(const uint8_t *key, size_t key_len, uint8_t *buf, size_t *len)
+{
+    struct pmksa_cache_blob blob;
+    esp_err_t ret;
+
+    if (!key || (key_len != 16 && key_len != 32) || !len) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    blob.key = key;
+    blob.key_len = key_len;
+    blob.buf = buf;
+    blob.len = *len;
+    ret = pmksa_cache_blob_call(pmksa_cache_save_process, &blob);
+    if (ret == ESP_OK || ret == ESP_ERR_INVALID_SIZE) {
+        *len = blob.len;
+    }
+    return ret;
+}
+
+esp_err_t esp_supplicant_pmksa_cache_restore(const uint8_t *key, size_t key_len, const uint8_t *buf, size_t len)
+{
+    struct pmksa_cache_blob blob;
+
+    if (!key || (key_len != 16 && key_len != 32) || !buf) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    blob.key = key;
+    blob.key_len = key_len;
+    blob.buf = (uint8_t *)buf;
+    blob.len = len;
+    return pmksa_cache_blob_call(pmksa_cache_restore_process, &blob);
+}
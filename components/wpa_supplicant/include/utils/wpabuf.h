@@ -31,6 +31,24 @@ struct wpabuf {
 	/* optionally followed by the allocated buffer */
 };
 
+/*
+ * Chained buffer for data that arrives in pieces, e.g., fragments of a TLS
+ * message. Each piece is copied once into its own segment and the chain is
+ * linearized once, when the complete data is needed as a wpabuf. A zeroed
+ * struct wpabuf_chain is a valid empty chain.
+ */
+struct wpabuf_chain_seg {
+	struct wpabuf_chain_seg *next;
+	size_t len;
+	/* followed by len octets of data */
+};
+
+struct wpabuf_chain {
+	struct wpabuf_chain_seg *head;
+	struct wpabuf_chain_seg *tail;
+	size_t len; /* total length of data in all segments */
+};
+
 
 int wpabuf_resize(struct wpabuf **buf, size_t add_len);
 struct wpabuf * wpabuf_alloc(size_t len);
@@ -43,6 +61,10 @@ void * wpabuf_put(struct wpabuf *buf, size_t len);
 struct wpabuf * wpabuf_concat(struct wpabuf *a, struct wpabuf *b);
 struct wpabuf * wpabuf_zeropad(struct wpabuf *buf, size_t len);
 void wpabuf_printf(struct wpabuf *buf, const char *fmt, ...) PRINTF_FORMAT(2, 3);
+int wpabuf_chain_put_data(struct wpabuf_chain *chain, const void *data,
+			  size_t len);
+struct wpabuf * wpabuf_chain_linearize(struct wpabuf_chain *chain);
+void wpabuf_chain_clear(struct wpabuf_chain *chain);
 
 
 /**
@@ -166,4 +188,51 @@ static inline void wpabuf_put_str(struct wpabuf *dst, const char *str)
 	wpabuf_put_data(dst, str, os_strlen(str));
 }
 
+/**
+ * wpabuf_slice - Set a view to a part of another buffer without copying
+ * @view: wpabuf to use as the view, typically on the stack
+ * @src: Buffer holding the data
+ * @offset: Offset of the first octet of the view in src
+ * @len: Length of the view
+ *
+ * The view refers to the data of src and must not be freed or outlive src.
+ */
+static inline void wpabuf_slice(struct wpabuf *view, const struct wpabuf *src,
+				size_t offset, size_t len)
+{
+	wpabuf_set(view, wpabuf_head_u8(src) + offset, len);
+}
+
+/**
+ * wpabuf_pull - Remove data from the head of a view
+ * @view: View set with wpabuf_set() or wpabuf_slice()
+ * @len: Number of octets to remove, at most wpabuf_len(view)
+ * Returns: Pointer to the removed data
+ */
+static inline const u8 * wpabuf_pull(struct wpabuf *view, size_t len)
+{
+	const u8 *pos = view->buf;
+
+	view->buf += len;
+	view->size -= len;
+	view->used -= len;
+	return pos;
+}
+
+/**
+ * wpabuf_chain_len - Get the total length of data in a chained buffer
+ * @chain: Chained buffer
+ * Returns: Length of data in all segments
+ */
+static inline size_t wpabuf_chain_len(const struct wpabuf_chain *chain)
+{
+	return chain->len;
+}
+
+static inline int wpabuf_chain_put_buf(struct wpabuf_chain *chain,
+				       const struct wpabuf *src)
+{
+	return wpabuf_chain_put_data(chain, wpabuf_head(src), wpabuf_len(src));
+}
+
 #endif /* WPABUF_H */
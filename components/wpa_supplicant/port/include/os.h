@@ -385,6 +385,7 @@ extern const wifi_osi_funcs_t *wifi_funcs;
 #define os_queue_msg_waiting(a) wifi_funcs->_queue_msg_waiting((a))
 
 #define os_task_create(a,b,c,d,e,f) wifi_funcs->_task_create((a), (b), (c), (d), (e), (f))
+#define os_task_create_pinned_to_core(a,b,c,d,e,f,g) wifi_funcs->_task_create_pinned_to_core((a), (b), (c), (d), (e), (f), (g))
 #define os_task_delete(a) wifi_funcs->_task_delete((a))
 #define os_task_get_current_task() wifi_funcs->_task_get_current_task()
 
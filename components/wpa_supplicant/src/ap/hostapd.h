@@ -69,6 +69,9 @@ struct hostapd_sae_commit_queue {
 	u8 bssid[ETH_ALEN];
 	u32 auth_transaction;
 	u16 status;
+#ifdef ESP_SUPPLICANT
+	struct os_reltime rx_time;
+#endif /* ESP_SUPPLICANT */
 	u8 msg[];
 };
 
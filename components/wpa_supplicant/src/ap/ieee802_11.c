@@ -21,6 +21,15 @@
 
 #ifdef CONFIG_SAE
 
+#ifdef ESP_SUPPLICANT
+/* hostapd state shared between the SAE commit workers */
+#define SAE_STATE_LOCK() wpa3_hostap_state_lock()
+#define SAE_STATE_UNLOCK() wpa3_hostap_state_unlock()
+#else
+#define SAE_STATE_LOCK()
+#define SAE_STATE_UNLOCK()
+#endif /* ESP_SUPPLICANT */
+
 static void sae_set_state(struct sta_info *sta, enum sae_state state,
                           const char *reason)
 {
@@ -210,6 +219,11 @@ static int use_sae_anti_clogging(struct hostapd_data *hapd)
         }
     }
 
+#ifdef ESP_SUPPLICANT
+    /* Commits already taken off the queue by other workers */
+    open += wpa3_hostap_sae_commits_in_flight();
+#endif /* ESP_SUPPLICANT */
+
     /* In addition to already existing open SAE sessions, check whether
      * there are enough pending commit messages in the processing queue to
      * potentially result in too many open sessions. */
@@ -484,10 +498,12 @@ int handle_auth_sae(struct hostapd_data *hapd, struct sta_info *sta,
             goto remove_sta;
         }
 
+        SAE_STATE_LOCK();
         if (token &&
             check_comeback_token(hapd->comeback_key,
                      hapd->comeback_pending_idx, sta->addr,
                      token, token_len) < 0) {
+            SAE_STATE_UNLOCK();
             wpa_printf(MSG_DEBUG, "SAE: Drop commit message with "
                        "incorrect token from " MACSTR,
                        MAC2STR(sta->addr));
@@ -496,6 +512,7 @@ int handle_auth_sae(struct hostapd_data *hapd, struct sta_info *sta,
         }
 
         if (resp != WLAN_STATUS_SUCCESS) {
+            SAE_STATE_UNLOCK();
             goto reply;
         }
 
@@ -517,6 +534,7 @@ int handle_auth_sae(struct hostapd_data *hapd, struct sta_info *sta,
                 sizeof(hapd->comeback_pending_idx),
                 sta->sae->group,
                 sta->addr, h2e);
+            SAE_STATE_UNLOCK();
             resp = WLAN_STATUS_ANTI_CLOGGING_TOKEN_REQ;
 
 #ifdef ESP_SUPPLICANT
@@ -525,6 +543,7 @@ int handle_auth_sae(struct hostapd_data *hapd, struct sta_info *sta,
 
             goto reply;
         }
+        SAE_STATE_UNLOCK();
 
         resp = sae_sm_step(hapd, sta, bssid, auth_transaction,
                            status, allow_reuse, &sta_removed);
@@ -606,27 +625,37 @@ int auth_sae_queue(struct hostapd_data *hapd,
     struct hostapd_sae_commit_queue *q, *q2;
     unsigned int queue_len;
 
+    q = os_zalloc(sizeof(*q) + len);
+    if (!q) {
+        return -1;
+    }
+
+    q->len = len;
+    os_memcpy(q->msg, buf, len);
+    os_memcpy(q->bssid, bssid, ETH_ALEN);
+    q->auth_transaction = auth_transaction;
+    q->status = status;
+#ifdef ESP_SUPPLICANT
+    os_get_reltime(&q->rx_time);
+#endif /* ESP_SUPPLICANT */
+
+    SAE_STATE_LOCK();
     queue_len = dl_list_len(&hapd->sae_commit_queue);
     if (queue_len >= 5) {
+#ifdef ESP_SUPPLICANT
+        wpa3_hostap_sae_stats_commit_dropped();
+#endif /* ESP_SUPPLICANT */
+        SAE_STATE_UNLOCK();
         wpa_printf(MSG_DEBUG,
                    "SAE: No more room in message queue - drop the new frame from "
                    MACSTR, MAC2STR(bssid));
+        os_free(q);
         return 0;
     }
 
     wpa_printf(MSG_DEBUG, "SAE: Queue Authentication message from "
                MACSTR " for processing (queue_len %u)", MAC2STR(bssid),
                queue_len);
-    q = os_zalloc(sizeof(*q) + len);
-    if (!q) {
-        return -1;
-    }
-
-    q->len = len;
-    os_memcpy(q->msg, buf, len);
-    os_memcpy(q->bssid, bssid, ETH_ALEN);
-    q->auth_transaction = auth_transaction;
-    q->status = status;
     /* Check whether there is already a queued Authentication frame from the
      * same station with the same transaction number and if so, replace that
      * queue entry with the new one. This avoids issues with a peer that
@@ -650,6 +679,10 @@ int auth_sae_queue(struct hostapd_data *hapd,
     dl_list_add_tail(&hapd->sae_commit_queue, &q->list);
 
 queued:
+#ifdef ESP_SUPPLICANT
+    wpa3_hostap_sae_stats_commit_queued(dl_list_len(&hapd->sae_commit_queue));
+#endif /* ESP_SUPPLICANT */
+    SAE_STATE_UNLOCK();
 
 #ifdef ESP_SUPPLICANT
     /* posting event to the task to handle commit */
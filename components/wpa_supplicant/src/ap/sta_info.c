@@ -19,6 +19,7 @@
 #include "ap_config.h"
 #include "sta_info.h"
 #include "esp_wps_i.h"
+#include "esp_wpa3_i.h"
 
 static void ap_sta_delayed_1x_auth_fail_cb(void *eloop_ctx, void *timeout_ctx);
 void hostapd_wps_eap_completed(struct hostapd_data *hapd);
@@ -43,9 +44,12 @@ struct sta_info * ap_get_sta(struct hostapd_data *hapd, const u8 *sta)
 {
 	struct sta_info *s;
 
+	/* The station table is shared with the SAE commit workers */
+	wpa3_hostap_state_lock();
 	s = hapd->sta_hash[STA_HASH(sta)];
 	while (s != NULL && os_memcmp(s->addr, sta, 6) != 0)
 		s = s->hnext;
+	wpa3_hostap_state_unlock();
 	return s;
 }
 
@@ -100,10 +104,12 @@ static void ap_sta_hash_del(struct hostapd_data *hapd, struct sta_info *sta)
 
 void ap_free_sta(struct hostapd_data *hapd, struct sta_info *sta)
 {
+	wpa3_hostap_state_lock();
 	ap_sta_hash_del(hapd, sta);
 	ap_sta_list_del(hapd, sta);
 
 	hapd->num_sta--;
+	wpa3_hostap_state_unlock();
 
 #ifdef CONFIG_SAE
 	sae_clear_data(sta->sae);
@@ -132,6 +138,7 @@ void hostapd_free_stas(struct hostapd_data *hapd)
 {
 	struct sta_info *sta, *prev;
 
+	wpa3_hostap_state_lock();
 	sta = hapd->sta_list;
 
 	while (sta) {
@@ -141,6 +148,7 @@ void hostapd_free_stas(struct hostapd_data *hapd)
 			   MAC2STR(prev->addr));
 		ap_free_sta(hapd, prev);
 	}
+	wpa3_hostap_state_unlock();
 }
 
 
@@ -148,22 +156,23 @@ struct sta_info * ap_sta_add(struct hostapd_data *hapd, const u8 *addr)
 {
 	struct sta_info *sta;
 
+	wpa3_hostap_state_lock();
 	sta = ap_get_sta(hapd, addr);
 	if (sta)
-		return sta;
+		goto out;
 
 	wpa_printf(MSG_DEBUG, "  New STA");
 	if (hapd->num_sta >= hapd->conf->max_num_sta) {
 		/* FIX: might try to remove some old STAs first? */
 		wpa_printf(MSG_DEBUG, "no more room for new STAs (%d/%d)",
 			   hapd->num_sta, hapd->conf->max_num_sta);
-		return NULL;
+		goto out;
 	}
 
 	sta = os_zalloc(sizeof(struct sta_info));
 	if (sta == NULL) {
 		wpa_printf(MSG_ERROR, "malloc failed");
-		return NULL;
+		goto out;
 	}
 
 	/* initialize STA info data */
@@ -178,6 +187,8 @@ struct sta_info * ap_sta_add(struct hostapd_data *hapd, const u8 *addr)
 	sta->lock = os_semphr_create(1, 1);
 #endif /* CONFIG_SAE */
 
+out:
+	wpa3_hostap_state_unlock();
 	return sta;
 }
 
@@ -38,6 +38,7 @@
 #include "esp_wpas_glue.h"
 #include "esp_wps_i.h"
 #include "esp_hostap.h"
+#include "esp_wpa3_i.h"
 
 #define STATE_MACHINE_DATA struct wpa_state_machine
 #define STATE_MACHINE_DEBUG_PREFIX "WPA"
@@ -2627,8 +2628,13 @@ bool wpa_ap_remove(u8* bssid)
     if (!hapd) {
         return false;
     }
+
+    /* Lookup and free must not interleave with an SAE worker taking the
+     * station, or the worker would end up using a freed entry */
+    wpa3_hostap_state_lock();
     struct sta_info *sta = ap_get_sta(hapd, bssid);
     if (!sta) {
+        wpa3_hostap_state_unlock();
         return false;
     }
 
@@ -2639,10 +2645,12 @@ bool wpa_ap_remove(u8* bssid)
         } else {
             sta->remove_pending = true;
         }
+        wpa3_hostap_state_unlock();
         return true;
     }
 #endif /* CONFIG_SAE */
     ap_free_sta(hapd, sta);
+    wpa3_hostap_state_unlock();
 
     return true;
 }
@@ -20,7 +20,89 @@
 #include "esp_wifi_driver.h"
 #endif
 
+#ifndef MAX_BSS_COUNT
 #define MAX_BSS_COUNT 20
+#endif
+/* Number of removed entries kept for reuse instead of being freed */
+#define MAX_BSS_FREE_COUNT 4
+
+static unsigned int wpa_bss_ssid_hash(const u8 *ssid, size_t ssid_len)
+{
+	unsigned int hash = 0;
+
+	while (ssid_len--)
+		hash = hash * 31 + *ssid++;
+	return hash % BSS_HASH_SIZE;
+}
+
+
+static void wpa_bss_hash_add(struct wpa_supplicant *wpa_s, struct wpa_bss *bss)
+{
+	unsigned int shash = wpa_bss_ssid_hash(bss->ssid, bss->ssid_len);
+
+	bss->hnext = wpa_s->bss_hash[BSS_HASH(bss->bssid)];
+	wpa_s->bss_hash[BSS_HASH(bss->bssid)] = bss;
+	bss->snext = wpa_s->bss_ssid_hash[shash];
+	wpa_s->bss_ssid_hash[shash] = bss;
+}
+
+
+static void wpa_bss_hash_del(struct wpa_supplicant *wpa_s, struct wpa_bss *bss)
+{
+	struct wpa_bss **s;
+
+	s = &wpa_s->bss_hash[BSS_HASH(bss->bssid)];
+	while (*s != NULL && *s != bss)
+		s = &(*s)->hnext;
+	if (*s != NULL)
+		*s = bss->hnext;
+	else
+		wpa_printf(MSG_DEBUG, "BSS: could not remove BSS " MACSTR
+			   " from hash table", MAC2STR(bss->bssid));
+
+	s = &wpa_s->bss_ssid_hash[wpa_bss_ssid_hash(bss->ssid, bss->ssid_len)];
+	while (*s != NULL && *s != bss)
+		s = &(*s)->snext;
+	if (*s != NULL)
+		*s = bss->snext;
+}
+
+
+static struct wpa_bss * wpa_bss_alloc(struct wpa_supplicant *wpa_s,
+				      size_t ies_len)
+{
+	struct wpa_bss *bss;
+	size_t ies_alloc;
+
+	dl_list_for_each(bss, &wpa_s->bss_free, struct wpa_bss, list) {
+		if (bss->ies_alloc >= ies_len) {
+			dl_list_del(&bss->list);
+			wpa_s->num_bss_free--;
+			ies_alloc = bss->ies_alloc;
+			os_memset(bss, 0, sizeof(*bss));
+			bss->ies_alloc = ies_alloc;
+			return bss;
+		}
+	}
+
+	bss = os_zalloc(sizeof(*bss) + ies_len);
+	if (bss)
+		bss->ies_alloc = ies_len;
+	return bss;
+}
+
+
+static void wpa_bss_free(struct wpa_supplicant *wpa_s, struct wpa_bss *bss)
+{
+	if (wpa_s->num_bss_free >= MAX_BSS_FREE_COUNT) {
+		os_free(bss);
+		return;
+	}
+
+	dl_list_add(&wpa_s->bss_free, &bss->list);
+	wpa_s->num_bss_free++;
+}
+
 
 void wpa_bss_remove(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 		    const char *reason)
@@ -40,11 +122,12 @@ void wpa_bss_remove(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 	}
 	dl_list_del(&bss->list);
 	dl_list_del(&bss->list_id);
+	wpa_bss_hash_del(wpa_s, bss);
 	wpa_s->num_bss--;
 	wpa_dbg(wpa_s, MSG_DEBUG, "BSS: Remove id %u BSSID " MACSTR
 		" SSID '%s' due to %s", bss->id, MAC2STR(bss->bssid),
 		wpa_ssid_txt(bss->ssid, bss->ssid_len), reason);
-	os_free(bss);
+	wpa_bss_free(wpa_s, bss);
 }
 
 
@@ -60,7 +143,8 @@ struct wpa_bss * wpa_bss_get(struct wpa_supplicant *wpa_s, const u8 *bssid,
 			     const u8 *ssid, size_t ssid_len)
 {
 	struct wpa_bss *bss;
-	dl_list_for_each(bss, &wpa_s->bss, struct wpa_bss, list) {
+
+	for (bss = wpa_s->bss_hash[BSS_HASH(bssid)]; bss; bss = bss->hnext) {
 		if (os_memcmp(bss->bssid, bssid, ETH_ALEN) == 0 &&
 		    bss->ssid_len == ssid_len &&
 		    os_memcmp(bss->ssid, ssid, ssid_len) == 0)
@@ -177,7 +261,7 @@ static int wpa_bss_remove_oldest(struct wpa_supplicant *wpa_s)
 
 static struct wpa_bss * wpa_bss_add(struct wpa_supplicant *wpa_s,
 				    const u8 *ssid, size_t ssid_len,
-				    struct wpa_scan_res *res,
+				    struct wpa_scan_res *res, const u8 *ies,
 				    struct os_reltime *fetch_time)
 {
 	struct wpa_bss *bss;
@@ -189,7 +273,7 @@ static struct wpa_bss * wpa_bss_add(struct wpa_supplicant *wpa_s,
 		return NULL;
 	}
 
-	bss = os_zalloc(sizeof(*bss) + res->ie_len + res->beacon_ie_len);
+	bss = wpa_bss_alloc(wpa_s, res->ie_len + res->beacon_ie_len);
 	if (bss == NULL)
 		return NULL;
 	bss->id = wpa_s->bss_next_id++;
@@ -199,10 +283,11 @@ static struct wpa_bss * wpa_bss_add(struct wpa_supplicant *wpa_s,
 	bss->ssid_len = ssid_len;
 	bss->ie_len = res->ie_len;
 	bss->beacon_ie_len = res->beacon_ie_len;
-	os_memcpy(bss->ies, res + 1, res->ie_len + res->beacon_ie_len);
+	os_memcpy(bss->ies, ies, res->ie_len + res->beacon_ie_len);
 
 	dl_list_add_tail(&wpa_s->bss, &bss->list);
 	dl_list_add_tail(&wpa_s->bss_id, &bss->list_id);
+	wpa_bss_hash_add(wpa_s, bss);
 	wpa_s->num_bss++;
 	wpa_dbg(wpa_s, MSG_INFO, "BSS: Add new id %u BSSID " MACSTR
 		" SSID '%s' chan %d",
@@ -213,7 +298,8 @@ static struct wpa_bss * wpa_bss_add(struct wpa_supplicant *wpa_s,
 
 static struct wpa_bss *
 wpa_bss_update(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
-	       struct wpa_scan_res *res, struct os_reltime *fetch_time)
+	       struct wpa_scan_res *res, const u8 *ies,
+	       struct os_reltime *fetch_time)
 {
 	if (bss->last_update_idx == wpa_s->bss_update_idx) {
 		struct os_reltime update_time;
@@ -235,11 +321,13 @@ wpa_bss_update(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 
 	bss->last_update_idx = wpa_s->bss_update_idx;
 	wpa_bss_copy_res(bss, res, fetch_time);
-	/* Move the entry to the end of the list */
+	/* Move the entry to the end of the list and to the head of its hash
+	 * lists, so that lookups find the most recently updated entry first.
+	 */
 	dl_list_del(&bss->list);
-	if (bss->ie_len + bss->beacon_ie_len >=
-	    res->ie_len + res->beacon_ie_len) {
-		os_memcpy(bss->ies, res + 1, res->ie_len + res->beacon_ie_len);
+	wpa_bss_hash_del(wpa_s, bss);
+	if (bss->ies_alloc >= res->ie_len + res->beacon_ie_len) {
+		os_memcpy(bss->ies, ies, res->ie_len + res->beacon_ie_len);
 		bss->ie_len = res->ie_len;
 		bss->beacon_ie_len = res->beacon_ie_len;
 	} else {
@@ -259,7 +347,8 @@ wpa_bss_update(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 			if (wpa_s->current_bss == bss)
 				wpa_s->current_bss = nbss;
 			bss = nbss;
-			os_memcpy(bss->ies, res + 1,
+			bss->ies_alloc = res->ie_len + res->beacon_ie_len;
+			os_memcpy(bss->ies, ies,
 				  res->ie_len + res->beacon_ie_len);
 			bss->ie_len = res->ie_len;
 			bss->beacon_ie_len = res->beacon_ie_len;
@@ -267,6 +356,7 @@ wpa_bss_update(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 		dl_list_add(prev, &bss->list_id);
 	}
 	dl_list_add_tail(&wpa_s->bss, &bss->list);
+	wpa_bss_hash_add(wpa_s, bss);
 
 	return bss;
 }
@@ -303,11 +393,33 @@ void wpa_bss_update_start(struct wpa_supplicant *wpa_s)
 void wpa_bss_update_scan_res(struct wpa_supplicant *wpa_s,
 			     struct wpa_scan_res *res,
 			     struct os_reltime *fetch_time)
+{
+	wpa_bss_update_scan_res_ies(wpa_s, res, (const u8 *) (res + 1),
+				    fetch_time);
+}
+
+
+/**
+ * wpa_bss_update_scan_res_ies - Update a BSS table entry from a received frame
+ * @wpa_s: Pointer to wpa_supplicant data
+ * @res: Scan result without the IEs
+ * @ies: res->ie_len + res->beacon_ie_len octets of IEs
+ * @fetch_time: Time when the result was fetched from the driver
+ *
+ * Same as wpa_bss_update_scan_res(), but the IEs do not need to follow @res
+ * in memory. This allows the IEs to be copied straight from the received
+ * Beacon/Probe Response frame into the BSS entry.
+ */
+void wpa_bss_update_scan_res_ies(struct wpa_supplicant *wpa_s,
+				 struct wpa_scan_res *res, const u8 *ies,
+				 struct os_reltime *fetch_time)
 {
 	const u8 *ssid;
 	struct wpa_bss *bss;
 
-	ssid = wpa_scan_get_ie(res, WLAN_EID_SSID);
+	/* Use the Beacon frame IEs if res->ie_len is not available */
+	ssid = get_ie(ies, res->ie_len ? res->ie_len : res->beacon_ie_len,
+		      WLAN_EID_SSID);
 	if (ssid == NULL) {
 		wpa_dbg(wpa_s, MSG_DEBUG, "BSS: No SSID IE included for "
 			MACSTR, MAC2STR(res->bssid));
@@ -324,9 +436,10 @@ void wpa_bss_update_scan_res(struct wpa_supplicant *wpa_s,
 
 	bss = wpa_bss_get(wpa_s, res->bssid, ssid + 2, ssid[1]);
 	if (bss == NULL)
-		bss = wpa_bss_add(wpa_s, ssid + 2, ssid[1], res, fetch_time);
+		bss = wpa_bss_add(wpa_s, ssid + 2, ssid[1], res, ies,
+				  fetch_time);
 	else {
-		bss = wpa_bss_update(wpa_s, bss, res, fetch_time);
+		bss = wpa_bss_update(wpa_s, bss, res, ies, fetch_time);
 		if (wpa_s->last_scan_res) {
 			unsigned int i;
 			for (i = 0; i < wpa_s->last_scan_res_used; i++) {
@@ -387,6 +500,10 @@ int wpa_bss_init(struct wpa_supplicant *wpa_s)
 {
 	dl_list_init(&wpa_s->bss);
 	dl_list_init(&wpa_s->bss_id);
+	dl_list_init(&wpa_s->bss_free);
+	wpa_s->num_bss_free = 0;
+	os_memset(wpa_s->bss_hash, 0, sizeof(wpa_s->bss_hash));
+	os_memset(wpa_s->bss_ssid_hash, 0, sizeof(wpa_s->bss_ssid_hash));
 	return 0;
 }
 
@@ -416,7 +533,18 @@ void wpa_bss_flush(struct wpa_supplicant *wpa_s)
  */
 void wpa_bss_deinit(struct wpa_supplicant *wpa_s)
 {
+	struct wpa_bss *bss, *n;
+
 	wpa_bss_flush(wpa_s);
+
+	if (wpa_s->bss_free.next == NULL)
+		return;
+
+	dl_list_for_each_safe(bss, n, &wpa_s->bss_free, struct wpa_bss, list) {
+		dl_list_del(&bss->list);
+		os_free(bss);
+	}
+	wpa_s->num_bss_free = 0;
 }
 
 
@@ -430,7 +558,9 @@ struct wpa_bss * wpa_bss_get_bssid(struct wpa_supplicant *wpa_s,
 				   const u8 *bssid)
 {
 	struct wpa_bss *bss;
-	dl_list_for_each_reverse(bss, &wpa_s->bss, struct wpa_bss, list) {
+
+	/* Hash lists are ordered from the most recently updated entry */
+	for (bss = wpa_s->bss_hash[BSS_HASH(bssid)]; bss; bss = bss->hnext) {
 		if (os_memcmp(bss->bssid, bssid, ETH_ALEN) == 0)
 			return bss;
 	}
@@ -438,6 +568,38 @@ struct wpa_bss * wpa_bss_get_bssid(struct wpa_supplicant *wpa_s,
 }
 
 
+/**
+ * wpa_bss_get_next_ssid - Fetch the next BSS table entry of an ESS
+ * @wpa_s: Pointer to wpa_supplicant data
+ * @ssid: SSID
+ * @ssid_len: Length of @ssid
+ * @prev_bss: Entry returned by the previous call or %NULL to get the first one
+ * Returns: Pointer to the BSS entry or %NULL if there are no more entries
+ *
+ * This can be used to walk through the roaming candidates for an ESS without
+ * going through the full BSS table. Entries are returned from the most
+ * recently updated one.
+ */
+struct wpa_bss * wpa_bss_get_next_ssid(struct wpa_supplicant *wpa_s,
+				       const u8 *ssid, size_t ssid_len,
+				       struct wpa_bss *prev_bss)
+{
+	struct wpa_bss *bss;
+
+	if (prev_bss)
+		bss = prev_bss->snext;
+	else
+		bss = wpa_s->bss_ssid_hash[wpa_bss_ssid_hash(ssid, ssid_len)];
+
+	for (; bss; bss = bss->snext) {
+		if (bss->ssid_len == ssid_len &&
+		    os_memcmp(bss->ssid, ssid, ssid_len) == 0)
+			return bss;
+	}
+	return NULL;
+}
+
+
 /**
  * wpa_bss_get_next_bss - Fetch a next BSS table entry from the list
  * @wpa_s: Pointer to wpa_supplicant data
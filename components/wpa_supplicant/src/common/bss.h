@@ -23,6 +23,10 @@ struct wpa_bss {
 	struct dl_list list;
 	/** List entry for struct wpa_supplicant::bss_id */
 	struct dl_list list_id;
+	/** Next entry in struct wpa_supplicant::bss_hash list */
+	struct wpa_bss *hnext;
+	/** Next entry in struct wpa_supplicant::bss_ssid_hash list */
+	struct wpa_bss *snext;
 	/** Unique identifier for this BSS entry */
 	unsigned int id;
 	/** Index of the last scan update */
@@ -57,6 +61,8 @@ struct wpa_bss {
 	size_t ie_len;
 	/** Length of the following Beacon IE field in octets */
 	size_t beacon_ie_len;
+	/** Allocated length of the ies field in octets */
+	size_t ies_alloc;
 	/* followed by ie_len octets of IEs */
 	/* followed by beacon_ie_len octets of IEs */
 	u8 ies[];
@@ -71,6 +77,9 @@ void wpa_bss_update_start(struct wpa_supplicant *wpa_s);
 void wpa_bss_update_scan_res(struct wpa_supplicant *wpa_s,
 			     struct wpa_scan_res *res,
 			     struct os_reltime *fetch_time);
+void wpa_bss_update_scan_res_ies(struct wpa_supplicant *wpa_s,
+				 struct wpa_scan_res *res, const u8 *ies,
+				 struct os_reltime *fetch_time);
 void wpa_bss_remove(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 		    const char *reason);
 void wpa_bss_update_end(struct wpa_supplicant *wpa_s);
@@ -81,6 +90,9 @@ struct wpa_bss * wpa_bss_get(struct wpa_supplicant *wpa_s, const u8 *bssid,
 			     const u8 *ssid, size_t ssid_len);
 struct wpa_bss * wpa_bss_get_bssid(struct wpa_supplicant *wpa_s,
 				   const u8 *bssid);
+struct wpa_bss * wpa_bss_get_next_ssid(struct wpa_supplicant *wpa_s,
+				       const u8 *ssid, size_t ssid_len,
+				       struct wpa_bss *prev_bss);
 const u8 * wpa_bss_get_ie(const struct wpa_bss *bss, u8 ie);
 const u8 * wpa_bss_get_vendor_ie(const struct wpa_bss *bss, u32 vendor_type);
 int wpa_bss_ext_capab(const struct wpa_bss *bss, unsigned int capab);
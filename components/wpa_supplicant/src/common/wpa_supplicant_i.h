@@ -50,6 +50,9 @@ struct wpa_bss_tmp_disallowed {
 };
 
 #define SSID_MAX_LEN 32
+#define BSS_HASH_SIZE 16
+#define BSS_HASH(bssid) (bssid[5] & 0xf)
+
 struct beacon_rep_data {
 	u8 token;
 	u8 last_indication;
@@ -88,7 +91,11 @@ struct wpa_supplicant {
 
 	struct dl_list bss; /* struct wpa_bss::list */
 	struct dl_list bss_id; /* struct wpa_bss::list_id */
+	struct dl_list bss_free; /* struct wpa_bss::list, recycled entries */
+	struct wpa_bss *bss_hash[BSS_HASH_SIZE]; /* struct wpa_bss::hnext */
+	struct wpa_bss *bss_ssid_hash[BSS_HASH_SIZE]; /* struct wpa_bss::snext */
 	size_t num_bss;
+	size_t num_bss_free;
 	unsigned int bss_update_idx;
 	unsigned int bss_next_id;
 
@@ -340,7 +340,7 @@ static int eap_peer_tls_reassemble_fragment(struct eap_ssl_data *data,
 {
 	size_t tls_in_len, in_len;
 
-	tls_in_len = data->tls_in ? wpabuf_len(data->tls_in) : 0;
+	tls_in_len = wpabuf_chain_len(&data->tls_in_frags);
 	in_len = in_data ? wpabuf_len(in_data) : 0;
 
 	if (tls_in_len + in_len == 0) {
@@ -373,14 +373,16 @@ static int eap_peer_tls_reassemble_fragment(struct eap_ssl_data *data,
 		return -1;
 	}
 
-	if (wpabuf_resize(&data->tls_in, in_len) < 0) {
+	/*
+	 * Keep fragments chained and linearize once the message is complete
+	 * instead of growing (and copying) the message on every fragment.
+	 */
+	if (in_data && wpabuf_chain_put_buf(&data->tls_in_frags, in_data) < 0) {
 		wpa_printf(MSG_INFO, "SSL: Could not allocate memory for TLS "
 			   "data");
 		eap_peer_tls_reset_input(data);
 		return -1;
 	}
-	if (in_data)
-		wpabuf_put_buf(data->tls_in, in_data);
 	data->tls_in_left -= in_len;
 
 	if (data->tls_in_left > 0) {
@@ -389,6 +391,14 @@ static int eap_peer_tls_reassemble_fragment(struct eap_ssl_data *data,
 		return 1;
 	}
 
+	data->tls_in = wpabuf_chain_linearize(&data->tls_in_frags);
+	if (data->tls_in == NULL) {
+		wpa_printf(MSG_INFO, "SSL: Could not allocate memory for TLS "
+			   "data");
+		eap_peer_tls_reset_input(data);
+		return -1;
+	}
+
 	return 0;
 }
 
@@ -411,7 +421,8 @@ static const struct wpabuf * eap_peer_tls_data_reassemble(
 {
 	*need_more_input = 0;
 
-	if (data->tls_in_left > wpabuf_len(in_data) || data->tls_in) {
+	if (data->tls_in_left > wpabuf_len(in_data) ||
+	    wpabuf_chain_len(&data->tls_in_frags)) {
 		/* Message has fragments */
 		int res = eap_peer_tls_reassemble_fragment(data, in_data);
 		if (res) {
@@ -815,6 +826,7 @@ const u8 * eap_peer_tls_process_init(struct eap_sm *sm,
 			data->tls_in_left = tls_msg_len;
 			wpabuf_free(data->tls_in);
 			data->tls_in = NULL;
+			wpabuf_chain_clear(&data->tls_in_frags);
 		}
 		pos += 4;
 		left -= 4;
@@ -850,6 +862,7 @@ void eap_peer_tls_reset_input(struct eap_ssl_data *data)
 	data->tls_in_left = data->tls_in_total = 0;
 	wpabuf_free(data->tls_in);
 	data->tls_in = NULL;
+	wpabuf_chain_clear(&data->tls_in_frags);
 }
 
 
@@ -34,10 +34,15 @@ struct eap_ssl_data {
 	size_t tls_out_limit;
 
 	/**
-	 * tls_in - Received TLS message buffer for re-assembly
+	 * tls_in - Received TLS message, linearized once fully re-assembled
 	 */
 	struct wpabuf *tls_in;
 
+	/**
+	 * tls_in_frags - Fragments of the TLS message being re-assembled
+	 */
+	struct wpabuf_chain tls_in_frags;
+
 	/**
 	 * tls_in_left - Number of remaining bytes in the incoming TLS message
 	 */
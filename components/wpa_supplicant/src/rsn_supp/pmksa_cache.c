@@ -13,6 +13,7 @@
 #include "rsn_supp/wpa_i.h"
 #include "common/eapol_common.h"
 #include "common/ieee802_11_defs.h"
+#include "crypto/aes_wrap.h"
 #include "pmksa_cache.h"
 
 #ifdef IEEE8021X_EAPOL
@@ -33,6 +34,9 @@ struct rsn_pmksa_cache {
 
 
 static void pmksa_cache_set_expiration(struct rsn_pmksa_cache *pmksa);
+static struct rsn_pmksa_cache_entry *
+pmksa_cache_add_entry(struct rsn_pmksa_cache *pmksa,
+        struct rsn_pmksa_cache_entry *entry);
 
 
 static void _pmksa_cache_free_entry(struct rsn_pmksa_cache_entry *entry)
@@ -108,7 +112,7 @@ pmksa_cache_add(struct rsn_pmksa_cache *pmksa, const u8 *pmk, size_t pmk_len,
         const u8 *pmkid, const u8 *kck, size_t kck_len,
         const u8 *aa, const u8 *spa, void *network_ctx, int akmp)
 {
-    struct rsn_pmksa_cache_entry *entry, *pos, *prev;
+    struct rsn_pmksa_cache_entry *entry;
     struct os_reltime now;
 
     if (pmk_len > PMK_LEN_MAX)
@@ -139,19 +143,30 @@ pmksa_cache_add(struct rsn_pmksa_cache *pmksa, const u8 *pmk, size_t pmk_len,
     os_memcpy(entry->aa, aa, ETH_ALEN);
     entry->network_ctx = network_ctx;
 
+    return pmksa_cache_add_entry(pmksa, entry);
+}
+
+
+static struct rsn_pmksa_cache_entry *
+pmksa_cache_add_entry(struct rsn_pmksa_cache *pmksa,
+        struct rsn_pmksa_cache_entry *entry)
+{
+    struct rsn_pmksa_cache_entry *pos, *prev;
+
     /* Replace an old entry for the same Authenticator (if found) with the
      * new entry */
     pos = pmksa->pmksa;
     prev = NULL;
     while (pos) {
-        if (os_memcmp(aa, pos->aa, ETH_ALEN) == 0) {
-            if (pos->pmk_len == pmk_len &&
-                    os_memcmp_const(pos->pmk, pmk, pmk_len) == 0 &&
+        if (os_memcmp(entry->aa, pos->aa, ETH_ALEN) == 0) {
+            if (pos->pmk_len == entry->pmk_len &&
+                    os_memcmp_const(pos->pmk, entry->pmk,
+                        entry->pmk_len) == 0 &&
                     os_memcmp_const(pos->pmkid, entry->pmkid,
                         PMKID_LEN) == 0) {
                 wpa_printf(MSG_DEBUG, "WPA: reusing previous "
                         "PMKSA entry");
-                os_free(entry);
+                _pmksa_cache_free_entry(entry);
                 return pos;
             }
             if (prev == NULL)
@@ -172,7 +187,7 @@ pmksa_cache_add(struct rsn_pmksa_cache *pmksa, const u8 *pmk, size_t pmk_len,
                     "the current AP and any PMKSA cache entry "
                     "that was based on the old PMK");
             if (!pos->opportunistic)
-                pmksa_cache_flush(pmksa, network_ctx, pos->pmk,
+                pmksa_cache_flush(pmksa, entry->network_ctx, pos->pmk,
                         pos->pmk_len);
             pmksa_cache_free_entry(pmksa, pos, PMKSA_REPLACE);
             break;
@@ -224,7 +239,7 @@ pmksa_cache_add(struct rsn_pmksa_cache *pmksa, const u8 *pmk, size_t pmk_len,
     }
     pmksa->pmksa_count++;
     wpa_printf(MSG_DEBUG, "RSN: Added PMKSA cache entry for " MACSTR
-            " network_ctx=%p", MAC2STR(entry->aa), network_ctx);
+            " network_ctx=%p", MAC2STR(entry->aa), entry->network_ctx);
 
     return entry;
 }
@@ -492,6 +507,211 @@ int pmksa_cache_list(struct rsn_pmksa_cache *pmksa, char *buf, size_t len)
 }
 
 
+/*
+ * Saved PMKSA cache layout. The header is authenticated as AAD, the records
+ * are encrypted with AES-GCM under the caller's key:
+ *
+ * magic(4) version(1) count(1) reserved(2) save_time(8) iv(12)
+ * count * { aa(6) akmp(4) pmk_len(1) pmk(PMK_LEN_MAX) pmkid(16)
+ *           lifetime(4) reauth(4) }
+ * tag(16)
+ *
+ * lifetime and reauth are the seconds remaining at save time. save_time is
+ * the wall clock at save time and is used on restore to age the entries.
+ */
+#define PMKSA_SAVE_MAGIC    0x504d4b53 /* "PMKS" */
+#define PMKSA_SAVE_VERSION  1
+#define PMKSA_SAVE_IV_LEN   12
+#define PMKSA_SAVE_TAG_LEN  16
+#define PMKSA_SAVE_HDR_LEN  (16 + PMKSA_SAVE_IV_LEN)
+#define PMKSA_SAVE_REC_LEN  (ETH_ALEN + 4 + 1 + PMK_LEN_MAX + PMKID_LEN + 4 + 4)
+
+/**
+ * pmksa_cache_save_len - Buffer length needed by pmksa_cache_save()
+ * @pmksa: Pointer to PMKSA cache data from pmksa_cache_init()
+ * Returns: Number of bytes needed to save the current cache contents
+ */
+size_t pmksa_cache_save_len(struct rsn_pmksa_cache *pmksa)
+{
+    return PMKSA_SAVE_HDR_LEN + pmksa->pmksa_count * PMKSA_SAVE_REC_LEN +
+        PMKSA_SAVE_TAG_LEN;
+}
+
+
+/**
+ * pmksa_cache_save - Save PMKSA cache entries in encrypted form
+ * @pmksa: Pointer to PMKSA cache data from pmksa_cache_init()
+ * @key: AES key (16 or 32 bytes) used to protect the saved entries
+ * @key_len: Length of the key
+ * @buf: Buffer for the saved entries
+ * @len: Length of the buffer, at least pmksa_cache_save_len()
+ * Returns: Number of bytes written to buffer or -1 on failure
+ *
+ * Expired entries are not saved. The result can be kept in flash or RTC
+ * memory and passed to pmksa_cache_restore() after a reboot or deep sleep.
+ */
+int pmksa_cache_save(struct rsn_pmksa_cache *pmksa, const u8 *key,
+        size_t key_len, u8 *buf, size_t len)
+{
+    struct rsn_pmksa_cache_entry *entry;
+    struct os_reltime now;
+    struct os_time wall;
+    u8 *plain, *pos;
+    size_t plain_len;
+    int count = 0, ret = -1;
+
+    if (len < pmksa_cache_save_len(pmksa) || pmksa->pmksa_count > 255)
+        return -1;
+
+    plain = os_malloc(pmksa->pmksa_count * PMKSA_SAVE_REC_LEN + 1);
+    if (plain == NULL)
+        return -1;
+
+    os_get_reltime(&now);
+    pos = plain;
+    for (entry = pmksa->pmksa; entry; entry = entry->next) {
+        if (entry->expiration <= now.sec)
+            continue;
+        os_memcpy(pos, entry->aa, ETH_ALEN);
+        pos += ETH_ALEN;
+        WPA_PUT_BE32(pos, entry->akmp);
+        pos += 4;
+        *pos++ = entry->pmk_len;
+        os_memset(pos, 0, PMK_LEN_MAX);
+        os_memcpy(pos, entry->pmk, entry->pmk_len);
+        pos += PMK_LEN_MAX;
+        os_memcpy(pos, entry->pmkid, PMKID_LEN);
+        pos += PMKID_LEN;
+        WPA_PUT_BE32(pos, entry->expiration - now.sec);
+        pos += 4;
+        WPA_PUT_BE32(pos, entry->reauth_time > now.sec ?
+                entry->reauth_time - now.sec : 0);
+        pos += 4;
+        count++;
+    }
+    plain_len = pos - plain;
+
+    os_get_time(&wall);
+    os_memset(buf, 0, PMKSA_SAVE_HDR_LEN);
+    WPA_PUT_BE32(buf, PMKSA_SAVE_MAGIC);
+    buf[4] = PMKSA_SAVE_VERSION;
+    buf[5] = count;
+    WPA_PUT_BE64(buf + 8, (u64) wall.sec);
+    if (os_get_random(buf + 16, PMKSA_SAVE_IV_LEN) < 0)
+        goto out;
+
+    if (aes_gcm_ae(key, key_len, buf + 16, PMKSA_SAVE_IV_LEN,
+                plain, plain_len, buf, PMKSA_SAVE_HDR_LEN,
+                buf + PMKSA_SAVE_HDR_LEN,
+                buf + PMKSA_SAVE_HDR_LEN + plain_len) < 0)
+        goto out;
+
+    ret = PMKSA_SAVE_HDR_LEN + plain_len + PMKSA_SAVE_TAG_LEN;
+    wpa_printf(MSG_DEBUG, "RSN: Saved %d PMKSA cache entries", count);
+out:
+    bin_clear_free(plain, pmksa->pmksa_count * PMKSA_SAVE_REC_LEN + 1);
+    return ret;
+}
+
+
+/**
+ * pmksa_cache_restore - Restore PMKSA cache entries saved by pmksa_cache_save()
+ * @pmksa: Pointer to PMKSA cache data from pmksa_cache_init()
+ * @key: AES key used when the entries were saved
+ * @key_len: Length of the key
+ * @buf: Saved entries
+ * @len: Length of the saved entries
+ * Returns: Number of restored entries or -1 if the data could not be
+ * authenticated
+ *
+ * Entries are aged by the wall-clock time elapsed since they were saved and
+ * expired ones are dropped. If the clock went backwards (e.g., no time sync
+ * after a power cycle) the elapsed time is unknown and taken as zero; an AP
+ * that no longer knows the PMKID simply falls back to full authentication.
+ * Entries for an Authenticator that already has a cache entry are skipped.
+ */
+int pmksa_cache_restore(struct rsn_pmksa_cache *pmksa, const u8 *key,
+        size_t key_len, const u8 *buf, size_t len)
+{
+    struct rsn_pmksa_cache_entry *entry;
+    struct os_reltime now;
+    struct os_time wall;
+    u8 *plain;
+    const u8 *pos;
+    size_t plain_len;
+    os_time_t elapsed = 0, saved;
+    u32 lifetime, reauth;
+    int i, count, restored = 0;
+
+    if (len < PMKSA_SAVE_HDR_LEN + PMKSA_SAVE_TAG_LEN ||
+            WPA_GET_BE32(buf) != PMKSA_SAVE_MAGIC ||
+            buf[4] != PMKSA_SAVE_VERSION)
+        return -1;
+
+    count = buf[5];
+    plain_len = len - PMKSA_SAVE_HDR_LEN - PMKSA_SAVE_TAG_LEN;
+    if (plain_len != (size_t) count * PMKSA_SAVE_REC_LEN)
+        return -1;
+
+    plain = os_malloc(plain_len + 1);
+    if (plain == NULL)
+        return -1;
+
+    if (aes_gcm_ad(key, key_len, buf + 16, PMKSA_SAVE_IV_LEN,
+                buf + PMKSA_SAVE_HDR_LEN, plain_len,
+                buf, PMKSA_SAVE_HDR_LEN,
+                buf + PMKSA_SAVE_HDR_LEN + plain_len, plain) < 0) {
+        wpa_printf(MSG_DEBUG, "RSN: Saved PMKSA cache failed authentication");
+        bin_clear_free(plain, plain_len + 1);
+        return -1;
+    }
+
+    os_get_time(&wall);
+    saved = (os_time_t) WPA_GET_BE64(buf + 8);
+    if (wall.sec >= saved)
+        elapsed = wall.sec - saved;
+    os_get_reltime(&now);
+
+    pos = plain;
+    for (i = 0; i < count; i++, pos += PMKSA_SAVE_REC_LEN) {
+        const u8 *aa = pos;
+        size_t pmk_len = pos[ETH_ALEN + 4];
+
+        lifetime = WPA_GET_BE32(pos + PMKSA_SAVE_REC_LEN - 8);
+        reauth = WPA_GET_BE32(pos + PMKSA_SAVE_REC_LEN - 4);
+        if (lifetime <= elapsed || pmk_len > PMK_LEN_MAX ||
+                pmksa_cache_get(pmksa, aa, NULL, NULL))
+            continue;
+        /* Never schedule reauthentication after the entry has expired */
+        if (reauth > lifetime)
+            reauth = lifetime;
+
+        entry = os_zalloc(sizeof(*entry));
+        if (entry == NULL)
+            break;
+        os_memcpy(entry->aa, aa, ETH_ALEN);
+        entry->akmp = WPA_GET_BE32(pos + ETH_ALEN);
+        entry->pmk_len = pmk_len;
+        os_memcpy(entry->pmk, pos + ETH_ALEN + 4 + 1, pmk_len);
+        os_memcpy(entry->pmkid, pos + ETH_ALEN + 4 + 1 + PMK_LEN_MAX,
+                PMKID_LEN);
+        entry->expiration = now.sec + (os_time_t) (lifetime - elapsed);
+        entry->reauth_time = now.sec;
+        if (reauth > elapsed)
+            entry->reauth_time += (os_time_t) (reauth - elapsed);
+        entry->network_ctx = pmksa->sm->network_ctx;
+
+        if (pmksa_cache_add_entry(pmksa, entry))
+            restored++;
+    }
+
+    bin_clear_free(plain, plain_len + 1);
+    wpa_printf(MSG_DEBUG, "RSN: Restored %d of %d saved PMKSA cache entries",
+            restored, count);
+    return restored;
+}
+
+
 /**
  * pmksa_cache_init - Initialize PMKSA cache
  * @free_cb: Callback function to be called when a PMKSA cache entry is freed
@@ -69,6 +69,11 @@ pmksa_cache_get_opportunistic(struct rsn_pmksa_cache *pmksa,
         void *network_ctx, const u8 *aa);
 void pmksa_cache_flush(struct rsn_pmksa_cache *pmksa, void *network_ctx,
         const u8 *pmk, size_t pmk_len);
+size_t pmksa_cache_save_len(struct rsn_pmksa_cache *pmksa);
+int pmksa_cache_save(struct rsn_pmksa_cache *pmksa, const u8 *key,
+        size_t key_len, u8 *buf, size_t len);
+int pmksa_cache_restore(struct rsn_pmksa_cache *pmksa, const u8 *key,
+        size_t key_len, const u8 *buf, size_t len);
 
 #else /* IEEE8021X_EAPOL */
 
@@ -129,6 +134,23 @@ static inline void pmksa_cache_flush(struct rsn_pmksa_cache *pmksa,
 {
 }
 
+static inline size_t pmksa_cache_save_len(struct rsn_pmksa_cache *pmksa)
+{
+    return 0;
+}
+
+static inline int pmksa_cache_save(struct rsn_pmksa_cache *pmksa,
+        const u8 *key, size_t key_len, u8 *buf, size_t len)
+{
+    return -1;
+}
+
+static inline int pmksa_cache_restore(struct rsn_pmksa_cache *pmksa,
+        const u8 *key, size_t key_len, const u8 *buf, size_t len)
+{
+    return -1;
+}
+
 #endif /* IEEE8021X_EAPOL */
 
 #endif /* PMKSA_CACHE_H */
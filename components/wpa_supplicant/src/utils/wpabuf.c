@@ -311,3 +311,87 @@ void wpabuf_printf(struct wpabuf *buf, const char *fmt, ...)
 		wpabuf_overflow(buf, res);
 	buf->used += res;
 }
+
+
+/**
+ * wpabuf_chain_put_data - Append data to a chained buffer
+ * @chain: Chained buffer
+ * @data: Data to append
+ * @len: Length of the data
+ * Returns: 0 on success, -1 on failure
+ *
+ * The data is copied into a new segment; earlier segments are not touched.
+ */
+int wpabuf_chain_put_data(struct wpabuf_chain *chain, const void *data,
+			  size_t len)
+{
+	struct wpabuf_chain_seg *seg;
+
+	if (len == 0)
+		return 0;
+
+	seg = os_malloc(sizeof(*seg) + len);
+	if (seg == NULL)
+		return -1;
+	seg->next = NULL;
+	seg->len = len;
+	os_memcpy(seg + 1, data, len);
+
+	if (chain->tail)
+		chain->tail->next = seg;
+	else
+		chain->head = seg;
+	chain->tail = seg;
+	chain->len += len;
+
+	return 0;
+}
+
+
+/**
+ * wpabuf_chain_linearize - Move the data of a chained buffer into a wpabuf
+ * @chain: Chained buffer
+ * Returns: wpabuf with the data of all segments or %NULL on failure
+ *
+ * On success the segments are freed and the chain is left empty. On failure
+ * the chain is not modified.
+ */
+struct wpabuf * wpabuf_chain_linearize(struct wpabuf_chain *chain)
+{
+	struct wpabuf_chain_seg *seg, *next;
+	struct wpabuf *buf;
+
+	buf = wpabuf_alloc(chain->len);
+	if (buf == NULL)
+		return NULL;
+
+	for (seg = chain->head; seg; seg = next) {
+		next = seg->next;
+		wpabuf_put_data(buf, seg + 1, seg->len);
+		bin_clear_free(seg, sizeof(*seg) + seg->len);
+	}
+	chain->head = chain->tail = NULL;
+	chain->len = 0;
+
+	return buf;
+}
+
+
+/**
+ * wpabuf_chain_clear - Free all segments of a chained buffer
+ * @chain: Chained buffer
+ *
+ * Segment data is cleared before freeing since chains are used for key
+ * material carrying protocols like TLS.
+ */
+void wpabuf_chain_clear(struct wpabuf_chain *chain)
+{
+	struct wpabuf_chain_seg *seg, *next;
+
+	for (seg = chain->head; seg; seg = next) {
+		next = seg->next;
+		bin_clear_free(seg, sizeof(*seg) + seg->len);
+	}
+	chain->head = chain->tail = NULL;
+	chain->len = 0;
+}
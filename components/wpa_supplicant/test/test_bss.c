@@ -0,0 +1,192 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "string.h"
+#include <inttypes.h>
+#include "esp_system.h"
+#include "unity.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "utils/common.h"
+#include "common/ieee802_11_defs.h"
+#include "common/wpa_supplicant_i.h"
+#include "drivers/driver.h"
+#include "common/bss.h"
+#include "esp_log.h"
+
+#define TEST_BSS_NUM        16
+#define TEST_FRAME_NUM      8
+#define TEST_SCAN_NUM       10
+
+/* Build the IEs of a Beacon/Probe Response: SSID followed by a vendor IE
+ * whose length depends on the frame, like Beacons and Probe Responses of
+ * one AP differ in size.
+ */
+static size_t build_ies(u8 *ies, int bss, int frame)
+{
+    size_t len = 0;
+    size_t pad = (frame % 3) * 40 + bss;
+
+    ies[len++] = WLAN_EID_SSID;
+    ies[len++] = 6;
+    memcpy(&ies[len], "ssid", 4);
+    ies[len + 4] = '0' + bss / 10;
+    ies[len + 5] = '0' + bss % 10;
+    len += 6;
+    ies[len++] = WLAN_EID_VENDOR_SPECIFIC;
+    ies[len++] = pad;
+    memset(&ies[len], bss, pad);
+    len += pad;
+
+    return len;
+}
+
+static void ingest_scan(struct wpa_supplicant *wpa_s)
+{
+    struct wpa_scan_res res;
+    struct os_reltime now;
+    struct wpa_bss *bss;
+    u8 ies[256];
+    size_t ies_len;
+
+    os_get_reltime(&now);
+    wpa_bss_update_start(wpa_s);
+    for (int f = 0; f < TEST_FRAME_NUM; f++) {
+        for (int b = 0; b < TEST_BSS_NUM; b++) {
+            memset(&res, 0, sizeof(res));
+            res.bssid[0] = 0x02;
+            res.bssid[5] = b;
+            res.chan = 1 + b % 11;
+            res.ie_len = ies_len = build_ies(ies, b, f);
+            wpa_bss_update_scan_res_ies(wpa_s, &res, ies, &now);
+
+            bss = wpa_bss_get(wpa_s, res.bssid, &ies[2], ies[1]);
+            TEST_ASSERT_NOT_NULL(bss);
+            TEST_ASSERT_EQUAL(ies_len, bss->ie_len);
+            TEST_ASSERT_EQUAL_HEX8_ARRAY(ies, bss->ies, ies_len);
+        }
+    }
+    wpa_bss_update_end(wpa_s);
+}
+
+TEST_CASE("BSS table ingests scan results without allocation", "[wpa_supplicant]")
+{
+    struct wpa_supplicant *wpa_s = os_zalloc(sizeof(*wpa_s));
+    size_t free_heap;
+    int64_t start;
+
+    TEST_ASSERT_NOT_NULL(wpa_s);
+    wpa_bss_init(wpa_s);
+
+    /* The first scan allocates the entries, at their largest IE size */
+    ingest_scan(wpa_s);
+    TEST_ASSERT_EQUAL(TEST_BSS_NUM, wpa_s->num_bss);
+
+    free_heap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    start = esp_timer_get_time();
+    for (int i = 0; i < TEST_SCAN_NUM; i++) {
+        ingest_scan(wpa_s);
+    }
+    ESP_LOGI("test_bss", "%d frames per scan, %lld us per scan", TEST_BSS_NUM * TEST_FRAME_NUM,
+             (esp_timer_get_time() - start) / TEST_SCAN_NUM);
+    TEST_ASSERT_EQUAL(free_heap, heap_caps_get_free_size(MALLOC_CAP_8BIT));
+    TEST_ASSERT_EQUAL(TEST_BSS_NUM, wpa_s->num_bss);
+
+    /* Flushed entries are recycled by the next scan */
+    wpa_bss_flush(wpa_s);
+    TEST_ASSERT_EQUAL(0, wpa_s->num_bss);
+    TEST_ASSERT_NOT_EQUAL(0, wpa_s->num_bss_free);
+    ingest_scan(wpa_s);
+    TEST_ASSERT_EQUAL(TEST_BSS_NUM, wpa_s->num_bss);
+
+    wpa_bss_deinit(wpa_s);
+    TEST_ASSERT_EQUAL(0, wpa_s->num_bss_free);
+    os_free(wpa_s);
+}
+
+#define TEST_LOOKUP_NUM     256
+
+static struct wpa_bss *linear_get_bssid(struct wpa_supplicant *wpa_s, const u8 *bssid)
+{
+    struct wpa_bss *bss;
+
+    dl_list_for_each_reverse(bss, &wpa_s->bss, struct wpa_bss, list) {
+        if (os_memcmp(bss->bssid, bssid, ETH_ALEN) == 0) {
+            return bss;
+        }
+    }
+    return NULL;
+}
+
+TEST_CASE("BSS table hash index lookups", "[wpa_supplicant]")
+{
+    struct wpa_supplicant *wpa_s = os_zalloc(sizeof(*wpa_s));
+    struct wpa_scan_res res;
+    struct os_reltime now;
+    struct wpa_bss *bss;
+    u8 bssid[ETH_ALEN] = {0x02, 0, 0, 0, 0, 0};
+    u8 ies[256];
+    int64_t start, hash_us, linear_us;
+    int found = 0, count;
+
+    TEST_ASSERT_NOT_NULL(wpa_s);
+    wpa_bss_init(wpa_s);
+
+    /* Two ESSes, "ssid00" and "ssid01" */
+    os_get_reltime(&now);
+    wpa_bss_update_start(wpa_s);
+    for (int b = 0; b < TEST_BSS_NUM; b++) {
+        memset(&res, 0, sizeof(res));
+        res.bssid[0] = 0x02;
+        res.bssid[4] = b;
+        res.bssid[5] = b;
+        res.ie_len = build_ies(ies, b % 2, 0);
+        wpa_bss_update_scan_res_ies(wpa_s, &res, ies, &now);
+    }
+    wpa_bss_update_end(wpa_s);
+    TEST_ASSERT_EQUAL(TEST_BSS_NUM, wpa_s->num_bss);
+
+    /* Walk the ESS through the SSID index */
+    build_ies(ies, 1, 0);
+    count = 0;
+    for (bss = wpa_bss_get_next_ssid(wpa_s, &ies[2], ies[1], NULL); bss;
+         bss = wpa_bss_get_next_ssid(wpa_s, &ies[2], ies[1], bss)) {
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(&ies[2], bss->ssid, ies[1]);
+        count++;
+    }
+    TEST_ASSERT_EQUAL(TEST_BSS_NUM / 2, count);
+
+    /* Look up 256 BSSIDs, TEST_BSS_NUM of them are in the table */
+    for (int i = 0; i < TEST_LOOKUP_NUM; i++) {
+        bssid[4] = i;
+        bssid[5] = i;
+        bss = wpa_bss_get_bssid(wpa_s, bssid);
+        TEST_ASSERT(bss == linear_get_bssid(wpa_s, bssid));
+        found += bss != NULL;
+    }
+    TEST_ASSERT_EQUAL(TEST_BSS_NUM, found);
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < TEST_LOOKUP_NUM; i++) {
+        bssid[4] = i;
+        bssid[5] = i;
+        wpa_bss_get_bssid(wpa_s, bssid);
+    }
+    hash_us = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < TEST_LOOKUP_NUM; i++) {
+        bssid[4] = i;
+        bssid[5] = i;
+        linear_get_bssid(wpa_s, bssid);
+    }
+    linear_us = esp_timer_get_time() - start;
+
+    ESP_LOGI("test_bss", "%d lookups: hash index %lld us, list walk %lld us",
+             TEST_LOOKUP_NUM, hash_us, linear_us);
+
+    wpa_bss_deinit(wpa_s);
+    os_free(wpa_s);
+}
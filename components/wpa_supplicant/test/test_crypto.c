@@ -15,6 +15,9 @@
 #include "crypto/crypto.h"
 
 #include "mbedtls/ecp.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ctr_drbg.h"
+#include "esp_timer.h"
 #include "test_utils.h"
 
 typedef struct crypto_bignum crypto_bignum;
@@ -538,3 +541,86 @@ TEST_CASE("Test crypto lib ECC apis", "[wpa_crypto]")
     }
 
 }
+
+
+#define EC_BENCH_ROUNDS 10
+
+TEST_CASE("Test crypto lib EC group cache", "[wpa_crypto]")
+{
+    struct crypto_ec *e1, *e2;
+    struct crypto_ec_group *g1, *g2;
+
+    /* Groups are shared and survive deinit */
+    e1 = crypto_ec_init(19);
+    TEST_ASSERT_NOT_NULL(e1);
+    crypto_ec_deinit(e1);
+    e2 = crypto_ec_init(19);
+    TEST_ASSERT(e1 == e2);
+    TEST_ASSERT(crypto_ec_prime_len(e2) == 32);
+    crypto_ec_deinit(e2);
+
+    g1 = crypto_ec_get_group_byname("secp384r1");
+    g2 = crypto_ec_get_group_byname("secp384r1");
+    TEST_ASSERT_NOT_NULL(g1);
+    TEST_ASSERT(g1 == g2);
+    TEST_ASSERT(crypto_ec_prime_len((struct crypto_ec *)g1) == 48);
+    crypto_ec_deinit((struct crypto_ec *)g1);
+    crypto_ec_deinit((struct crypto_ec *)g2);
+    TEST_ASSERT(crypto_ec_get_group_byname("no-such-curve") == NULL);
+
+    {
+        /* Generator multiplication as done once per SAE/OWE/DPP key:
+         * group load + DRBG seeding before, cached group after */
+        mbedtls_ecp_group ref;
+        mbedtls_ecp_point ref_res;
+        mbedtls_mpi k;
+        mbedtls_entropy_context entropy;
+        mbedtls_ctr_drbg_context ctr_drbg;
+        struct crypto_ec *e;
+        struct crypto_ec_point *g, *res;
+        uint8_t scalar[32];
+        int64_t start, before = 0, after = 0;
+        int i;
+
+        for (i = 0; i < EC_BENCH_ROUNDS; i++) {
+            TEST_ASSERT(!os_get_random(scalar, sizeof(scalar)));
+            scalar[0] &= 0x7f;
+            mbedtls_mpi_init(&k);
+            TEST_ASSERT(mbedtls_mpi_read_binary(&k, scalar, sizeof(scalar)) == 0);
+
+            start = esp_timer_get_time();
+            mbedtls_ecp_group_init(&ref);
+            mbedtls_ecp_point_init(&ref_res);
+            mbedtls_entropy_init(&entropy);
+            mbedtls_ctr_drbg_init(&ctr_drbg);
+            TEST_ASSERT(mbedtls_ecp_group_load(&ref, MBEDTLS_ECP_DP_SECP256R1) == 0);
+            TEST_ASSERT(mbedtls_ctr_drbg_seed(&ctr_drbg, mbedtls_entropy_func, &entropy, NULL, 0) == 0);
+            TEST_ASSERT(mbedtls_ecp_mul(&ref, &ref_res, &k, &ref.G, mbedtls_ctr_drbg_random, &ctr_drbg) == 0);
+            before += esp_timer_get_time() - start;
+
+            start = esp_timer_get_time();
+            e = crypto_ec_init(19);
+            TEST_ASSERT_NOT_NULL(e);
+            g = crypto_ec_point_init(e);
+            res = crypto_ec_point_init(e);
+            TEST_ASSERT(mbedtls_ecp_copy((mbedtls_ecp_point *)g, &ref.G) == 0);
+            TEST_ASSERT(crypto_ec_point_mul(e, g, (crypto_bignum *) &k, res) == 0);
+            after += esp_timer_get_time() - start;
+
+            TEST_ASSERT(mbedtls_ecp_point_cmp(&ref_res, (mbedtls_ecp_point *)res) == 0);
+
+            crypto_ec_point_deinit(g, 1);
+            crypto_ec_point_deinit(res, 1);
+            crypto_ec_deinit(e);
+            mbedtls_ctr_drbg_free(&ctr_drbg);
+            mbedtls_entropy_free(&entropy);
+            mbedtls_ecp_point_free(&ref_res);
+            mbedtls_ecp_group_free(&ref);
+            mbedtls_mpi_free(&k);
+        }
+
+        ESP_LOGI("EC Test", "P-256 generator mul: %lld us uncached, %lld us cached",
+                 before / EC_BENCH_ROUNDS, after / EC_BENCH_ROUNDS);
+        TEST_ASSERT(after <= before);
+    }
+}
@@ -4,11 +4,15 @@
  * SPDX-License-Identifier: Unlicense OR CC0-1.0
  */
 #include "string.h"
+#include <stdio.h>
 #include <inttypes.h>
 #include "unity.h"
 #include "utils/common.h"
 #include "mbedtls/pkcs5.h"
 #include "crypto/sha1.h"
+#include "crypto/fastpbkdf2.h"
+#include "esp_timer.h"
+#include "esp_log.h"
 
 #if SOC_WIFI_SUPPORTED
 
@@ -65,4 +69,98 @@ TEST_CASE("Test pbkdf2", "[crypto-pbkdf2]")
 	TEST_ASSERT(memcmp(PMK, expected_pmk, PMK_LEN) == 0);
 }
 
+/* RFC 6070 test vectors (the 16777216 iteration one takes minutes on target) */
+static const struct {
+	const char *pw;
+	size_t npw;
+	const char *salt;
+	size_t nsalt;
+	uint32_t iterations;
+	size_t nout;
+	const uint8_t dk[25];
+} rfc6070_vectors[] = {
+	{ "password", 8, "salt", 4, 1, 20,
+	  {0x0c, 0x60, 0xc8, 0x0f, 0x96, 0x1f, 0x0e, 0x71, 0xf3, 0xa9, 0xb5, 0x24, 0xaf, 0x60, 0x12, 0x06,
+	   0x2f, 0xe0, 0x37, 0xa6} },
+	{ "password", 8, "salt", 4, 2, 20,
+	  {0xea, 0x6c, 0x01, 0x4d, 0xc7, 0x2d, 0x6f, 0x8c, 0xcd, 0x1e, 0xd9, 0x2a, 0xce, 0x1d, 0x41, 0xf0,
+	   0xd8, 0xde, 0x89, 0x57} },
+	{ "password", 8, "salt", 4, 4096, 20,
+	  {0x4b, 0x00, 0x79, 0x01, 0xb7, 0x65, 0x48, 0x9a, 0xbe, 0xad, 0x49, 0xd9, 0x26, 0xf7, 0x21, 0xd0,
+	   0x65, 0xa4, 0x29, 0xc1} },
+	{ "passwordPASSWORDpassword", 24, "saltSALTsaltSALTsaltSALTsaltSALTsalt", 36, 4096, 25,
+	  {0x3d, 0x2e, 0xec, 0x4f, 0xe4, 0x1c, 0x84, 0x9b, 0x80, 0xc8, 0xd8, 0x36, 0x62, 0xc0, 0xe4, 0x4a,
+	   0x8b, 0x29, 0x1a, 0x96, 0x4c, 0xf2, 0xf0, 0x70, 0x38} },
+	{ "pass\0word", 9, "sa\0lt", 5, 4096, 16,
+	  {0x56, 0xfa, 0x6a, 0xa7, 0x55, 0x48, 0x09, 0x9d, 0xcc, 0x37, 0xd7, 0xf0, 0x34, 0x25, 0xe0, 0xc3} },
+};
+
+TEST_CASE("Test pbkdf2 RFC 6070 vectors", "[crypto-pbkdf2]")
+{
+	fastpbkdf2_sha1_job job;
+	uint8_t dk[25];
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(rfc6070_vectors); i++) {
+		fastpbkdf2_hmac_sha1((const uint8_t *)rfc6070_vectors[i].pw, rfc6070_vectors[i].npw,
+				     (const uint8_t *)rfc6070_vectors[i].salt, rfc6070_vectors[i].nsalt,
+				     rfc6070_vectors[i].iterations, dk, rfc6070_vectors[i].nout);
+		TEST_ASSERT(memcmp(dk, rfc6070_vectors[i].dk, rfc6070_vectors[i].nout) == 0);
+
+		job.pw = (const uint8_t *)rfc6070_vectors[i].pw;
+		job.npw = rfc6070_vectors[i].npw;
+		job.salt = (const uint8_t *)rfc6070_vectors[i].salt;
+		job.nsalt = rfc6070_vectors[i].nsalt;
+		job.out = dk;
+		job.nout = rfc6070_vectors[i].nout;
+		os_memset(dk, 0, sizeof(dk));
+		fastpbkdf2_hmac_sha1_multi(&job, 1, rfc6070_vectors[i].iterations);
+		TEST_ASSERT(memcmp(dk, rfc6070_vectors[i].dk, rfc6070_vectors[i].nout) == 0);
+	}
+}
+
+#define TEST_MULTI_NUM 8
+
+TEST_CASE("Test pbkdf2 multi-lane", "[crypto-pbkdf2]")
+{
+	fastpbkdf2_sha1_job jobs[TEST_MULTI_NUM];
+	char passphrase[TEST_MULTI_NUM][16];
+	uint8_t PMK[TEST_MULTI_NUM][PMK_LEN];
+	uint8_t expected_pmk[PMK_LEN];
+	int64_t start, single_us, multi_us;
+	int i;
+
+	for (i = 0; i < TEST_MULTI_NUM; i++) {
+		snprintf(passphrase[i], sizeof(passphrase[i]), "espressif%d", i);
+		jobs[i].pw = (const uint8_t *)passphrase[i];
+		jobs[i].npw = strlen(passphrase[i]);
+		jobs[i].salt = (const uint8_t *)"espressif";
+		jobs[i].nsalt = strlen("espressif");
+		jobs[i].out = PMK[i];
+		/* Include a job with a partial last block */
+		jobs[i].nout = i == 1 ? 24 : PMK_LEN;
+	}
+
+	start = esp_timer_get_time();
+	fastpbkdf2_hmac_sha1_multi(jobs, TEST_MULTI_NUM, 4096);
+	multi_us = esp_timer_get_time() - start;
+
+	for (i = 0; i < TEST_MULTI_NUM; i++) {
+		mbedtls_pkcs5_pbkdf2_hmac_ext(MBEDTLS_MD_SHA1, jobs[i].pw, jobs[i].npw,
+					      jobs[i].salt, jobs[i].nsalt, 4096,
+					      jobs[i].nout, expected_pmk);
+		TEST_ASSERT(memcmp(PMK[i], expected_pmk, jobs[i].nout) == 0);
+	}
+
+	start = esp_timer_get_time();
+	for (i = 0; i < TEST_MULTI_NUM; i++) {
+		fastpbkdf2_hmac_sha1(jobs[i].pw, jobs[i].npw, jobs[i].salt,
+				     jobs[i].nsalt, 4096, PMK[i], jobs[i].nout);
+	}
+	single_us = esp_timer_get_time() - start;
+
+	ESP_LOGI("test_pbkdf2", "%d PSKs: one at a time %lld us, multi-lane %lld us",
+		 TEST_MULTI_NUM, single_us, multi_us);
+}
+
 #endif /* SOC_WIFI_SUPPORTED */
@@ -0,0 +1,127 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "string.h"
+#include <sys/time.h>
+#include "unity.h"
+#include "utils/includes.h"
+#include "utils/common.h"
+#include "rsn_supp/wpa.h"
+#include "rsn_supp/wpa_i.h"
+#include "rsn_supp/pmksa_cache.h"
+
+#define TEST_PMKSA_NUM      4
+
+static const u8 test_key[16] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+
+static void test_free_cb(struct rsn_pmksa_cache_entry *entry, void *ctx,
+                         enum pmksa_free_reason reason)
+{
+}
+
+static void test_aa(u8 *aa, int i)
+{
+    static const u8 base[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x11, 0x22, 0x00 };
+
+    memcpy(aa, base, ETH_ALEN);
+    aa[5] = i;
+}
+
+TEST_CASE("PMKSA cache save and restore", "[wpa_supplicant]")
+{
+    static const u8 spa[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x33, 0x44, 0x55 };
+    struct wpa_sm sm_a, sm_b;
+    struct rsn_pmksa_cache *a, *b;
+    struct rsn_pmksa_cache_entry *entry, *restored;
+    struct os_reltime now;
+    struct timeval tv;
+    u8 aa[ETH_ALEN], pmk[PMK_LEN], wrong_key[16];
+    u8 *buf;
+    size_t len;
+    int i, ret;
+
+    memset(&sm_a, 0, sizeof(sm_a));
+    memset(&sm_b, 0, sizeof(sm_b));
+    a = pmksa_cache_init(test_free_cb, &sm_a, &sm_a);
+    b = pmksa_cache_init(test_free_cb, &sm_b, &sm_b);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+
+    for (i = 0; i < TEST_PMKSA_NUM; i++) {
+        test_aa(aa, i);
+        memset(pmk, 0xa0 + i, sizeof(pmk));
+        TEST_ASSERT_NOT_NULL(pmksa_cache_add(a, pmk, sizeof(pmk), NULL,
+                                             NULL, 0, aa, spa, NULL,
+                                             WPA_KEY_MGMT_SAE));
+    }
+
+    /* Last entry is about to expire */
+    os_get_reltime(&now);
+    test_aa(aa, TEST_PMKSA_NUM - 1);
+    entry = pmksa_cache_get(a, aa, NULL, NULL);
+    TEST_ASSERT_NOT_NULL(entry);
+    entry->expiration = now.sec + 5;
+
+    len = pmksa_cache_save_len(a);
+    buf = os_malloc(len);
+    TEST_ASSERT_NOT_NULL(buf);
+    TEST_ASSERT_EQUAL(-1, pmksa_cache_save(a, test_key, sizeof(test_key),
+                                           buf, len - 1));
+    ret = pmksa_cache_save(a, test_key, sizeof(test_key), buf, len);
+    TEST_ASSERT_EQUAL(len, ret);
+
+    /* Wrong key and tampered data are rejected */
+    memcpy(wrong_key, test_key, sizeof(wrong_key));
+    wrong_key[0] ^= 0x01;
+    TEST_ASSERT_EQUAL(-1, pmksa_cache_restore(b, wrong_key, sizeof(wrong_key),
+                                              buf, len));
+    buf[len / 2] ^= 0x01;
+    TEST_ASSERT_EQUAL(-1, pmksa_cache_restore(b, test_key, sizeof(test_key),
+                                              buf, len));
+    buf[len / 2] ^= 0x01;
+
+    /* All entries restore with the same PMK, PMKID and AKMP */
+    TEST_ASSERT_EQUAL(TEST_PMKSA_NUM,
+                      pmksa_cache_restore(b, test_key, sizeof(test_key),
+                                          buf, len));
+    for (i = 0; i < TEST_PMKSA_NUM; i++) {
+        test_aa(aa, i);
+        entry = pmksa_cache_get(a, aa, NULL, NULL);
+        restored = pmksa_cache_get(b, aa, entry->pmkid, NULL);
+        TEST_ASSERT_NOT_NULL(restored);
+        TEST_ASSERT_EQUAL(entry->pmk_len, restored->pmk_len);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(entry->pmk, restored->pmk,
+                                     entry->pmk_len);
+        TEST_ASSERT_EQUAL(entry->akmp, restored->akmp);
+        TEST_ASSERT_INT_WITHIN(1, entry->expiration, restored->expiration);
+    }
+
+    /* Restoring again does not duplicate entries */
+    TEST_ASSERT_EQUAL(0, pmksa_cache_restore(b, test_key, sizeof(test_key),
+                                             buf, len));
+    pmksa_cache_deinit(b);
+
+    /* Entries age by the time spent away; the short-lived one expires */
+    gettimeofday(&tv, NULL);
+    tv.tv_sec += 10;
+    settimeofday(&tv, NULL);
+    b = pmksa_cache_init(test_free_cb, &sm_b, &sm_b);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_EQUAL(TEST_PMKSA_NUM - 1,
+                      pmksa_cache_restore(b, test_key, sizeof(test_key),
+                                          buf, len));
+    test_aa(aa, TEST_PMKSA_NUM - 1);
+    TEST_ASSERT_NULL(pmksa_cache_get(b, aa, NULL, NULL));
+    gettimeofday(&tv, NULL);
+    tv.tv_sec -= 10;
+    settimeofday(&tv, NULL);
+
+    os_free(buf);
+    pmksa_cache_deinit(a);
+    pmksa_cache_deinit(b);
+}
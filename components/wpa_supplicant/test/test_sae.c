@@ -11,6 +11,7 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <time.h>
+#include <inttypes.h>
 #include "unity.h"
 #include <string.h>
 #include "utils/common.h"
@@ -19,6 +20,17 @@
 #include "../src/common/sae.h"
 #include "utils/wpabuf.h"
 #include "test_utils.h"
+#include "esp_wpa3_i.h"
+#include "esp_event.h"
+#include "esp_wifi.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "common/ieee802_11_defs.h"
+#include "ap/hostapd.h"
+#include "ap/ap_config.h"
+#include "ap/sta_info.h"
+#include "ap/ieee802_11.h"
 #if !CONFIG_IDF_TARGET_ESP32H2 // IDF-6781
 typedef struct crypto_bignum crypto_bignum;
 
@@ -423,5 +435,190 @@ TEST_CASE("Test SAE functionality with ECC group", "[wpa3_sae]")
     ESP_LOGI("SAE Test", "=========== Complete ============");
 
 }
+
+static void sae_pt_to_bin(struct sae_pt *pt, u8 *bin)
+{
+    size_t prime_len = crypto_ec_prime_len(pt->ec);
+
+    TEST_ASSERT(crypto_ec_point_to_bin(pt->ec, pt->ecc_pt, bin, bin + prime_len) == 0);
+}
+
+TEST_CASE("Test SAE H2E PT cache", "[wpa3_sae]")
+{
+    const char *ssid = "byteme";
+    const char *pw = "mekmitasdigoat";
+    const char *pw2 = "mekmitasdigoat2";
+    int groups[] = { IANA_SECP256R1, 0 };
+    u8 ref[SAE_MAX_ECC_PRIME_LEN * 2], bin[SAE_MAX_ECC_PRIME_LEN * 2];
+    struct sae_pt *pt;
+    unsigned int hits, misses;
+
+    esp_wpa3_sae_pt_cache_clear();
+
+    pt = sae_derive_pt(groups, (const u8 *) ssid, os_strlen(ssid),
+                       (const u8 *) pw, os_strlen(pw), NULL);
+    TEST_ASSERT(pt != NULL);
+    sae_pt_to_bin(pt, ref);
+    sae_deinit_pt(pt);
+
+    /* First lookup derives and fills the cache */
+    pt = esp_wpa3_sae_pt_get(groups, (const u8 *) ssid, os_strlen(ssid),
+                             (const u8 *) pw, os_strlen(pw), NULL);
+    TEST_ASSERT(pt != NULL);
+    TEST_ASSERT(pt->group == IANA_SECP256R1);
+    sae_pt_to_bin(pt, bin);
+    TEST_ASSERT(os_memcmp(ref, bin, sizeof(bin)) == 0);
+    sae_deinit_pt(pt);
+    esp_wpa3_sae_pt_cache_get_stats(&hits, &misses);
+    TEST_ASSERT_EQUAL(0, hits);
+    TEST_ASSERT_EQUAL(1, misses);
+
+    /* Reconnect with the same credentials is served from the cache */
+    pt = esp_wpa3_sae_pt_get(groups, (const u8 *) ssid, os_strlen(ssid),
+                             (const u8 *) pw, os_strlen(pw), NULL);
+    TEST_ASSERT(pt != NULL);
+    sae_pt_to_bin(pt, bin);
+    TEST_ASSERT(os_memcmp(ref, bin, sizeof(bin)) == 0);
+    sae_deinit_pt(pt);
+    esp_wpa3_sae_pt_cache_get_stats(&hits, &misses);
+    TEST_ASSERT_EQUAL(1, hits);
+    TEST_ASSERT_EQUAL(1, misses);
+
+    /* A password identifier or a password change must not hit the old entry */
+    pt = esp_wpa3_sae_pt_get(groups, (const u8 *) ssid, os_strlen(ssid),
+                             (const u8 *) pw, os_strlen(pw), "psk4internet");
+    TEST_ASSERT(pt != NULL);
+    sae_pt_to_bin(pt, bin);
+    TEST_ASSERT(os_memcmp(ref, bin, sizeof(bin)) != 0);
+    sae_deinit_pt(pt);
+
+    pt = esp_wpa3_sae_pt_get(groups, (const u8 *) ssid, os_strlen(ssid),
+                             (const u8 *) pw2, os_strlen(pw2), NULL);
+    TEST_ASSERT(pt != NULL);
+    sae_pt_to_bin(pt, bin);
+    TEST_ASSERT(os_memcmp(ref, bin, sizeof(bin)) != 0);
+    sae_deinit_pt(pt);
+    esp_wpa3_sae_pt_cache_get_stats(&hits, &misses);
+    TEST_ASSERT_EQUAL(1, hits);
+    TEST_ASSERT_EQUAL(3, misses);
+
+    /* The old credentials were replaced and need a fresh derivation */
+    pt = esp_wpa3_sae_pt_get(groups, (const u8 *) ssid, os_strlen(ssid),
+                             (const u8 *) pw, os_strlen(pw), NULL);
+    TEST_ASSERT(pt != NULL);
+    sae_pt_to_bin(pt, bin);
+    TEST_ASSERT(os_memcmp(ref, bin, sizeof(bin)) == 0);
+    sae_deinit_pt(pt);
+    esp_wpa3_sae_pt_cache_get_stats(&hits, &misses);
+    TEST_ASSERT_EQUAL(1, hits);
+    TEST_ASSERT_EQUAL(4, misses);
+
+    /* Clearing the cache wipes the elements and the counters */
+    esp_wpa3_sae_pt_cache_clear();
+    pt = esp_wpa3_sae_pt_get(groups, (const u8 *) ssid, os_strlen(ssid),
+                             (const u8 *) pw, os_strlen(pw), NULL);
+    TEST_ASSERT(pt != NULL);
+    sae_deinit_pt(pt);
+    esp_wpa3_sae_pt_cache_get_stats(&hits, &misses);
+    TEST_ASSERT_EQUAL(0, hits);
+    TEST_ASSERT_EQUAL(1, misses);
+
+    esp_wpa3_sae_pt_cache_clear();
+}
+
+#ifdef CONFIG_SAE
+#define TEST_SAE_AP_SSID        "sae_workers"
+#define TEST_SAE_AP_PASSWORD    "mekmitasdigoat"
+#define TEST_SAE_AP_STAS        4
+
+TEST_CASE("Test SoftAP SAE commits from several stations", "[wpa3_sae]")
+{
+    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+    wifi_config_t ap_config = {
+        .ap = {
+            .ssid = TEST_SAE_AP_SSID,
+            .ssid_len = sizeof(TEST_SAE_AP_SSID) - 1,
+            .password = TEST_SAE_AP_PASSWORD,
+            .max_connection = TEST_SAE_AP_STAS,
+            .authmode = WIFI_AUTH_WPA3_PSK,
+            .sae_pwe_h2e = WPA3_SAE_PWE_BOTH,
+            .pmf_cfg = {
+                .required = true,
+            },
+        },
+    };
+    u8 sta_addr[ETH_ALEN] = { 0x02, 0x00, 0x5a, 0xe0, 0x00, 0x00 };
+    u8 ap_addr[ETH_ALEN];
+    struct wpa3_hostap_sae_stats stats;
+    struct hostapd_data *hapd;
+    int i, retry;
+
+    cfg.nvs_enable = false;
+    TEST_ESP_OK(esp_event_loop_create_default());
+    TEST_ESP_OK(esp_wifi_init(&cfg));
+    TEST_ESP_OK(esp_wifi_set_mode(WIFI_MODE_AP));
+    TEST_ESP_OK(esp_wifi_set_config(WIFI_IF_AP, &ap_config));
+    TEST_ESP_OK(esp_wifi_start());
+    TEST_ESP_OK(esp_wifi_get_mac(WIFI_IF_AP, ap_addr));
+
+    hapd = (struct hostapd_data *)esp_wifi_get_hostap_private_internal();
+    TEST_ASSERT(hapd != NULL);
+    wpa3_hostap_sae_stats_reset();
+
+    /* Queue one commit per station back to back, as a burst of joins would */
+    for (i = 0; i < TEST_SAE_AP_STAS; i++) {
+        struct sae_data sae;
+        struct wpabuf *buf;
+
+        sta_addr[5] = i;
+        memset(&sae, 0, sizeof(sae));
+        TEST_ASSERT(sae_set_group(&sae, IANA_SECP256R1) == 0);
+        TEST_ASSERT(sae_prepare_commit(sta_addr, ap_addr, (const u8 *) TEST_SAE_AP_PASSWORD,
+                                       strlen(TEST_SAE_AP_PASSWORD), &sae) == 0);
+        buf = wpabuf_alloc2(SAE_COMMIT_MAX_LEN);
+        TEST_ASSERT(buf != NULL);
+        TEST_ASSERT(sae_write_commit(&sae, buf, NULL, NULL) == 0);
+        TEST_ASSERT(auth_sae_queue(hapd, wpabuf_mhead_u8(buf), wpabuf_len(buf), sta_addr,
+                                   WLAN_STATUS_SUCCESS, SAE_MSG_COMMIT) == 0);
+        wpabuf_free2(buf);
+        sae_clear_data(&sae);
+    }
+
+    for (retry = 0; retry < 100; retry++) {
+        wpa3_hostap_sae_stats_get(&stats);
+        if (stats.processed + stats.dropped == TEST_SAE_AP_STAS && stats.in_flight == 0) {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(50));
+    }
+    ESP_LOGI("SAE Test", "%d SAE workers: max latency %" PRIu32 " us, mean %" PRIu32 " us",
+             WPA3_HOSTAP_SAE_WORKERS, stats.latency_max_us,
+             stats.processed ? (u32)(stats.latency_total_us / stats.processed) : 0);
+
+    /* Every commit left the queue and was handled exactly once */
+    TEST_ASSERT_EQUAL(TEST_SAE_AP_STAS, stats.queued);
+    TEST_ASSERT_EQUAL(TEST_SAE_AP_STAS, stats.processed);
+    TEST_ASSERT_EQUAL(0, stats.dropped);
+    TEST_ASSERT_EQUAL(0, stats.queue_depth);
+    TEST_ASSERT_EQUAL(0, stats.in_flight);
+
+    /* Each worker added its own station, and removal frees it */
+    for (i = 0; i < TEST_SAE_AP_STAS; i++) {
+        sta_addr[5] = i;
+        TEST_ASSERT(ap_get_sta(hapd, sta_addr) != NULL);
+        TEST_ASSERT(wpa_ap_remove(sta_addr));
+        TEST_ASSERT(ap_get_sta(hapd, sta_addr) == NULL);
+    }
+
+    wpa3_hostap_sae_stats_reset();
+    wpa3_hostap_sae_stats_get(&stats);
+    TEST_ASSERT_EQUAL(0, stats.queued);
+    TEST_ASSERT_EQUAL(0, stats.processed);
+
+    TEST_ESP_OK(esp_wifi_stop());
+    TEST_ESP_OK(esp_wifi_deinit());
+    TEST_ESP_OK(esp_event_loop_delete_default());
+}
+#endif /* CONFIG_SAE */
 #endif
 #endif /* CONFIG_WPA3_SAE */
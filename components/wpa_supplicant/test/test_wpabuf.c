@@ -0,0 +1,109 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "string.h"
+#include <inttypes.h>
+#include <sys/param.h>
+#include "unity.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "utils/includes.h"
+#include "utils/common.h"
+#include "utils/wpabuf.h"
+#include "esp_log.h"
+
+/* A certificate chain sized TLS message received in EAP-TLS fragments */
+#define TEST_MSG_LEN        16384
+#define TEST_FRAG_LEN       1024
+
+static void fill_fragment(u8 *frag, size_t len, size_t offset)
+{
+    for (size_t i = 0; i < len; i++) {
+        frag[i] = (u8)(offset + i);
+    }
+}
+
+TEST_CASE("wpabuf chain reassembles fragments", "[wpa_supplicant]")
+{
+    struct wpabuf_chain chain;
+    struct wpabuf *grown = NULL, *linear, frag;
+    u8 *data = os_malloc(TEST_FRAG_LEN);
+    size_t free_heap, chain_heap, min_free_grown, min_free_chain;
+    int64_t start, grown_us, chain_us;
+
+    TEST_ASSERT_NOT_NULL(data);
+    free_heap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+
+    /* Growing a single buffer, as fragment reassembly used to do */
+    min_free_grown = free_heap;
+    start = esp_timer_get_time();
+    for (size_t off = 0; off < TEST_MSG_LEN; off += TEST_FRAG_LEN) {
+        fill_fragment(data, TEST_FRAG_LEN, off);
+        wpabuf_set(&frag, data, TEST_FRAG_LEN);
+        TEST_ASSERT_EQUAL(0, wpabuf_resize(&grown, TEST_FRAG_LEN));
+        wpabuf_put_buf(grown, &frag);
+        min_free_grown = MIN(min_free_grown, heap_caps_get_free_size(MALLOC_CAP_8BIT));
+    }
+    grown_us = esp_timer_get_time() - start;
+
+    /* Chaining the fragments and linearizing once */
+    os_memset(&chain, 0, sizeof(chain));
+    chain_heap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    min_free_chain = chain_heap;
+    start = esp_timer_get_time();
+    for (size_t off = 0; off < TEST_MSG_LEN; off += TEST_FRAG_LEN) {
+        fill_fragment(data, TEST_FRAG_LEN, off);
+        wpabuf_set(&frag, data, TEST_FRAG_LEN);
+        TEST_ASSERT_EQUAL(0, wpabuf_chain_put_buf(&chain, &frag));
+        min_free_chain = MIN(min_free_chain, heap_caps_get_free_size(MALLOC_CAP_8BIT));
+    }
+    TEST_ASSERT_EQUAL(TEST_MSG_LEN, wpabuf_chain_len(&chain));
+    linear = wpabuf_chain_linearize(&chain);
+    chain_us = esp_timer_get_time() - start;
+    TEST_ASSERT_NOT_NULL(linear);
+    TEST_ASSERT_EQUAL(0, wpabuf_chain_len(&chain));
+
+    ESP_LOGI("test_wpabuf", "%d byte message in %d byte fragments: resize %lld us, chain %lld us",
+             TEST_MSG_LEN, TEST_FRAG_LEN, grown_us, chain_us);
+    ESP_LOGI("test_wpabuf", "heap in use while reassembling: resize %u, chain %u (before linearize)",
+             (unsigned)(free_heap - min_free_grown), (unsigned)(chain_heap - min_free_chain));
+
+    TEST_ASSERT_EQUAL(TEST_MSG_LEN, wpabuf_len(linear));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(wpabuf_head(grown), wpabuf_head(linear), TEST_MSG_LEN);
+    wpabuf_free(grown);
+    wpabuf_free(linear);
+
+    /* Clearing a partially filled chain frees all segments */
+    TEST_ASSERT_EQUAL(0, wpabuf_chain_put_data(&chain, data, TEST_FRAG_LEN));
+    TEST_ASSERT_EQUAL(0, wpabuf_chain_put_data(&chain, data, TEST_FRAG_LEN));
+    wpabuf_chain_clear(&chain);
+    TEST_ASSERT_EQUAL(0, wpabuf_chain_len(&chain));
+
+    TEST_ASSERT_EQUAL(free_heap, heap_caps_get_free_size(MALLOC_CAP_8BIT));
+    os_free(data);
+}
+
+TEST_CASE("wpabuf slice views", "[wpa_supplicant]")
+{
+    struct wpabuf *buf = wpabuf_alloc(64);
+    struct wpabuf view;
+    u8 data[64];
+
+    TEST_ASSERT_NOT_NULL(buf);
+    fill_fragment(data, sizeof(data), 0);
+    wpabuf_put_data(buf, data, sizeof(data));
+
+    wpabuf_slice(&view, buf, 16, 32);
+    TEST_ASSERT_EQUAL(32, wpabuf_len(&view));
+    TEST_ASSERT_EQUAL_PTR(wpabuf_head_u8(buf) + 16, wpabuf_head(&view));
+
+    TEST_ASSERT_EQUAL_PTR(wpabuf_head_u8(buf) + 16, wpabuf_pull(&view, 5));
+    TEST_ASSERT_EQUAL(27, wpabuf_len(&view));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(data + 21, wpabuf_head(&view), 27);
+    wpabuf_pull(&view, 27);
+    TEST_ASSERT_EQUAL(0, wpabuf_len(&view));
+
+    wpabuf_free(buf);
+}
@@ -0,0 +1,23 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Host replacement of esp_supplicant/src/esp_wifi_driver.h, only what bss.c uses */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum wpa_alg {
+	WIFI_WPA_ALG_NONE,
+};
+
+struct wifi_ssid {
+	int len;
+	uint8_t ssid[32];
+};
+
+struct wifi_ssid *esp_wifi_sta_get_prof_ssid_internal(void);
@@ -0,0 +1,239 @@
+/*
+ * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Host test and benchmark of the BSS table of bss.c with a few hundred entries:
+ * the BSSID and SSID hash indexes against a walk of the whole list.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include "utils/includes.h"
+#include "utils/common.h"
+#include "common/ieee802_11_defs.h"
+#include "common/wpa_supplicant_i.h"
+#include "drivers/driver.h"
+#include "common/bss.h"
+
+#define TEST_SSID_NUM       8
+/* More BSSIDs than entries, so that the table is full and evicts */
+#define TEST_BSSID_NUM      (MAX_BSS_COUNT + MAX_BSS_COUNT / 4)
+#define TEST_ROUNDS         20000
+#define BENCH_LOOKUPS       200000
+
+static struct wifi_ssid s_prof_ssid;
+
+struct wifi_ssid *esp_wifi_sta_get_prof_ssid_internal(void)
+{
+    return &s_prof_ssid;
+}
+
+int os_get_time(struct os_time *t)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    t->sec = tv.tv_sec;
+    t->usec = tv.tv_usec;
+    return 0;
+}
+
+/* Used by the parsers of ieee802_11_common.c, which the BSS table does not call */
+int hwaddr_aton2(const char *txt, u8 *addr)
+{
+    abort();
+}
+
+int hexstr2bin(const char *hex, u8 *buf, size_t len)
+{
+    abort();
+}
+
+struct wpabuf *wpabuf_alloc(size_t len)
+{
+    abort();
+}
+
+void *wpabuf_put(struct wpabuf *buf, size_t len)
+{
+    abort();
+}
+
+static void bssid_init(u8 *bssid, int idx)
+{
+    memset(bssid, 0, ETH_ALEN);
+    bssid[0] = 0x02;
+    bssid[4] = idx >> 8;
+    bssid[5] = idx;
+}
+
+/* SSID IE, and a vendor IE whose length changes from frame to frame */
+static size_t build_ies(u8 *ies, int ssid, int pad)
+{
+    size_t len = 0;
+
+    ies[len++] = WLAN_EID_SSID;
+    ies[len++] = 6;
+    memcpy(&ies[len], "ssid", 4);
+    ies[len + 4] = '0' + ssid / 10;
+    ies[len + 5] = '0' + ssid % 10;
+    len += 6;
+    ies[len++] = WLAN_EID_VENDOR_SPECIFIC;
+    ies[len++] = pad;
+    memset(&ies[len], ssid, pad);
+    return len + pad;
+}
+
+static void ingest(struct wpa_supplicant *wpa_s, int idx, int pad)
+{
+    struct wpa_scan_res res;
+    struct os_reltime now;
+    u8 ies[256];
+
+    memset(&res, 0, sizeof(res));
+    bssid_init(res.bssid, idx);
+    res.chan = 1 + idx % 11;
+    res.level = -30 - idx % 60;
+    res.ie_len = build_ies(ies, idx % TEST_SSID_NUM, pad);
+    os_get_reltime(&now);
+    wpa_bss_update_scan_res_ies(wpa_s, &res, ies, &now);
+}
+
+/* Reference lookups, by a walk of the whole list from the most recently updated entry */
+static struct wpa_bss *linear_get_bssid(struct wpa_supplicant *wpa_s, const u8 *bssid)
+{
+    struct wpa_bss *bss;
+
+    dl_list_for_each_reverse(bss, &wpa_s->bss, struct wpa_bss, list) {
+        if (os_memcmp(bss->bssid, bssid, ETH_ALEN) == 0) {
+            return bss;
+        }
+    }
+    return NULL;
+}
+
+static int linear_count_ssid(struct wpa_supplicant *wpa_s, const u8 *ssid, size_t ssid_len)
+{
+    struct wpa_bss *bss;
+    int count = 0;
+
+    dl_list_for_each(bss, &wpa_s->bss, struct wpa_bss, list) {
+        if (bss->ssid_len == ssid_len && os_memcmp(bss->ssid, ssid, ssid_len) == 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static void check_all(struct wpa_supplicant *wpa_s)
+{
+    u8 bssid[ETH_ALEN], ies[256];
+    struct wpa_bss *bss;
+    int count;
+
+    for (int i = 0; i < TEST_BSSID_NUM; i++) {
+        bssid_init(bssid, i);
+        bss = wpa_bss_get_bssid(wpa_s, bssid);
+        assert(bss == linear_get_bssid(wpa_s, bssid));
+        if (bss) {
+            build_ies(ies, i % TEST_SSID_NUM, 0);
+            assert(wpa_bss_get(wpa_s, bssid, &ies[2], ies[1]) == bss);
+        }
+    }
+
+    /* Every entry of an ESS comes once through the SSID index */
+    for (int s = 0; s < TEST_SSID_NUM; s++) {
+        build_ies(ies, s, 0);
+        count = 0;
+        for (bss = wpa_bss_get_next_ssid(wpa_s, &ies[2], ies[1], NULL); bss;
+                bss = wpa_bss_get_next_ssid(wpa_s, &ies[2], ies[1], bss)) {
+            assert(bss->ssid_len == ies[1] && memcmp(bss->ssid, &ies[2], ies[1]) == 0);
+            assert(wpa_bss_get_bssid(wpa_s, bss->bssid) == bss);
+            count++;
+        }
+        assert(count == linear_count_ssid(wpa_s, &ies[2], ies[1]));
+    }
+}
+
+static void check_table(struct wpa_supplicant *wpa_s)
+{
+    /* Fill the table up to its size */
+    wpa_bss_update_start(wpa_s);
+    for (int i = 0; i < MAX_BSS_COUNT; i++) {
+        ingest(wpa_s, i, i % 64);
+    }
+    wpa_bss_update_end(wpa_s);
+    assert(wpa_s->num_bss == MAX_BSS_COUNT);
+    check_all(wpa_s);
+
+    /* Updates reorder the lists and the hash chains, new BSSIDs evict the oldest entries */
+    for (int round = 0; round < TEST_ROUNDS; round++) {
+        if (round % 100 == 0) {
+            wpa_bss_update_end(wpa_s);
+            wpa_bss_update_start(wpa_s);
+        }
+        ingest(wpa_s, rand() % TEST_BSSID_NUM, rand() % 64);
+        assert(wpa_s->num_bss <= MAX_BSS_COUNT);
+        if (round % 1000 == 0) {
+            check_all(wpa_s);
+        }
+    }
+    wpa_bss_update_end(wpa_s);
+    assert(wpa_s->num_bss == MAX_BSS_COUNT);
+    check_all(wpa_s);
+}
+
+static double elapsed_s(const struct timespec *start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static double bench(struct wpa_supplicant *wpa_s, bool linear)
+{
+    struct timespec start;
+    volatile int found = 0;
+    u8 bssid[ETH_ALEN];
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCH_LOOKUPS; i++) {
+        /* Some of them were evicted */
+        bssid_init(bssid, i % TEST_BSSID_NUM);
+        if (linear) {
+            found += !!linear_get_bssid(wpa_s, bssid);
+        } else {
+            found += !!wpa_bss_get_bssid(wpa_s, bssid);
+        }
+    }
+    return BENCH_LOOKUPS / elapsed_s(&start);
+}
+
+int main(void)
+{
+    struct wpa_supplicant *wpa_s = os_zalloc(sizeof(*wpa_s));
+
+    assert(wpa_s);
+    srand(1);
+    wpa_bss_init(wpa_s);
+    check_table(wpa_s);
+
+    double linear = bench(wpa_s, true);
+    double hashed = bench(wpa_s, false);
+    printf("BSSID lookups/s with %d entries: list walk %.0f, hash index %.0f\n",
+           MAX_BSS_COUNT, linear, hashed);
+
+    wpa_bss_flush(wpa_s);
+    assert(wpa_s->num_bss == 0);
+    wpa_bss_deinit(wpa_s);
+    free(wpa_s->last_scan_res);
+    free(wpa_s);
+    printf("All tests passed\n");
+    return 0;
+}